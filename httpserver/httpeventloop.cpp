@@ -0,0 +1,407 @@
+/**
+  @file
+  @author Mark Liversedge
+*/
+
+#include "httpeventloop.h"
+#include <QMutexLocker>
+
+// response bytes queued on a socket before the head of the pipeline waits
+static const int MAXBUFFERED=256*1024;
+
+HttpEventJob::HttpEventJob(HttpEventConnection* connection, HttpRequest* request, HttpRequestHandler* requestHandler, int limit) {
+    this->connection=connection;
+    this->request=request;
+    this->requestHandler=requestHandler;
+    this->limit=limit;
+    head=false;
+    finished=false;
+    aborted=false;
+    setAutoDelete(false);
+
+    // HTTP/1.0 clients close the connection unless they ask to keep it
+    QByteArray mode=request->getHeader("Connection").toLower();
+    closing=(mode=="close" || (request->getVersion()=="HTTP/1.0" && mode!="keep-alive"));
+}
+
+
+HttpEventJob::~HttpEventJob() {
+    delete request;
+}
+
+
+void HttpEventJob::run() {
+    HttpResponse response(this);
+    try {
+        requestHandler->service(*request, response);
+    }
+    catch (...) {
+        qCritical("HttpEventJob (%p): An uncatched exception occured in the request handler",this);
+    }
+
+    // Finalize sending the response if not already done
+    if (!response.hasSentLastPart()) {
+        response.write(QByteArray(),true);
+    }
+
+    // Posted while locked, the connection deletes the job once it sees it
+    // finished and the job must not be touched after that
+    QMutexLocker locker(&mutex);
+    finished=true;
+    QMetaObject::invokeMethod(connection,"pump",Qt::QueuedConnection);
+}
+
+
+bool HttpEventJob::send(const QByteArray& data) {
+    QMutexLocker locker(&mutex);
+    // Only the head of the pipeline is being sent, the others collect
+    // their response until it is their turn
+    while (head && !aborted && output.size()>=limit) {
+        drained.wait(&mutex);
+    }
+    if (aborted) {
+        return false;
+    }
+    bool notify=head && output.isEmpty();
+    output.append(data);
+    if (notify) {
+        QMetaObject::invokeMethod(connection,"pump",Qt::QueuedConnection);
+    }
+    return true;
+}
+
+
+void HttpEventJob::close() {
+    QMutexLocker locker(&mutex);
+    closing=true;
+}
+
+
+bool HttpEventJob::take(QByteArray& data) {
+    QMutexLocker locker(&mutex);
+    data=output;
+    output=QByteArray();
+    drained.wakeAll();
+    return finished;
+}
+
+
+void HttpEventJob::setHead() {
+    QMutexLocker locker(&mutex);
+    head=true;
+}
+
+
+void HttpEventJob::abort() {
+    QMutexLocker locker(&mutex);
+    aborted=true;
+    output=QByteArray();
+    drained.wakeAll();
+}
+
+
+bool HttpEventJob::closeConnection() {
+    QMutexLocker locker(&mutex);
+    return closing;
+}
+
+
+HttpEventConnection::HttpEventConnection(QSettings* settings, HttpRequestHandler* requestHandler, QThreadPool* computePool,
+                                         QAtomicInt* connections, tSocketDescriptor socketDescriptor, QObject* parent)
+    : QObject(parent)
+{
+    this->settings=settings;
+    this->requestHandler=requestHandler;
+    this->computePool=computePool;
+    this->connections=connections;
+    readTimeoutInterval=settings->value("readTimeout",60000).toInt();
+    maxPipelined=qMax(1,settings->value("maxPipelined",8).toInt());
+    limit=MAXBUFFERED;
+    currentRequest=0;
+    closing=false;
+    gone=false;
+
+    socket=new QTcpSocket(this);
+    connect(socket, SIGNAL(readyRead()), SLOT(read()));
+    connect(socket, SIGNAL(bytesWritten(qint64)), SLOT(pump()));
+    connect(socket, SIGNAL(disconnected()), SLOT(disconnected()));
+    connect(&readTimer, SIGNAL(timeout()), SLOT(readTimeout()));
+    readTimer.setSingleShot(true);
+
+    if (!socket->setSocketDescriptor(socketDescriptor)) {
+        qCritical("HttpEventConnection (%p): cannot initialize socket: %s", this,qPrintable(socket->errorString()));
+        gone=true;
+        release();
+        return;
+    }
+
+    // Start timer for read timeout
+    readTimer.start(readTimeoutInterval);
+}
+
+
+HttpEventConnection::~HttpEventConnection() {
+    delete currentRequest;
+    qDeleteAll(jobs);
+    connections->fetchAndAddOrdered(-1);
+}
+
+
+void HttpEventConnection::abort() {
+    socket->abort();
+    if (!gone) {
+        disconnected();
+    }
+}
+
+
+void HttpEventConnection::read() {
+    if (closing) {
+        // Requests after one that closes the connection are ignored
+        socket->readAll();
+        return;
+    }
+    dispatch();
+}
+
+
+void HttpEventConnection::dispatch() {
+    // The loop adds support for HTTP pipelining, requests are dispatched
+    // until the pipeline is full and the rest wait in the socket
+    while (!closing && jobs.count()<maxPipelined) {
+        input.append(socket->readAll());
+        if (input.isEmpty()) {
+            break;
+        }
+
+        // Create new HttpRequest object if necessary
+        if (!currentRequest) {
+            currentRequest=new HttpRequest(settings);
+        }
+        int used=currentRequest->readFromBuffer(input);
+
+        // If the request is aborted, return error message and close the connection
+        if (currentRequest->getStatus()==HttpRequest::abort) {
+            delete currentRequest;
+            currentRequest=0;
+            input.clear();
+            fail("HTTP/1.1 413 entity too large\r\nConnection: close\r\n\r\n413 Entity too large\r\n");
+            return;
+        }
+
+        if (currentRequest->getStatus()!=HttpRequest::complete) {
+            // Restart timer for read timeout, otherwise it would
+            // expire during large file uploads.
+            readTimer.start(readTimeoutInterval);
+            break;
+        }
+
+        // Let the compute pool service the request
+        input.remove(0,used);
+        HttpEventJob* job=new HttpEventJob(this,currentRequest,requestHandler,limit);
+        currentRequest=0;
+        if (job->closeConnection()) {
+            closing=true;
+        }
+        if (jobs.isEmpty()) {
+            job->setHead();
+        }
+        jobs.enqueue(job);
+        readTimer.stop();
+        computePool->start(job);
+    }
+}
+
+
+void HttpEventConnection::fail(const QByteArray& response) {
+    failure=response;
+    closing=true;
+    pump();
+}
+
+
+void HttpEventConnection::pump() {
+    while (!jobs.isEmpty()) {
+        // Leave the response with the job until the socket has caught up
+        if (!gone && socket->bytesToWrite()>=limit) {
+            return;
+        }
+
+        HttpEventJob* job=jobs.head();
+        QByteArray data;
+        bool finished=job->take(data);
+        if (!gone && !data.isEmpty()) {
+            socket->write(data);
+        }
+        if (!finished) {
+            return;
+        }
+
+        // Response complete, the next one in the pipeline goes out as it comes
+        jobs.dequeue();
+        if (job->closeConnection()) {
+            // Requests pipelined after it are not answered
+            closing=true;
+            foreach(HttpEventJob* next, jobs) {
+                next->abort();
+            }
+        }
+        delete job;
+        if (!jobs.isEmpty()) {
+            jobs.head()->setHead();
+        }
+    }
+
+    // All responses have been sent
+    if (gone) {
+        release();
+        return;
+    }
+    if (!failure.isEmpty()) {
+        socket->write(failure);
+        failure.clear();
+    }
+    if (closing) {
+        // Close the connection after delivering the responses
+        socket->disconnectFromHost();
+        return;
+    }
+
+    // Start timer for next request, and read the requests
+    // held back while the pipeline was full
+    readTimer.start(readTimeoutInterval);
+    dispatch();
+}
+
+
+void HttpEventConnection::disconnected() {
+    wDebug("HttpEventConnection (%p): disconnected", this);
+    gone=true;
+    closing=true;
+    readTimer.stop();
+    delete currentRequest;
+    currentRequest=0;
+
+    // The jobs still running finish without sending
+    foreach(HttpEventJob* job, jobs) {
+        job->abort();
+    }
+    pump();
+}
+
+
+void HttpEventConnection::readTimeout() {
+    // The client is waiting for a response, not idle
+    if (!jobs.isEmpty()) {
+        return;
+    }
+    wDebug("HttpEventConnection (%p): read timeout occured",this);
+    socket->disconnectFromHost();
+}
+
+
+void HttpEventConnection::release() {
+    if (gone && jobs.isEmpty()) {
+        deleteLater();
+    }
+}
+
+
+HttpEventLoop::HttpEventLoop(QSettings* settings, HttpRequestHandler* requestHandler, QThreadPool* computePool, QAtomicInt* connections)
+    : QThread()
+{
+    this->settings=settings;
+    this->requestHandler=requestHandler;
+    this->computePool=computePool;
+    this->connections=connections;
+
+    // execute signals in my own thread
+    moveToThread(this);
+
+    wDebug("HttpEventLoop (%p): constructed", this);
+    this->start();
+}
+
+
+HttpEventLoop::~HttpEventLoop() {
+    quit();
+    wait();
+    wDebug("HttpEventLoop (%p): destroyed", this);
+}
+
+
+void HttpEventLoop::run() {
+    wDebug("HttpEventLoop (%p): thread started", this);
+    try {
+        exec();
+    }
+    catch (...) {
+        qCritical("HttpEventLoop (%p): an uncatched exception occured in the thread",this);
+    }
+
+    // Connections still open when the server stops
+    qDeleteAll(findChildren<HttpEventConnection*>());
+    wDebug("HttpEventLoop (%p): thread stopped", this);
+}
+
+
+void HttpEventLoop::handleConnection(tSocketDescriptor socketDescriptor) {
+    #ifdef SUPERVERBOSE
+        wDebug("HttpEventLoop (%p): handle new connection", this);
+    #endif
+    new HttpEventConnection(settings,requestHandler,computePool,connections,socketDescriptor,this);
+}
+
+
+void HttpEventLoop::abortConnections() {
+    foreach(HttpEventConnection* connection, findChildren<HttpEventConnection*>()) {
+        connection->abort();
+    }
+}
+
+
+HttpEventLoopPool::HttpEventLoopPool(QSettings* settings, HttpRequestHandler* requestHandler)
+    : QObject()
+{
+    Q_ASSERT(settings!=0);
+    Q_ASSERT(requestHandler!=0);
+    this->settings=settings;
+    next=0;
+    maxConnections=settings->value("maxConnections",1000).toInt();
+
+    int computeThreads=settings->value("computeThreads",QThread::idealThreadCount()).toInt();
+    computePool.setMaxThreadCount(qMax(1,computeThreads));
+
+    int ioThreads=qMax(1,settings->value("ioThreads",2).toInt());
+    for (int i=0; i<ioThreads; i++) {
+        loops.append(new HttpEventLoop(settings,requestHandler,&computePool,&connections));
+    }
+    wDebug("HttpEventLoopPool: %i I/O threads, %i compute threads",ioThreads,computePool.maxThreadCount());
+}
+
+
+HttpEventLoopPool::~HttpEventLoopPool() {
+    // Stop the responses in progress, wait for the handlers to
+    // return and then stop the I/O threads
+    foreach(HttpEventLoop* loop, loops) {
+        QMetaObject::invokeMethod(loop,"abortConnections",Qt::BlockingQueuedConnection);
+    }
+    computePool.waitForDone();
+    qDeleteAll(loops);
+    wDebug("HttpEventLoopPool (%p): destroyed", this);
+}
+
+
+bool HttpEventLoopPool::handleConnection(tSocketDescriptor socketDescriptor) {
+    if (connections.fetchAndAddOrdered(1)>=maxConnections) {
+        connections.fetchAndAddOrdered(-1);
+        return false;
+    }
+
+    // The descriptor is queued because the connection must be
+    // created in the thread that owns its socket
+    QMetaObject::invokeMethod(loops.at(next),"handleConnection",Qt::QueuedConnection,
+                              Q_ARG(tSocketDescriptor,socketDescriptor));
+    next=(next+1)%loops.count();
+    return true;
+}
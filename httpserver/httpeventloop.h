@@ -0,0 +1,268 @@
+/**
+  @file
+  @author Mark Liversedge
+*/
+
+#ifndef HTTPEVENTLOOP_H
+#define HTTPEVENTLOOP_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QQueue>
+#include <QRunnable>
+#include <QSettings>
+#include <QTcpSocket>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+#include <QWaitCondition>
+#include "httpglobal.h"
+#include "httpconnectionhandler.h"
+#include "httprequest.h"
+#include "httpresponse.h"
+#include "httprequesthandler.h"
+
+class HttpEventConnection;
+
+/**
+  One request received on a connection, serviced on the compute pool.
+  The response is collected here until the connection's I/O thread
+  takes it; only the request at the head of the pipeline is held back
+  when the client reads slowly, so a large response is sent without
+  being kept in memory as a whole.
+*/
+class DECLSPEC HttpEventJob : public QRunnable, public HttpResponseSink {
+    Q_DISABLE_COPY(HttpEventJob)
+public:
+    /**
+      Constructor.
+      @param connection Connection the request was received on, notified as the response is written
+      @param request The request, deleted with the job
+      @param requestHandler Processes the request
+      @param limit Bytes of response held at the head of the pipeline before the handler has to wait
+    */
+    HttpEventJob(HttpEventConnection* connection, HttpRequest* request, HttpRequestHandler* requestHandler, int limit);
+
+    /** Destructor */
+    virtual ~HttpEventJob();
+
+    /** Service the request, called on the compute pool */
+    void run();
+
+    /** Collect response data, see HttpResponseSink */
+    bool send(const QByteArray& data);
+
+    /** Close the connection after the response, see HttpResponseSink */
+    void close();
+
+    /**
+      Take the response data written so far, called by the I/O thread.
+      @param data Receives the data
+      @return true once the response is complete and all of it has been taken
+    */
+    bool take(QByteArray& data);
+
+    /** The job is now at the head of the pipeline and its output is sent as it comes */
+    void setHead();
+
+    /** The connection has gone, stop waiting and discard the rest of the response */
+    void abort();
+
+    /** The connection must be closed after this response */
+    bool closeConnection();
+
+private:
+    HttpEventConnection* connection;
+    HttpRequest* request;
+    HttpRequestHandler* requestHandler;
+    int limit;
+
+    QMutex mutex;
+    QWaitCondition drained;
+    QByteArray output;
+    bool head;
+    bool finished;
+    bool aborted;
+    bool closing;
+};
+
+/**
+  A keep-alive connection owned by one of the I/O threads. Requests are
+  parsed from the received data as it arrives and dispatched to the compute
+  pool; pipelined requests are serviced in parallel but their responses are
+  sent in the order the requests arrived.
+  <p>
+  The following configuration settings are used:
+  <code><pre>
+  readTimeout=60000
+  maxPipelined=8
+  </pre></code>
+  The read timeout closes idle connections. MaxPipelined is the number of
+  requests of one connection that are dispatched before earlier responses
+  have been sent, further requests wait in the socket buffer.
+*/
+class DECLSPEC HttpEventConnection : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY(HttpEventConnection)
+public:
+    /**
+      Constructor, called in the I/O thread.
+      @param settings Configuration settings for the HTTP server
+      @param requestHandler Processes each received HTTP request
+      @param computePool Pool the requests are serviced on
+      @param connections Count of open connections, decremented when the connection is deleted
+      @param socketDescriptor The accepted connection
+      @param parent The I/O thread's event loop
+    */
+    HttpEventConnection(QSettings* settings, HttpRequestHandler* requestHandler, QThreadPool* computePool,
+                        QAtomicInt* connections, tSocketDescriptor socketDescriptor, QObject* parent);
+
+    /** Destructor */
+    virtual ~HttpEventConnection();
+
+    /** Close the connection and discard responses in progress */
+    void abort();
+
+public slots:
+    /** Send what the jobs have written, called when a job writes or the socket drains */
+    void pump();
+
+private slots:
+    /** Collect received data and dispatch complete requests */
+    void read();
+
+    /** The client has gone */
+    void disconnected();
+
+    /** Close the connection if it has been idle too long */
+    void readTimeout();
+
+private:
+    /** Parse the received data while more requests may be dispatched */
+    void dispatch();
+
+    /** Send an error response once the pending responses are sent, then close */
+    void fail(const QByteArray& response);
+
+    /** Delete the connection once the client has gone and the jobs have finished */
+    void release();
+
+    QSettings* settings;
+    HttpRequestHandler* requestHandler;
+    QThreadPool* computePool;
+    QAtomicInt* connections;
+    QTcpSocket* socket;
+    QTimer readTimer;
+    int readTimeoutInterval;
+    int maxPipelined;
+    int limit;
+
+    /** Received data that does not belong to a dispatched request yet */
+    QByteArray input;
+
+    /** Request being received */
+    HttpRequest* currentRequest;
+
+    /** Dispatched requests in the order received */
+    QQueue<HttpEventJob*> jobs;
+
+    /** Error response sent after the pending responses */
+    QByteArray failure;
+
+    /** No more requests are read, the connection closes once the pending responses are sent */
+    bool closing;
+
+    /** The client has gone */
+    bool gone;
+};
+
+/**
+  An I/O thread multiplexing many connections in its event loop.
+*/
+class DECLSPEC HttpEventLoop : public QThread {
+    Q_OBJECT
+    Q_DISABLE_COPY(HttpEventLoop)
+public:
+    /**
+      Constructor, starts the thread.
+      @param settings Configuration settings for the HTTP server
+      @param requestHandler Processes each received HTTP request
+      @param computePool Pool the requests are serviced on
+      @param connections Count of connections open on all the I/O threads
+    */
+    HttpEventLoop(QSettings* settings, HttpRequestHandler* requestHandler, QThreadPool* computePool, QAtomicInt* connections);
+
+    /** Destructor, stops the thread and closes its connections */
+    virtual ~HttpEventLoop();
+
+public slots:
+    /** Take over a new incoming connection */
+    void handleConnection(tSocketDescriptor socketDescriptor);
+
+    /** Close all connections and discard responses in progress */
+    void abortConnections();
+
+private:
+    /** Executes the event loop */
+    void run();
+
+    QSettings* settings;
+    HttpRequestHandler* requestHandler;
+    QThreadPool* computePool;
+    QAtomicInt* connections;
+};
+
+/**
+  Event driven alternative to the HttpConnectionHandlerPool. A small fixed
+  number of I/O threads each multiplex many keep-alive connections, and the
+  requests are serviced on a bounded pool of compute threads, so the number
+  of threads no longer grows with the number of clients.
+  <p>
+  Example for the configuration settings:
+  <code><pre>
+  ioThreads=2
+  computeThreads=4
+  maxConnections=1000
+  maxPipelined=8
+  readTimeout=60000
+  maxRequestSize=16000
+  maxMultiPartSize=1000000
+  </pre></code>
+  ComputeThreads defaults to the number of processor cores. SSL is not
+  supported, a listener with SSL settings uses the HttpConnectionHandlerPool.
+  @see HttpEventConnection for description of maxPipelined and readTimeout
+  @see HttpRequest for description of config settings maxRequestSize and maxMultiPartSize
+*/
+class DECLSPEC HttpEventLoopPool : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY(HttpEventLoopPool)
+public:
+    /**
+      Constructor.
+      @param settings Configuration settings for the HTTP server. Must not be 0.
+      @param requestHandler The handler that will process each received HTTP request.
+    */
+    HttpEventLoopPool(QSettings* settings, HttpRequestHandler* requestHandler);
+
+    /** Destructor, waits for the requests in progress */
+    virtual ~HttpEventLoopPool();
+
+    /**
+      Pass a new connection to the next I/O thread.
+      @return false if there are too many connections
+    */
+    bool handleConnection(tSocketDescriptor socketDescriptor);
+
+private:
+    QSettings* settings;
+    QThreadPool computePool;
+    QList<HttpEventLoop*> loops;
+    QAtomicInt connections;
+    int maxConnections;
+    int next;
+};
+
+#endif // HTTPEVENTLOOP_H
@@ -14,6 +14,7 @@ HttpListener::HttpListener(QSettings* settings, HttpRequestHandler* requestHandl
     Q_ASSERT(settings!=0);
     Q_ASSERT(requestHandler!=0);
     pool=NULL;
+    loops=NULL;
     this->settings=settings;
     this->requestHandler=requestHandler;
     // Reqister type of socketDescriptor for signal/slot handling
@@ -30,8 +31,14 @@ HttpListener::~HttpListener() {
 
 
 void HttpListener::listen() {
-    if (!pool) {
-        pool=new HttpConnectionHandlerPool(settings,requestHandler);
+    if (!pool && !loops) {
+        // The event driven front end does not support SSL
+        if (settings->value("ioThreads",2).toInt()>0 && settings->value("sslKeyFile").toString().isEmpty()) {
+            loops=new HttpEventLoopPool(settings,requestHandler);
+        }
+        else {
+            pool=new HttpConnectionHandlerPool(settings,requestHandler);
+        }
     }
     QString host = settings->value("host").toString();
     int port=settings->value("port").toInt();
@@ -52,6 +59,10 @@ void HttpListener::close() {
         delete pool;
         pool=NULL;
     }
+    if (loops) {
+        delete loops;
+        loops=NULL;
+    }
 }
 
 void HttpListener::incomingConnection(tSocketDescriptor socketDescriptor) {
@@ -59,6 +70,11 @@ void HttpListener::incomingConnection(tSocketDescriptor socketDescriptor) {
     wDebug("HttpListener: New connection");
 #endif
 
+    // Let the next I/O thread take it
+    if (loops && loops->handleConnection(socketDescriptor)) {
+        return;
+    }
+
     HttpConnectionHandler* freeHandler=NULL;
     if (pool) {
         freeHandler=pool->getConnectionHandler();
@@ -12,6 +12,7 @@
 #include "httpglobal.h"
 #include "httpconnectionhandler.h"
 #include "httpconnectionhandlerpool.h"
+#include "httpeventloop.h"
 #include "httprequesthandler.h"
 
 /**
@@ -22,6 +23,8 @@
   <code><pre>
   ;host=192.168.0.100
   port=8080
+  ioThreads=2
+  ;computeThreads=4
   minThreads=1
   maxThreads=10
   cleanupInterval=1000
@@ -34,6 +37,10 @@
   The optional host parameter binds the listener to one network interface.
   The listener handles all network interfaces if no host is configured.
   The port number specifies the incoming TCP port that this listener listens to.
+  <p>
+  Connections are handled by a few event driven I/O threads unless ioThreads
+  is 0 or SSL is configured, then each connection gets a thread of its own.
+  @see HttpEventLoopPool for description of config settings ioThreads and computeThreads
   @see HttpConnectionHandlerPool for description of config settings minThreads, maxThreads, cleanupInterval and ssl settings
   @see HttpConnectionHandler for description of the readTimeout
   @see HttpRequest for description of config settings maxRequestSize and maxMultiPartSize
@@ -84,6 +91,9 @@ private:
     /** Pool of connection handlers */
     HttpConnectionHandlerPool* pool;
 
+    /** Event driven I/O threads, used instead of the pool when configured */
+    HttpEventLoopPool* loops;
+
 signals:
 
     /**
@@ -12,6 +12,7 @@ HttpRequest::HttpRequest(QSettings* settings) {
     status=waitForRequest;
     currentSize=0;
     expectedBodySize=0;
+    headerSize=0;
     maxSize=settings->value("maxRequestSize","16000").toInt();
     maxMultiPartSize=settings->value("maxMultiPartSize","1000000").toInt();
 }
@@ -213,7 +214,7 @@ void HttpRequest::extractCookies() {
     #ifdef SUPERVERBOSE
         wDebug("HttpRequest: extract cookies");
     #endif
-    foreach(QByteArray cookieStr, headers.values("Cookie")) {
+    foreach(QByteArray cookieStr, getHeaders("Cookie")) {
         QList<QByteArray> list=HttpCookie::splitCSV(cookieStr);
         foreach(QByteArray part, list) {
             #ifdef SUPERVERBOSE
@@ -260,6 +261,171 @@ void HttpRequest::readFromSocket(QTcpSocket* socket) {
 }
 
 
+int HttpRequest::readFromBuffer(const QByteArray& buffer) {
+    Q_ASSERT(status!=complete);
+    if (status==waitForRequest || status==waitForHeader) {
+        // Wait for the empty line that ends the headers
+        int end=buffer.indexOf("\r\n\r\n");
+        int bare=buffer.indexOf("\n\n");
+        if (bare>=0 && (end<0 || bare<end)) {
+            headerSize=bare+2;
+        }
+        else if (end>=0) {
+            headerSize=end+4;
+        }
+        else {
+            if (buffer.size()>maxSize) {
+                qWarning("HttpRequest: received too many bytes");
+                status=abort;
+            }
+            return 0;
+        }
+        if (headerSize>maxSize) {
+            qWarning("HttpRequest: received too many bytes");
+            status=abort;
+            return 0;
+        }
+        headerBlock=buffer.left(headerSize);
+        currentSize=headerSize;
+        parseHeaderBlock();
+        if (status==abort) {
+            return 0;
+        }
+    }
+    if (status==waitForBody) {
+        if (buffer.size()<headerSize+expectedBodySize) {
+            return 0;
+        }
+        if (boundary.isEmpty()) {
+            bodyData=buffer.mid(headerSize,expectedBodySize);
+        }
+        else {
+            // multipart body, parsed from a temp file as when read from the socket
+            if (!tempFile.open()) {
+                qCritical("HttpRequest: Error opening temp file for multipart body");
+                status=abort;
+                return 0;
+            }
+            tempFile.write(buffer.constData()+headerSize,expectedBodySize);
+            tempFile.flush();
+            if (tempFile.error()) {
+                qCritical("HttpRequest: Error writing temp file for multipart body");
+            }
+            parseMultiPartFile();
+            tempFile.close();
+        }
+        currentSize+=expectedBodySize;
+        status=complete;
+    }
+    // Extract and decode request parameters from url and body
+    decodeRequestParams();
+    // Extract cookies from headers
+    extractCookies();
+    return headerSize+expectedBodySize;
+}
+
+void HttpRequest::parseHeaderBlock() {
+    #ifdef SUPERVERBOSE
+        wDebug("HttpRequest: parse header block");
+    #endif
+    const char* data=headerBlock.constData();
+    int size=headerBlock.size();
+    int pos=0;
+    bool firstLine=true;
+    while (pos<size) {
+        int eol=headerBlock.indexOf('\n',pos);
+        if (eol<0) {
+            eol=size;
+        }
+        int start=pos;
+        int stop=eol;
+        pos=eol+1;
+        // Trim the line without copying it
+        while (start<stop && (data[start]==' ' || data[start]=='\t')) {
+            start++;
+        }
+        while (stop>start && (data[stop-1]=='\r' || data[stop-1]==' ' || data[stop-1]=='\t')) {
+            stop--;
+        }
+        if (start==stop) {
+            // Empty lines before the request line are allowed, the
+            // empty line after the headers ends the block
+            if (firstLine) {
+                continue;
+            }
+            break;
+        }
+        if (firstLine) {
+            // The request line is small and kept as a copy
+            QList<QByteArray> list=QByteArray(data+start,stop-start).split(' ');
+            if (list.count()!=3 || !list.at(2).contains("HTTP")) {
+                qWarning("HttpRequest: received broken HTTP request, invalid first line");
+                status=abort;
+                return;
+            }
+            method=list.at(0);
+            path=list.at(1);
+            version=list.at(2);
+            firstLine=false;
+            continue;
+        }
+        int colon=headerBlock.indexOf(':',start);
+        if (colon<=start || colon>=stop) {
+            // Folded header lines are obsolete, they are ignored
+            continue;
+        }
+        int valueStart=colon+1;
+        while (valueStart<stop && (data[valueStart]==' ' || data[valueStart]=='\t')) {
+            valueStart++;
+        }
+        headers.insert(QByteArray::fromRawData(data+start,colon-start),
+                       QByteArray::fromRawData(data+valueStart,stop-valueStart));
+        #ifdef SUPERVERBOSE
+            wDebug("HttpRequest: received header %s",detach(QByteArray::fromRawData(data+start,stop-start)).data());
+        #endif
+    }
+    if (firstLine) {
+        qWarning("HttpRequest: received broken HTTP request, no request line");
+        status=abort;
+        return;
+    }
+    // Check for multipart/form-data
+    QByteArray contentType=headers.value("Content-Type");
+    if (contentType.startsWith("multipart/form-data")) {
+        int posi=contentType.indexOf("boundary=");
+        if (posi>=0) {
+            boundary=detach(contentType.mid(posi+9));
+        }
+    }
+    QByteArray contentLength=headers.value("Content-Length");
+    if (!contentLength.isEmpty()) {
+        expectedBodySize=detach(contentLength).toInt();
+    }
+    if (expectedBodySize<0) {
+        qWarning("HttpRequest: invalid content length");
+        status=abort;
+    }
+    else if (boundary.isEmpty() && expectedBodySize+currentSize>maxSize) {
+        qWarning("HttpRequest: expected body is too large");
+        status=abort;
+    }
+    else if (!boundary.isEmpty() && expectedBodySize>maxMultiPartSize) {
+        qWarning("HttpRequest: expected multipart body is too large");
+        status=abort;
+    }
+    else {
+        status=waitForBody;
+    }
+}
+
+QByteArray HttpRequest::detach(const QByteArray& value) const {
+    // Values referring into the header block must not outlive the request
+    if (headerBlock.isEmpty()) {
+        return value;
+    }
+    return QByteArray(value.constData(),value.size());
+}
+
 HttpRequest::RequestStatus HttpRequest::getStatus() const {
     return status;
 }
@@ -281,15 +447,28 @@ QByteArray HttpRequest::getVersion() const {
 
 
 QByteArray HttpRequest::getHeader(const QByteArray& name) const {
-    return headers.value(name);
+    return detach(headers.value(name));
 }
 
 QList<QByteArray> HttpRequest::getHeaders(const QByteArray& name) const {
-    return headers.values(name);
+    QList<QByteArray> list;
+    foreach(QByteArray value, headers.values(name)) {
+        list.append(detach(value));
+    }
+    return list;
 }
 
 QMultiMap<QByteArray,QByteArray> HttpRequest::getHeaderMap() const {
-    return headers;
+    if (headerBlock.isEmpty()) {
+        return headers;
+    }
+    QMultiMap<QByteArray,QByteArray> map;
+    QMapIterator<QByteArray,QByteArray> it(headers);
+    while (it.hasNext()) {
+        it.next();
+        map.insert(detach(it.key()),detach(it.value()));
+    }
+    return map;
 }
 
 QByteArray HttpRequest::getParameter(const QByteArray& name) const {
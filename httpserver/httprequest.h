@@ -59,6 +59,20 @@ public:
     */
     void readFromSocket(QTcpSocket* socket);
 
+    /**
+      Read the request from the start of a buffer that collects the bytes
+      received on a connection, as used by the HttpEventLoop front end.
+      This method must be called again as more data arrives until the
+      status is RequestStatus::complete or RequestStatus::abort.
+      <p>
+      The header block is copied out of the buffer once and the header
+      names and values refer into that copy instead of being collected
+      line by line.
+      @param buffer Data received so far, starting with this request
+      @return Number of bytes of the buffer used by the complete request, 0 if incomplete
+    */
+    int readFromBuffer(const QByteArray& buffer);
+
     /**
       Get the status of this reqeust.
       @see RequestStatus
@@ -212,6 +226,18 @@ private:
     /** Buffer for collecting characters of request and header lines */
     QByteArray lineBuffer;
 
+    /** Header block when read by readFromBuffer(), the headers refer into it */
+    QByteArray headerBlock;
+
+    /** Size of the request line and headers including the empty line */
+    int headerSize;
+
+    /** Sub-procedure of readFromBuffer(), parse the header block. */
+    void parseHeaderBlock();
+
+    /** Copy of a header value that does not refer into the header block */
+    QByteArray detach(const QByteArray& value) const;
+
 };
 
 #endif // HTTPREQUEST_H
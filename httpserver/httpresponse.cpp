@@ -7,6 +7,17 @@
 
 HttpResponse::HttpResponse(QTcpSocket* socket) {
     this->socket=socket;
+    sink=NULL;
+    init();
+}
+
+HttpResponse::HttpResponse(HttpResponseSink* sink) {
+    this->socket=NULL;
+    this->sink=sink;
+    init();
+}
+
+void HttpResponse::init() {
     statusCode=200;
     statusText="OK";
     sentHeaders=false;
@@ -14,6 +25,9 @@ HttpResponse::HttpResponse(QTcpSocket* socket) {
     buffersize=40960;
     barry.reserve(40960);
     userdata_=NULL;
+    capture=NULL;
+    capturelimit=0;
+    captureoverflow=false;
 }
 
 void HttpResponse::setHeader(QByteArray name, QByteArray value) {
@@ -60,6 +74,9 @@ void HttpResponse::writeHeaders() {
 }
 
 bool HttpResponse::writeToSocket(QByteArray data) {
+    if (sink) {
+        return sink->send(data);
+    }
     int remaining=data.size();
     char* ptr=data.data();
     while (socket->isOpen() && remaining>0) {
@@ -108,6 +125,12 @@ void HttpResponse::write(QByteArray data, bool lastPart) {
         }
         writeHeaders();
     }
+    if (capture && !captureoverflow) {
+        if (capture->size() + data.size() > capturelimit) {
+            captureoverflow=true;
+            capture->clear();
+        } else capture->append(data);
+    }
     bool chunked=headers.value("Transfer-Encoding")=="chunked" || headers.value("Transfer-Encoding")=="Chunked";
     if (chunked) {
         if (data.size()>0) {
@@ -126,7 +149,12 @@ void HttpResponse::write(QByteArray data, bool lastPart) {
             writeToSocket("0\r\n\r\n");
         }
         else if (!headers.contains("Content-Length")) {
-            socket->disconnectFromHost();
+            if (sink) {
+                sink->close();
+            }
+            else {
+                socket->disconnectFromHost();
+            }
         }
         sentLastPart=true;
     }
@@ -12,6 +12,24 @@
 #include "httpglobal.h"
 #include "httpcookie.h"
 
+/**
+  Destination of the response when it is not written straight to a socket.
+  The event driven front end passes the response back to the I/O thread
+  that owns the connection.
+  @see HttpEventConnection
+*/
+class DECLSPEC HttpResponseSink {
+public:
+    virtual ~HttpResponseSink() {}
+    /**
+      Pass raw response data on. May block until earlier data has been sent.
+      @return false if the connection has gone
+    */
+    virtual bool send(const QByteArray& data)=0;
+    /** Close the connection after the data passed on has been sent */
+    virtual void close()=0;
+};
+
 /**
   This object represents a HTTP response, in particular the response headers.
   <p>
@@ -44,6 +62,12 @@ public:
     */
     HttpResponse(QTcpSocket* socket);
 
+    /**
+      Constructor.
+      @param sink used to write the response
+    */
+    HttpResponse(HttpResponseSink* sink);
+
     /**
       Set a HTTP response header
       @param name name of the header
@@ -69,6 +93,9 @@ public:
     */
     void setStatus(int statusCode, QByteArray description=QByteArray());
 
+    /** Get the status code */
+    int getStatus() const { return statusCode; }
+
     /**
       Write body data to the socket.
       <p>
@@ -94,6 +121,11 @@ public:
     void setUserData(void *here) { userdata_ = here; }
     void *userData() { return userdata_; }
 
+    // keep a copy of the body as it is written, up to limit bytes
+    // after which the copy is abandoned and captured() returns false
+    void setCapture(QByteArray *here, int limit) { capture=here; capturelimit=limit; captureoverflow=false; }
+    bool captured() const { return capture != NULL && !captureoverflow; }
+
     /**
       Indicates wheter the body has been sent completely. Used by the connection
       handler to terminate the body automatically when necessary.
@@ -120,6 +152,12 @@ private:
     /** Socket for writing output */
     QTcpSocket* socket;
 
+    /** Alternative destination for the output, when there is no socket */
+    HttpResponseSink* sink;
+
+    /** Set the initial state, shared by the constructors */
+    void init();
+
     /** HTTP status code*/
     int statusCode;
 
@@ -149,6 +187,11 @@ private:
     QByteArray barry;
 
     void *userdata_;
+
+    // capture of the body written
+    QByteArray *capture;
+    int capturelimit;
+    bool captureoverflow;
 };
 
 #endif // HTTPRESPONSE_H
@@ -50,6 +50,8 @@
 #include <qendian.h>
 #include <qdebug.h>
 #include <qdir.h>
+#include <QThread>
+#include <QtConcurrent>
 
 #ifdef Q_CC_MSVC
 #include <QtZlib\zlib.h>
@@ -255,6 +257,65 @@ static int deflate (Bytef *dest, ulong *destLen, const Bytef *source, ulong sour
     return err;
 }
 
+// deflate whatever is pending in the stream onto the end of out
+static int deflate(z_stream *stream, QByteArray &out, int flush)
+{
+    int err;
+    do {
+        const int chunk = 64 * 1024;
+        const int used = out.size();
+        out.resize(used + chunk);
+        stream->next_out = (Bytef*)out.data() + used;
+        stream->avail_out = chunk;
+        err = deflate(stream, flush);
+        out.resize(used + chunk - stream->avail_out);
+    } while (err == Z_OK && stream->avail_out == 0);
+    return err;
+}
+
+// with AutoCompress only files that get smaller are compressed, which
+// is judged from the first chunk, and small files never are
+static bool worthDeflating(ZipWriter::CompressionPolicy policy, const char *data, qint64 n)
+{
+    if (policy == ZipWriter::NeverCompress) return false;
+    if (policy == ZipWriter::AlwaysCompress) return true;
+    if (n < 64) return false;
+
+    QByteArray probe;
+    ulong len = compressBound(n);
+    probe.resize(len);
+    return deflate((uchar*)probe.data(), &len, (const uchar*)data, n) == Z_OK && len <= ulong(n) * 0.95;
+}
+
+static QByteArray inflateData(const QByteArray &compressed, int uncompressed_size)
+{
+    QByteArray baunzip;
+    ulong len = qMax(uncompressed_size,  1);
+    int res;
+    do {
+        baunzip.resize(len);
+        res = inflate((uchar*)baunzip.data(), &len,
+                      (uchar*)compressed.constData(), compressed.size());
+
+        switch (res) {
+        case Z_OK:
+            if ((int)len != baunzip.size())
+                baunzip.resize(len);
+            break;
+        case Z_MEM_ERROR:
+            qWarning("QZip: Z_MEM_ERROR: Not enough memory");
+            break;
+        case Z_BUF_ERROR:
+            len *= 2;
+            break;
+        case Z_DATA_ERROR:
+            qWarning("QZip: Z_DATA_ERROR: Input data is corrupted");
+            break;
+        }
+    } while (res == Z_BUF_ERROR);
+    return baunzip;
+}
+
 static QFile::Permissions modeToPermissions(quint32 mode)
 {
     QFile::Permissions ret;
@@ -441,6 +502,7 @@ public:
     }
 
     void scanFiles();
+    QByteArray rawFileData(int index, int *compression_method);
 
     ZipReader::Status status;
 };
@@ -463,6 +525,9 @@ public:
     enum EntryType { Directory, File, Symlink };
 
     void addEntry(EntryType type, const QString &fileName, const QByteArray &contents);
+    void writeEntry(EntryType type, const QString &fileName, const QByteArray &data,
+                    uint crc_32, uint uncompressed_size, int compression_method, const QDateTime &lastModified);
+    void writeStreamedEntry(const QString &fileName, QIODevice *source, ZipWriter::CompressionPolicy policy);
 };
 
 LocalFileHeader CentralFileHeader::toLocalHeader() const
@@ -580,12 +645,6 @@ void ZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const Q
     ZDEBUG() << "adding" << entryTypes[type] <<":" << fileName.toUtf8().data() << (type == 2 ? QByteArray(" -> " + contents).constData() : "");
 #endif
 
-    if (! (device->isOpen() || device->open(QIODevice::WriteOnly))) {
-        status = ZipWriter::FileOpenError;
-        return;
-    }
-    device->seek(start_of_directory);
-
     // don't compress small files
     ZipWriter::CompressionPolicy compression = compressionPolicy;
     if (compressionPolicy == ZipWriter::AutoCompress) {
@@ -595,16 +654,8 @@ void ZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const Q
             compression = ZipWriter::AlwaysCompress;
     }
 
-    FileHeader header;
-    memset(&header.h, 0, sizeof(CentralFileHeader));
-    writeUInt(header.h.signature, 0x02014b50);
-
-    writeUShort(header.h.version_needed, 0x14);
-    writeUInt(header.h.uncompressed_size, contents.length());
-    writeMSDosDate(header.h.last_mod_file, QDateTime::currentDateTime());
     QByteArray data = contents;
     if (compression == ZipWriter::AlwaysCompress) {
-        writeUShort(header.h.compression_method, 8);
 
        ulong len = contents.length();
         // shamelessly copied form zlib
@@ -629,9 +680,31 @@ void ZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const Q
         } while (res == Z_BUF_ERROR);
     }
 // TODO add a check if data.length() > contents.length().  Then try to store the original and revert the compression method to be uncompressed
-    writeUInt(header.h.compressed_size, data.length());
     uint crc_32 = ::crc32(0, 0, 0);
     crc_32 = ::crc32(crc_32, (const uchar *)contents.constData(), contents.length());
+
+    writeEntry(type, fileName, data, crc_32, contents.length(),
+               compression == ZipWriter::AlwaysCompress ? 8 : 0, QDateTime::currentDateTime());
+}
+
+void ZipWriterPrivate::writeEntry(EntryType type, const QString &fileName, const QByteArray &data,
+                                  uint crc_32, uint uncompressed_size, int compression_method, const QDateTime &lastModified)
+{
+    if (! (device->isOpen() || device->open(QIODevice::WriteOnly))) {
+        status = ZipWriter::FileOpenError;
+        return;
+    }
+    device->seek(start_of_directory);
+
+    FileHeader header;
+    memset(&header.h, 0, sizeof(CentralFileHeader));
+    writeUInt(header.h.signature, 0x02014b50);
+
+    writeUShort(header.h.version_needed, 0x14);
+    writeUInt(header.h.uncompressed_size, uncompressed_size);
+    writeMSDosDate(header.h.last_mod_file, lastModified);
+    writeUShort(header.h.compression_method, compression_method);
+    writeUInt(header.h.compressed_size, data.length());
     writeUInt(header.h.crc_32, crc_32);
 
     header.file_name = fileName.toLocal8Bit();
@@ -665,6 +738,95 @@ void ZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const Q
     dirtyFileTree = true;
 }
 
+void ZipWriterPrivate::writeStreamedEntry(const QString &fileName, QIODevice *source, ZipWriter::CompressionPolicy policy)
+{
+    const qint64 chunkSize = 256 * 1024;
+
+    QFile *f = qobject_cast<QFile*>(source);
+    QDateTime lastModified = f ? QFileInfo(*f).lastModified() : QDateTime::currentDateTime();
+
+    const qint64 start = source->pos();
+    QByteArray chunk(chunkSize, Qt::Uninitialized);
+    qint64 n = source->read(chunk.data(), chunkSize);
+    if (n < 0) n = 0;
+
+    bool deflated = worthDeflating(policy, chunk.constData(), n);
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflated && deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        qWarning("QZip: Z_MEM_ERROR: Not enough memory to compress file, storing it");
+        deflated = false;
+    }
+
+    // the header goes first, the crc and sizes are filled in at the end
+    const qint64 header = start_of_directory;
+    const int entries = fileHeaders.count();
+    writeEntry(File, fileName, QByteArray(), 0, 0, deflated ? 8 : 0, lastModified);
+    if (fileHeaders.count() == entries) {
+        if (deflated) deflateEnd(&stream);
+        return;
+    }
+
+    bool failed = false;
+    uint crc_32 = ::crc32(0, 0, 0);
+    qint64 size = 0, written = 0;
+    QByteArray out;
+    while (n > 0) {
+        crc_32 = ::crc32(crc_32, (const uchar *)chunk.constData(), n);
+        size += n;
+
+        if (deflated) {
+            stream.next_in = (Bytef*)chunk.constData();
+            stream.avail_in = n;
+            out.resize(0);
+            int err = deflate(&stream, out, Z_NO_FLUSH);
+            if (err != Z_OK && err != Z_BUF_ERROR) {
+                failed = true;
+                break;
+            }
+            written += device->write(out);
+        } else {
+            written += device->write(chunk.constData(), n);
+        }
+        n = source->read(chunk.data(), chunkSize);
+    }
+
+    if (deflated) {
+        stream.avail_in = 0;
+        out.resize(0);
+        if (!failed && deflate(&stream, out, Z_FINISH) != Z_STREAM_END)
+            failed = true;
+        else
+            written += device->write(out);
+        deflateEnd(&stream);
+    }
+
+    // drop the entry, and store it instead if we can read it again
+    if (failed) {
+        fileHeaders.removeLast();
+        start_of_directory = header;
+        if (source->seek(start)) {
+            qWarning("QZip: Failed to compress file, storing it");
+            writeStreamedEntry(fileName, source, ZipWriter::NeverCompress);
+        } else {
+            qWarning("QZip: Failed to compress file, skipping");
+            status = ZipWriter::FileError;
+        }
+        return;
+    }
+
+    CentralFileHeader &h = fileHeaders.last().h;
+    writeUInt(h.crc_32, crc_32);
+    writeUInt(h.compressed_size, written);
+    writeUInt(h.uncompressed_size, size);
+    LocalFileHeader local = h.toLocalHeader();
+    device->seek(header);
+    device->write((const char *)&local, sizeof(LocalFileHeader));
+
+    start_of_directory += written;
+    device->seek(start_of_directory);
+}
+
 //////////////////////////////  Reader
 
 /*!
@@ -844,6 +1006,28 @@ ZipReader::FileInfo ZipReader::entryInfoAt(int index) const
     return fi;
 }
 
+QByteArray ZipReaderPrivate::rawFileData(int index, int *compression_method)
+{
+    const FileHeader &header = fileHeaders.at(index);
+
+    int compressed_size = readUInt(header.h.compressed_size);
+    int start = readUInt(header.h.offset_local_header);
+    //qDebug("uncompressing file %d: local header at %d", i, start);
+
+    device->seek(start);
+    LocalFileHeader lh;
+    device->read((char *)&lh, sizeof(LocalFileHeader));
+    uint skip = readUShort(lh.file_name_length) + readUShort(lh.extra_field_length);
+    device->seek(device->pos() + skip);
+
+    *compression_method = readUShort(lh.compression_method);
+
+    //qDebug("file at %lld", device->pos());
+    QByteArray compressed = device->read(compressed_size);
+    compressed.truncate(compressed_size);
+    return compressed;
+}
+
 /*!
     Fetch the file contents from the zip archive and return the uncompressed bytes.
 */
@@ -858,62 +1042,60 @@ QByteArray ZipReader::fileData(const QString &fileName) const
     if (i == d->fileHeaders.size())
         return QByteArray();
 
-    FileHeader header = d->fileHeaders.at(i);
-
-    int compressed_size = readUInt(header.h.compressed_size);
-    int uncompressed_size = readUInt(header.h.uncompressed_size);
-    int start = readUInt(header.h.offset_local_header);
-    //qDebug("uncompressing file %d: local header at %d", i, start);
-
-    d->device->seek(start);
-    LocalFileHeader lh;
-    d->device->read((char *)&lh, sizeof(LocalFileHeader));
-    uint skip = readUShort(lh.file_name_length) + readUShort(lh.extra_field_length);
-    d->device->seek(d->device->pos() + skip);
-
-    int compression_method = readUShort(lh.compression_method);
-    //qDebug("file=%s: compressed_size=%d, uncompressed_size=%d", fileName.toLocal8Bit().data(), compressed_size, uncompressed_size);
+    int uncompressed_size = readUInt(d->fileHeaders.at(i).h.uncompressed_size);
+    int compression_method;
+    QByteArray compressed = d->rawFileData(i, &compression_method);
+    //qDebug("file=%s: compressed_size=%d, uncompressed_size=%d", fileName.toLocal8Bit().data(), compressed.size(), uncompressed_size);
 
-    //qDebug("file at %lld", d->device->pos());
-    QByteArray compressed = d->device->read(compressed_size);
     if (compression_method == 0) {
         // no compression
         compressed.truncate(uncompressed_size);
         return compressed;
     } else if (compression_method == 8) {
         // Deflate
-        //qDebug("compressed=%d", compressed.size());
-        compressed.truncate(compressed_size);
-        QByteArray baunzip;
-        ulong len = qMax(uncompressed_size,  1);
-        int res;
-        do {
-            baunzip.resize(len);
-            res = inflate((uchar*)baunzip.data(), &len,
-                          (uchar*)compressed.constData(), compressed_size);
-
-            switch (res) {
-            case Z_OK:
-                if ((int)len != baunzip.size())
-                    baunzip.resize(len);
-                break;
-            case Z_MEM_ERROR:
-                qWarning("QZip: Z_MEM_ERROR: Not enough memory");
-                break;
-            case Z_BUF_ERROR:
-                len *= 2;
-                break;
-            case Z_DATA_ERROR:
-                qWarning("QZip: Z_DATA_ERROR: Input data is corrupted");
-                break;
-            }
-        } while (res == Z_BUF_ERROR);
-        return baunzip;
+        return inflateData(compressed, uncompressed_size);
     }
     qWarning() << "QZip: Unknown compression method";
     return QByteArray();
 }
 
+/*!
+    Fetch the file contents at \a index as they are stored in the zip archive,
+    \a deflated is set if they are compressed. The data can be passed straight
+    to ZipWriter::addCompressedFile() to copy an entry between archives
+    without uncompressing and compressing it again.
+*/
+QByteArray ZipReader::rawFileData(int index, bool *deflated) const
+{
+    d->scanFiles();
+    *deflated = false;
+    if (index < 0 || index >= d->fileHeaders.count())
+        return QByteArray();
+
+    int compression_method;
+    QByteArray compressed = d->rawFileData(index, &compression_method);
+    *deflated = (compression_method == 8);
+    return compressed;
+}
+
+// uncompress and write a file on a worker thread for extractAll()
+static bool extractFile(const QString &absPath, const QByteArray &compressed, int compression_method,
+                        int uncompressed_size, QFile::Permissions permissions)
+{
+    QFile f(absPath);
+    if (!f.open(QIODevice::WriteOnly))
+        return false;
+    if (compression_method == 0)
+        f.write(compressed.left(uncompressed_size));
+    else if (compression_method == 8)
+        f.write(inflateData(compressed, uncompressed_size));
+    else
+        qWarning() << "QZip: Unknown compression method";
+    if (permissions > 0) f.setPermissions(permissions);
+    f.close();
+    return true;
+}
+
 /*!
     Extracts the full contents of the zip file into \a destinationDir on
     the local filesystem.
@@ -954,19 +1136,28 @@ bool ZipReader::extractAll(const QString &destinationDir) const
         }
     }
 
-    foreach (FileInfo fi, allFiles) {
+    // the archive is read here, in order, but the files are uncompressed
+    // and written on the thread pool, keeping a few in flight at a time
+    const int window = qMax(2, QThread::idealThreadCount() * 2);
+    QList<QFuture<bool> > pending;
+    bool extracted = true;
+
+    for (int i = 0; i < allFiles.count() && extracted; ++i) {
+        const FileInfo &fi = allFiles.at(i);
         const QString absPath = destinationDir + QDir::separator() + fi.filePath;
         if (!fi.isDir && !fi.isSymLink) { // is file not always set correctly!?
-            QFile f(absPath);
-            if (!f.open(QIODevice::WriteOnly))
-                return false;
-            f.write(fileData(fi.filePath));
-            if (fi.permissions > 0) f.setPermissions(fi.permissions);
-            f.close();
+            int compression_method;
+            QByteArray compressed = d->rawFileData(i, &compression_method);
+            pending << QtConcurrent::run(extractFile, absPath, compressed, compression_method, int(fi.size), fi.permissions);
+
+            while (pending.count() >= window)
+                extracted &= pending.takeFirst().result();
         }
     }
+    while (!pending.isEmpty())
+        extracted &= pending.takeFirst().result();
 
-    return true;
+    return extracted;
 }
 
 /*!
@@ -1180,10 +1371,9 @@ void ZipWriter::addFile(const QString &fileName, const QByteArray &data)
 
 /*!
     Add a file to the archive with \a device as the source of the contents.
-    The contents returned from QIODevice::readAll() will be used as the
-    filedata.
-    The file will be stored in the archive using the \a fileName which
-    includes the full path in the archive.
+    The contents are read, compressed and written to the archive in chunks
+    so large files are never held in memory. The file will be stored in the
+    archive using the \a fileName which includes the full path in the archive.
 */
 void ZipWriter::addFile(const QString &fileName, QIODevice *device)
 {
@@ -1197,11 +1387,113 @@ void ZipWriter::addFile(const QString &fileName, QIODevice *device)
             return;
         }
     }
-    d->addEntry(ZipWriterPrivate::File, QDir::fromNativeSeparators(fileName), device->readAll());
+    d->writeStreamedEntry(QDir::fromNativeSeparators(fileName), device, d->compressionPolicy);
     if (opened)
         device->close();
 }
 
+/*!
+    Read the contents of \a device in chunks and compress them according to
+    \a policy, ready to be added to an archive with addCompressedFile().
+    The device must be open for reading. No writer state is used, so files
+    can be compressed on worker threads while a single thread writes the archive.
+    If the device is a QFile its modification time is kept.
+    If compression fails the file is stored instead, when the device can seek
+    back to where it started, otherwise the returned file is not ok and
+    addCompressedFile() skips it.
+*/
+ZipWriter::CompressedFile ZipWriter::compressFile(const QString &fileName, QIODevice *device, CompressionPolicy policy)
+{
+    const qint64 chunkSize = 256 * 1024;
+
+    CompressedFile file;
+    file.fileName = QDir::fromNativeSeparators(fileName);
+    QFile *f = qobject_cast<QFile*>(device);
+    file.lastModified = f ? QFileInfo(*f).lastModified() : QDateTime::currentDateTime();
+
+    const qint64 start = device->pos();
+    QByteArray chunk(chunkSize, Qt::Uninitialized);
+    qint64 n = device->read(chunk.data(), chunkSize);
+    if (n < 0) n = 0;
+
+    file.deflated = worthDeflating(policy, chunk.constData(), n);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (file.deflated && deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        qWarning("QZip: Z_MEM_ERROR: Not enough memory to compress file, storing it");
+        file.deflated = false;
+    }
+
+    bool failed = false;
+    file.crc_32 = ::crc32(0, 0, 0);
+    while (n > 0) {
+        file.crc_32 = ::crc32(file.crc_32, (const uchar *)chunk.constData(), n);
+        file.size += n;
+
+        if (file.deflated) {
+            stream.next_in = (Bytef*)chunk.constData();
+            stream.avail_in = n;
+            int err = deflate(&stream, file.data, Z_NO_FLUSH);
+            if (err != Z_OK && err != Z_BUF_ERROR) {
+                failed = true;
+                break;
+            }
+        } else {
+            file.data.append(chunk.constData(), n);
+        }
+        n = device->read(chunk.data(), chunkSize);
+    }
+
+    if (file.deflated) {
+        stream.avail_in = 0;
+        if (!failed && deflate(&stream, file.data, Z_FINISH) != Z_STREAM_END)
+            failed = true;
+        deflateEnd(&stream);
+    }
+
+    // store it instead, if we can read it again
+    if (failed) {
+        if (device->seek(start)) {
+            qWarning("QZip: Failed to compress file, storing it");
+            return compressFile(fileName, device, NeverCompress);
+        }
+        qWarning("QZip: Failed to compress file, skipping");
+        file.data.clear();
+        file.ok = false;
+    }
+    return file;
+}
+
+/*!
+    Returns the crc-32 of the remaining contents of \a device, read in chunks.
+*/
+uint ZipWriter::checksum(QIODevice *device)
+{
+    const qint64 chunkSize = 256 * 1024;
+    QByteArray chunk(chunkSize, Qt::Uninitialized);
+
+    uint crc_32 = ::crc32(0, 0, 0);
+    qint64 n;
+    while ((n = device->read(chunk.data(), chunkSize)) > 0)
+        crc_32 = ::crc32(crc_32, (const uchar *)chunk.constData(), n);
+    return crc_32;
+}
+
+/*!
+    Add a file prepared by compressFile(), or copied from another archive,
+    to the archive.
+*/
+void ZipWriter::addCompressedFile(const CompressedFile &file)
+{
+    if (!file.ok) {
+        d->status = ZipWriter::FileError;
+        return;
+    }
+    d->writeEntry(ZipWriterPrivate::File, file.fileName, file.data, file.crc_32, file.size,
+                  file.deflated ? 8 : 0, file.lastModified);
+}
+
 /*!
     Create a new directory in the archive with the specified \a dirName and
     the \a permissions;
@@ -1260,6 +1552,10 @@ void ZipWriter::close()
 
     d->device->write((const char *)&eod, sizeof(EndOfDirectory));
     d->device->write(d->comment);
+
+    // an entry dropped after it was partly written leaves data beyond the end
+    QFileDevice *file = qobject_cast<QFileDevice*>(d->device);
+    if (file) file->resize(file->pos());
     d->device->close();
 }
 
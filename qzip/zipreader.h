@@ -99,6 +99,7 @@ public:
 
     FileInfo entryInfoAt(int index) const;
     QByteArray fileData(const QString &fileName) const;
+    QByteArray rawFileData(int index, bool *deflated) const;
     bool extractAll(const QString &destinationDir) const;
 
     enum Status {
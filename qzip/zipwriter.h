@@ -53,6 +53,7 @@
 // We mean it.
 //
 
+#include <QtCore/qdatetime.h>
 #include <QtCore/qstring.h>
 #include <QtCore/qfile.h>
 
@@ -100,6 +101,22 @@ public:
 
     void addFile(const QString &fileName, QIODevice *device);
 
+    struct CompressedFile
+    {
+        CompressedFile() : crc_32(0), size(0), deflated(false), ok(true) {}
+        QString fileName;
+        QByteArray data;
+        uint crc_32;
+        qint64 size;
+        bool deflated;
+        bool ok; // false if it could be neither compressed nor stored
+        QDateTime lastModified;
+    };
+
+    static CompressedFile compressFile(const QString &fileName, QIODevice *device, CompressionPolicy policy = AutoCompress);
+    void addCompressedFile(const CompressedFile &file);
+    static uint checksum(QIODevice *device);
+
     void addDirectory(const QString &dirName);
 
     void addSymLink(const QString &fileName, const QString &destination);
@@ -22,6 +22,7 @@
 #include "Athlete.h"
 #include "AllPlotWindow.h"
 #include "AllPlotSlopeCurve.h"
+#include "AllPlotDecimatedCurve.h"
 #include "ReferenceLineDialog.h"
 #include "ExhaustionDialog.h"
 #include "RideFile.h"
@@ -292,97 +293,97 @@ AllPlotObject::AllPlotObject(AllPlot *plot, QList<UserData*> user) : plot(plot)
     wattsCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     wattsCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 0));
 
-    antissCurve = new QwtPlotCurve(tr("anTISS"));
+    antissCurve = new AllPlotDecimatedCurve(tr("anTISS"));
     antissCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     antissCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 3));
 
-    atissCurve = new QwtPlotCurve(tr("aTISS"));
+    atissCurve = new AllPlotDecimatedCurve(tr("aTISS"));
     atissCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     atissCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 3));
 
-    npCurve = new QwtPlotCurve(tr("IsoPower"));
+    npCurve = new AllPlotDecimatedCurve(tr("IsoPower"));
     npCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     npCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 0));
 
-    rvCurve = new QwtPlotCurve(tr("Vertical Oscillation"));
+    rvCurve = new AllPlotDecimatedCurve(tr("Vertical Oscillation"));
     rvCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     rvCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 0));
 
-    rcadCurve = new QwtPlotCurve(tr("Run Cadence"));
+    rcadCurve = new AllPlotDecimatedCurve(tr("Run Cadence"));
     rcadCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     rcadCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 0));
 
-    rgctCurve = new QwtPlotCurve(tr("GCT"));
+    rgctCurve = new AllPlotDecimatedCurve(tr("GCT"));
     rgctCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     rgctCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 0));
 
-    gearCurve = new QwtPlotCurve(tr("Gear Ratio"));
+    gearCurve = new AllPlotDecimatedCurve(tr("Gear Ratio"));
     gearCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     gearCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 0));
     gearCurve->setStyle(QwtPlotCurve::Steps);
     gearCurve->setCurveAttribute(QwtPlotCurve::Inverted);
 
-    smo2Curve = new QwtPlotCurve(tr("SmO2"));
+    smo2Curve = new AllPlotDecimatedCurve(tr("SmO2"));
     smo2Curve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     smo2Curve->setYAxis(QwtAxisId(QwtAxis::yLeft, 1));
 
-    thbCurve = new QwtPlotCurve(tr("tHb"));
+    thbCurve = new AllPlotDecimatedCurve(tr("tHb"));
     thbCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     thbCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 0));
 
-    o2hbCurve = new QwtPlotCurve(tr("O2Hb"));
+    o2hbCurve = new AllPlotDecimatedCurve(tr("O2Hb"));
     o2hbCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     o2hbCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 0));
 
-    hhbCurve = new QwtPlotCurve(tr("HHb"));
+    hhbCurve = new AllPlotDecimatedCurve(tr("HHb"));
     hhbCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     hhbCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 0));
 
-    xpCurve = new QwtPlotCurve(tr("xPower"));
+    xpCurve = new AllPlotDecimatedCurve(tr("xPower"));
     xpCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     xpCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 0));
 
-    apCurve = new QwtPlotCurve(tr("aPower"));
+    apCurve = new AllPlotDecimatedCurve(tr("aPower"));
     apCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     apCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 0));
 
-    hrCurve = new QwtPlotCurve(tr("Heart Rate"));
+    hrCurve = new AllPlotDecimatedCurve(tr("Heart Rate"));
     hrCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     hrCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 1));
 
-    tcoreCurve = new QwtPlotCurve(tr("Core Temp"));
+    tcoreCurve = new AllPlotDecimatedCurve(tr("Core Temp"));
     tcoreCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     tcoreCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 1));
 
-    accelCurve = new QwtPlotCurve(tr("Acceleration"));
+    accelCurve = new AllPlotDecimatedCurve(tr("Acceleration"));
     accelCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     accelCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 0));
 
-    wattsDCurve = new QwtPlotCurve(tr("Power Delta"));
+    wattsDCurve = new AllPlotDecimatedCurve(tr("Power Delta"));
     wattsDCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     wattsDCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 0));
 
-    cadDCurve = new QwtPlotCurve(tr("Cadence Delta"));
+    cadDCurve = new AllPlotDecimatedCurve(tr("Cadence Delta"));
     cadDCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     cadDCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 0));
 
-    nmDCurve = new QwtPlotCurve(tr("Torque Delta"));
+    nmDCurve = new AllPlotDecimatedCurve(tr("Torque Delta"));
     nmDCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     nmDCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 0));
 
-    hrDCurve = new QwtPlotCurve(tr("Heartrate Delta"));
+    hrDCurve = new AllPlotDecimatedCurve(tr("Heartrate Delta"));
     hrDCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     hrDCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 0));
 
-    speedCurve = new QwtPlotCurve(tr("Speed"));
+    speedCurve = new AllPlotDecimatedCurve(tr("Speed"));
     speedCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     speedCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 0));
 
-    cadCurve = new QwtPlotCurve(tr("Cadence"));
+    cadCurve = new AllPlotDecimatedCurve(tr("Cadence"));
     cadCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     cadCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 1));
 
-    altCurve = new QwtPlotCurve(tr("Altitude"));
+    altCurve = new AllPlotDecimatedCurve(tr("Altitude"));
     altCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     // standard->altCurve->setRenderHint(QwtPlotItem::RenderAntialiased);
     altCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 1));
@@ -394,12 +395,12 @@ AllPlotObject::AllPlotObject(AllPlot *plot, QList<UserData*> user) : plot(plot)
     altSlopeCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 1));
     altSlopeCurve->setZ(-5); // always at the back.
 
-    slopeCurve = new QwtPlotCurve(tr("Slope"));
+    slopeCurve = new AllPlotDecimatedCurve(tr("Slope"));
     slopeCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     slopeCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 3));
 
 
-    tempCurve = new QwtPlotCurve(tr("Temperature"));
+    tempCurve = new AllPlotDecimatedCurve(tr("Temperature"));
     tempCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     if (plot->context->athlete->useMetricUnits)
         tempCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 0));
@@ -409,39 +410,39 @@ AllPlotObject::AllPlotObject(AllPlot *plot, QList<UserData*> user) : plot(plot)
     windCurve = new QwtPlotIntervalCurve(tr("Wind"));
     windCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 0));
 
-    torqueCurve = new QwtPlotCurve(tr("Torque"));
+    torqueCurve = new AllPlotDecimatedCurve(tr("Torque"));
     torqueCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     torqueCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 0));
 
-    balanceLCurve = new QwtPlotCurve(tr("Left Balance"));
+    balanceLCurve = new AllPlotDecimatedCurve(tr("Left Balance"));
     balanceLCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     balanceLCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 3));
 
-    balanceRCurve = new QwtPlotCurve(tr("Right Balance"));
+    balanceRCurve = new AllPlotDecimatedCurve(tr("Right Balance"));
     balanceRCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     balanceRCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 3));
 
-    lteCurve = new QwtPlotCurve(tr("Left Torque Efficiency"));
+    lteCurve = new AllPlotDecimatedCurve(tr("Left Torque Efficiency"));
     lteCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     lteCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 3));
 
-    rteCurve = new QwtPlotCurve(tr("Right Torque Efficiency"));
+    rteCurve = new AllPlotDecimatedCurve(tr("Right Torque Efficiency"));
     rteCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     rteCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 3));
 
-    lpsCurve = new QwtPlotCurve(tr("Left Pedal Smoothness"));
+    lpsCurve = new AllPlotDecimatedCurve(tr("Left Pedal Smoothness"));
     lpsCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     lpsCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 3));
 
-    rpsCurve = new QwtPlotCurve(tr("Right Pedal Smoothness"));
+    rpsCurve = new AllPlotDecimatedCurve(tr("Right Pedal Smoothness"));
     rpsCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     rpsCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 3));
 
-    lpcoCurve = new QwtPlotCurve(tr("Left Pedal Center Offset"));
+    lpcoCurve = new AllPlotDecimatedCurve(tr("Left Pedal Center Offset"));
     lpcoCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     lpcoCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 3));
 
-    rpcoCurve = new QwtPlotCurve(tr("Right Pedal Center Offset"));
+    rpcoCurve = new AllPlotDecimatedCurve(tr("Right Pedal Center Offset"));
     rpcoCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     rpcoCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 3));
 
@@ -457,11 +458,11 @@ AllPlotObject::AllPlotObject(AllPlot *plot, QList<UserData*> user) : plot(plot)
     rpppCurve = new QwtPlotIntervalCurve(tr("Right Peak Pedal Power Phase"));
     rpppCurve->setYAxis(QwtAxisId(QwtAxis::yLeft, 3));
 
-    wCurve = new QwtPlotCurve(tr("W' Balance (kJ)"));
+    wCurve = new AllPlotDecimatedCurve(tr("W' Balance (kJ)"));
     wCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     wCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 2));
 
-    mCurve = new QwtPlotCurve(tr("Matches"));
+    mCurve = new AllPlotDecimatedCurve(tr("Matches"));
     mCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
     mCurve->setStyle(QwtPlotCurve::Dots);
     mCurve->setYAxis(QwtAxisId(QwtAxis::yRight, 2));
@@ -4407,7 +4408,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::cad:
                 {
-                ourCurve = new QwtPlotCurve(tr("Cadence"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Cadence"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->cadCurve;
                 title = tr("Cadence");
@@ -4416,7 +4417,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::tcore:
                 {
-                ourCurve = new QwtPlotCurve(tr("Core Temp"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Core Temp"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->tcoreCurve;
                 title = tr("Core Temp");
@@ -4425,7 +4426,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::hr:
                 {
-                ourCurve = new QwtPlotCurve(tr("Heart Rate"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Heart Rate"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->hrCurve;
                 title = tr("Heartrate");
@@ -4434,7 +4435,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::kphd:
                 {
-                ourCurve = new QwtPlotCurve(tr("Acceleration"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Acceleration"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->accelCurve;
                 title = tr("Acceleration");
@@ -4443,7 +4444,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::wattsd:
                 {
-                ourCurve = new QwtPlotCurve(tr("Power Delta"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Power Delta"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->wattsDCurve;
                 title = tr("Power Delta");
@@ -4452,7 +4453,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::cadd:
                 {
-                ourCurve = new QwtPlotCurve(tr("Cadence Delta"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Cadence Delta"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->cadDCurve;
                 title = tr("Cadence Delta");
@@ -4461,7 +4462,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::nmd:
                 {
-                ourCurve = new QwtPlotCurve(tr("Torque Delta"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Torque Delta"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->nmDCurve;
                 title = tr("Torque Delta");
@@ -4470,7 +4471,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::hrd:
                 {
-                ourCurve = new QwtPlotCurve(tr("Heartrate Delta"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Heartrate Delta"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->hrDCurve;
                 title = tr("Heartrate Delta");
@@ -4479,7 +4480,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::kph:
                 {
-                ourCurve = new QwtPlotCurve(tr("Speed"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Speed"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->speedCurve;
                 if (secondaryScope == RideFile::headwind) {
@@ -4492,7 +4493,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::nm:
                 {
-                ourCurve = new QwtPlotCurve(tr("Torque"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Torque"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->torqueCurve;
                 title = tr("Torque");
@@ -4510,9 +4511,9 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::wprime:
                 {
-                ourCurve = new QwtPlotCurve(tr("W' Balance (kJ)"));
+                ourCurve = new AllPlotDecimatedCurve(tr("W' Balance (kJ)"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
-                ourCurve2 = new QwtPlotCurve(tr("Matches"));
+                ourCurve2 = new AllPlotDecimatedCurve(tr("Matches"));
                 ourCurve2->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 ourCurve2->setStyle(QwtPlotCurve::Dots);
                 ourCurve2->setYAxis(QwtAxisId(QwtAxis::yRight, 2));
@@ -4526,7 +4527,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
             case RideFile::alt:
                {
                if (secondaryScope != RideFile::slope) {
-                   ourCurve = new QwtPlotCurve(tr("Altitude"));
+                   ourCurve = new AllPlotDecimatedCurve(tr("Altitude"));
                    ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                    ourCurve->setZ(-10); // always at the back.
                    thereCurve = referencePlot->standard->altCurve;
@@ -4543,7 +4544,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::slope:
                 {
-                ourCurve = new QwtPlotCurve(tr("Slope"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Slope"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->slopeCurve;
                 title = tr("Slope");
@@ -4560,7 +4561,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::temp:
                 {
-                ourCurve = new QwtPlotCurve(tr("Temperature"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Temperature"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->tempCurve;
                 title = tr("Temperature");
@@ -4569,7 +4570,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::anTISS:
                 {
-                ourCurve = new QwtPlotCurve(tr("Anaerobic TISS"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Anaerobic TISS"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->antissCurve;
                 title = tr("Anaerobic TISS");
@@ -4578,7 +4579,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::aTISS:
                 {
-                ourCurve = new QwtPlotCurve(tr("Aerobic TISS"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Aerobic TISS"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->atissCurve;
                 title = tr("Aerobic TISS");
@@ -4587,7 +4588,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::IsoPower:
                 {
-                ourCurve = new QwtPlotCurve(tr("IsoPower"));
+                ourCurve = new AllPlotDecimatedCurve(tr("IsoPower"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->npCurve;
                 title = tr("IsoPower");
@@ -4596,7 +4597,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::rvert:
                 {
-                ourCurve = new QwtPlotCurve(tr("Vertical Oscillation"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Vertical Oscillation"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->rvCurve;
                 title = tr("Vertical Oscillation");
@@ -4605,7 +4606,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::rcad:
                 {
-                ourCurve = new QwtPlotCurve(tr("Run Cadence"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Run Cadence"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->rcadCurve;
                 title = tr("Run Cadence");
@@ -4614,7 +4615,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::rcontact:
                 {
-                ourCurve = new QwtPlotCurve(tr("GCT"));
+                ourCurve = new AllPlotDecimatedCurve(tr("GCT"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->rgctCurve;
                 title = tr("GCT");
@@ -4623,7 +4624,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::gear:
                 {
-                ourCurve = new QwtPlotCurve(tr("Gear Ratio"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Gear Ratio"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->gearCurve;
                 title = tr("Gear Ratio");
@@ -4632,7 +4633,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::smo2:
                 {
-                ourCurve = new QwtPlotCurve(tr("SmO2"));
+                ourCurve = new AllPlotDecimatedCurve(tr("SmO2"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->smo2Curve;
                 title = tr("SmO2");
@@ -4641,7 +4642,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::thb:
                 {
-                ourCurve = new QwtPlotCurve(tr("tHb"));
+                ourCurve = new AllPlotDecimatedCurve(tr("tHb"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->thbCurve;
                 title = tr("tHb");
@@ -4650,7 +4651,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::o2hb:
                 {
-                ourCurve = new QwtPlotCurve(tr("O2Hb"));
+                ourCurve = new AllPlotDecimatedCurve(tr("O2Hb"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->o2hbCurve;
                 title = tr("O2Hb");
@@ -4659,7 +4660,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::hhb:
                 {
-                ourCurve = new QwtPlotCurve(tr("HHb"));
+                ourCurve = new AllPlotDecimatedCurve(tr("HHb"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->hhbCurve;
                 title = tr("HHb");
@@ -4668,7 +4669,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::xPower:
                 {
-                ourCurve = new QwtPlotCurve(tr("xPower"));
+                ourCurve = new AllPlotDecimatedCurve(tr("xPower"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->xpCurve;
                 title = tr("xPower");
@@ -4677,7 +4678,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::lps:
                 {
-                ourCurve = new QwtPlotCurve(tr("Left Pedal Smoothness"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Left Pedal Smoothness"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->lpsCurve;
                 title = tr("Left Pedal Smoothness");
@@ -4686,7 +4687,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::rps:
                 {
-                ourCurve = new QwtPlotCurve(tr("Right Pedal Smoothness"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Right Pedal Smoothness"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->rpsCurve;
                 title = tr("Right Pedal Smoothness");
@@ -4695,7 +4696,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::lte:
                 {
-                ourCurve = new QwtPlotCurve(tr("Left Torque Efficiency"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Left Torque Efficiency"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->lteCurve;
                 title = tr("Left Torque Efficiency");
@@ -4704,7 +4705,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::rte:
                 {
-                ourCurve = new QwtPlotCurve(tr("Right Torque Efficiency"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Right Torque Efficiency"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->rteCurve;
                 title = tr("Right Torque Efficiency");
@@ -4714,10 +4715,10 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
             case RideFile::rpco:
             case RideFile::lpco:
                 {
-                ourCurve = new QwtPlotCurve(tr("Left Pedal Center Offset"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Left Pedal Center Offset"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->lpcoCurve;
-                ourCurve2 = new QwtPlotCurve(tr("Right Pedal Center Offset"));
+                ourCurve2 = new AllPlotDecimatedCurve(tr("Right Pedal Center Offset"));
                 ourCurve2->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve2 = referencePlot->standard->rpcoCurve;
                 title = tr("Left/Right Pedal Center Offset");
@@ -4762,9 +4763,9 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::lrbalance:
                 {
-                ourCurve = new QwtPlotCurve(tr("Left Balance"));
+                ourCurve = new AllPlotDecimatedCurve(tr("Left Balance"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
-                ourCurve2 = new QwtPlotCurve(tr("Right Balance"));
+                ourCurve2 = new AllPlotDecimatedCurve(tr("Right Balance"));
                 ourCurve2->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->balanceLCurve;
                 thereCurve2 = referencePlot->standard->balanceRCurve;
@@ -4774,7 +4775,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
             case RideFile::aPower:
                 {
-                ourCurve = new QwtPlotCurve(tr("aPower"));
+                ourCurve = new AllPlotDecimatedCurve(tr("aPower"));
                 ourCurve->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
                 thereCurve = referencePlot->standard->apCurve;
                 title = tr("aPower");
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "AllPlotDecimatedCurve.h"
+
+#include "qwt_point_data.h"
+#include "qwt_scale_map.h"
+#include "qwt_symbol.h"
+
+#include <algorithm>
+#include <cmath>
+
+// only decimate when there are at least this many samples per pixel
+static const int DECIMATEPERPIXEL = 4;
+
+AllPlotDecimatedCurve::AllPlotDecimatedCurve(const QString &title) :
+    QwtPlotCurve(title), built(false), sorted(false)
+{
+}
+
+AllPlotDecimatedCurve::AllPlotDecimatedCurve(const QwtText &title) :
+    QwtPlotCurve(title), built(false), sorted(false)
+{
+}
+
+void
+AllPlotDecimatedCurve::dataChanged()
+{
+    // rebuilt on next paint, curves that are hidden never pay for it
+    built = false;
+    pyramid.clear();
+
+    QwtPlotCurve::dataChanged();
+}
+
+void
+AllPlotDecimatedCurve::buildPyramid(const double *x, const double *y, int n) const
+{
+    pyramid.clear();
+    built = true;
+
+    // we binary search the visible range, so x must be ascending
+    sorted = true;
+    for (int i=1; i<n; i++) {
+        if (x[i] < x[i-1]) {
+            sorted = false;
+            return;
+        }
+    }
+
+    // level 0 is min,max of each pair of samples
+    int blocks = n / 2;
+    if (blocks < 1) return;
+
+    QVector<double> level(blocks * 2);
+    for (int b=0; b<blocks; b++) {
+        level[2*b]   = qMin(y[2*b], y[2*b+1]);
+        level[2*b+1] = qMax(y[2*b], y[2*b+1]);
+    }
+    pyramid << level;
+
+    // each level above combines pairs of blocks from the level below
+    while ((blocks /= 2) >= 1) {
+
+        const QVector<double> &below = pyramid.last();
+        QVector<double> above(blocks * 2);
+
+        for (int b=0; b<blocks; b++) {
+            above[2*b]   = qMin(below[4*b], below[4*b+2]);
+            above[2*b+1] = qMax(below[4*b+1], below[4*b+3]);
+        }
+        pyramid << above;
+    }
+}
+
+void
+AllPlotDecimatedCurve::drawSeries(QPainter *painter, const QwtScaleMap &xMap,
+                                  const QwtScaleMap &yMap, const QRectF &canvasRect,
+                                  int from, int to) const
+{
+    const int n = dataSize();
+    if (!painter || n <= 0) return;
+    if (to < 0) to = n-1;
+
+    // only plain lines are decimated, steps, dots, symbols and
+    // fitted curves would look different with fewer samples
+    const QwtPointArrayData *array = dynamic_cast<const QwtPointArrayData*>(data());
+    const int pixels = fabs(xMap.p2() - xMap.p1());
+
+    if (array == NULL || style() != QwtPlotCurve::Lines || testCurveAttribute(QwtPlotCurve::Fitted) ||
+        (symbol() && symbol()->style() != QwtSymbol::NoSymbol) ||
+        pixels < 1 || (to-from+1) < pixels * DECIMATEPERPIXEL) {
+        QwtPlotCurve::drawSeries(painter, xMap, yMap, canvasRect, from, to);
+        return;
+    }
+
+    const double *x = array->xData().constData();
+    const double *y = array->yData().constData();
+
+    if (!built) buildPyramid(x, y, n);
+    if (!sorted) {
+        QwtPlotCurve::drawSeries(painter, xMap, yMap, canvasRect, from, to);
+        return;
+    }
+
+    // visible range, with a sample either side so the line meets the edges
+    const double s1 = qMin(xMap.s1(), xMap.s2());
+    const double s2 = qMax(xMap.s1(), xMap.s2());
+
+    int start = std::lower_bound(x + from, x + to + 1, s1) - x;
+    if (start > from) start--;
+    int stop = std::upper_bound(x + start, x + to + 1, s2) - x;
+    if (stop > to) stop = to;
+
+    const int count = stop - start + 1;
+    if (count < pixels * DECIMATEPERPIXEL) {
+        if (count > 0) QwtPlotCurve::drawSeries(painter, xMap, yMap, canvasRect, start, stop);
+        return;
+    }
+
+    // use blocks of up to half the samples in a pixel column
+    const int spp = count / pixels;
+    int level = -1, block = 1;
+    while (level+1 < pyramid.count() && block * 4 <= spp) {
+        block *= 2;
+        level++;
+    }
+    const double *minmax = level >= 0 ? pyramid[level].constData() : NULL;
+
+    // first, min, max and last sample in each pixel column
+    QVector<QPointF> points;
+    points.reserve(4 * (pixels + 2));
+
+    int i = start;
+    while (i <= stop) {
+
+        const double column = floor(xMap.transform(x[i]));
+        const int first = i;
+        double low = y[i], high = y[i];
+
+        for (i++; i <= stop; ) {
+
+            if (minmax && (i % block) == 0 && i + block - 1 <= stop &&
+                floor(xMap.transform(x[i + block - 1])) == column) {
+
+                // whole block lands in this column
+                const int b = i / block;
+                low = qMin(low, minmax[2*b]);
+                high = qMax(high, minmax[2*b+1]);
+                i += block;
+
+            } else if (floor(xMap.transform(x[i])) == column) {
+
+                low = qMin(low, y[i]);
+                high = qMax(high, y[i]);
+                i++;
+
+            } else break;
+        }
+
+        const int last = i - 1;
+        points << QPointF(x[first], y[first]);
+        if (last > first) {
+            const double mid = (x[first] + x[last]) / 2.0;
+            if (y[last] >= y[first]) points << QPointF(mid, low) << QPointF(mid, high);
+            else points << QPointF(mid, high) << QPointF(mid, low);
+            points << QPointF(x[last], y[last]);
+        }
+    }
+
+    // draw the reduced set in place of the full data then put it back
+    AllPlotDecimatedCurve *self = const_cast<AllPlotDecimatedCurve*>(this);
+    QwtSeriesData<QPointF> *full = self->swapData(new QwtPointSeriesData(points));
+    QwtPlotCurve::drawSeries(painter, xMap, yMap, canvasRect, 0, points.count()-1);
+    delete self->swapData(full);
+}
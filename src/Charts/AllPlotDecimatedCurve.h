@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_AllPlotDecimatedCurve
+#define _GC_AllPlotDecimatedCurve 1
+
+#include "qwt_plot_curve.h"
+#include "qwt_text.h"
+
+#include <QString>
+#include <QVector>
+
+//
+// A line curve that renders at pixel resolution.
+//
+// When there are many more samples than pixels across the plot the
+// visible samples are reduced to the first, min, max and last value
+// in each pixel column before handing them to QwtPlotCurve, so the
+// cost of a repaint is proportional to the plot width and not the
+// length of the ride. The shape drawn is identical to drawing every
+// sample since all extremes in a column are kept.
+//
+// The min/max values are looked up in a pyramid of blocks (2, 4, 8 ..
+// samples) built lazily on first paint after the data changes, so a
+// zoom or resize does not need to touch every sample again.
+//
+// data() is left untouched, so anything reading samples back from the
+// curve (hover, interval selection, export) still sees full resolution.
+//
+class AllPlotDecimatedCurve : public QwtPlotCurve
+{
+    public:
+
+        explicit AllPlotDecimatedCurve(const QString &title = QString());
+        explicit AllPlotDecimatedCurve(const QwtText &title);
+
+        virtual void drawSeries(QPainter *painter, const QwtScaleMap &xMap,
+                                const QwtScaleMap &yMap, const QRectF &canvasRect,
+                                int from, int to) const;
+
+    protected:
+
+        // invalidate the pyramid when samples are replaced
+        virtual void dataChanged();
+
+    private:
+
+        void buildPyramid(const double *x, const double *y, int n) const;
+
+        // pyramid[k] holds min,max pairs for blocks of 2^(k+1) samples
+        mutable QVector<QVector<double> > pyramid;
+        mutable bool built, sorted;
+};
+
+#endif
@@ -66,7 +66,7 @@
 static const int stackZoomWidth[8] = { 5, 10, 15, 20, 30, 45, 60, 120 };
 
 AllPlotWindow::AllPlotWindow(Context *context) :
-    GcChartWindow(context), current(NULL), context(context), active(false), stale(true), setupStack(false), setupSeriesStack(false), compareStale(true), firstShow(true)
+    GcChartWindow(context), current(NULL), context(context), active(false), stale(true), setupStack(false), setupSeriesStack(false), compareStale(true), firstShow(true), prepared(NULL)
 {
     // basic setup
     setContentsMargins(0,0,0,0);
@@ -820,6 +820,7 @@ AllPlotWindow::AllPlotWindow(Context *context) :
     connect(context, SIGNAL(zoomOut()), this, SLOT(zoomOut()));
     connect(context, SIGNAL(intervalSelected()), this, SLOT(intervalSelected()));
     connect(context, SIGNAL(rideDeleted(RideItem*)), this, SLOT(rideDeleted(RideItem*)));
+    connect(&preparer, SIGNAL(finished()), this, SLOT(rideDataPrepared()));
 
     // comparing things
     connect(context, SIGNAL(compareIntervalsStateChanged(bool)), this, SLOT(compareChanged()));
@@ -1788,6 +1789,20 @@ AllPlotWindow::forceReplot()
     rideSelected();
 }
 
+AllPlotWindow::~AllPlotWindow()
+{
+    // the job works on the ride file, don't leave it running
+    preparer.waitForFinished();
+}
+
+void
+AllPlotWindow::rideDataPrepared()
+{
+    // the ride may have changed whilst we were working, in
+    // which case rideSelected will prepare the latest one
+    rideSelected();
+}
+
 void
 AllPlotWindow::rideSelected()
 {
@@ -1804,6 +1819,7 @@ AllPlotWindow::rideSelected()
     // ignore if not active
     if (!amVisible()) {
         stale = true;
+        prepared = NULL;
         setupSeriesStack = setupStack = false;
         return;
     }
@@ -1823,6 +1839,17 @@ AllPlotWindow::rideSelected()
     //XXX if (!ride->isDirty() && ride == current && stale == false) return;
     if (ride == current && stale == false) return;
 
+    // prepare the ride data in the background first, if a job is
+    // already running we come back here when it finishes, so rides
+    // skipped over whilst arrowing through the list never get prepared
+    if (preparer.isRunning()) return;
+    if (prepared != ride) {
+        prepared = ride;
+        preparer.setFuture(ride->prepare());
+        return;
+    }
+    prepared = NULL;
+
     // ok, its now the current ride
     current = ride;
 
@@ -1861,6 +1888,10 @@ AllPlotWindow::rideSelected()
 void
 AllPlotWindow::rideDeleted(RideItem *ride)
 {
+    // may be preparing it
+    preparer.waitForFinished();
+    if (ride == prepared) prepared = NULL;
+
     if (ride == myRideItem) {
         // we have nothing to show
         setProperty("ride", QVariant::fromValue<RideItem*>(NULL));
@@ -25,6 +25,7 @@
 #include <QFormLayout>
 #include <QStyle>
 #include <QStyleFactory>
+#include <QFutureWatcher>
 
 #include "UserData.h"
 
@@ -111,6 +112,7 @@ class AllPlotWindow : public GcChartWindow
     public:
 
         AllPlotWindow(Context *context);
+        ~AllPlotWindow();
         void setData(RideItem *ride);
 
         bool isCompare() const { return context->isCompareIntervals; }
@@ -411,6 +413,11 @@ class AllPlotWindow : public GcChartWindow
         bool compareStale;     // compare init one off setup
         bool firstShow;
 
+        // ride data is prepared in the background before plotting, only
+        // the latest selection is prepared, stale selections are dropped
+        QFutureWatcher<void> preparer;
+        RideItem *prepared;
+
         struct SeriesWanted { RideFile::SeriesType one; RideFile::SeriesType two; };
 
     private slots:
@@ -419,6 +426,7 @@ class AllPlotWindow : public GcChartWindow
         void plotPickerMoved(const QPoint &);
         void plotPickerSelected(const QPoint &);
         void allPlotResized();
+        void rideDataPrepared();
 };
 
 #endif // _GC_AllPlotWindow_h
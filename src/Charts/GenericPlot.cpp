@@ -25,6 +25,12 @@
 #include "Utils.h"
 
 #include <limits>
+#include <cmath>
+#include <algorithm>
+#include <QtConcurrent>
+
+// decimate line curves with more than this many points per pixel
+static const int LODPOINTSPERPIXEL = 4;
 
 // used to format dates/times on axes
 QString GenericPlot::gl_dateformat = QString("dd MMM yy");
@@ -91,6 +97,11 @@ GenericPlot::GenericPlot(QWidget *parent, Context *context) : QWidget(parent), c
     connect(legend, SIGNAL(clicked(QString,bool)), this, SLOT(setSeriesVisible(QString,bool)));
     connect(qchart, SIGNAL(plotAreaChanged(QRectF)), this, SLOT(plotAreaChanged()));
 
+    // level of detail updates
+    lodgeneration = 0;
+    lodpending = false;
+    connect(&lodwatcher, SIGNAL(finished()), this, SLOT(lodReady()));
+
     // config changed...
     configChanged(0);
 }
@@ -354,6 +365,102 @@ GenericPlot::plotAreaChanged()
     for(int i=0; i< ar.count() && i <lr.count(); i++) {
         axisRect.insert(ar[i].axis, lr[i]);
     }
+
+    // plot width likely changed
+    refreshLOD();
+}
+
+// min/max per pixel (along with first and last) keeps the shape of the
+// curve exactly, since each column of pixels is a vertical line from the
+// minimum to the maximum, and it joins up with the columns either side
+QVector<QPointF>
+GenericPlot::decimate(const QVector<QPointF> &points, double from, double to, int pixels)
+{
+    if (pixels < 1 || to <= from || points.count() <= pixels * LODPOINTSPERPIXEL) return points;
+
+    // just the visible points, and one either side to join the edges
+    int start = std::lower_bound(points.begin(), points.end(), QPointF(from,0), CompareQPointFX()) - points.begin();
+    int stop = std::upper_bound(points.begin(), points.end(), QPointF(to,0), CompareQPointFX()) - points.begin();
+    if (start > 0) start--;
+    if (stop < points.count()) stop++;
+
+    QVector<QPointF> returning;
+    returning.reserve(pixels * 4 + 2);
+
+    double width = (to - from) / double(pixels);
+    int i=start;
+    while (i < stop) {
+
+        // all the points in this column
+        int column = std::floor((points[i].x() - from) / width);
+        int first=i, min=i, max=i;
+        for (i++; i < stop && std::floor((points[i].x() - from) / width) == column; i++) {
+            if (points[i].y() < points[min].y()) min=i;
+            if (points[i].y() > points[max].y()) max=i;
+        }
+        int last = i-1;
+
+        // keep them in order, without repeats
+        int keep[4] = { first, min < max ? min : max, min < max ? max : min, last };
+        for (int k=0; k<4; k++)
+            if (k == 0 || keep[k] != keep[k-1]) returning << points[keep[k]];
+    }
+    return returning;
+}
+
+static QList<GenericLOD>
+decimateLOD(QList<GenericLOD> jobs)
+{
+    for(int i=0; i<jobs.count(); i++)
+        jobs[i].result = GenericPlot::decimate(jobs[i].points, jobs[i].from, jobs[i].to, jobs[i].pixels);
+    return jobs;
+}
+
+void
+GenericPlot::refreshLOD()
+{
+    if (lod.isEmpty()) return;
+
+    // still working on the last one, we go again when it finishes
+    if (lodwatcher.isRunning()) {
+        lodpending = true;
+        return;
+    }
+
+    int pixels = qchart->plotArea().width();
+    if (pixels < 1) return;
+
+    QList<GenericLOD> jobs;
+    foreach(GenericLOD job, lod) {
+
+        // visible x range for this curve
+        job.from = qchart->mapToValue(qchart->plotArea().topLeft(), job.series).x();
+        job.to = qchart->mapToValue(qchart->plotArea().bottomRight(), job.series).x();
+        if (job.to < job.from) std::swap(job.from, job.to);
+        job.pixels = pixels;
+        job.generation = lodgeneration;
+        jobs << job;
+    }
+    lodwatcher.setFuture(QtConcurrent::run(decimateLOD, jobs));
+}
+
+void
+GenericPlot::lodReady()
+{
+    // curves removed or replaced whilst we were busy, so go again
+    bool stale = false;
+    foreach(GenericLOD job, lodwatcher.result()) {
+        if (job.generation != lodgeneration) {
+            stale = true;
+            break;
+        }
+        job.line->replace(job.result);
+    }
+
+    if (stale || lodpending) {
+        lodpending = false;
+        refreshLOD();
+    }
 }
 
 bool
@@ -364,6 +471,8 @@ GenericPlot::initialiseChart(QString title, int type, bool animate, int legpos)
         qchart->removeAllSeries();
         curves.clear();
         barseries=NULL;
+        lod.clear();
+        lodgeneration++;
     }
 
     foreach(QLabel *label, labels) delete label;
@@ -448,6 +557,8 @@ GenericPlot::addCurve(QString name, QVector<double> xseries, QVector<double> yse
     if (charttype==GC_CHART_LINE || charttype==GC_CHART_SCATTER || charttype==GC_CHART_PIE) {
         QAbstractSeries *existing = curves.value(name);
         if (existing) {
+            lod.remove(existing);
+            lodgeneration++;
             qchart->removeSeries(existing);
             delete existing;
             curves.remove(name);
@@ -504,6 +615,7 @@ GenericPlot::addCurve(QString name, QVector<double> xseries, QVector<double> yse
             // set up the curves
             QLineSeries *add = new QLineSeries();
             add->setName(name);
+            GenericLOD lodinfo;
 
             // aesthetics
             add->setBrush(Qt::NoBrush);
@@ -514,14 +626,29 @@ GenericPlot::addCurve(QString name, QVector<double> xseries, QVector<double> yse
             add->setOpacity(double(opacity) / 100.0); // 0-100% to 0.0-1.0 values
 
             // data
+            QVector<QPointF> points;
+            points.reserve(xseries.size());
+            bool sorted = true;
             for (int i=0; i<xseries.size() && i<yseries.size(); i++) {
-                add->append(xseries.at(i), yseries.at(i));
+                points << QPointF(xseries.at(i), yseries.at(i));
+                if (i && xseries.at(i) < xseries.at(i-1)) sorted = false;
 
                 // tell axis about the data
                 xaxis->point(xseries.at(i), yseries.at(i));
                 yaxis->point(xseries.at(i), yseries.at(i));
             }
 
+            // far more points than pixels, so plot decimated for the whole
+            // range to start with, refreshed when we know the plot area
+            int pixels = qchart->plotArea().width() > 0 ? qchart->plotArea().width() : chartview->width();
+            if (sorted && linestyle != 0 && !datalabels && pixels > 0 && points.count() > pixels * LODPOINTSPERPIXEL) {
+                lodinfo.line = add;
+                lodinfo.points = points;
+                add->replace(decimate(points, points.first().x(), points.last().x(), pixels));
+            } else {
+                add->replace(points);
+            }
+
             // hardware support?
             chartview->setRenderHint(QPainter::Antialiasing);
             add->setUseOpenGL(opengl); // for scatter or line only apparently
@@ -556,6 +683,10 @@ GenericPlot::addCurve(QString name, QVector<double> xseries, QVector<double> yse
 
                 qchart->addSeries(area);
                 curves.insert(name,area);
+                if (lodinfo.line) {
+                    lodinfo.series = area;
+                    lod.insert(area, lodinfo);
+                }
                 xaxis->series.append(area);
                 yaxis->series.append(area);
 
@@ -564,6 +695,10 @@ GenericPlot::addCurve(QString name, QVector<double> xseries, QVector<double> yse
                 // normal line series
                 qchart->addSeries(add);
                 curves.insert(name,add);
+                if (lodinfo.line) {
+                    lodinfo.series = add;
+                    lod.insert(add, lodinfo);
+                }
                 xaxis->series.append(add);
                 yaxis->series.append(add);
             }
@@ -577,8 +712,7 @@ GenericPlot::addCurve(QString name, QVector<double> xseries, QVector<double> yse
                 dec->setName(dname);
 
                 // data
-                for (int i=0; i<xseries.size() && i<yseries.size(); i++)
-                    dec->append(xseries.at(i), yseries.at(i));
+                dec->replace(points);
 
                 // if no line, but we still want labels then show
                 // for our data points
@@ -651,11 +785,16 @@ GenericPlot::addCurve(QString name, QVector<double> xseries, QVector<double> yse
 
             // set the quadtree up - now we know the ranges...
             Quadtree *tree = new Quadtree(QPointF(calc.x.min, calc.y.min), QPointF(calc.x.max, calc.y.max));
+            // one per point in the series so searches return series indexes
+            QVector<QPointF> treepoints;
+            treepoints.reserve(xseries.size());
             for (int i=0; i<xseries.size() && i<yseries.size(); i++)
-                if (xseries.at(i) != 0 && yseries.at(i) != 0) // 0,0 is common and lets ignore (usually means no data)
-                    tree->insert(QPointF(xseries.at(i), yseries.at(i)));
+                if (xseries.at(i) != 0 && yseries.at(i) != 0) treepoints << QPointF(xseries.at(i), yseries.at(i));
+                else treepoints << QPointF(std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN()); // 0,0 is common and lets ignore (usually means no data)
+            tree->load(treepoints);
 
-            if (tree->nodes.count() || tree->root->contents.count()) quadtrees.insert(add, tree);
+            if (!tree->isEmpty()) quadtrees.insert(add, tree);
+            else delete tree;
 
             // hardware support?
             chartview->setRenderHint(QPainter::Antialiasing);
@@ -914,6 +1053,14 @@ GenericPlot::finaliseChart()
                     series->attachAxis(add);
                 foreach(QAbstractSeries *series, axisinfo->decorations)
                     series->attachAxis(add);
+
+                // x range changes need a new level of detail
+                if (add->orientation() == Qt::Horizontal) {
+                    if (add->type() == QAbstractAxis::AxisTypeValue)
+                        connect(add, SIGNAL(rangeChanged(qreal,qreal)), this, SLOT(refreshLOD()));
+                    else if (add->type() == QAbstractAxis::AxisTypeDateTime)
+                        connect(add, SIGNAL(rangeChanged(QDateTime,QDateTime)), this, SLOT(refreshLOD()));
+                }
             }
         }
     }
@@ -33,6 +33,7 @@
 #include <QtCharts>
 #include <QGraphicsItem>
 #include <QFontMetrics>
+#include <QFutureWatcher>
 #include "Quadtree.h"
 
 #include "GoldenCheetah.h"
@@ -56,6 +57,20 @@ class GenericLegend;
 class GenericSelectTool;
 class GenericAxisInfo;
 
+// level of detail for a line curve, the full resolution points and
+// the decimated points for the current view (computed off the gui thread)
+struct GenericLOD {
+    GenericLOD() : series(NULL), line(NULL), from(0), to(0), pixels(0), generation(0) {}
+
+    QAbstractSeries *series;    // the curve, might be an area
+    QXYSeries *line;            // where the points go
+    QVector<QPointF> points;    // full resolution
+    double from, to;            // x range visible
+    int pixels;                 // plot width
+    int generation;             // curves changed since?
+    QVector<QPointF> result;    // decimated
+};
+
 // the chart
 class GenericPlot : public QWidget {
 
@@ -75,6 +90,9 @@ class GenericPlot : public QWidget {
         // some helper functions
         static QColor seriesColor(QAbstractSeries* series);
 
+        // min/max per pixel for points sorted by x, visible between from and to
+        static QVector<QPointF> decimate(const QVector<QPointF> &points, double from, double to, int pixels);
+
         enum annotationType { LINE=0,                 // Continious range
                               RECTANGLE=1,
                               TEXT=2,
@@ -113,6 +131,10 @@ class GenericPlot : public QWidget {
         void barsetHover(bool status, int index, QBarSet *barset);
         void plotAreaChanged();
 
+        // decimate again for the current plot area and x range
+        void refreshLOD();
+        void lodReady();
+
 
     protected:
 
@@ -139,6 +161,13 @@ class GenericPlot : public QWidget {
         // quadtrees
         QMap<QAbstractSeries*, Quadtree*> quadtrees;
 
+        // line curves with many more points than pixels are plotted
+        // decimated, the full data is here for hover and selection
+        QMap<QAbstractSeries*, GenericLOD> lod;
+        QFutureWatcher<QList<GenericLOD> > lodwatcher;
+        int lodgeneration;
+        bool lodpending;
+
 
         // annotation labels
         QList<QLabel *> labels;
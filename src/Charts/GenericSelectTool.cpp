@@ -534,13 +534,6 @@ GenericSelectTool::dragStart()
     }
 }
 
-// for std::lower_bound search of x QPointF value
-struct CompareQPointFX {
-    bool operator()(const QPointF p1, const QPointF p2) {
-        return p1.x() < p2.x();
-    }
-};
-
 bool
 GenericSelectTool::moved(QPointF pos)
 {
@@ -615,14 +608,19 @@ GenericSelectTool::moved(QPointF pos)
                     double pixels = 10 * dpiXFactor; // within 10 pixels
                     QRectF srect(pos-QPointF(pixels,pixels), pos+QPointF(pixels,pixels));
                     QRectF vrect(host->qchart->mapToValue(srect.topLeft(),series), host->qchart->mapToValue(srect.bottomRight(),series));
-                    //QPointF vpos = host->qchart->mapToValue(pos, series);
 
-                    // find candidates all close by using paint co-ords
-                    QList<QPointF> tohere;
-                    tree->candidates(vrect, tohere);
+                    // nearest few within the rect, scaled to pixels so they
+                    // are nearest on screen; then pick using paint co-ords
+                    // as the axes might be log scaled
+                    QPointF vpos = host->qchart->mapToValue(pos, series);
+                    double sx = vrect.width() ? (2*pixels) / std::fabs(vrect.width()) : 1;
+                    double sy = vrect.height() ? (2*pixels) / std::fabs(vrect.height()) : 1;
+                    QVector<int> tohere;
+                    tree->nearest(vpos, 5, tohere, sx, sy, vrect);
 
                     QPointF cursorpos=mapFromScene(pos);
-                    foreach(QPointF p, tohere) {
+                    foreach(int index, tohere) {
+                        QPointF p = static_cast<QScatterSeries*>(series)->at(index);
                         QPointF scpos = mapFromScene(host->qchart->mapToPosition(p, series));
                         if (hoverpoint == QPointF()) {
                             hoverpoint = scpos;
@@ -678,8 +676,11 @@ GenericSelectTool::moved(QPointF pos)
                 // pointsVector
                 if (series->type() == QAbstractSeries::SeriesTypeLine || series->type() == QAbstractSeries::SeriesTypeArea) {
 
+                    // full resolution when plotted decimated, otherwise
                     // we take a copy, would love to avoid this.
-                    QVector<QPointF> p = series->type() == QAbstractSeries::SeriesTypeLine ? static_cast<QLineSeries*>(series)->pointsVector() :
+                    QVector<QPointF> p;
+                    if (host->lod.contains(series)) p = host->lod.value(series).points;
+                    else p = series->type() == QAbstractSeries::SeriesTypeLine ? static_cast<QLineSeries*>(series)->pointsVector() :
                                                                               static_cast<QAreaSeries*>(series)->upperSeries()->pointsVector();
 
                     // value we want
@@ -687,6 +688,7 @@ GenericSelectTool::moved(QPointF pos)
 
                     // lower_bound to value near x
                     QVector<QPointF>::const_iterator i = std::lower_bound(p.begin(), p.end(), x, CompareQPointFX());
+                    if (i == p.end()) continue;
 
                     // collect them away
                     vals.insert(series, QPointF(*i));
@@ -1016,18 +1018,37 @@ GenericSelectTool::updateScene()
                     calc.xaxis = xaxis;
                     calc.yaxis = yaxis;
                     calc.series = line;
-                    for(int i=0; i<line->count(); i++) {
-                        QPointF point = line->at(i); // avoid deep copy
-                        if (point.x() >= minx && point.x() <= maxx) {
-                            if (!points.contains(point)) points << point; // avoid dupes
-                            calc.addPoint(point);
+                    if (host->lod.contains(x)) {
+
+                        // plotted decimated, so stats from the full resolution
+                        // data and the selection curve is decimated too
+                        QVector<QPointF> full = host->lod.value(x).points;
+                        QVector<QPointF>::const_iterator it = std::lower_bound(full.constBegin(), full.constEnd(), QPointF(minx,0), CompareQPointFX());
+                        QVector<QPointF> selected;
+                        for(; it != full.constEnd() && it->x() <= maxx; ++it) {
+                            selected << *it;
+                            calc.addPoint(*it);
                         }
-                    }
-                    calc.finalise();
-                    stats.insert(line, calc);
+                        calc.finalise();
+                        stats.insert(line, calc);
 
-                    selection->clear();
-                    if (points.count()) selection->append(points);
+                        selection->replace(GenericPlot::decimate(selected, minx, maxx, host->qchart->plotArea().width()));
+
+                    } else {
+
+                        for(int i=0; i<line->count(); i++) {
+                            QPointF point = line->at(i); // avoid deep copy
+                            if (point.x() >= minx && point.x() <= maxx) {
+                                if (!points.contains(point)) points << point; // avoid dupes
+                                calc.addPoint(point);
+                            }
+                        }
+                        calc.finalise();
+                        stats.insert(line, calc);
+
+                        selection->clear();
+                        if (points.count()) selection->append(points);
+                    }
 
                 }
                 break;
@@ -74,6 +74,13 @@ class GenericCalculator
     QDateTime midnight; // used for transform time to seconds
 };
 
+// for std::lower_bound search of x QPointF value
+struct CompareQPointFX {
+    bool operator()(const QPointF p1, const QPointF p2) const {
+        return p1.x() < p2.x();
+    }
+};
+
 // hover points etc
 struct SeriesPoint {
     QAbstractSeries *series;    // series this is a point for
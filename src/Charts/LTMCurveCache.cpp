@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "LTMCurveCache.h"
+#include "LTMSettings.h"
+#include "Context.h"
+#include "Athlete.h"
+#include "RideCache.h"
+#include "Season.h"
+
+// date range changes generate a new set of keys every time
+// so we start again rather than grow without limit
+static const int MAXCURVES = 256;
+
+LTMCurveCache::LTMCurveCache(Context *context) : QObject(context), context(context)
+{
+    setObjectName("LTMCurveCache");
+
+    // same triggers as PMCData
+    connect(context, SIGNAL(rideAdded(RideItem*)), this, SLOT(invalidate()));
+    connect(context, SIGNAL(rideDeleted(RideItem*)), this, SLOT(invalidate()));
+    connect(context, SIGNAL(refreshUpdate(QDate)), this, SLOT(invalidate()));
+    connect(context, SIGNAL(configChanged(qint32)), this, SLOT(invalidate()));
+    connect(context->athlete->rideCache, SIGNAL(itemChanged(RideItem*)), this, SLOT(invalidate()));
+    connect(context->athlete->seasons, SIGNAL(seasonsChanged()), this, SLOT(invalidate()));
+}
+
+LTMCurveCache *
+LTMCurveCache::instance(Context *context)
+{
+    LTMCurveCache *returning = context->findChild<LTMCurveCache*>("LTMCurveCache", Qt::FindDirectChildrenOnly);
+    if (!returning) returning = new LTMCurveCache(context);
+    return returning;
+}
+
+QString
+LTMCurveCache::key(Context *context, LTMSettings *settings, const MetricDetail &metricDetail, bool forceZero)
+{
+    // only the ride cache driven curves
+    if (metricDetail.type != METRIC_DB && metricDetail.type != METRIC_META &&
+        metricDetail.type != METRIC_FORMULA) return QString();
+
+    // time of day curves are not grouped by date
+    if (settings->groupBy == LTM_TOD) return QString();
+
+    bool wantZero = forceZero || metricDetail.curveStyle == QwtPlotCurve::Steps;
+    DateRange range = settings->specification.dateRange();
+
+    return QString("%1|%2|%3|%4|%5|%6|%7|%8|%9")
+           .arg(metricDetail.type)
+           .arg(metricDetail.type == METRIC_FORMULA ? metricDetail.formula
+                                                     : (metricDetail.type == METRIC_META ? metricDetail.name : metricDetail.symbol))
+           .arg(metricDetail.formulaType)
+           .arg(metricDetail.datafilter)
+           .arg(wantZero)
+           .arg(metricDetail.uunits)
+           .arg(context->athlete->useMetricUnits)
+           .arg(QString("%1|%2|%3").arg(settings->groupBy)
+                                   .arg(settings->start.date().toString(Qt::ISODate))
+                                   .arg(settings->end.date().toString(Qt::ISODate)))
+           .arg(QString("%1|%2|%3").arg(range.from.toString(Qt::ISODate))
+                                   .arg(range.to.toString(Qt::ISODate))
+                                   .arg(settings->specification.filterSet().signature()));
+}
+
+bool
+LTMCurveCache::find(const QString &key, LTMCurveData &data) const
+{
+    if (key.isEmpty()) return false;
+
+    QHash<QString, LTMCurveData>::const_iterator it = cache.find(key);
+    if (it == cache.end()) return false;
+
+    data = it.value();
+    return true;
+}
+
+void
+LTMCurveCache::insert(const QString &key, const LTMCurveData &data)
+{
+    if (key.isEmpty()) return;
+
+    if (cache.count() >= MAXCURVES) cache.clear();
+    cache.insert(key, data);
+}
+
+void
+LTMCurveCache::invalidate()
+{
+    cache.clear();
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_LTMCurveCache_h
+#define _GC_LTMCurveCache_h 1
+#include "GoldenCheetah.h"
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QString>
+
+class Context;
+class LTMSettings;
+class MetricDetail;
+
+// grouped x/y data for a single curve, as returned by createCurveData
+struct LTMCurveData {
+    LTMCurveData() : n(0) {}
+
+    QVector<double> x, y;
+    int n;
+};
+
+//
+// Curve data aggregated from the ride cache by group-by period, shared
+// between all the trends charts for an athlete. Rebuilding a dashboard
+// with many curves after a date range change is dominated by walking the
+// ride cache once per curve, so results are kept until the underlying
+// data changes.
+//
+// Only the ride cache driven curves (metrics, metadata and formulas) are
+// cached, PMC, bests and estimates have caches of their own.
+//
+class LTMCurveCache : public QObject
+{
+    Q_OBJECT
+
+    public:
+
+        // one per context, created on first use and owned by the context
+        static LTMCurveCache *instance(Context *context);
+
+        // key for the curve or an empty string if not cacheable
+        static QString key(Context *context, LTMSettings *settings, const MetricDetail &metricDetail, bool forceZero=false);
+
+        bool find(const QString &key, LTMCurveData &data) const;
+        void insert(const QString &key, const LTMCurveData &data);
+
+    public slots:
+
+        // ride data, config or seasons changed
+        void invalidate();
+
+    private:
+
+        LTMCurveCache(Context *context);
+
+        Context *context;
+        QHash<QString, LTMCurveData> cache;
+};
+
+#endif
@@ -41,8 +41,10 @@
 #include "Zones.h"
 #include "HrZones.h"
 #include "PaceZones.h"
+#include "Trace.h"
 
 #include <QSettings>
+#include <QtConcurrent>
 
 #include <qwt_series_data.h>
 #include <qwt_scale_widget.h>
@@ -223,6 +225,8 @@ LTMPlot::setAxisTitle(QwtAxisId axis, QString label)
 void
 LTMPlot::setData(LTMSettings *set)
 {
+    TraceSpan span("chart", "LTMPlot::setData");
+
     QTime timer;
     timer.start();
 
@@ -377,9 +381,17 @@ LTMPlot::setData(LTMSettings *set)
     stackY.clear();
     stacks.clear();
 
+    // get the data for all the curves up front
+    QVector<LTMCurveData> gathered;
+    gatherCurveData(context, settings, gathered);
+
+    //qDebug()<<"Gathered curve data.."<<timer.elapsed();
+
     int r=0;
 
-    foreach (MetricDetail metricDetail, settings->metrics) {
+    for (int m=0; m<settings->metrics.count(); m++) {
+
+        MetricDetail metricDetail = settings->metrics[m];
 
         // if we have at least one banister curve visible then helper is relevant
         if (metricDetail.hidden == false && metricDetail.type == METRIC_BANISTER) haveBanister=true;
@@ -387,17 +399,11 @@ LTMPlot::setData(LTMSettings *set)
         if (metricDetail.stack == true) {
 
             // register this data
-            QVector<double> *xdata = new QVector<double>();
-            QVector<double> *ydata = new QVector<double>();
+            QVector<double> *xdata = new QVector<double>(gathered[m].x);
+            QVector<double> *ydata = new QVector<double>(gathered[m].y);
             stackX.append(xdata);
             stackY.append(ydata);
 
-            int count;
-            if (settings->groupBy != LTM_TOD)
-                createCurveData(context, settings, metricDetail, *xdata, *ydata, count);
-            else
-                createTODCurveData(context, settings, metricDetail, *xdata, *ydata, count);
-
             // we add in the last curve for X axis values
             if (r) {
                 aggregateCurves(*stackY[r], *stackY[r-1]);
@@ -593,15 +599,9 @@ LTMPlot::setData(LTMSettings *set)
         //
         if (metricDetail.stack == true) continue;
 
-        QVector<double> xdata, ydata;
-
-        int count;
-        if (settings->groupBy != LTM_TOD)
-            createCurveData(context, settings, metricDetail, xdata, ydata, count);
-        else
-            createTODCurveData(context, settings, metricDetail, xdata, ydata, count);
-
-        //qDebug()<<"Create curve data.."<<timer.elapsed();
+        QVector<double> xdata = gathered[m].x;
+        QVector<double> ydata = gathered[m].y;
+        int count = gathered[m].n;
 
         // Create a curve
         QwtPlotCurve *current = (metricDetail.type == METRIC_ESTIMATE || metricDetail.type == METRIC_BANISTER || metricDetail.type == METRIC_D_MEASURE)
@@ -2604,6 +2604,72 @@ LTMPlot::createTODCurveData(Context *context, LTMSettings *settings, MetricDetai
     }
 }
 
+// a ride cache walk for one curve, run on the thread pool
+struct LTMCurveJob {
+    LTMPlot *plot;
+    Context *context;
+    LTMSettings *settings;
+    int index;
+    LTMCurveData *data;
+};
+
+static void gatherMetricData(LTMCurveJob &job)
+{
+    job.plot->createMetricData(job.context, job.settings, job.settings->metrics[job.index],
+                               job.data->x, job.data->y, job.data->n);
+}
+
+void
+LTMPlot::gatherCurveData(Context *context, LTMSettings *settings, QVector<LTMCurveData> &gathered)
+{
+    LTMCurveCache *cache = LTMCurveCache::instance(context);
+
+    gathered.resize(settings->metrics.count());
+    QVector<QString> keys(settings->metrics.count());
+    QList<LTMCurveJob> jobs;
+
+    // as in createCurveData, nothing to gather for an empty date range
+    int maxdays = groupForDate(settings->end.date(), settings->groupBy)
+                  - groupForDate(settings->start.date(), settings->groupBy) + 1;
+
+    for (int m=0; m<settings->metrics.count(); m++) {
+
+        const MetricDetail &metricDetail = settings->metrics[m];
+
+        // already aggregated by this or another chart
+        keys[m] = LTMCurveCache::key(context, settings, metricDetail);
+        if (cache->find(keys[m], gathered[m])) continue;
+
+        // metric and metadata curves only read the ride cache so can be
+        // gathered concurrently, formulas and curve filters use a
+        // DataFilter and everything else has its own caches
+        if (settings->groupBy != LTM_TOD && SearchFilterBox::isNull(metricDetail.datafilter) &&
+            (metricDetail.type == METRIC_DB || metricDetail.type == METRIC_META)) {
+
+            if (maxdays <= 0) continue;
+
+            LTMCurveJob job;
+            job.plot = this;
+            job.context = context;
+            job.settings = settings;
+            job.index = m;
+            job.data = &gathered[m];
+            jobs << job;
+            continue;
+        }
+
+        if (settings->groupBy != LTM_TOD)
+            createCurveData(context, settings, metricDetail, gathered[m].x, gathered[m].y, gathered[m].n);
+        else
+            createTODCurveData(context, settings, metricDetail, gathered[m].x, gathered[m].y, gathered[m].n);
+    }
+
+    QtConcurrent::blockingMap(jobs, gatherMetricData);
+
+    for (int m=0; m<settings->metrics.count(); m++)
+        cache->insert(keys[m], gathered[m]);
+}
+
 void
 LTMPlot::createCurveData(Context *context, LTMSettings *settings, MetricDetail metricDetail, QVector<double>&x,QVector<double>&y,int&n, bool forceZero)
 {
@@ -33,6 +33,7 @@
 #include "AllPlot.h" // for curve colors widget
 #include "LTMSettings.h"
 #include "LTMCanvasPicker.h"
+#include "LTMCurveCache.h"
 
 #include "Context.h"
 
@@ -114,6 +115,9 @@ class LTMPlot : public QwtPlot
         QVector< QVector<double>* > stackY;
 
         int groupForDate(QDate , int);
+
+        // get the data for all curves, from the curve cache or created concurrently
+        void gatherCurveData(Context *, LTMSettings *, QVector<LTMCurveData>&);
         void createCurveData(Context *,LTMSettings *, MetricDetail, QVector<double>&, QVector<double>&, int&, bool=false);
 
         // create curve data from Banister
@@ -1961,10 +1961,11 @@ PowerHist::setArraysFromRide(RideFile *ride, HistData &standard, const Zones *zo
         standard.wbalZoneSelectedArray.resize(4);
 
         // t is time in seconds
-        for(int t=0; t< ride->wprimeData()->ydata().count(); t++) {
+        const QVector<double> &wbal = ride->wprimeData()->ydata();
+        for(int t=0; t< wbal.count(); t++) {
 
             // get the value
-            double value = ride->wprimeData()->ydata()[t];
+            double value = wbal[t];
 
             // percent left
             double percent = 100.0f - ((double (value) / WPRIME) * 100.0f);
@@ -45,6 +45,10 @@
 #include "GcOverlayWidget.h"
 #include "IntervalSummaryWindow.h"
 #include <QDebug>
+#include <QDataStream>
+
+#include <cmath>
+#include <algorithm>
 
 RideMapWindow::RideMapWindow(Context *context, int mapType) : GcChartWindow(context), context(context),
                                                        range(-1), current(NULL), firstShow(true), stale(false)
@@ -332,6 +336,7 @@ RideMapWindow::rideSelected()
 
 void RideMapWindow::loadRide()
 {
+    createRoute();
     createHtml();
 
     view->page()->setHtml(currentPage);
@@ -426,15 +431,33 @@ void RideMapWindow::createHtml()
     "var intervalList;\n"  // array of intervals
     "var markerList;\n"  // array of markers
     "var polyList;\n"  // array of polylines
+    "var routeList;\n"  // route and shaded segments
     "var tmpIntervalHighlighter;\n"  // temp interval
 
     // Draw the entire route, we use a local webbridge
     // to supply the data to a) reduce bandwidth and
     // b) allow local manipulation. This makes the UI
-    // considerably more 'snappy'
+    // considerably more 'snappy'. It is simplified for
+    // the zoom level so redrawn when the zoom changes
     "function drawRoute() {\n"
+    "   var zoom = map.getZoom();\n"
+    "   if (zoom === undefined) return;\n" // google sets it after fitBounds
     // load the GPS co-ordinates
-    "   webBridge.getLatLons(0, drawRouteForLatLons);\n"
+    "   webBridge.getRoute(zoom, drawRouteForLatLons);\n"
+    "}\n"
+
+    // lat/lons arrive as base64 float32 offsets from the first point
+    "function decodeLatLons(route) {\n"
+    "   var bytes = atob(route.data);\n"
+    "   var buffer = new Uint8Array(bytes.length);\n"
+    "   for (var i=0; i<bytes.length; i++) buffer[i] = bytes.charCodeAt(i);\n"
+    "   var offsets = new Float32Array(buffer.buffer);\n"
+    "   var latlons = new Float64Array(offsets.length);\n"
+    "   for (var j=0; j<offsets.length; j += 2) {\n"
+    "       latlons[j] = route.lat + offsets[j];\n"
+    "       latlons[j+1] = route.lon + offsets[j+1];\n"
+    "   }\n"
+    "   return latlons;\n"
     "}\n"
     "\n");
 
@@ -442,8 +465,10 @@ void RideMapWindow::createHtml()
         // when we have style options we draw the route in cplotmarker colors
         // and no opacity since its just a stylised map used for dashboards or
         // small thumbnails.
-        currentPage += QString("function drawRouteForLatLons(latlons) {\n"
+        currentPage += QString("function drawRouteForLatLons(route) {\n"
 
+            // remove the route drawn for the last zoom level
+            "    while (routeList.length) map.removeLayer(routeList.pop());\n"
 
             // route will be drawn with these options
             "    var routeOptionsYellow = {\n"
@@ -455,6 +480,7 @@ void RideMapWindow::createHtml()
             "    };\n"
 
             // lastly, populate the route path
+            "    var latlons = decodeLatLons(route);\n"
             "    var path = [];\n"
             "    var j=0;\n"
             "    while (j < latlons.length) { \n"
@@ -463,13 +489,30 @@ void RideMapWindow::createHtml()
             "    };\n"
 
             "    var routeYellow = new L.Polyline(path, routeOptionsYellow).addTo(map);\n"
+            "    routeList.push(routeYellow);\n"
+            "    listenRoute(routeYellow);\n"
+            "    routeYellow.on('mousemove', function(event) { webBridge.hoverPath(event.latlng.lat, event.latlng.lng); });\n"
+
+            // shaded segments, coloured by power zone
+            "    for (var i=0; i<route.colors.length; i++) {\n"
+            "        var polyOptions = {\n"
+            "            stroke: true,\n"
+            "            color: route.colors[i],\n"
+            "            weight: 3,\n"
+            "            opacity: 0.5,\n" // for out and backs, we need both
+            "            zIndex: 0\n"
+            "        };\n"
+            "        var polyline = new L.Polyline(path.slice(route.segments[i], route.segments[i+1]+1), polyOptions).addTo(map);\n"
+            "        routeList.push(polyline);\n"
+            "        listenRoute(polyline);\n"
+            "    }\n"
+            "}\n"
 
             // Listen mouse events
-            "routeYellow.on('mousedown', function(event) { map.dragging.disable();L.DomEvent.stopPropagation(event);webBridge.clickPath(event.latlng.lat, event.latlng.lng); });\n" // map.setOptions({draggable: false, zoomControl: false, scrollwheel: false, disableDoubleClickZoom: true});
-            "routeYellow.on('mouseup',   function(event) { map.dragging.enable();L.DomEvent.stopPropagation(event);webBridge.mouseup(); });\n" // setOptions ?
-            "routeYellow.on('mouseover', function(event) { webBridge.hoverPath(event.latlng.lat, event.latlng.lng); });\n"
-            "routeYellow.on('mousemove', function(event) { webBridge.hoverPath(event.latlng.lat, event.latlng.lng); });\n"
-
+            "function listenRoute(polyline) {\n"
+            "    polyline.on('mousedown', function(event) { map.dragging.disable();L.DomEvent.stopPropagation(event);webBridge.clickPath(event.latlng.lat, event.latlng.lng); });\n" // map.setOptions({draggable: false, zoomControl: false, scrollwheel: false, disableDoubleClickZoom: true});
+            "    polyline.on('mouseup',   function(event) { map.dragging.enable();L.DomEvent.stopPropagation(event);webBridge.mouseup(); });\n" // setOptions ?
+            "    polyline.on('mouseover', function(event) { webBridge.hoverPath(event.latlng.lat, event.latlng.lng); });\n"
             "}\n").arg(styleoptions == "" ? "#FFFF00" : GColor(CPLOTMARKER).name())
                   .arg(styleoptions == "" ? 0.4 : 1.0);
     }
@@ -478,7 +521,10 @@ void RideMapWindow::createHtml()
        // when we have style options we draw the route in cplotmarker colors
        // and no opacity since its just a stylised map used for dashboards or
        // small thumbnails.
-       currentPage += QString("function drawRouteForLatLons(latlons) {\n"
+       currentPage += QString("function drawRouteForLatLons(route) {\n"
+
+           // remove the route drawn for the last zoom level
+           "    while (routeList.length) routeList.pop().setMap(null);\n"
 
            // route will be drawn with these options
            "    var routeOptionsYellow = {\n"
@@ -488,23 +534,43 @@ void RideMapWindow::createHtml()
            "        zIndex: -2\n"
            "    };\n"
 
-           // create the route Polyline
-           "    var routeYellow = new google.maps.Polyline(routeOptionsYellow);\n"
-           "    routeYellow.setMap(map);\n"
-
-           // lastly, populate the route path
-           "    var path = routeYellow.getPath();\n"
+           // populate the route path
+           "    var latlons = decodeLatLons(route);\n"
+           "    var path = [];\n"
            "    var j=0;\n"
            "    while (j < latlons.length) { \n"
            "        path.push(new google.maps.LatLng(latlons[j], latlons[j+1]));\n"
            "        j += 2;\n"
            "    }\n"
 
-           // Listen mouse events
-           "    google.maps.event.addListener(routeYellow, 'mousedown', function(event) { map.setOptions({draggable: false, zoomControl: false, scrollwheel: false, disableDoubleClickZoom: true}); webBridge.clickPath(event.latLng.lat(), event.latLng.lng()); });\n"
-           "    google.maps.event.addListener(routeYellow, 'mouseup',   function(event) { map.setOptions({draggable: true, zoomControl: true, scrollwheel: true, disableDoubleClickZoom: false}); webBridge.mouseup(); });\n"
-           "    google.maps.event.addListener(routeYellow, 'mouseover', function(event) { webBridge.hoverPath(event.latLng.lat(), event.latLng.lng()); });\n"
+           // create the route Polyline
+           "    var routeYellow = new google.maps.Polyline(routeOptionsYellow);\n"
+           "    routeYellow.setPath(path);\n"
+           "    routeYellow.setMap(map);\n"
+           "    routeList.push(routeYellow);\n"
+           "    listenRoute(routeYellow);\n"
+
+           // shaded segments, coloured by power zone
+           "    for (var i=0; i<route.colors.length; i++) {\n"
+           "        var polyOptions = {\n"
+           "            strokeColor: route.colors[i],\n"
+           "            strokeWeight: 3,\n"
+           "            strokeOpacity: 0.5,\n" // for out and backs, we need both
+           "            zIndex: 0,\n"
+           "            path: path.slice(route.segments[i], route.segments[i+1]+1)\n"
+           "        };\n"
+           "        var polyline = new google.maps.Polyline(polyOptions);\n"
+           "        polyline.setMap(map);\n"
+           "        routeList.push(polyline);\n"
+           "        listenRoute(polyline);\n"
+           "    }\n"
+           "}\n"
 
+           // Listen mouse events
+           "function listenRoute(polyline) {\n"
+           "    google.maps.event.addListener(polyline, 'mousedown', function(event) { map.setOptions({draggable: false, zoomControl: false, scrollwheel: false, disableDoubleClickZoom: true}); webBridge.clickPath(event.latLng.lat(), event.latLng.lng()); });\n"
+           "    google.maps.event.addListener(polyline, 'mouseup',   function(event) { map.setOptions({draggable: true, zoomControl: true, scrollwheel: true, disableDoubleClickZoom: false}); webBridge.mouseup(); });\n"
+           "    google.maps.event.addListener(polyline, 'mouseover', function(event) { webBridge.hoverPath(event.latLng.lat(), event.latLng.lng()); });\n"
            "}\n").arg(styleoptions == "" ? "#FFFF00" : GColor(CPLOTMARKER).name())
                  .arg(styleoptions == "" ? 0.4f : 1.0f);
     }
@@ -599,11 +665,13 @@ void RideMapWindow::createHtml()
                                "    markerList = new Array();\n"
                                "    intervalList = new Array();\n"
                                "    polyList = new Array();\n"
+                               "    routeList = new Array();\n"
 
                                // draw the main route data, getting the geo
                                // data from the webbridge - reduces data sent/received
                                // to the map server and makes the UI pretty snappy
                                "    drawRoute();\n"
+                               "    map.on('zoomend', drawRoute);\n"
                                "    drawIntervals();\n"
                                // catch signals to redraw intervals
                                "    webBridge.drawIntervals.connect(drawIntervals);\n"
@@ -703,11 +771,13 @@ void RideMapWindow::createHtml()
             "    markerList = new Array();\n"
             "    intervalList = new Array();\n"
             "    polyList = new Array();\n"
+            "    routeList = new Array();\n"
 
             // draw the main route data, getting the geo
             // data from the webbridge - reduces data sent/received
             // to the map server and makes the UI pretty snappy
             "    drawRoute();\n"
+            "    google.maps.event.addListener(map, 'zoom_changed', drawRoute);\n"
             "    drawIntervals();\n"
             // catch signals to redraw intervals
             "    webBridge.drawIntervals.connect(drawIntervals);\n"
@@ -738,9 +808,9 @@ QColor RideMapWindow::GetColor(int watts)
     else return zoneColor(context->athlete->zones(myRideItem ? myRideItem->isRun : false)->whichZone(range, watts), 7);
 }
 
-// create the ride line
+// create the route, split into shaded segments
 void
-RideMapWindow::drawShadedRoute()
+RideMapWindow::createRoute()
 {
     int intervalTime = 60;  // 60 seconds
     double rtime=0; // running total for accumulated data
@@ -748,34 +818,19 @@ RideMapWindow::drawShadedRoute()
     int rwatts=0; // running total of watts
     double prevtime=0; // time for previous point
 
-    QString code;
+    QVector<int> points;
+    QVector<int> starts;
+    QStringList colors;
 
-    foreach(RideFilePoint *rfp, myRideItem->ride()->dataPoints()) {
-        if (mapCombo->currentIndex() == OSM) {
-            // Get GPS coordinates.
-            if (count == 0) {
-                // Start of segment.
-                code = QString("{\n"
-                               "var latLons = [");
-            }
+    // styled maps (dashboards, thumbnails) are not shaded
+    bool shaded = (styleoptions == "");
 
-            if (rfp->lat || rfp->lon)
-                code += QString("[%1, %2], ").arg(rfp->lat,0,'g',GPS_COORD_TO_STRING).arg(rfp->lon,0,'g',GPS_COORD_TO_STRING);
-        } else if (mapCombo->currentIndex() == GOOGLE) {
-            if (count == 0) {
-                code = QString("{\nvar polyline = new google.maps.Polyline();\n"
-                       "   polyline.setMap(map);\n"
-                       "   path = polyline.getPath();\n");
-
-                // Listen mouse events
-                code += QString("google.maps.event.addListener(polyline, 'mousedown', function(event) { map.setOptions({draggable: false, zoomControl: false, scrollwheel: false, disableDoubleClickZoom: true}); webBridge.clickPath(event.latLng.lat(), event.latLng.lng()); });\n"
-                                "google.maps.event.addListener(polyline, 'mouseup',   function(event) { map.setOptions({draggable: true, zoomControl: true, scrollwheel: true, disableDoubleClickZoom: false}); webBridge.mouseup(); });\n"
-                                "google.maps.event.addListener(polyline, 'mouseover', function(event) { webBridge.hoverPath(event.latLng.lat(), event.latLng.lng()); });\n");
-            } else {
-                if (rfp->lat || rfp->lon)
-                    code += QString("path.push(new google.maps.LatLng(%1,%2));\n").arg(rfp->lat,0,'g',GPS_COORD_TO_STRING).arg(rfp->lon,0,'g',GPS_COORD_TO_STRING);
-            }
-        }
+    starts << 0;
+    const QVector<RideFilePoint*> &samples = myRideItem->ride()->dataPoints();
+    for (int i=0; i<samples.count(); i++) {
+
+        RideFilePoint *rfp = samples[i];
+        if (rfp->lat || rfp->lon) points << i;
 
         // running total of time
         rtime += rfp->secs - prevtime;
@@ -783,54 +838,24 @@ RideMapWindow::drawShadedRoute()
         prevtime = rfp->secs;
         count++;
 
-        // end of segment
+        // end of segment, segments share their end points
+        // so there are no gaps between them
         if (rtime >= intervalTime) {
-            if (mapCombo->currentIndex() == OSM) {
-                // Finalize variable "latLons" for the segment.
-                if (code.endsWith(", "))
-                    code.resize(code.length() - 2);
-                code += QString("];\n");
+            if (shaded && points.count()-1 > starts.last()) {
+                colors << GetColor(rwatts / count).name();
+                starts << points.count()-1;
             }
-
-            int avgWatts = rwatts / count;
-            QColor color = GetColor(avgWatts);
-            // thats this segment done, so finish off and
-            // add tooltip junk
             count = rwatts = rtime = 0;
-
-            if (mapCombo->currentIndex() == OSM) {
-                // Create and color a polyline for the segment.
-                code += QString("var polyOptions = {\n"
-                                "    stroke: true,\n"
-                                "    color: '%1',\n"
-                                "    weight: 3,\n"
-                                "    opacity: %2,\n" // for out and backs, we need both
-                                "    zIndex: 0\n"
-                                "};\n"
-                                "var polyline = new L.Polyline(latLons, polyOptions).addTo(map);\n"
-                                "polyline.on('mousedown', function(event) { map.dragging.disable();L.DomEvent.stopPropagation(event);webBridge.clickPath(event.latlng.lat, event.latlng.lng); });\n" // map.setOptions({draggable: false, zoomControl: false, scrollwheel: false, disableDoubleClickZoom: true});
-                                "polyline.on('mouseup',   function(event) { map.dragging.enable();L.DomEvent.stopPropagation(event);webBridge.mouseup(); });\n" // setOptions ?
-                                "polyline.on('mouseover', function(event) { webBridge.hoverPath(event.latlng.lat, event.latlng.lng); });\n"
-                                "path = polyline.getLatLngs();\n"
-                                "}\n").arg(styleoptions == "" ? color.name() : GColor(CPLOTMARKER).name())
-                                .arg(styleoptions == "" ? 0.5 : 1.0);
-            } else if (mapCombo->currentIndex() == GOOGLE) {
-                // color the polyline
-                code += QString("var polyOptions = {\n"
-                                "    strokeColor: '%1',\n"
-                                "    strokeWeight: 3,\n"
-                                "    strokeOpacity: %2,\n" // for out and backs, we need both
-                                "    zIndex: 0,\n"
-                                "}\n"
-                                "polyline.setOptions(polyOptions);\n"
-                                "}\n").arg(styleoptions == "" ? color.name() : GColor(CPLOTMARKER).name())
-                                      .arg(styleoptions == "" ? 0.5f : 1.0f);
-
-            }
-            view->page()->runJavaScript(code);
         }
     }
 
+    // and whatever is left at the end
+    if (points.count()-1 > starts.last()) {
+        if (shaded) colors << GetColor(count ? rwatts / count : 0).name();
+        starts << points.count()-1;
+    }
+
+    route.setRide(myRideItem->ride(), points, starts, colors);
 }
 
 void
@@ -1163,6 +1188,194 @@ void RideMapWindow::zoomInterval(IntervalItem *which)
     view->page()->runJavaScript(code);
 }
 
+// spatial index grid, about 100m
+static const double GRIDSIZE = 0.001;
+
+// map tiles are 256 pixels and cover 360 degrees at zoom 0
+static double degreesPerPixel(int zoom)
+{
+    return 360.0 / (256.0 * pow(2.0, zoom));
+}
+
+static qint64 gridKey(qint64 x, qint64 y)
+{
+    return qint64((quint64(y) << 32) | (quint64(x) & 0xffffffffULL));
+}
+
+qint64
+RideMapRoute::cell(double lat, double lon) const
+{
+    return gridKey(floor(lon / GRIDSIZE), floor(lat / GRIDSIZE));
+}
+
+void
+RideMapRoute::setRide(const RideFile *ride, QVector<int> samples, QVector<int> starts, QStringList colors)
+{
+    points.resize(samples.count());
+    for (int i=0; i<samples.count(); i++) {
+        const RideFilePoint *p = ride->dataPoints().at(samples[i]);
+        points[i].lat = p->lat;
+        points[i].lon = p->lon;
+        points[i].index = samples[i];
+    }
+    this->starts = starts;
+    this->colors = colors;
+    simplified.clear();
+    grid.clear();
+
+    // distances are on an equirectangular projection, which is fine at ride scale
+    coslat = points.count() ? cos(points[0].lat * M_PI / 180.0) : 1.0;
+    if (coslat < 0.01) coslat = 0.01;
+
+    for (int i=0; i<points.count(); i++) grid[cell(points[i].lat, points[i].lon)] << i;
+}
+
+// Douglas-Peucker, marks the points to keep in [from, to]
+void
+RideMapRoute::simplify(int from, int to, double tolerance, QVector<bool> &keep) const
+{
+    keep[from] = keep[to] = true;
+
+    QVector<QPair<int,int> > spans;
+    spans << QPair<int,int>(from, to);
+
+    while (!spans.isEmpty()) {
+
+        QPair<int,int> span = spans.takeLast();
+        int a = span.first, b = span.second;
+        if (b - a < 2) continue;
+
+        double ax = points[a].lon * coslat, ay = points[a].lat;
+        double dx = points[b].lon * coslat - ax, dy = points[b].lat - ay;
+        double length = dx*dx + dy*dy;
+
+        // furthest point from the line a-b
+        double worst = 0;
+        int index = -1;
+        for (int i=a+1; i<b; i++) {
+            double px = points[i].lon * coslat - ax, py = points[i].lat - ay;
+            double t = length > 0 ? qBound(0.0, (px*dx + py*dy) / length, 1.0) : 0;
+            double ex = px - t*dx, ey = py - t*dy;
+            double distance = ex*ex + ey*ey;
+            if (distance > worst) {
+                worst = distance;
+                index = i;
+            }
+        }
+
+        if (index >= 0 && worst > tolerance * tolerance) {
+            keep[index] = true;
+            spans << QPair<int,int>(a, index) << QPair<int,int>(index, b);
+        }
+    }
+}
+
+QVariantMap
+RideMapRoute::geometry(int zoom)
+{
+    this->zoom = zoom;
+    if (simplified.contains(zoom)) return simplified.value(zoom);
+
+    // half a pixel
+    double tolerance = 0.5 * degreesPerPixel(zoom) * coslat;
+
+    QVector<bool> keep(points.count(), starts.count() < 2);
+    for (int s=0; s+1 < starts.count(); s++) simplify(starts[s], starts[s+1], tolerance, keep);
+
+    // float32 offsets from the first point keep well under a meter of
+    // precision and are decoded straight into a typed array by the page
+    double lat = points.count() ? points[0].lat : 0;
+    double lon = points.count() ? points[0].lon : 0;
+
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    // where each segment starts in the points we send
+    QVariantList segments;
+    int n=0;
+    for (int i=0, s=0; i<points.count(); i++) {
+        if (s < starts.count() && starts[s] == i) {
+            segments << n;
+            s++;
+        }
+        if (!keep[i]) continue;
+
+        stream << (points[i].lat - lat) << (points[i].lon - lon);
+        n++;
+    }
+
+    QVariantMap returning;
+    returning.insert("lat", lat);
+    returning.insert("lon", lon);
+    returning.insert("data", QString::fromLatin1(bytes.toBase64()));
+    returning.insert("segments", segments);
+    returning.insert("colors", colors);
+
+    simplified.insert(zoom, returning);
+    return returning;
+}
+
+QList<int>
+RideMapRoute::search(double lat, double lng) const
+{
+    QList<int> list;
+    if (points.isEmpty()) return list;
+
+    // within 0.0001 degrees, or a few pixels when zoomed out
+    // since the route drawn has been simplified
+    double dlat = qMax(0.0001, 3 * degreesPerPixel(zoom) * coslat);
+    double dlon = dlat / coslat;
+
+    QVector<int> found;
+    qint64 x0 = floor((lng - dlon) / GRIDSIZE), x1 = floor((lng + dlon) / GRIDSIZE);
+    qint64 y0 = floor((lat - dlat) / GRIDSIZE), y1 = floor((lat + dlat) / GRIDSIZE);
+
+    if ((x1 - x0 + 1) * (y1 - y0 + 1) > grid.count()) {
+
+        // zoomed right out, quicker to just look at them all
+        for (int i=0; i<points.count(); i++) found << i;
+
+    } else {
+
+        for (qint64 y=y0; y<=y1; y++) {
+            for (qint64 x=x0; x<=x1; x++) {
+                QHash<qint64, QVector<int> >::const_iterator it = grid.constFind(gridKey(x, y));
+                if (it != grid.constEnd()) found << it.value();
+            }
+        }
+        std::sort(found.begin(), found.end());
+    }
+
+    // consecutive samples are the same pass of the route
+    // so we return the closest one for each pass
+    int best = -1, prev = -2;
+    double bestd = 0;
+    foreach(int i, found) {
+
+        double ey = points[i].lat - lat;
+        double ex = points[i].lon - lng;
+        if (fabs(ey) > dlat || fabs(ex) > dlon) continue;
+
+        if (i != prev+1 && best >= 0) {
+            list << points[best].index;
+            best = -1;
+        }
+
+        ex *= coslat;
+        double distance = ex*ex + ey*ey;
+        if (best < 0 || distance < bestd) {
+            best = i;
+            bestd = distance;
+        }
+        prev = i;
+    }
+    if (best >= 0) list << points[best].index;
+
+    return list;
+}
+
 // quick diag, used to debug code only
 void MapWebBridge::call(int count)
 {
@@ -1217,16 +1430,21 @@ MapWebBridge::getLatLons(int i)
     return latlons;
 }
 
-// once the basic map and route have been marked, overlay markers, shaded areas etc
+// the route simplified for the zoom level, with shading
+QVariantMap
+MapWebBridge::getRoute(int zoom)
+{
+    return mw->mapRoute().geometry(zoom);
+}
+
+// once the basic map and route have been marked, overlay markers etc
 void
 MapWebBridge::drawOverlays()
 {
-    // overlay the markers
+    // overlay the markers, the shaded route
+    // is drawn along with the route itself
     mw->createMarkers();
 
-    // overlay a shaded route
-    if (mw->getStyleOptions() == "") mw->drawShadedRoute();
-
     // Get the latest new selection lap number.
     RideItem *rideItem = mw->property("ride").value<RideItem*>();
     if (rideItem)
@@ -1290,23 +1508,13 @@ MapWebBridge::searchPoint(double lat, double lng)
 {
     QList<RideFilePoint*> list;
 
+    // resolve through the ride as it is now
     RideItem *rideItem = mw->property("ride").value<RideItem*>();
+    if (!rideItem || !rideItem->ride()) return list;
 
-    RideFilePoint *candidat = NULL;
-    foreach (RideFilePoint *p1, rideItem->ride()->dataPoints()) {
-        if (p1->lat == 0 && p1->lon == 0)
-            continue;
-
-        if (((p1->lat-lat> 0 && p1->lat-lat< 0.0001) || (p1->lat-lat< 0 && p1->lat-lat> -0.0001)) &&
-            ((p1->lon-lng> 0 && p1->lon-lng< 0.0001) || (p1->lon-lng< 0 && p1->lon-lng> -0.0001))) {
-            // Verifie distance avec dernier candidat
-            candidat = p1;
-        } else if (candidat)  {
-            list.append(candidat);
-            candidat = NULL;
-        }
-    }
-
+    const QVector<RideFilePoint*> &points = rideItem->ride()->dataPoints();
+    foreach(int index, mw->mapRoute().search(lat, lng))
+        if (index < points.count()) list << points[index];
     return list;
 }
 
@@ -24,6 +24,9 @@
 
 #include <QWidget>
 #include <QDialog>
+#include <QHash>
+#include <QMap>
+#include <QVariant>
 
 #include <string>
 #include <iostream>
@@ -54,6 +57,49 @@ class mapWebPage : public QWebEnginePage
 {
 };
 
+// The GPS track shown on the map. It is simplified to the zoom level
+// being shown before it is sent to the page and has a spatial index
+// so hover and click can find samples without scanning the ride. It
+// keeps its own copy of the positions and refers to samples by their
+// index in the ride, since the ride's points can be freed when it is
+// edited or closed.
+class RideMapRoute
+{
+    public:
+        RideMapRoute() : coslat(1.0), zoom(0) {}
+
+        // the gps samples, by index in the ride's dataPoints(), split into segments
+        // from starts[i] to starts[i+1] that are shaded with colors[i], no colors
+        // means no shading
+        void setRide(const RideFile *ride, QVector<int> samples, QVector<int> starts, QStringList colors);
+
+        // route simplified to half a pixel at this zoom level, the lat/lons
+        // are base64 little endian float32 offsets from the first sample
+        QVariantMap geometry(int zoom);
+
+        // index of the nearest sample on each pass of the route within a
+        // few pixels of lat, lng at the last zoom level drawn, in time order
+        QList<int> search(double lat, double lng) const;
+
+    private:
+        qint64 cell(double lat, double lon) const;
+        void simplify(int from, int to, double tolerance, QVector<bool> &keep) const;
+
+        struct Sample {
+            double lat, lon;
+            int index; // in the ride's dataPoints()
+        };
+        QVector<Sample> points;
+        QVector<int> starts;
+        QStringList colors;
+        double coslat; // scales longitude for distances
+
+        QHash<qint64, QVector<int> > grid; // point indexes by grid cell
+
+        int zoom; // last zoom drawn
+        QMap<int, QVariantMap> simplified;
+};
+
 class MapWebBridge : public QObject
 {
     Q_OBJECT
@@ -78,6 +124,7 @@ class MapWebBridge : public QObject
         // drawing basic route, and interval polylines
         Q_INVOKABLE int intervalCount();
         Q_INVOKABLE QVariantList getLatLons(int i); // get array of latitudes for highlighted n
+        Q_INVOKABLE QVariantMap getRoute(int zoom); // simplified and shaded route
 
         // once map and basic route is loaded
         // this slot is called to draw additional
@@ -149,6 +196,8 @@ class RideMapWindow : public GcChartWindow
         QString googleKey() const { return gkey->text(); }
         void setGoogleKey(QString x) { gkey->setText(x); }
 
+        RideMapRoute &mapRoute() { return route; }
+
 
     public slots:
         void mapTypeSelected(int x);
@@ -162,7 +211,6 @@ class RideMapWindow : public GcChartWindow
         void forceReplot();
         void rideSelected();
         void createMarkers();
-        void drawShadedRoute();
         void zoomInterval(IntervalItem*);
         void configChanged(qint32);
 
@@ -201,6 +249,10 @@ class RideMapWindow : public GcChartWindow
         QColor GetColor(int watts);
         void createHtml();
 
+        // the route and its shading
+        RideMapRoute route;
+        void createRoute();
+
     private slots:
         void loadRide();
         void updateFrame();
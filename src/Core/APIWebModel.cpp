@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "APIWebModel.h"
+
+#include "Settings.h"
+#include "RideItem.h"
+#include "IntervalItem.h"
+#include "RideFileCache.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QMutexLocker>
+
+// converted activities and rendered responses kept per athlete
+static const int MAXACTIVITIES = 16;
+static const int MAXRESPONSES = 32;
+
+//
+// Athlete data
+//
+APIAthleteData::APIAthleteData(QDir home, QString name) : name(name), home(home)
+{
+    QString athlete = home.absolutePath() + "/" + name;
+
+    // the ride cache
+    APIWebModel::readRideDB(athlete + "/cache/rideDB.json", athlete + "/activities", rides);
+
+    // activity files for the fast listing, same checks as before
+    QDir dir(athlete + "/activities");
+    foreach(QString file, dir.entryList(QStringList() << "*", QDir::Files, QDir::Name)) {
+
+        QDateTime dateTime;
+        if (!RideFile::parseRideFileName(file, &dateTime)) continue;
+        if (file.endsWith(".bak")) continue;
+
+        activities.insert(file, dateTime);
+    }
+
+    // anything the responses are built from, the activity files
+    // themselves are checked by crc when they are asked for
+    QFileInfo rideDB(athlete + "/cache/rideDB.json");
+    modified = rideDB.lastModified();
+    foreach(QString path, QStringList() << "/cache" << "/activities" << "/config") {
+        QDateTime changed = QFileInfo(athlete + path).lastModified();
+        if (changed > modified) modified = changed;
+    }
+    tag = QString("%1-%2").arg(modified.toMSecsSinceEpoch(), 0, 16).arg(rideDB.size(), 0, 16);
+}
+
+APIAthleteData::~APIAthleteData()
+{
+    // ride items don't own the intervals the parser gave them
+    foreach(RideItem *item, rides) {
+        qDeleteAll(item->intervals());
+        item->clearIntervals();
+        delete item;
+    }
+}
+
+const QHash<QString, QVector<float> > &
+APIAthleteData::meanMaxSeries(RideFile::SeriesType series)
+{
+    // called with the lock held
+    QHash<int, QHash<QString, QVector<float> > >::const_iterator it = meanmax.find(series);
+    if (it != meanmax.end()) return it.value();
+
+    QHash<QString, QVector<float> > &values = meanmax[series];
+
+    // read every cpx file once for this series
+    QString cacheDir = home.absolutePath() + "/" + name + "/cache";
+    foreach(QString cacheFilename, QDir(cacheDir).entryList(QDir::Files)) {
+
+        if (!cacheFilename.endsWith(".cpx")) continue;
+
+        QVector<float> current = RideFileCache::meanMaxFor(cacheDir + "/" + cacheFilename, series);
+        if (current.isEmpty()) continue;
+        values.insert(cacheFilename, current);
+
+        if (!cpxDates.contains(cacheFilename)) {
+            QDateTime dt;
+            if (RideFile::parseRideFileName(cacheFilename, &dt)) cpxDates.insert(cacheFilename, dt.date());
+            else cpxDates.insert(cacheFilename, QDate());
+        }
+    }
+    return values;
+}
+
+QVector<float>
+APIAthleteData::meanMax(QString filename, RideFile::SeriesType series)
+{
+    QString cacheFilename = QFileInfo(filename).completeBaseName() + ".cpx";
+
+    // already have every cpx file for this series from a bests request
+    {
+        QMutexLocker locker(&lock);
+        QHash<int, QHash<QString, QVector<float> > >::const_iterator it = meanmax.find(series);
+        if (it != meanmax.end()) return it.value().value(cacheFilename);
+    }
+
+    // otherwise just read the one file, without holding the lock
+    QString CPXfilename = home.absolutePath() + "/" + name + "/cache/" + cacheFilename;
+    if (!QFileInfo(CPXfilename).exists()) return QVector<float>();
+    return RideFileCache::meanMaxFor(CPXfilename, series);
+}
+
+QVector<float>
+APIAthleteData::bests(RideFile::SeriesType series, QDate from, QDate to)
+{
+    QMutexLocker locker(&lock);
+
+    bool first = true;
+    QVector<float> returning;
+
+    QHashIterator<QString, QVector<float> > it(meanMaxSeries(series));
+    while (it.hasNext()) {
+        it.next();
+
+        // in range?
+        QDate date = cpxDates.value(it.key());
+        if (!date.isValid() || date < from || date > to) continue;
+
+        const QVector<float> &current = it.value();
+        if (first) {
+            first = false;
+            returning = current;
+        } else {
+            if (current.size() > returning.size()) returning.resize(current.size());
+            for(int i=0; i< current.size(); i++) if (current[i] > returning[i]) returning[i]=current[i];
+        }
+    }
+    return returning;
+}
+
+QByteArray
+APIAthleteData::activity(QString filename, QString format)
+{
+    QMutexLocker locker(&lock);
+
+    QString key = filename + "/" + format;
+    for (int i=0; i<converted.count(); i++) {
+        if (converted[i].key != key) continue;
+
+        // edited in place since we converted it?
+        QFileInfo file(home.absolutePath() + "/" + name + "/activities/" + filename);
+        if (file.lastModified() != converted[i].modified) {
+            converted.removeAt(i);
+            return QByteArray();
+        }
+
+        converted.move(i, converted.count()-1);
+        return converted.last().contents;
+    }
+    return QByteArray();
+}
+
+void
+APIAthleteData::setActivity(QString filename, QString format, QByteArray contents)
+{
+    QMutexLocker locker(&lock);
+
+    QString key = filename + "/" + format;
+    for (int i=0; i<converted.count(); i++) {
+        if (converted[i].key == key) {
+            converted.removeAt(i);
+            break;
+        }
+    }
+
+    ActivityEntry add;
+    add.key = key;
+    add.modified = QFileInfo(home.absolutePath() + "/" + name + "/activities/" + filename).lastModified();
+    add.contents = contents;
+    converted.append(add);
+
+    while (converted.count() > MAXACTIVITIES) converted.removeFirst();
+}
+
+//
+// Model
+//
+APIWebModel::APIWebModel(QDir home, QObject *parent) : QObject(parent), home(home), athletesStale(true)
+{
+    watcher = new QFileSystemWatcher(this);
+    watcher->addPath(home.absolutePath());
+
+    connect(watcher, SIGNAL(directoryChanged(QString)), this, SLOT(pathChanged(QString)));
+    connect(watcher, SIGNAL(fileChanged(QString)), this, SLOT(pathChanged(QString)));
+}
+
+APIWebModel::~APIWebModel()
+{
+}
+
+QList<APIAthleteInfo>
+APIWebModel::athletes()
+{
+    QMutexLocker locker(&lock);
+    if (!athletesStale) return athletes_;
+
+    athletes_.clear();
+    foreach(QString name, home.entryList(QStringList() << "*", QDir::Dirs, QDir::Name)) {
+
+        // sure fire sign the athlete has been upgraded to post 3.2 and not some
+        // random directory full of other things & check something basic is set
+        QString ridedb = home.absolutePath() + "/" + name + "/cache/rideDB.json";
+        if (QFile(ridedb).exists() && appsettings->cvalue(name, GC_SEX, "") != "") {
+
+            APIAthleteInfo info;
+            info.name = name;
+            info.dob = appsettings->cvalue(name, GC_DOB).toDate();
+            info.weight = appsettings->cvalue(name, GC_WEIGHT).toDouble();
+            info.height = appsettings->cvalue(name, GC_HEIGHT).toDouble();
+            info.sex = appsettings->cvalue(name, GC_SEX).toInt();
+            athletes_ << info;
+        }
+    }
+    athletesStale = false;
+    return athletes_;
+}
+
+QSharedPointer<APIAthleteData>
+APIWebModel::athlete(QString name)
+{
+    int current;
+    {
+        QMutexLocker locker(&lock);
+        QSharedPointer<APIAthleteData> returning = loaded.value(name);
+        if (returning) return returning;
+        current = generation.value(name);
+    }
+
+    // unknown athlete
+    if (name == "" || name.contains("/") || name.contains("\\") ||
+        !QFile(home.absolutePath() + "/" + name + "/cache/rideDB.json").exists())
+        return QSharedPointer<APIAthleteData>();
+
+    // load without holding the lock, other athletes can still be served
+    QSharedPointer<APIAthleteData> returning(new APIAthleteData(home, name));
+
+    QMutexLocker locker(&lock);
+
+    // another request got there first
+    if (loaded.contains(name)) return loaded.value(name);
+
+    // only keep it if nothing changed on disk while we were loading
+    if (generation.value(name) == current) {
+        loaded.insert(name, returning);
+
+        // the watcher belongs to our thread
+        QMetaObject::invokeMethod(this, "watch", Qt::QueuedConnection, Q_ARG(QString, name));
+    }
+    return returning;
+}
+
+void
+APIWebModel::watch(QString name)
+{
+    QStringList paths;
+    QString athlete = home.absolutePath() + "/" + name;
+    paths << athlete + "/cache" << athlete + "/cache/rideDB.json"
+          << athlete + "/activities" << athlete + "/config";
+
+    // rideDB.json is replaced when saved, which drops it from the watcher
+    QStringList watched = watcher->files() + watcher->directories();
+    foreach(QString path, paths)
+        if (!watched.contains(path) && QFileInfo(path).exists()) watcher->addPath(path);
+}
+
+void
+APIWebModel::pathChanged(QString path)
+{
+    QMutexLocker locker(&lock);
+
+    // any change may add, remove or reconfigure an athlete
+    athletesStale = true;
+    if (path == home.absolutePath()) return;
+
+    QString name = home.relativeFilePath(path).section('/', 0, 0);
+    loaded.remove(name);
+    generation[name]++;
+}
+
+QString
+APIAthleteData::fileTag(QString filename, QDateTime &modified)
+{
+    QFileInfo file(home.absolutePath() + "/" + name + "/activities/" + filename);
+    modified = file.lastModified();
+    if (!file.exists()) return QString();
+
+    QMutexLocker locker(&lock);
+
+    QHash<QString, FileTagEntry>::const_iterator it = fileTags.find(filename);
+    if (it != fileTags.end() && it.value().modified == modified) return it.value().tag;
+
+    FileTagEntry add;
+    add.modified = modified;
+    add.tag = QString("%1-%2").arg(RideFile::computeFileCRC(file.absoluteFilePath()), 0, 16).arg(file.size(), 0, 16);
+    fileTags.insert(filename, add);
+    return add.tag;
+}
+
+bool
+APIAthleteData::response(QString key, QByteArray &contentType, QByteArray &encoding, QByteArray &body)
+{
+    QMutexLocker locker(&lock);
+
+    for (int i=0; i<responses.count(); i++) {
+        if (responses[i].key != key) continue;
+
+        responses.move(i, responses.count()-1);
+        contentType = responses.last().contentType;
+        encoding = responses.last().encoding;
+        body = responses.last().body;
+        return true;
+    }
+    return false;
+}
+
+void
+APIAthleteData::setResponse(QString key, QByteArray contentType, QByteArray encoding, QByteArray body)
+{
+    QMutexLocker locker(&lock);
+
+    for (int i=0; i<responses.count(); i++) {
+        if (responses[i].key == key) {
+            responses.removeAt(i);
+            break;
+        }
+    }
+
+    ResponseEntry add;
+    add.key = key;
+    add.contentType = contentType;
+    add.encoding = encoding;
+    add.body = body;
+    responses.append(add);
+
+    while (responses.count() > MAXRESPONSES) responses.removeFirst();
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_APIWebModel_h
+#define _GC_APIWebModel_h
+
+#include "RideFile.h"
+
+#include <QObject>
+#include <QDir>
+#include <QDate>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVector>
+
+class RideItem;
+class QFileSystemWatcher;
+
+// athlete characteristics listed at the root of the API
+struct APIAthleteInfo {
+    QString name;
+    QDate dob;
+    double weight, height;
+    int sex;
+};
+
+//
+// Everything the API serves for one athlete, loaded once from disk.
+//
+// The ride list and metrics come from cache/rideDB.json, mean max data
+// is read from the .cpx files the first time each series is asked for
+// and converted activities are kept for the most recent requests.
+//
+// Instances are shared between the connection handler threads and never
+// change once loaded (apart from the lazily filled caches which have a
+// lock of their own). When the files change the model loads a fresh one
+// and requests in flight finish with the old.
+//
+class APIAthleteData
+{
+    public:
+
+        APIAthleteData(QDir home, QString name);
+        ~APIAthleteData();
+
+        QString name;
+
+        // rides from the ride cache and the activity files on disk
+        QList<RideItem*> rides;
+        QMap<QString, QDateTime> activities;
+
+        // mean max for a single ride, or best in the date range
+        QVector<float> meanMax(QString filename, RideFile::SeriesType series);
+        QVector<float> bests(RideFile::SeriesType series, QDate from, QDate to);
+
+        // activity converted to format, empty if not cached
+        QByteArray activity(QString filename, QString format);
+        void setActivity(QString filename, QString format, QByteArray contents);
+
+        // validators for conditional requests, from the files loaded
+        QString tag;
+        QDateTime modified;
+
+        // crc of an activity file, recomputed when the file changes
+        QString fileTag(QString filename, QDateTime &modified);
+
+        // rendered responses keyed on endpoint and parameters
+        bool response(QString key, QByteArray &contentType, QByteArray &encoding, QByteArray &body);
+        void setResponse(QString key, QByteArray contentType, QByteArray encoding, QByteArray body);
+
+    private:
+
+        const QHash<QString, QVector<float> > &meanMaxSeries(RideFile::SeriesType series);
+
+        QDir home;
+
+        QMutex lock;
+
+        // series -> cpx filename -> values
+        QHash<int, QHash<QString, QVector<float> > > meanmax;
+        QHash<QString, QDate> cpxDates;
+
+        // filename/format -> contents, most recent last
+        struct ActivityEntry {
+            QString key;
+            QDateTime modified;
+            QByteArray contents;
+        };
+        QList<ActivityEntry> converted;
+
+        struct FileTagEntry {
+            QDateTime modified;
+            QString tag;
+        };
+        QHash<QString, FileTagEntry> fileTags;
+
+        // most recent last
+        struct ResponseEntry {
+            QString key;
+            QByteArray contentType, encoding, body;
+        };
+        QList<ResponseEntry> responses;
+};
+
+//
+// Resident model behind the API web service.
+//
+// In --server mode every request used to go to disk; the ride cache was
+// parsed and the .cpx files read for each call. The model loads each
+// athlete on first use and keeps it until a file system watcher sees the
+// athlete's cache, activities or config change.
+//
+class APIWebModel : public QObject
+{
+    Q_OBJECT
+
+    public:
+
+        APIWebModel(QDir home, QObject *parent=NULL);
+        ~APIWebModel();
+
+        // athletes with a ride cache, in name order
+        QList<APIAthleteInfo> athletes();
+
+        // loaded athlete data, NULL if no such athlete
+        QSharedPointer<APIAthleteData> athlete(QString name);
+
+        // parse cache/rideDB.json into rides, see RideDB.y
+        static void readRideDB(QString filename, QString path, QList<RideItem*> &rides);
+
+    private slots:
+
+        void pathChanged(QString path);
+        void watch(QString name);
+
+    private:
+
+        QDir home;
+        QFileSystemWatcher *watcher;
+
+        QMutex lock;
+        bool athletesStale;
+        QList<APIAthleteInfo> athletes_;
+        QHash<QString, QSharedPointer<APIAthleteData> > loaded;
+        QHash<QString, int> generation; // bumped when files change
+};
+
+#endif
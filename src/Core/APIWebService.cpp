@@ -33,6 +33,20 @@
 
 #include <QTemporaryFile>
 #include <QFile>
+#include <QDataStream>
+#include <QLocale>
+
+#ifdef Q_CC_MSVC
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+// RFC 7231 date format used by Last-Modified and If-Modified-Since
+static const QString HTTPDATE = "ddd, dd MMM yyyy hh:mm:ss 'GMT'";
+
+// largest response we keep a copy of
+static const int MAXCAPTURE = 1024 * 1024;
 
 void
 APIWebService::service(HttpRequest &request, HttpResponse &response)
@@ -55,9 +69,99 @@ APIWebService::service(HttpRequest &request, HttpResponse &response)
         return;
     }
 
+    // validators and cached responses for the athlete, an unknown
+    // athlete drops through to athleteData to report it
+    QSharedPointer<APIAthleteData> data = model->athlete(paths[0]);
+    QString key;
+    QByteArray body;
+    if (data) {
+
+        // the same url gives different content for different accept headers
+        QByteArray accepts = request.getHeader("Accept") + "|" + request.getHeader("Accept-Encoding");
+        QString variant = QString("%1").arg(qHash(accepts), 0, 16);
+
+        // activities are tagged by their crc, everything else
+        // by the ride cache and config the athlete was loaded from
+        QString tag;
+        QDateTime modified;
+        if (paths.count() == 3 && paths[1] == "activity") tag = data->fileTag(paths[2], modified);
+        else {
+            tag = data->tag;
+            modified = data->modified;
+        }
+
+        if (tag != "") {
+            QByteArray etag = QString("\"%1-%2\"").arg(tag).arg(variant).toLatin1();
+            response.setHeader("ETag", etag);
+            response.setHeader("Last-Modified", QLocale::c().toString(modified.toUTC(), HTTPDATE).toLatin1());
+
+            if (notModified(request, etag, modified)) {
+                response.setStatus(304, "Not Modified");
+                response.write(QByteArray(), true);
+                return;
+            }
+        }
+
+        // the bulk exports are streamed and too big to keep
+        if (!(paths.count() == 2 && (paths[1] == "columns" || paths[1] == "samples"))) {
+
+            key = fullPath + "?";
+            QMapIterator<QByteArray, QByteArray> it(request.getParameterMap());
+            while (it.hasNext()) {
+                it.next();
+                key += it.key() + "=" + it.value() + "&";
+            }
+            key += variant;
+
+            QByteArray contentType, encoding;
+            if (data->response(key, contentType, encoding, body)) {
+                response.setHeader("Content-Type", contentType);
+                if (encoding != "") response.setHeader("Content-Encoding", encoding);
+                response.write(body, true);
+                return;
+            }
+            response.setCapture(&body, MAXCAPTURE);
+        }
+    }
+
     // Call to retreive athlete data, downstream will resolve
     // which functions to call for different data requests
     athleteData(paths, request, response);
+
+    // keep successful responses for next time
+    if (key != "") {
+        if (!response.hasSentLastPart()) response.flush();
+        if (response.getStatus() == 200 && response.captured())
+            data->setResponse(key, response.getHeaders().value("Content-Type"),
+                              response.getHeaders().value("Content-Encoding"), body);
+    }
+}
+
+bool
+APIWebService::notModified(HttpRequest &request, QByteArray etag, QDateTime modified)
+{
+    // If-None-Match wins when both are sent
+    QByteArray match = request.getHeader("If-None-Match");
+    if (match != "") {
+        foreach(QByteArray candidate, match.split(',')) {
+            candidate = candidate.trimmed();
+            if (candidate.startsWith("W/")) candidate = candidate.mid(2);
+            if (candidate == etag || candidate == "*") return true;
+        }
+        return false;
+    }
+
+    QByteArray since = request.getHeader("If-Modified-Since");
+    if (since != "") {
+        QDateTime when = QLocale::c().toDateTime(QString(since), HTTPDATE);
+        when.setTimeSpec(Qt::UTC);
+
+        // http dates have no milliseconds
+        QDateTime changed = modified.toUTC();
+        changed.setTime(QTime(changed.time().hour(), changed.time().minute(), changed.time().second()));
+        if (when.isValid() && changed <= when) return true;
+    }
+    return false;
 }
 
 void
@@ -72,8 +176,7 @@ APIWebService::athleteData(QStringList &paths, HttpRequest &request, HttpRespons
         response.write("missing athlete.");
         return;
     } else {
-        QFile ridedb(home.absolutePath() + "/" + paths[0] + "/cache/rideDB.json");
-        if (!ridedb.exists()) {
+        if (!model->athlete(paths[0])) {
             response.setStatus(404); // malformed URL
             response.setHeader("Content-Type", "text; charset=ISO-8859-1");
             response.write("unknown athlete " + paths[0].toLocal8Bit());
@@ -108,6 +211,26 @@ APIWebService::athleteData(QStringList &paths, HttpRequest &request, HttpRespons
             return;
         }
 
+        // GET METRICS AS COLUMNS
+        // http://localhost:12021/athlete/columns
+        // optional query parameters:
+        //      ?since=yyyy/MM/dd&before=yyyy/MM/dd
+        //      ?metrics=<list>     comma separated, as for the ride list
+        if (paths[0] == "columns") {
+            listColumns(athlete, request, response);
+            return;
+        }
+
+        // GET SAMPLES AS COLUMNS, ONE BLOCK PER ACTIVITY
+        // http://localhost:12021/athlete/samples
+        // optional query parameters:
+        //      ?since=yyyy/MM/dd&before=yyyy/MM/dd
+        //      ?series=<list>      comma separated e.g. SECS,POWER,HEARTRATE
+        if (paths[0] == "samples") {
+            listSamples(athlete, request, response);
+            return;
+        }
+
     } else if (paths.count() == 3) {
 
         QString athlete = paths[0];
@@ -164,29 +287,18 @@ APIWebService::listAthletes(HttpRequest &, HttpResponse &response)
 {
     response.setHeader("Content-Type", "text; charset=ISO-8859-1");
 
-    // This will read the user preferences and change the file list order as necessary:
-    QFlags<QDir::Filter> spec = QDir::Dirs;
-    QStringList names;
-    names << "*"; // anything
-
     response.write("name,dob,weight,height,sex\n");
-    foreach(QString name, home.entryList(names, spec, QDir::Name)) {
-
-        // sure fire sign the athlete has been upgraded to post 3.2 and not some
-        // random directory full of other things & check something basic is set
-        QString ridedb = home.absolutePath() + "/" + name + "/cache/rideDB.json";
-        if (QFile(ridedb).exists() && appsettings->cvalue(name, GC_SEX, "") != "") {
-            // we got one
-            QString line = name;
-            line += ", " + appsettings->cvalue(name, GC_DOB).toDate().toString("yyyy/MM/dd");
-            line += ", " + QString("%1").arg(appsettings->cvalue(name, GC_WEIGHT).toDouble());
-            line += ", " + QString("%1").arg(appsettings->cvalue(name, GC_HEIGHT).toDouble());
-            line += (appsettings->cvalue(name, GC_SEX).toInt() == 0) ? ", Male" : ", Female";
-            line += "\n";
-
-            // out a line
-            response.write(line.toLocal8Bit());
-        }
+    foreach(APIAthleteInfo info, model->athletes()) {
+
+        QString line = info.name;
+        line += ", " + info.dob.toString("yyyy/MM/dd");
+        line += ", " + QString("%1").arg(info.weight);
+        line += ", " + QString("%1").arg(info.height);
+        line += (info.sex == 0) ? ", Male" : ", Female";
+        line += "\n";
+
+        // out a line
+        response.write(line.toLocal8Bit());
     }
 }
 
@@ -352,6 +464,16 @@ APIWebService::listActivity(QString athlete, QStringList paths, HttpRequest &req
             if (format == "pwx") response.setHeader("Content-Type", "application/vnd.trainingpeaks.pwx+xml; charset=ISO-8859-1");
         }
 
+        // converted recently?
+        QSharedPointer<APIAthleteData> data = model->athlete(athlete);
+        if (data) {
+            QByteArray converted = data->activity(paths[0], format);
+            if (!converted.isEmpty()) {
+                response.write(converted, true);
+                return;
+            }
+        }
+
         // lets read the file in as a ridefile
         QStringList errors;
         RideFile *f = RideFileFactory::instance().openRideFile(NULL, file, errors);
@@ -396,7 +518,9 @@ APIWebService::listActivity(QString athlete, QStringList paths, HttpRequest &req
             out.close();
 
             // write back in one hit
-            response.write(contents.toLocal8Bit(), true);
+            QByteArray converted = contents.toLocal8Bit();
+            if (data) data->setActivity(paths[0], format, converted);
+            response.write(converted, true);
             return;
 
         } else {
@@ -444,6 +568,14 @@ APIWebService::listMMP(QString athlete, QStringList paths, HttpRequest &request,
 
     QString filename=paths[0];
 
+    // mean max arrays are read from the cpx files once
+    QSharedPointer<APIAthleteData> data = model->athlete(athlete);
+    if (!data) {
+        response.setStatus(404);
+        response.write("unknown athlete.\n");
+        return;
+    }
+
     if (paths[0] == "bests") {
 
         // header
@@ -462,26 +594,22 @@ APIWebService::listMMP(QString athlete, QStringList paths, HttpRequest &request,
         if (beforep != "") before = QDate::fromString(beforep,"yyyy/MM/dd");
 
         int secs=0;
-        foreach(float value, RideFileCache::meanMaxFor(home.absolutePath() + "/" + athlete + "/cache", series, since, before)) {
+        foreach(float value, data->bests(series, since, before)) {
             if (secs >0) response.bwrite(QString("%1, %2\n").arg(secs).arg(value).toLocal8Bit());
             secs++;
         }
 
 
     } else {
-        QString CPXfilename = home.absolutePath() + "/" + athlete + "/cache/" + QFileInfo(filename).completeBaseName() + ".cpx";
-
         // header
         response.bwrite("secs, ");
         response.bwrite(seriesp.toLocal8Bit());
         response.bwrite("\n");
 
-        if (QFileInfo(CPXfilename).exists()) {
-            int secs=0;
-            foreach(float value, RideFileCache::meanMaxFor(CPXfilename, series)) {
-                if (secs >0) response.bwrite(QString("%1, %2\n").arg(secs).arg(value).toLocal8Bit());
-                secs++;
-            }
+        int secs=0;
+        foreach(float value, data->meanMax(filename, series)) {
+            if (secs >0) response.bwrite(QString("%1, %2\n").arg(secs).arg(value).toLocal8Bit());
+            secs++;
         }
         response.flush();
     }
@@ -686,3 +814,298 @@ APIWebService::listMeasures(QString athlete, QStringList paths, HttpRequest &req
     response.write("\n");
 
 }
+
+//
+// Columnar export
+//
+// The columns and samples endpoints return little endian binary so analytics
+// jobs can read whole columns straight into arrays rather than parse text.
+//
+//  stream  := "GCCOLS01" block* end
+//  block   := uint32 rows, uint32 columns, string label,
+//             column-header{columns}, column-data{columns}
+//  header  := string name, uint8 type (0=float64, 1=int64, 2=string)
+//  data    := uint32 bytes, then rows float64 / int64 / string values
+//  string  := uint32 bytes, utf-8
+//  end     := uint32 0, uint32 0
+//
+// The response is sent with chunked transfer encoding, a block at a time,
+// and gzip or deflate compressed when the client says it accepts them.
+//
+static const int STREAMCHUNK = 64 * 1024;
+
+class APIColumnStream
+{
+    public:
+
+        enum { Float=0, Integer=1, Text=2 };
+
+        APIColumnStream(HttpRequest &request, HttpResponse &response) : response(response), compressed(false) {
+
+            response.setHeader("Content-Type", "application/vnd.goldencheetah.columns");
+
+            // gzip preferred, both are zlib with different windowBits
+            QByteArray accepts = request.getHeader("Accept-Encoding");
+            int windowBits = 0;
+            if (accepts.contains("gzip")) {
+                response.setHeader("Content-Encoding", "gzip");
+                windowBits = 15 + 16;
+            } else if (accepts.contains("deflate")) {
+                response.setHeader("Content-Encoding", "deflate");
+                windowBits = 15;
+            }
+
+            if (windowBits) {
+                strm.zalloc = Z_NULL;
+                strm.zfree = Z_NULL;
+                strm.opaque = Z_NULL;
+                compressed = deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+            }
+
+            write("GCCOLS01");
+        }
+
+        ~APIColumnStream() {
+            if (compressed) deflateEnd(&strm);
+        }
+
+        // a block of columns, all the same length
+        void block(QString label, int rows, const QList<QString> &names, const QList<int> &types, const QList<QByteArray> &data) {
+
+            QByteArray head;
+            QDataStream out(&head, QIODevice::WriteOnly);
+            out.setByteOrder(QDataStream::LittleEndian);
+
+            out << quint32(rows) << quint32(names.count());
+            string(out, label);
+            for (int i=0; i<names.count(); i++) {
+                string(out, names[i]);
+                out << quint8(types[i]);
+            }
+            write(head);
+
+            for (int i=0; i<data.count(); i++) {
+                QByteArray length;
+                QDataStream len(&length, QIODevice::WriteOnly);
+                len.setByteOrder(QDataStream::LittleEndian);
+                len << quint32(data[i].size());
+                write(length);
+                write(data[i]);
+            }
+        }
+
+        void finish() {
+            QByteArray end;
+            QDataStream out(&end, QIODevice::WriteOnly);
+            out.setByteOrder(QDataStream::LittleEndian);
+            out << quint32(0) << quint32(0);
+            write(end);
+            flush(true);
+        }
+
+        static void string(QDataStream &out, QString text) {
+            QByteArray utf8 = text.toUtf8();
+            out << quint32(utf8.size());
+            out.writeRawData(utf8.constData(), utf8.size());
+        }
+
+    private:
+
+        void write(const QByteArray &data) {
+            buffer.append(data);
+            if (buffer.size() >= STREAMCHUNK) flush(false);
+        }
+
+        // send what we have as a chunk, the last one ends the response
+        void flush(bool last) {
+
+            if (!compressed) {
+                response.write(buffer, last);
+                buffer.clear();
+                return;
+            }
+
+            QByteArray out;
+            char chunk[STREAMCHUNK];
+
+            strm.avail_in = buffer.size();
+            strm.next_in = (Bytef *)buffer.data();
+            do {
+                strm.avail_out = sizeof(chunk);
+                strm.next_out = (Bytef *)chunk;
+                deflate(&strm, last ? Z_FINISH : Z_NO_FLUSH);
+                out.append(chunk, sizeof(chunk) - strm.avail_out);
+            } while (strm.avail_out == 0);
+            buffer.clear();
+
+            if (out.size() || last) response.write(out, last);
+        }
+
+        HttpResponse &response;
+        QByteArray buffer;
+        bool compressed;
+        z_stream strm;
+};
+
+// rides in the date range given by since and before
+static QList<RideItem*> ridesInRange(QSharedPointer<APIAthleteData> data, HttpRequest &request)
+{
+    // honour the since parameter
+    QString sincep(request.getParameter("since"));
+    QDate since(1900,01,01);
+    if (sincep != "") since = QDate::fromString(sincep,"yyyy/MM/dd");
+
+    // before parameter
+    QString beforep(request.getParameter("before"));
+    QDate before(3000,01,01);
+    if (beforep != "") before = QDate::fromString(beforep,"yyyy/MM/dd");
+
+    QList<RideItem*> returning;
+    foreach(RideItem *item, data->rides)
+        if (item->dateTime.date() >= since && item->dateTime.date() <= before) returning << item;
+    return returning;
+}
+
+// rides per block for the metrics columns
+static const int COLUMNROWS = 1024;
+
+void
+APIWebService::listColumns(QString athlete, HttpRequest &request, HttpResponse &response)
+{
+    QSharedPointer<APIAthleteData> data = model->athlete(athlete);
+    if (!data) {
+        response.setStatus(404);
+        response.write("unknown athlete.\n");
+        return;
+    }
+
+    // which metrics, names are underscored as in the ride list
+    const RideMetricFactory &factory = RideMetricFactory::instance();
+    QStringList wantedNames;
+    QString metrics(request.getParameter("metrics"));
+    if (metrics != "") wantedNames = metrics.split(",");
+
+    QList<int> wanted;
+    QList<QString> names;
+    QList<int> types;
+    names << "date" << "time" << "filename";
+    types << APIColumnStream::Integer << APIColumnStream::Integer << APIColumnStream::Text;
+
+    foreach(QString name, factory.allMetrics()) {
+        const RideMetric *m = factory.rideMetric(name);
+        QString underscored = m->name().replace(" ","_");
+        if (wantedNames.count() && !wantedNames.contains(underscored) && !wantedNames.contains(m->symbol())) continue;
+
+        wanted << m->index();
+        names << m->symbol();
+        types << APIColumnStream::Float;
+    }
+
+    QList<RideItem*> rides = ridesInRange(data, request);
+    APIColumnStream stream(request, response);
+
+    for (int from=0; from < rides.count(); from += COLUMNROWS) {
+
+        int rows = qMin(COLUMNROWS, rides.count() - from);
+
+        // date as yyyyMMdd and time as seconds since midnight
+        QList<QByteArray> columns;
+        QByteArray dates, times, files;
+        QDataStream d(&dates, QIODevice::WriteOnly), t(&times, QIODevice::WriteOnly), f(&files, QIODevice::WriteOnly);
+        d.setByteOrder(QDataStream::LittleEndian);
+        t.setByteOrder(QDataStream::LittleEndian);
+        f.setByteOrder(QDataStream::LittleEndian);
+
+        for (int r=0; r<rows; r++) {
+            RideItem *item = rides[from + r];
+            QDate date = item->dateTime.date();
+            d << qint64(date.year() * 10000 + date.month() * 100 + date.day());
+            t << qint64(QTime(0,0,0).secsTo(item->dateTime.time()));
+            APIColumnStream::string(f, item->fileName);
+        }
+        columns << dates << times << files;
+
+        // metrics
+        foreach(int index, wanted) {
+            QByteArray values;
+            values.reserve(rows * int(sizeof(double)));
+            QDataStream v(&values, QIODevice::WriteOnly);
+            v.setByteOrder(QDataStream::LittleEndian);
+            for (int r=0; r<rows; r++) v << rides[from + r]->metrics().value(index, 0.0);
+            columns << values;
+        }
+
+        stream.block("metrics", rows, names, types, columns);
+    }
+    stream.finish();
+}
+
+void
+APIWebService::listSamples(QString athlete, HttpRequest &request, HttpResponse &response)
+{
+    QSharedPointer<APIAthleteData> data = model->athlete(athlete);
+    if (!data) {
+        response.setStatus(404);
+        response.write("unknown athlete.\n");
+        return;
+    }
+
+    // which series, by default all that are present in each ride
+    QList<RideFile::SeriesType> wanted;
+    QString seriesp(request.getParameter("series"));
+    if (seriesp != "") {
+        foreach(QString symbol, seriesp.split(",")) {
+            RideFile::SeriesType series = RideFile::seriesForSymbol(symbol);
+            if (series == RideFile::none) {
+                response.setStatus(500);
+                response.write("unknown series requested: ");
+                response.write(symbol.toLocal8Bit());
+                response.write("\n");
+                return;
+            }
+            wanted << series;
+        }
+    }
+
+    QList<RideItem*> rides = ridesInRange(data, request);
+    APIColumnStream stream(request, response);
+
+    // one ride in memory at a time
+    foreach(RideItem *item, rides) {
+
+        QFile file(home.absolutePath() + "/" + athlete + "/activities/" + item->fileName);
+        QStringList errors;
+        RideFile *ride = RideFileFactory::instance().openRideFile(NULL, file, errors);
+        if (ride == NULL) continue;
+
+        QList<RideFile::SeriesType> series = wanted;
+        if (series.isEmpty()) {
+            foreach(QString symbol, RideFile::symbols()) {
+                RideFile::SeriesType s = RideFile::seriesForSymbol(symbol);
+                if (s == RideFile::index || s == RideFile::wbal) continue;
+                if (s == RideFile::secs || ride->isDataPresent(s)) series << s;
+            }
+        }
+
+        int rows = ride->dataPoints().count();
+        QList<QString> names;
+        QList<int> types;
+        QList<QByteArray> columns;
+
+        foreach(RideFile::SeriesType s, series) {
+            QByteArray values;
+            values.reserve(rows * int(sizeof(double)));
+            QDataStream v(&values, QIODevice::WriteOnly);
+            v.setByteOrder(QDataStream::LittleEndian);
+            for (int r=0; r<rows; r++) v << ride->getPointValue(r, s);
+
+            names << RideFile::symbolForSeries(s);
+            types << APIColumnStream::Float;
+            columns << values;
+        }
+
+        stream.block(item->fileName, rows, names, types, columns);
+        delete ride;
+    }
+    stream.finish();
+}
@@ -22,6 +22,7 @@
 #include "httprequesthandler.h"
 #include "RideItem.h"
 #include "RideMetadata.h"
+#include "APIWebModel.h"
 #include <QDir>
 
 struct listRideSettings {
@@ -36,8 +37,9 @@ class APIWebService : public HttpRequestHandler
 
     public:
 
-        // nothing to do in constructor
-        APIWebService(QDir home, QObject *parent=NULL) : HttpRequestHandler(parent), home(home) {}
+        // athlete data is loaded on demand by the model
+        APIWebService(QDir home, QObject *parent=NULL) : HttpRequestHandler(parent), home(home),
+                                                         model(new APIWebModel(home, this)) {}
 
         // request despatchers
         void service(HttpRequest &request, HttpResponse &response);
@@ -51,11 +53,17 @@ class APIWebService : public HttpRequestHandler
         void listZones(QString athlete, QStringList paths, HttpRequest &request, HttpResponse &response);
         void listMeasures(QString athlete, QStringList paths, HttpRequest &request, HttpResponse &response);
 
+        // Bulk columnar export (see APIWebService.cpp for the format)
+        void listColumns(QString athlete, HttpRequest &request, HttpResponse &response);
+        void listSamples(QString athlete, HttpRequest &request, HttpResponse &response);
+
         // utility
         void writeRideLine(RideItem &item, HttpRequest *request, HttpResponse *response);
+        bool notModified(HttpRequest &request, QByteArray etag, QDateTime modified);
 
     private:
         QDir home;
+        APIWebModel *model;
 };
 
 #endif
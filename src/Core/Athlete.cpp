@@ -56,6 +56,14 @@
 #include "GcUpgrade.h" // upgrade wizard
 #include "GcCrashDialog.h" // recovering from a crash?
 
+// problems reading zones, in batch mode there is no window to show them
+static void zonesMessage(Context *context, bool critical, QString title, QString text)
+{
+    if (!context->mainWindow) fprintf(stdout, "%s: %s\n", title.toLocal8Bit().constData(), text.toLocal8Bit().constData());
+    else if (critical) QMessageBox::critical(context->mainWindow, title, text);
+    else QMessageBox::warning(context->mainWindow, title, text);
+}
+
 Athlete::Athlete(Context *context, const QDir &homeDir)
 {
     // athlete name / structured directory
@@ -105,9 +113,9 @@ Athlete::Athlete(Context *context, const QDir &homeDir)
         QFile zonesFile(home->config().canonicalPath() + "/" + zones_[i]->fileName());
         if (zonesFile.exists()) {
             if (!zones_[i]->read(zonesFile)) {
-                QMessageBox::critical(context->mainWindow, tr("Zones File %1 Error").arg(zones_[i]->fileName()), zones_[i]->errorString());
+                zonesMessage(context, true, tr("Zones File %1 Error").arg(zones_[i]->fileName()), zones_[i]->errorString());
             } else if (! zones_[i]->warningString().isEmpty()) {
-                QMessageBox::warning(context->mainWindow, tr("Reading Zones File %1").arg(zones_[i]->fileName()), zones_[i]->warningString());
+                zonesMessage(context, false, tr("Reading Zones File %1").arg(zones_[i]->fileName()), zones_[i]->warningString());
             }
         }
         if (i == 1 && zones_[i]->getRangeSize() == 0) { // No running Power zones
@@ -124,9 +132,9 @@ Athlete::Athlete(Context *context, const QDir &homeDir)
         QFile hrzonesFile(home->config().canonicalPath() + "/" + hrzones_[i]->fileName());
         if (hrzonesFile.exists()) {
             if (!hrzones_[i]->read(hrzonesFile)) {
-                QMessageBox::critical(context->mainWindow, tr("HR Zones File %1 Error").arg(hrzones_[i]->fileName()), hrzones_[i]->errorString());
+                zonesMessage(context, true, tr("HR Zones File %1 Error").arg(hrzones_[i]->fileName()), hrzones_[i]->errorString());
             } else if (! hrzones_[i]->warningString().isEmpty()) {
-                QMessageBox::warning(context->mainWindow, tr("Reading HR Zones File %1").arg(hrzones_[i]->fileName()), hrzones_[i]->warningString());
+                zonesMessage(context, false, tr("Reading HR Zones File %1").arg(hrzones_[i]->fileName()), hrzones_[i]->warningString());
             }
         }
         if (i == 1 && hrzones_[i]->getRangeSize() == 0) { // No running HR zones
@@ -143,7 +151,7 @@ Athlete::Athlete(Context *context, const QDir &homeDir)
         QFile pacezonesFile(home->config().canonicalPath() + "/" + pacezones_[i]->fileName());
         if (pacezonesFile.exists()) {
             if (!pacezones_[i]->read(pacezonesFile)) {
-                QMessageBox::critical(context->mainWindow, tr("Pace Zones File %1 Error").arg(pacezones_[i]->fileName()), pacezones_[i]->errorString());
+                zonesMessage(context, true, tr("Pace Zones File %1 Error").arg(pacezones_[i]->fileName()), pacezones_[i]->errorString());
             }
         }
     }
@@ -207,10 +215,13 @@ Athlete::close()
     appsettings->setCValue(context->athlete->home->root().dirName(), GC_VERSION_USED, VERSION_LATEST);
     appsettings->setCValue(context->athlete->home->root().dirName(), GC_SAFEEXIT, true);
 
-    // run autobackup on close (if configured)
-    AthleteBackup *backup = new AthleteBackup(context->athlete->home->root());
-    backup->backupOnClose();
-    delete backup;
+    // run autobackup on close (if configured), it can ask the
+    // user so not when there is no window (--batch)
+    if (context->mainWindow) {
+        AthleteBackup *backup = new AthleteBackup(context->athlete->home->root());
+        backup->backupOnClose();
+        delete backup;
+    }
 
 }
 void
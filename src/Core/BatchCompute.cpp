@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "BatchCompute.h"
+#include "Context.h"
+#include "Athlete.h"
+#include "RideCache.h"
+#include "RideItem.h"
+#include "DataProcessor.h"
+#include "Settings.h"
+#include "Trace.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QTimer>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QFile>
+
+#include <stdio.h>
+
+// all batch output goes to stdout, stderr is redirected to goldencheetah.log
+static void report(QString text)
+{
+    fprintf(stdout, "%s\n", text.toLocal8Bit().constData());
+    fflush(stdout);
+}
+
+BatchCompute::BatchCompute() : rebuild(false), cpx(false), threads(0)
+{
+}
+
+bool
+BatchCompute::isOption(QString arg)
+{
+    return arg == "--refresh" || arg == "--rebuild" || arg == "--cpx" ||
+           arg.startsWith("--process=") || arg.startsWith("--export=") || arg.startsWith("--threads=");
+}
+
+void
+BatchCompute::usage()
+{
+    fprintf(stderr, "--batch             to compute without a display and exit, with the options:\n");
+    fprintf(stderr, "    --refresh           refresh stale metrics and cpx files (the default)\n");
+    fprintf(stderr, "    --rebuild           recompute metrics for every activity, e.g. after a zone change\n");
+    fprintf(stderr, "    --cpx               regenerate the cpx (mean max) cache files too\n");
+    fprintf(stderr, "    --process=name      run a data processor over every activity, may be repeated\n");
+    fprintf(stderr, "    --export=file       export metrics to a .csv or rideDB format .json file\n");
+    fprintf(stderr, "    --threads=n         number of activities computed at once (default one per core)\n");
+    fprintf(stderr, "    exits 0 when done, 1 bad options, 2 athlete not found, 3 unknown processor, 4 export failed,\n");
+    fprintf(stderr, "    5 some activities could not be processed\n");
+}
+
+bool
+BatchCompute::parse(QStringList options)
+{
+    foreach(QString option, options) {
+
+        QString value = option.mid(option.indexOf('=')+1);
+
+        if (option == "--refresh") {
+            // the default, but nice to say so in a crontab
+        } else if (option == "--rebuild") {
+            rebuild = true;
+        } else if (option == "--cpx") {
+            cpx = true;
+        } else if (option.startsWith("--process=")) {
+            if (value == "") {
+                fprintf(stderr, "--process needs a data processor name\n");
+                return false;
+            }
+            processors << value;
+        } else if (option.startsWith("--export=")) {
+            QString suffix = QFileInfo(value).suffix().toLower();
+            if (suffix != "csv" && suffix != "json") {
+                fprintf(stderr, "--export file must be .csv or .json\n");
+                return false;
+            }
+            exportFile = value;
+        } else if (option.startsWith("--threads=")) {
+            bool ok;
+            threads = value.toInt(&ok);
+            if (!ok || threads < 1) {
+                fprintf(stderr, "--threads must be 1 or more\n");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void
+BatchCompute::wait(Context *context, QString what)
+{
+    RideCache *cache = context->athlete->rideCache;
+
+    // progress comes back via signals so we need an event loop running
+    int reported = -1;
+    while (cache->isRunning()) {
+        QEventLoop loop;
+        QTimer::singleShot(250, &loop, SLOT(quit()));
+        loop.exec();
+
+        int step = int(cache->progress()) / 10;
+        if (cache->isRunning() && step > reported) {
+            report(QString("%1: %2%").arg(what).arg(step * 10));
+            reported = step;
+        }
+    }
+
+    // deliver the finished notifications, e.g. garbage collection
+    QCoreApplication::processEvents();
+}
+
+int
+BatchCompute::run(QDir home, QString athlete)
+{
+    TraceSpan span("batch", "BatchCompute::run");
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    // athlete can be a path to the athlete directory
+    QFileInfo path(athlete);
+    if (athlete.contains('/') && path.isDir()) {
+        home = path.absoluteDir();
+        athlete = path.fileName();
+    }
+
+    if (athlete == "" || !home.cd(athlete)) {
+        report(QString("athlete %1 not found in %2").arg(athlete).arg(home.absolutePath()));
+        return NoAthlete;
+    }
+
+    // the upgrade asks the user, so it must be done in the gui first
+    QDir root(home);
+    root.cdUp();
+    appsettings->initializeQSettingsAthlete(root.canonicalPath(), athlete);
+    if (!appsettings->cvalue(athlete, GC_UPGRADE_FOLDER_SUCCESS, false).toBool()) {
+        report(QString("athlete %1 needs upgrading, open it in GoldenCheetah first").arg(athlete));
+        return NoAthlete;
+    }
+
+    // check the processors before doing any work
+    QList<DataProcessor*> process;
+    QMap<QString, DataProcessor*> all = DataProcessorFactory::instance().getProcessors();
+    foreach(QString name, processors) {
+        DataProcessor *found = NULL;
+        QMapIterator<QString, DataProcessor*> i(all);
+        while (i.hasNext()) {
+            i.next();
+            if (i.key().compare(name, Qt::CaseInsensitive) == 0 ||
+                i.value()->name().compare(name, Qt::CaseInsensitive) == 0) {
+                found = i.value();
+                break;
+            }
+        }
+        if (!found) {
+            report(QString("unknown data processor %1, one of: %2").arg(name).arg(QStringList(all.keys()).join(", ")));
+            return NoProcessor;
+        }
+        process << found;
+    }
+
+    if (threads) QThreadPool::globalInstance()->setMaxThreadCount(threads);
+    report(QString("athlete %1, %2 threads").arg(athlete).arg(QThreadPool::globalInstance()->maxThreadCount()));
+
+    // open without a window, the ride cache starts refreshing stale activities
+    Context *context = new Context(NULL);
+    context->athlete = new Athlete(context, home);
+    RideCache *cache = context->athlete->rideCache;
+
+    if (rebuild || cpx) {
+
+        // start again with everything stale
+        cache->cancel();
+        foreach(RideItem *item, cache->rides()) {
+            item->isstale = true;
+            if (cpx) {
+                QString cpxfile = QString("%1%2/%3.cpx").arg(context->athlete->home->cache().canonicalPath())
+                                                        .arg(item->planned ? "/planned" : "")
+                                                        .arg(QFileInfo(item->fileName).baseName());
+                QFile::remove(cpxfile);
+            }
+        }
+        cache->refresh();
+    }
+    wait(context, "refresh");
+    report(QString("refresh: done, %1 activities").arg(cache->count()));
+
+    // processors save the activities they change and refresh them
+    int returning = Ok;
+    if (process.count()) {
+        QStringList names;
+        foreach(DataProcessor *processor, process) names << processor->name();
+        report(QString("process: %1").arg(names.join(", ")));
+
+        QList<RideItem*> rides;
+        QStringList failed;
+        foreach(RideItem *item, cache->rides()) rides << item;
+        int changed = DataProcessorFactory::instance().batchProcess(context, rides, process,
+                                                                    QList<DataProcessorConfig*>(), "UPDATE", NULL, &failed);
+
+        wait(context, "refresh");
+        foreach(QString failure, failed) report(QString("process: %1").arg(failure));
+        report(QString("process: done, %1 activities changed, %2 problems").arg(changed).arg(failed.count()));
+        if (failed.count()) returning = ProcessFailed;
+    }
+
+    // rideDB.json
+    cache->save();
+
+    if (exportFile != "") {
+
+        // writeAsCSV would tell the user with a dialog
+        QFile file(exportFile);
+        if (!file.open(QFile::WriteOnly)) {
+            report(QString("export: cannot write to %1").arg(exportFile));
+            returning = ExportFailed;
+        } else {
+            file.close();
+            if (QFileInfo(exportFile).suffix().toLower() == "csv") cache->writeAsCSV(exportFile);
+            else cache->save(false, exportFile);
+            report(QString("export: %1").arg(exportFile));
+        }
+    }
+
+    // as if closed in the gui
+    context->athlete->close();
+    delete context->athlete;
+    delete context;
+
+    report(QString("done in %1s").arg(elapsed.elapsed() / 1000.0, 0, 'f', 1));
+    return returning;
+}
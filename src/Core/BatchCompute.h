@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_BatchCompute_h
+#define _GC_BatchCompute_h 1
+
+#include <QDir>
+#include <QString>
+#include <QStringList>
+
+class Context;
+
+//
+// Headless batch compute, GoldenCheetah --batch [options] [directory] athlete
+//
+// Opens the athlete without a window, brings the ride cache up to date
+// (metrics and cpx files), runs data processors over every activity and
+// exports the metrics, then exits. Progress and problems are written
+// to stdout so it can be scheduled on a server with no display.
+//
+class BatchCompute {
+
+    public:
+
+        // exit codes, so scripts can tell what went wrong
+        enum { Ok = 0, Usage = 1, NoAthlete = 2, NoProcessor = 3, ExportFailed = 4, ProcessFailed = 5 };
+
+        BatchCompute();
+
+        // is this a switch for batch mode, e.g. --threads=4
+        static bool isOption(QString arg);
+
+        // check the switches, prints the problem if not valid
+        bool parse(QStringList options);
+        static void usage();
+
+        // open the athlete in home, or athlete as a path, and do the work
+        int run(QDir home, QString athlete);
+
+    private:
+
+        // wait for the ride cache refresh to finish, reporting progress
+        void wait(Context *context, QString what);
+
+        bool rebuild, cpx;
+        int threads;
+        QStringList processors;
+        QString exportFile;
+};
+
+#endif
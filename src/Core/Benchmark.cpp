@@ -0,0 +1,676 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "Benchmark.h"
+#include "Context.h"
+#include "Athlete.h"
+#include "RideCache.h"
+#include "RideItem.h"
+#include "RideFile.h"
+#include "RideFileCache.h"
+#include "JsonRideFile.h"
+#include "RideMetric.h"
+#include "Specification.h"
+#include "WPrime.h"
+#include "DataFilter.h"
+#include "ErgFile.h"
+#include "LTMChartParser.h"
+#include "Zones.h"
+#include "HrZones.h"
+#include "PaceZones.h"
+#include "GcUpgrade.h"
+#include "Settings.h"
+#ifdef GC_WANT_R
+#include "RTool.h"
+#include "RVector.h"
+#endif
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QTimer>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QSysInfo>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QXmlInputSource>
+#include <QXmlSimpleReader>
+
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+
+// the synthetic athlete
+static const char *ATHLETE = "benchmark";
+
+static void report(QString text)
+{
+    fprintf(stdout, "%s\n", text.toLocal8Bit().constData());
+    fflush(stdout);
+}
+
+// a fixed sequence so the synthetic data is the same on every
+// platform, qrand() is not
+static double noise(unsigned int &seed)
+{
+    seed = seed * 1103515245u + 12345u;
+    return double((seed >> 16) & 0x7fff) / 32767.0;
+}
+
+static double elapsed(QElapsedTimer &timer)
+{
+    return timer.nsecsElapsed() / 1000000.0;
+}
+
+Benchmark::Benchmark() : repeat(5), rides(10000)
+{
+}
+
+bool
+Benchmark::isOption(QString arg)
+{
+    return arg.startsWith("--benchmark=") || arg.startsWith("--bench-output=") ||
+           arg.startsWith("--bench-repeat=") || arg.startsWith("--bench-rides=");
+}
+
+void
+Benchmark::usage()
+{
+    fprintf(stderr, "--benchmark=dir     to time readers, metrics, mean max, W'bal, formulas, workouts and\n");
+    fprintf(stderr, "                    R charts (when R is embedded) on the fixtures in the test directory dir\n");
+    fprintf(stderr, "                    and exit, with the options:\n");
+    fprintf(stderr, "    --bench-output=file  results as json (default goldencheetah-benchmark.json)\n");
+    fprintf(stderr, "    --bench-repeat=n     times each is run, the fastest and median are kept (default 5)\n");
+    fprintf(stderr, "    --bench-rides=n      activities in the synthetic athlete (default 10000, about 400MB)\n");
+}
+
+bool
+Benchmark::parse(QStringList options)
+{
+    output = "goldencheetah-benchmark.json";
+
+    foreach(QString option, options) {
+
+        QString value = option.mid(option.indexOf('=')+1);
+
+        if (option.startsWith("--benchmark=")) {
+            tests = QDir(value);
+            if (value == "" || !tests.exists()) {
+                fprintf(stderr, "--benchmark test directory %s not found\n", value.toLocal8Bit().constData());
+                return false;
+            }
+        } else if (option.startsWith("--bench-output=")) {
+            if (value == "") {
+                fprintf(stderr, "--bench-output needs a file name\n");
+                return false;
+            }
+            output = value;
+        } else if (option.startsWith("--bench-repeat=")) {
+            bool ok;
+            repeat = value.toInt(&ok);
+            if (!ok || repeat < 1) {
+                fprintf(stderr, "--bench-repeat must be 1 or more\n");
+                return false;
+            }
+        } else if (option.startsWith("--bench-rides=")) {
+            bool ok;
+            rides = value.toInt(&ok);
+            if (!ok || rides < 1) {
+                fprintf(stderr, "--bench-rides must be 1 or more\n");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//
+// Synthetic data
+//
+RideFile *
+Benchmark::synthetic(Context *context, QDateTime start, double seconds, double hz, unsigned int seed)
+{
+    RideFile *ride = new RideFile(start, 1.0 / hz);
+    ride->context = context;
+    ride->setDeviceType("Benchmark");
+    ride->setTag("Sport", "Bike");
+
+    // efforts from 30s to 20 minutes, some over CP, so mean max,
+    // W'bal and the zone metrics have some work to do
+    int samples = seconds * hz;
+    double km = 0, hr = 90, target = 0, next = 0;
+    RideFilePoint p;
+    for(int i=0; i<samples; i++) {
+
+        p.secs = i / hz;
+        if (p.secs >= next) {
+            target = noise(seed) > 0.7 ? 280 + noise(seed) * 150 : 150 + noise(seed) * 80;
+            next = p.secs + 30 + noise(seed) * 1170;
+        }
+
+        p.watts = qMax(0.0, target + (noise(seed) - 0.5) * 60);
+        hr += (100 + target / 3.5 - hr) / (30 * hz); // lags the effort
+        p.hr = hr;
+        p.cad = 85 + (noise(seed) - 0.5) * 10;
+        p.kph = 20 + p.watts / 20;
+        km += p.kph / 3600.0 / hz;
+        p.km = km;
+        p.alt = 100 + 50 * sin(p.secs / 600.0);
+        ride->appendPoint(p);
+    }
+    return ride;
+}
+
+bool
+Benchmark::syntheticAthlete(QDir home)
+{
+    // no upgrade needed, as created by NewCyclistDialog
+    AthleteDirectoryStructure athleteHome(home);
+    athleteHome.createAllSubdirs();
+
+    QDir root(home);
+    root.cdUp();
+    appsettings->initializeQSettingsNewAthlete(root.canonicalPath(), ATHLETE);
+    appsettings->setCValue(ATHLETE, GC_UPGRADE_FOLDER_SUCCESS, true);
+    appsettings->setCValue(ATHLETE, GC_VERSION_USED, QVariant(VERSION_LATEST));
+    appsettings->setCValue(ATHLETE, GC_DOB, QDate(1980, 1, 1));
+    appsettings->setCValue(ATHLETE, GC_WEIGHT, 75.0);
+    appsettings->setCValue(ATHLETE, GC_HEIGHT, 1.8);
+
+    Zones zones;
+    zones.addZoneRange(QDate(1900, 01, 01), 250, 250, 20000, 1000);
+    zones.write(athleteHome.config().canonicalPath());
+
+    HrZones hrzones;
+    hrzones.addHrZoneRange(QDate(1900, 01, 01), 165, 50, 190);
+    hrzones.write(athleteHome.config().canonicalPath());
+
+    PaceZones rnPaceZones(false);
+    rnPaceZones.addZoneRange(QDate(1900, 01, 01), 14.0);
+    rnPaceZones.write(athleteHome.config().canonicalPath());
+
+    PaceZones swPaceZones(true);
+    swPaceZones.addZoneRange(QDate(1900, 01, 01), 4.0);
+    swPaceZones.write(athleteHome.config().canonicalPath());
+
+    appsettings->syncQSettingsAllAthletes();
+
+    // 10 minute activities, two a day
+    JsonFileReader writer;
+    QDateTime start(QDate(2000, 1, 1), QTime(8, 0, 0));
+    for(int i=0; i<rides; i++) {
+
+        QDateTime when = start.addSecs(qint64(i) * 43200);
+        RideFile *ride = synthetic(NULL, when, 600, 1, i + 1);
+
+        QFile file(athleteHome.activities().canonicalPath() + "/" + when.toString("yyyy_MM_dd_hh_mm_ss") + ".json");
+        bool written = writer.writeRideFile(NULL, ride, file);
+        delete ride;
+
+        if (!written) {
+            report(QString("benchmark: cannot write %1").arg(file.fileName()));
+            return false;
+        }
+        if ((i+1) % 1000 == 0) report(QString("benchmark: %1 of %2 activities written").arg(i+1).arg(rides));
+    }
+    return true;
+}
+
+Context *
+Benchmark::openAthlete(QDir home)
+{
+    Context *context = new Context(NULL);
+    context->athlete = new Athlete(context, home);
+
+    // the ride cache refresh reports progress via signals
+    while (context->athlete->rideCache->isRunning()) {
+        QEventLoop loop;
+        QTimer::singleShot(100, &loop, SLOT(quit()));
+        loop.exec();
+    }
+    QCoreApplication::processEvents();
+
+    return context;
+}
+
+void
+Benchmark::closeAthlete(Context *context)
+{
+    delete context->athlete;
+    delete context;
+}
+
+RideItem *
+Benchmark::wrap(Context *context, RideFile *ride)
+{
+    RideItem *returning = new RideItem(ride, context);
+    returning->dateTime = ride->startTime();
+    returning->sport = ride->sport();
+    returning->isBike = ride->isBike();
+    returning->isRun = ride->isRun();
+    returning->isSwim = ride->isSwim();
+    returning->isXtrain = ride->isXtrain();
+
+    // zone ranges, as RideItem::refresh
+    QDate date = returning->dateTime.date();
+    if (context->athlete->zones(returning->isRun)) returning->zoneRange = context->athlete->zones(returning->isRun)->whichRange(date);
+    if (context->athlete->hrZones(returning->isRun)) returning->hrZoneRange = context->athlete->hrZones(returning->isRun)->whichRange(date);
+    if (context->athlete->paceZones(returning->isSwim)) returning->paceZoneRange = context->athlete->paceZones(returning->isSwim)->whichRange(date);
+
+    return returning;
+}
+
+//
+// Benchmarks
+//
+void
+Benchmark::readers(Context *context, QList<RideItem*> &opened, QStringList &names)
+{
+    foreach(QString folder, QStringList() << "rides" << "runs" << "swims") {
+
+        QDir dir(tests.absoluteFilePath(folder));
+        foreach(QString name, RideFileFactory::instance().listRideFiles(dir)) {
+
+            BenchmarkResult result;
+            result.group = "reader";
+            result.name = folder + "/" + name;
+            result.samples = 0;
+
+            // the first is kept for the metrics and mean max
+            RideFile *first = NULL;
+            for(int i=0; i<repeat; i++) {
+
+                QFile file(dir.absoluteFilePath(name));
+                QStringList errors;
+
+                QElapsedTimer timer;
+                timer.start();
+                RideFile *ride = RideFileFactory::instance().openRideFile(context, file, errors);
+                double ms = elapsed(timer);
+
+                if (!ride) {
+                    result.error = errors.count() ? errors.join("; ") : QString("cannot read");
+                    break;
+                }
+                result.times << ms;
+                result.samples = ride->dataPoints().count();
+
+                if (first) delete ride;
+                else first = ride;
+            }
+            add(result);
+
+            if (first && first->dataPoints().count()) {
+                opened << wrap(context, first);
+                names << result.name;
+            } else delete first;
+        }
+    }
+}
+
+void
+Benchmark::compute(QString name, RideItem *item)
+{
+    RideFile *ride = item->ride();
+    const QStringList &metrics = RideMetricFactory::instance().allMetrics();
+
+    BenchmarkResult computed;
+    computed.group = "metrics";
+    computed.name = name;
+    computed.samples = ride->dataPoints().count();
+
+    BenchmarkResult meanmax = computed;
+    meanmax.group = "meanmax";
+
+    BenchmarkResult wbal = computed;
+    wbal.group = "wprime";
+
+    for(int i=0; i<repeat; i++) {
+
+        QElapsedTimer timer;
+        timer.start();
+        RideMetric::computeMetrics(item, Specification(), metrics);
+        computed.times << elapsed(timer);
+
+        timer.start();
+        RideFileCache cache(ride);
+        meanmax.times << elapsed(timer);
+
+        timer.start();
+        WPrime wprime;
+        wprime.setRide(ride);
+        wbal.times << elapsed(timer);
+    }
+    add(computed);
+    add(meanmax);
+    if (ride->isDataPresent(RideFile::watts)) add(wbal);
+}
+
+void
+Benchmark::formulas(Context *context)
+{
+    QDir dir(tests.absoluteFilePath("charts"));
+    foreach(QString name, dir.entryList(QStringList() << "*.xml", QDir::Files, QDir::Name)) {
+
+        // trends charts, their curves may be formulas
+        QFile chartsFile(dir.absoluteFilePath(name));
+        QXmlInputSource source(&chartsFile);
+        QXmlSimpleReader xmlReader;
+        LTMChartParser handler;
+        xmlReader.setContentHandler(&handler);
+        xmlReader.setErrorHandler(&handler);
+        xmlReader.parse(source);
+
+        foreach(LTMSettings chart, handler.getSettings()) {
+            foreach(MetricDetail metric, chart.metrics) {
+
+                if (metric.type != METRIC_FORMULA) continue;
+
+                BenchmarkResult result;
+                result.group = "formula";
+                result.name = QString("%1/%2").arg(chart.name).arg(metric.uname != "" ? metric.uname : metric.name);
+                result.samples = i ? qMin(365, context->athlete->rideCache->count()) : context->athlete->rideCache->count();
+
+                // as LTMPlot, parsed then evaluated for every activity
+                for(int i=0; i<repeat; i++) {
+
+                    QElapsedTimer timer;
+                    timer.start();
+                    DataFilter parser(NULL, context, metric.formula);
+                    if (parser.getErrors().count()) {
+                        result.error = parser.getErrors().join("; ");
+                        break;
+                    }
+                    foreach(RideItem *item, context->athlete->rideCache->rides()) parser.evaluate(item, NULL);
+                    result.times << elapsed(timer);
+                }
+                add(result);
+            }
+        }
+    }
+}
+
+void
+Benchmark::workouts(Context *context)
+{
+    QDir dir(tests.absoluteFilePath("workouts"));
+    foreach(QString name, dir.entryList(QDir::Files, QDir::Name)) {
+
+        if (!ErgFile::isWorkout(name)) continue;
+
+        BenchmarkResult result;
+        result.group = "workout";
+        result.name = "workouts/" + name;
+        result.samples = 0;
+
+        for(int i=0; i<repeat; i++) {
+
+            QElapsedTimer timer;
+            timer.start();
+            ErgFile erg(dir.absoluteFilePath(name), 0, context);
+            double ms = elapsed(timer);
+
+            if (!erg.isValid()) {
+                result.error = "not valid";
+                break;
+            }
+            result.times << ms;
+            result.samples = erg.Points.count();
+        }
+        add(result);
+    }
+}
+
+#ifdef GC_WANT_R
+void
+Benchmark::rcharts(Context *context)
+{
+    if (rtool == NULL) {
+        report("benchmark: R is not embedded, R charts skipped");
+        return;
+    }
+
+    // as an R chart on trends would, every metric for all the activities
+    // and the series for a season of them. Most charts only look at a few
+    // columns, as here, memory is what R holds whilst it has the data
+    struct { const char *name, *script; } charts[] = {
+        { "season metrics", "gc.data <- GC.season.metrics(all=TRUE)\n"
+                            "gc.bench <- sum(gc.data[[2]], na.rm=TRUE)\n" },
+        { "season activities", "gc.data <- GC.activity(activity=tail(GC.activities(), 365))\n"
+                               "gc.bench <- sum(sapply(gc.data, function(a) mean(a$power, na.rm=TRUE)))\n" },
+    };
+    const char *clear = "rm(list=intersect(ls(), c(\"gc.data\", \"gc.bench\"))); invisible(gc(full=TRUE))\n";
+
+    // the same charts with vectors copied into R, then
+    // shared if this version of R can
+    RVector::setShared(true);
+    bool altrep = RVector::shared();
+
+    rtool->context = context;
+    foreach(bool shared, QList<bool>() << false << true) {
+
+        if (shared && !altrep) break;
+        RVector::setShared(shared);
+
+        for(int i=0; i<2; i++) {
+
+            BenchmarkResult result;
+            result.group = "rchart";
+            result.name = QString("%1 %2").arg(charts[i].name).arg(shared ? "shared" : "copied");
+            result.samples = context->athlete->rideCache->count();
+
+            for(int j=0; j<repeat; j++) {
+
+                SEXP ans;
+                rtool->R->parseEvalQNT(clear);
+                rtool->cancelled = false;
+
+                QElapsedTimer timer;
+                timer.start();
+                if (rtool->R->parseEval(charts[i].script, ans)) {
+                    result.error = rtool->messages.join("");
+                    break;
+                }
+                result.times << elapsed(timer);
+
+                // Ncells and Vcells in use, in MB
+                if (rtool->R->parseEval("sum(gc(full=TRUE)[,2])\n", ans) == 0 && Rf_isReal(ans))
+                    result.memory = REAL(ans)[0];
+            }
+            rtool->messages.clear();
+            add(result);
+        }
+    }
+    rtool->R->parseEvalQNT(clear);
+    RVector::setShared(true);
+    rtool->context = NULL;
+}
+#endif
+
+//
+// Results
+//
+static double median(QVector<double> times)
+{
+    std::sort(times.begin(), times.end());
+    int n = times.count();
+    return n % 2 ? times[n/2] : (times[n/2-1] + times[n/2]) / 2.0;
+}
+
+void
+Benchmark::add(BenchmarkResult result)
+{
+    if (result.times.count()) {
+        double fastest = *std::min_element(result.times.constBegin(), result.times.constEnd());
+        report(QString("%1 %2: %3ms (median %4ms, %5 samples)%6")
+               .arg(result.group).arg(result.name)
+               .arg(fastest, 0, 'f', 2).arg(median(result.times), 0, 'f', 2).arg(result.samples)
+               .arg(result.memory > 0 ? QString(" %1MB").arg(result.memory, 0, 'f', 1) : QString()));
+    } else {
+        report(QString("%1 %2: %3").arg(result.group).arg(result.name).arg(result.error));
+    }
+    results << result;
+}
+
+bool
+Benchmark::write()
+{
+    QJsonArray list;
+    foreach(BenchmarkResult result, results) {
+
+        QJsonObject object;
+        object.insert("group", result.group);
+        object.insert("name", result.name);
+        object.insert("samples", result.samples);
+        if (result.memory > 0) object.insert("memory", result.memory);
+        if (result.error != "") object.insert("error", result.error);
+
+        if (result.times.count()) {
+            double total = 0;
+            QJsonArray times;
+            foreach(double ms, result.times) {
+                times.append(ms);
+                total += ms;
+            }
+            object.insert("runs", result.times.count());
+            object.insert("min", *std::min_element(result.times.constBegin(), result.times.constEnd()));
+            object.insert("median", median(result.times));
+            object.insert("mean", total / result.times.count());
+            object.insert("times", times);
+        }
+        list.append(object);
+    }
+
+    // enough to tell runs apart when comparing
+    QJsonObject root;
+    root.insert("version", QString(VERSION_STRING));
+    root.insert("build", VERSION_LATEST);
+    root.insert("qt", QString(qVersion()));
+    root.insert("os", QSysInfo::prettyProductName());
+    root.insert("cpu", QSysInfo::currentCpuArchitecture());
+    root.insert("threads", QThreadPool::globalInstance()->maxThreadCount());
+    root.insert("repeat", repeat);
+    root.insert("rides", rides);
+    root.insert("date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    root.insert("units", QString("ms"));
+    root.insert("results", list);
+
+    QFile file(output);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) return false;
+    file.write(QJsonDocument(root).toJson());
+    file.close();
+    return file.error() == QFile::NoError;
+}
+
+int
+Benchmark::run()
+{
+    // start from nothing every time
+    QDir work(QDir::tempPath() + "/goldencheetah-benchmark");
+    work.removeRecursively();
+    if (!QDir().mkpath(work.absoluteFilePath(ATHLETE))) {
+        report(QString("benchmark: cannot create %1").arg(work.absolutePath()));
+        return WriteFailed;
+    }
+    QDir home(work.absoluteFilePath(ATHLETE));
+
+    report(QString("benchmark: %1 activities in %2").arg(rides).arg(home.absolutePath()));
+    if (!syntheticAthlete(home)) return WriteFailed;
+
+    // the refresh computes metrics and cpx for every activity, once
+    BenchmarkResult refresh;
+    refresh.group = "athlete";
+    refresh.name = "refresh";
+    refresh.samples = rides;
+    QElapsedTimer timer;
+    timer.start();
+    Context *context = openAthlete(home);
+    refresh.times << elapsed(timer);
+    add(refresh);
+    closeAthlete(context); // saves rideDB.json
+
+    // then opening it again just loads rideDB.json
+    BenchmarkResult load;
+    load.group = "athlete";
+    load.name = "load";
+    load.samples = rides;
+    for(int i=0; i<repeat; i++) {
+        timer.start();
+        context = openAthlete(home);
+        load.times << elapsed(timer);
+        if (i < repeat-1) closeAthlete(context);
+    }
+    add(load);
+
+    // the fixtures
+    QList<RideItem*> opened;
+    QStringList names;
+    readers(context, opened, names);
+    for(int i=0; i<opened.count(); i++) compute(names[i], opened[i]);
+    qDeleteAll(opened);
+
+    // long rides, written and read back as json too
+    struct { const char *name; double seconds, hz; } large[] = {
+        { "synthetic 10h 1Hz", 36000, 1 },
+        { "synthetic 1h 100Hz", 3600, 100 }
+    };
+    for(int i=0; i<2; i++) {
+
+        RideFile *synth = synthetic(context, QDateTime(QDate(2020, 1, 1), QTime(8, 0, 0)), large[i].seconds, large[i].hz, 1);
+        QFile file(work.absoluteFilePath(QString("%1.json").arg(i)));
+        JsonFileReader().writeRideFile(context, synth, file);
+
+        BenchmarkResult reader;
+        reader.group = "reader";
+        reader.name = large[i].name;
+        reader.samples = synth->dataPoints().count();
+        for(int j=0; j<repeat; j++) {
+            QStringList errors;
+            timer.start();
+            RideFile *ride = RideFileFactory::instance().openRideFile(context, file, errors);
+            if (!ride) {
+                reader.error = errors.join("; ");
+                break;
+            }
+            reader.times << elapsed(timer);
+            delete ride;
+        }
+        add(reader);
+
+        RideItem *synthItem = wrap(context, synth);
+        compute(large[i].name, synthItem);
+        delete synthItem;
+    }
+
+    formulas(context);
+    workouts(context);
+#ifdef GC_WANT_R
+    rcharts(context);
+#endif
+    closeAthlete(context);
+
+    if (!write()) {
+        report(QString("benchmark: cannot write %1").arg(output));
+        return WriteFailed;
+    }
+    report(QString("benchmark: results in %1").arg(output));
+    return Ok;
+}
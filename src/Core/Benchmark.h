@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_Benchmark_h
+#define _GC_Benchmark_h 1
+
+#include <QDir>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+
+class Context;
+class RideFile;
+class RideItem;
+
+// timings for one benchmark, in milliseconds
+struct BenchmarkResult {
+    BenchmarkResult() : samples(0), memory(0) {}
+    QString group, name, error;
+    int samples;
+    double memory; // MB, when measured
+    QVector<double> times;
+};
+
+//
+// Benchmarks, GoldenCheetah --benchmark=<test directory> [options]
+//
+// Times the work done when refreshing and opening activities using the
+// fixtures in test/ (rides, runs, swims, workouts and charts) and some
+// synthetic data: long rides at 1Hz and 100Hz and an athlete with many
+// activities. When R is embedded, season scale R charts are timed too.
+// Each benchmark is repeated and the results written as json so releases
+// can be compared.
+//
+// The synthetic athlete is created in a work directory in the system temp
+// folder, it is emptied at the start of each run and left afterwards.
+//
+class Benchmark {
+
+    public:
+
+        // exit codes, as for BatchCompute
+        enum { Ok = 0, Usage = 1, NoTests = 2, WriteFailed = 4 };
+
+        Benchmark();
+
+        // is this a switch for the benchmark, e.g. --bench-repeat=5
+        static bool isOption(QString arg);
+
+        // check the switches, prints the problem if not valid
+        bool parse(QStringList options);
+        static void usage();
+
+        // run them all and write the results
+        int run();
+
+    private:
+
+        // synthetic data, the same every run
+        RideFile *synthetic(Context *context, QDateTime start, double seconds, double hz, unsigned int seed);
+        bool syntheticAthlete(QDir home);
+        Context *openAthlete(QDir home);
+        void closeAthlete(Context *context);
+
+        // a ride item for the ride, that it owns
+        RideItem *wrap(Context *context, RideFile *ride);
+
+        // the benchmarks, readers keeps the activities it opened
+        void readers(Context *context, QList<RideItem*> &opened, QStringList &names);
+        void compute(QString name, RideItem *item);
+        void formulas(Context *context);
+        void workouts(Context *context);
+#ifdef GC_WANT_R
+        void rcharts(Context *context);
+#endif
+
+        void add(BenchmarkResult result);
+        bool write();
+
+        QDir tests;
+        QString output;
+        int repeat, rides;
+
+        QList<BenchmarkResult> results;
+};
+
+#endif
@@ -44,6 +44,7 @@
 #endif
 #ifdef GC_WANT_PYTHON
 #include "PythonEmbed.h"
+#include "PythonWorkers.h"
 QMutex pythonMutex;
 #endif
 
@@ -6356,12 +6357,18 @@ DataFilterRuntime::runPythonScript(Context *context, QString script, RideItem *m
 {
     if (python == NULL) return(0);
 
-    // get the lock
-    pythonMutex.lock();
-
     // return result
     double result = 0;
 
+    // workers run in parallel, the embedded interpreter
+    // is only needed for calls they don't support
+    QStringList messages;
+    if (pythonWorkers && pythonWorkers->runline(ScriptContext(context, m, metrics, spec), script, result, messages))
+        return result;
+
+    // get the lock
+    pythonMutex.lock();
+
     // run it !!
     python->canvas = NULL;
     python->chart = NULL;
@@ -18,122 +18,238 @@
 
 #include "Quadtree.h"
 
-// add a node
-bool
-QuadtreeNode::insert(Quadtree *root, QPointF value)
+#include <algorithm>
+#include <queue>
+#include <vector>
+
+typedef QPair<QPointF,int> QuadtreePoint;
+
+// ordering used to remove duplicates when loading, the
+// first loaded of any duplicates sorts ahead of the others
+struct CompareQuadtreePoint {
+    bool operator()(const QuadtreePoint &a, const QuadtreePoint &b) const {
+        if (a.first.x() != b.first.x()) return a.first.x() < b.first.x();
+        if (a.first.y() != b.first.y()) return a.first.y() < b.first.y();
+        return a.second < b.second;
+    }
+};
+
+struct SameQuadtreePoint {
+    bool operator()(const QuadtreePoint &a, const QuadtreePoint &b) const { return a.first == b.first; }
+};
+
+// partitions used to split a quadrant, points on the
+// midline go to the first quadrant, as they always have
+struct QuadtreeLeftOf {
+    QuadtreeLeftOf(double x) : x(x) {}
+    bool operator()(const QuadtreePoint &p) const { return p.first.x() <= x; }
+    double x;
+};
+
+struct QuadtreeAbove {
+    QuadtreeAbove(double y) : y(y) {}
+    bool operator()(const QuadtreePoint &p) const { return p.first.y() <= y; }
+    double y;
+};
+
+// search queue entries for nearest, nodes and points
+// are ordered so the closest is at the top
+struct QuadtreeEntry {
+    QuadtreeEntry(double d, int index) : d(d), index(index) {}
+    bool operator<(const QuadtreeEntry &other) const { return d > other.d; }
+    double d;
+    int index;
+};
+
+double
+QuadtreeNode::distance(const QPointF &p, double sx, double sy) const
+{
+    double dx = 0, dy = 0;
+    if (p.x() < topleft.x()) dx = topleft.x() - p.x();
+    else if (p.x() > bottomright.x()) dx = p.x() - bottomright.x();
+    if (p.y() < topleft.y()) dy = topleft.y() - p.y();
+    else if (p.y() > bottomright.y()) dy = p.y() - bottomright.y();
+    dx *= sx;
+    dy *= sy;
+    return dx*dx + dy*dy;
+}
+
+Quadtree::Quadtree(QPointF topleft, QPointF bottomright)
+{
+    reset(topleft, bottomright);
+}
+
+void
+Quadtree::reset(QPointF topleft, QPointF bottomright)
 {
-    if (!contains(value)) return false;
+    this->topleft = topleft;
+    this->bottomright = bottomright;
+    points.clear();
+    nodes.clear();
+    nodes.append(QuadtreeNode(topleft, bottomright));
+}
 
-    // here will do
-    if (leaf && contents.count() < maxentries) {
-        if (!contents.contains(value)) contents.append(value); // de dupe
-        return true;
+void
+Quadtree::load(const QVector<QPointF> &add)
+{
+    reset(topleft, bottomright);
+
+    // only those in range, remembering where they came from
+    points.reserve(add.count());
+    for(int i=0; i<add.count(); i++) {
+        const QPointF &p = add.at(i);
+        if (p.x() >= topleft.x() && p.x() <= bottomright.x() && p.y() >= topleft.y() && p.y() <= bottomright.y())
+            points.append(QuadtreePoint(p, i));
     }
 
-    // full, so split out
-    if (leaf)  split(root);
+    // de dupe
+    std::sort(points.begin(), points.end(), CompareQuadtreePoint());
+    points.erase(std::unique(points.begin(), points.end(), SameQuadtreePoint()), points.end());
 
-    // find me a home below
-    for(int i=0; i<4; i++)
-        if (aabb[i]->insert(root, value) == true)
-            return true;
+    if (points.count()) build(0, 0, points.count(), 0);
+}
 
-    // should not get here
-    return false;
+void
+Quadtree::build(int node, int start, int end, int depth)
+{
+    // few enough to be a leaf, or as deep as we go
+    if (end - start <= maxentries || depth == maxdepth) {
+        nodes[node].start = start;
+        nodes[node].count = end - start;
+        return;
+    }
+
+    QPointF tl = nodes[node].topleft;
+    QPointF br = nodes[node].bottomright;
+    QPointF mid = (tl+br)/2.0;
+
+    // left and right, then top and bottom of each
+    QuadtreePoint *b = points.data() + start;
+    QuadtreePoint *e = points.data() + end;
+    QuadtreePoint *x = std::partition(b, e, QuadtreeLeftOf(mid.x()));
+    QuadtreePoint *left = std::partition(b, x, QuadtreeAbove(mid.y()));
+    QuadtreePoint *right = std::partition(x, e, QuadtreeAbove(mid.y()));
+
+    // children are allocated together
+    int first = nodes.count();
+    nodes[node].children = first;
+    nodes.append(QuadtreeNode(tl, mid));
+    nodes.append(QuadtreeNode(QPointF(mid.x(),tl.y()), QPointF(br.x(), mid.y())));
+    nodes.append(QuadtreeNode(QPointF(tl.x(),mid.y()), QPointF(mid.x(), br.y())));
+    nodes.append(QuadtreeNode(mid,br));
+
+    const QuadtreePoint *base = points.constData();
+    build(first,   start,       left-base,  depth+1);
+    build(first+1, x-base,      right-base, depth+1);
+    build(first+2, left-base,   x-base,     depth+1);
+    build(first+3, right-base,  end,        depth+1);
 }
 
 // get candidates
 int
-QuadtreeNode::candidates(QRectF rect, QList<QPointF> &here)
+Quadtree::candidates(QRectF rect, QVector<int> &here) const
 {
-    // nope
-    if (!intersect(rect)) return 0;
+    if (points.isEmpty()) return 0;
 
-    if (leaf) {
+    rect = rect.normalized();
 
-        // lemme see if any of mine match
-        int found=0;
-        for(int i=0; i<contents.count(); i++) {
-            if (rect.contains(contents.at(i))) {
-                here.append(contents.at(i));
-                found++;
-            }
-        }
-        return found;
+    int found=0;
+    QVector<int> stack;
+    stack << 0;
+    while(!stack.isEmpty()) {
 
-    } else {
+        const QuadtreeNode &node = nodes.at(stack.takeLast());
 
-        // recurse through my children
-        int count=0;
-        for (int i=0; i<4; i++)
-            count += aabb[i]->candidates(rect, here);
-        return count;
-    }
-}
+        // nope
+        if (!node.intersect(rect)) continue;
 
-// infitesmal amount to make quadtrees have slightly
-// tiny differences on boundaries
-static double tiny = 0.000000001;
+        if (node.leaf()) {
 
-// split leaf into nodes (when to many entries)
-void
-QuadtreeNode::split(Quadtree *root)
-{
-    leaf=false;
-    aabb[0]=root->newnode(topleft, mid);
-    aabb[1]=root->newnode(QPointF(mid.x(),topleft.y()), QPointF(bottomright.x(), mid.y()));
-    aabb[2]=root->newnode(QPointF(topleft.x(),mid.y()), QPointF(mid.x(), bottomright.y()));
-    aabb[3]=root->newnode(mid,bottomright);
-
-    // find them homes and clear here
-    for(int i=0; i<contents.count(); i++)
-        for(int j=0; j<4; j++)
-            if (aabb[j]->insert(root, contents.at(i)) == true)
-                break;
-    contents.clear();
+            // lemme see if any of mine match
+            for(int i=node.start; i<node.start+node.count; i++) {
+                const QPointF &p = points.at(i).first;
+                if (p.x() >= rect.left() && p.x() <= rect.right() && p.y() >= rect.top() && p.y() <= rect.bottom()) {
+                    here.append(points.at(i).second);
+                    found++;
+                }
+            }
 
-}
+        } else {
 
-Quadtree::Quadtree(QPointF topleft, QPointF bottomright)
-{
-    root = new QuadtreeNode(topleft, bottomright);
+            // look through my children
+            for (int i=0; i<4; i++) stack << node.children + i;
+        }
+    }
+    return found;
 }
 
-// manage the entire child tree on a single qvector to delete quickly
-void
-Quadtree::reset (QPointF topleft, QPointF bottomright)
+int
+Quadtree::nearest(QPointF p, double sx, double sy) const
 {
-    for(int i=0; i<nodes.count(); i++) delete nodes.at(i);
-    nodes.clear();
-    delete root;
-    root = new QuadtreeNode(topleft,bottomright);
+    QVector<int> found;
+    if (nearest(p, 1, found, sx, sy) == 1) return found.at(0);
+    return -1;
 }
 
-Quadtree::~Quadtree()
+int
+Quadtree::nearest(QPointF p, int k, QVector<int> &here, double sx, double sy, QRectF within) const
 {
-    // zap the nodes
-    for(int i=0; i<nodes.count(); i++) delete nodes.at(i);
-    nodes.clear();
-    delete root;
-}
+    if (points.isEmpty() || k < 1) return 0;
 
-QuadtreeNode *
-Quadtree::newnode(QPointF topleft, QPointF bottomright)
-{
-    QuadtreeNode *add = new QuadtreeNode(topleft, bottomright);
-    nodes.append(add);
-    return add;
-}
+    bool limit = within.isValid() || within.width() || within.height();
+    within = within.normalized();
 
-bool Quadtree::insert(QPointF point)
-{
-    bool result= root->insert(this, point);
-    if (result == false) {
+    // best first, nodes are visited closest first and we stop when
+    // the next one is further away than the k'th nearest point so far
+    std::priority_queue<QuadtreeEntry> queue;
+    std::priority_queue<QuadtreeEntry> best; // furthest at the top, with d negated
+
+    queue.push(QuadtreeEntry(nodes.at(0).distance(p, sx, sy), 0));
+    while(!queue.empty()) {
+
+        QuadtreeEntry next = queue.top();
+        queue.pop();
+
+        if ((int)best.size() == k && next.d > -best.top().d) break;
+
+        const QuadtreeNode &node = nodes.at(next.index);
+        if (limit && !node.intersect(within)) continue;
+
+        if (node.leaf()) {
+
+            for(int i=node.start; i<node.start+node.count; i++) {
+
+                const QPointF &c = points.at(i).first;
+                if (limit && (c.x() < within.left() || c.x() > within.right() || c.y() < within.top() || c.y() > within.bottom()))
+                    continue;
+
+                double dx = (c.x()-p.x()) * sx;
+                double dy = (c.y()-p.y()) * sy;
+                double d = dx*dx + dy*dy;
+
+                if ((int)best.size() < k) best.push(QuadtreeEntry(-d, points.at(i).second));
+                else if (d < -best.top().d) {
+                    best.pop();
+                    best.push(QuadtreeEntry(-d, points.at(i).second));
+                }
+            }
+
+        } else {
+
+            for(int i=0; i<4; i++) {
+                int child = node.children + i;
+                queue.push(QuadtreeEntry(nodes.at(child).distance(p, sx, sy), child));
+            }
+        }
+    }
 
-        fprintf(stderr, "quadtree: insert failed (%f,%f) in [%f,%f = %f-%f]\n", point.x(), point.y(),
-                                                                               root->topleft.x(), root->topleft.y(),
-                                                                               root->bottomright.x(), root->bottomright.y());
-        fflush(stderr);
+    // closest first
+    int found = best.size();
+    int n = here.count();
+    here.resize(n + found);
+    for(int i=found-1; i>=0; i--) {
+        here[n+i] = best.top().index;
+        best.pop();
     }
-    return result;
+    return found;
 }
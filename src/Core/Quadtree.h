@@ -19,79 +19,88 @@
 #ifndef _GC_Quadtree_h
 #define _GC_Quadtree_h 1
 
+#include <QPair>
 #include <QPointF>
 #include <QRectF>
-#include <QList>
-
-class GenericPlot;
+#include <QVector>
+
+//
+// A point quadtree held in two flat arrays; the nodes and the points
+// they contain. It is bulk loaded from all the points at once, so the
+// points in each leaf sit next to each other and the children of a node
+// are allocated together. Each point keeps its index in the vector it
+// was loaded from, and searches return those indexes.
+//
 class Quadtree;
 class QuadtreeNode
 {
-    static const int maxdepth=12;
-    static const int maxentries=25;
-
     friend class ::Quadtree;
-    friend class ::GenericPlot;
 
     public:
 
-        // constructor makes an empty leaf
+        QuadtreeNode() : children(-1), start(0), count(0) {}
         QuadtreeNode(QPointF topleft, QPointF bottomright) :
-              topleft(topleft), bottomright(bottomright), mid((topleft+bottomright)/2.0), leaf(true) {}
-
-        // is the point in our space - when inserting
-        bool contains(QPointF p) { return ((p.x() >= topleft.x() && p.x() <= bottomright.x()) &&
-                                           p.y() >= topleft.y() && p.y() <= bottomright.y()); }
+              topleft(topleft), bottomright(bottomright), children(-1), start(0), count(0) {}
 
         // do we overlap with the search space - when looking
-        bool intersect(QRectF r) { return r.intersects(QRectF(topleft,bottomright)); }
+        bool intersect(const QRectF &r) const { return r.left() <= bottomright.x() && r.right() >= topleft.x() &&
+                                                       r.top() <= bottomright.y() && r.bottom() >= topleft.y(); }
 
-        // add a point - return false if not added
-        bool insert(Quadtree *root, QPointF value);
+        // squared distance from p to the quadrant, with x and y scaled
+        double distance(const QPointF &p, double sx, double sy) const;
 
-        // get candidates in same quadrant (might be miles away for big quadrant).
-        int candidates(QRectF,QList<QPointF>&tohere);
+        bool leaf() const { return children == -1; }
 
     protected:
 
-        // split leaf into nodes (when to many entries)
-        void split(Quadtree *root);
-
         // geom of quadrant
-        QPointF topleft, bottomright, mid;
+        QPointF topleft, bottomright;
 
-        // AABB children (also in a freelist in Quadtree)
-        QuadtreeNode *aabb[4];
+        // index of the first of our 4 children in nodes, -1 when a leaf
+        int children;
 
-        // the points in this quadrant
-        QList<QPointF> contents;
-
-        // if no children in aabb leaf==true
-        bool leaf;
+        // when a leaf, the points [start, start+count) are ours
+        int start, count;
 };
 
 class Quadtree
 {
-    friend class ::GenericPlot;
+    static const int maxdepth=12;
+    static const int maxentries=25;
 
     public:
         Quadtree (QPointF topleft, QPointF bottomright);
-        ~Quadtree();
 
-        // add a point - returns false if not in range
-        bool insert(QPointF x);
+        // replace the contents with these points, any outside the
+        // tree bounds (or NaN) are ignored and duplicates are removed,
+        // the first is kept. Searches return indexes into points.
+        void load(const QVector<QPointF> &points);
+
+        // empty it and set new bounds
+        void reset(QPointF topleft, QPointF bottomright);
+
+        bool isEmpty() const { return points.isEmpty(); }
+        int count() const { return points.count(); }
+
+        // find points in bounding rect, of course might be long way away...
+        int candidates(QRectF rect, QVector<int> &tohere) const;
 
-        // find points in boundg rect, of course might be long way away...
-        int candidates(QRectF rect, QList<QPointF>&tohere) { return root->candidates(rect, tohere); }
+        // nearest point to p or -1 if empty, distances in x and y are scaled by
+        // sx and sy (e.g. pixels per unit) so they are compared like on screen
+        int nearest(QPointF p, double sx=1.0, double sy=1.0) const;
 
-        // manage the entire child tree on a single qvector to delete quickly
-        QuadtreeNode *newnode(QPointF topleft, QPointF bottomright);
-        void reset (QPointF topleft, QPointF bottomright);
-        QVector<QuadtreeNode *> nodes;
+        // the k nearest points to p, closest first, limited to those within
+        // the rect when it is valid. Returns how many were found.
+        int nearest(QPointF p, int k, QVector<int> &tohere, double sx=1.0, double sy=1.0, QRectF within=QRectF()) const;
 
     protected:
-        QuadtreeNode *root;
-};
 
+        // partition points [start,end) into node and its children
+        void build(int node, int start, int end, int depth);
+
+        QPointF topleft, bottomright;
+        QVector<QuadtreeNode> nodes; // root is nodes[0]
+        QVector<QPair<QPointF,int> > points; // point and index it was loaded from
+};
 
 #endif
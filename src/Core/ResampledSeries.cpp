@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ResampledSeries.h"
+
+ResampledSeries::ResampledSeries(const RideFile *ride, RideFile::SeriesType series) : series(series)
+{
+    integrated << 0;
+
+    if (!ride || ride->dataPoints().isEmpty()) return;
+
+    const int SAMPLERATE = 1000; // 1000ms samplerate = 1 second samples
+
+    // set the array size, the time series always starts
+    // at zero, normalized by the file reader
+    // multi-day events are fine, but a month or more is a broken timestamp
+    // and would be mostly gap, so we don't resample those
+    double duration = ride->dataPoints().last()->secs + ride->recIntSecs();
+    if (duration <= 0 || duration > MAXSECS) return;
+    int arraySize = duration;
+
+    samples.reserve(arraySize);
+    integrated.reserve(arraySize + 1);
+
+    double sample = 0;          // value being aggregated
+    int aggregated = 0;         // ms aggregated into sample so far
+    double lastT = 0.0f;        // last sample time seen in seconds
+    double rtot = 0;            // running total
+
+    foreach(const RideFilePoint *p, ride->dataPoints()) {
+
+        // increment secs by recIntSecs as each sample
+        // covers the recording interval up to it
+        double psecs = p->secs + ride->recIntSecs();
+
+        // whats the dt in milliseconds
+        int dt = (psecs * 1000) - (lastT * 1000);
+        lastT = psecs;
+
+        // ignore time goes backwards
+        if (dt < 0) continue;
+
+        double value = p->value(series);
+
+        //
+        // AGGREGATE INTO SAMPLES
+        //
+        while (samples.count() < arraySize && dt) {
+
+            // 'need' is whats left to aggregate for the full sample
+            int need = SAMPLERATE - aggregated;
+
+            if (dt < need) {
+
+                // the entire sample read is less than we need
+                // so aggregate the whole lot and wait for more
+                // data to be read. If there is no more data then
+                // this will be lost, we don't keep incomplete samples
+                aggregated += dt;
+                sample += double(dt) * value;
+                dt = 0;
+
+            } else {
+
+                // dt is more than we need to fill an entire sample
+                // so lets just take the fraction we need
+                dt -= need;
+
+                sample += double(need) * value;
+                sample /= SAMPLERATE;
+
+                rtot += sample;
+                samples << sample;
+                integrated << rtot;
+
+                // reset back to zero so we can aggregate
+                // the next sample
+                aggregated = 0;
+                sample = 0;
+            }
+        }
+    }
+}
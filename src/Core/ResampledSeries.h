@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_ResampledSeries_h
+#define _GC_ResampledSeries_h 1
+#include "GoldenCheetah.h"
+
+#include "RideFile.h"
+
+#include <QVector>
+
+//
+// A data series aggregated into 1 second samples, along with its running
+// total so the total or mean of any run of samples is a single subtraction.
+//
+// They are expensive to create for long rides, so get them from
+// RideItem::resampled() which computes them once and shares them
+// until the ride data changes.
+//
+class ResampledSeries
+{
+    public:
+        ResampledSeries(const RideFile *ride, RideFile::SeriesType series);
+
+        // longest ride we will resample (31 days)
+        static const int MAXSECS = 31*24*3600;
+
+        RideFile::SeriesType series;
+
+        // one value per second, from the start of the ride
+        QVector<double> samples;
+
+        // integrated[i] is the sum of the first i samples, so it
+        // has one more entry than samples, starting with zero
+        QVector<double> integrated;
+
+        int count() const { return samples.count(); }
+
+        // total and mean of the samples [from, from+secs)
+        double total(int from, int secs) const { return integrated[from+secs] - integrated[from]; }
+        double mean(int from, int secs) const { return secs > 0 ? total(from, secs) / double(secs) : 0; }
+};
+#endif
@@ -42,6 +42,7 @@
 #include "RideMetric.h"
 #include "UserMetricSettings.h"
 #include "UserMetricParser.h"
+#include "Trace.h"
 #include <QXmlInputSource>
 #include <QXmlSimpleReader>
 
@@ -55,6 +56,7 @@ RideCache::RideCache(Context *context) : context(context)
     plannedDirectory = context->athlete->home->planned();
 
     progress_ = 100;
+    refreshStart = -1;
     exiting = false;
     estimator = new Estimator(context);
 
@@ -145,6 +147,7 @@ RideCache::RideCache(Context *context) : context(context)
 
 
     // future watching
+    connect(&watcher, SIGNAL(finished()), this, SLOT(refreshed()));
     connect(&watcher, SIGNAL(finished()), this, SLOT(garbageCollect()));
     connect(&watcher, SIGNAL(finished()), this, SLOT(save()));
     connect(&watcher, SIGNAL(finished()), context, SLOT(notifyRefreshEnd()));
@@ -172,6 +175,14 @@ RideCache::garbageCollect()
     delete_.clear();
 }
 
+void
+RideCache::refreshed()
+{
+    // the span started in refresh() ends when the last item is done
+    if (refreshStart >= 0) Trace::complete("refresh", "RideCache::refresh", QString("%1 activities").arg(reverse_.count()), refreshStart);
+    refreshStart = -1;
+}
+
 void
 RideCache::initEstimates()
 {
@@ -188,7 +199,7 @@ RideCache::configChanged(qint32 what)
     // if the wbal formula changed invalidate all cached values
     if (what & CONFIG_WBAL) {
         foreach(RideItem *item, rides()) {
-            if (item->isOpen()) item->ride()->wstale=true;
+            if (item->isOpen()) item->ride()->wstale.storeRelease(true);
         }
     }
 
@@ -489,6 +500,10 @@ RideCache::refresh()
     // already on it !
     if (future.isRunning()) return;
 
+    // just the stale checks and starting the threads, the whole
+    // refresh is traced when the watcher says it finished
+    TraceSpan span("refresh", "RideCache::refresh scheduling");
+
     // how many need refreshing ?
     int staleCount = 0;
 
@@ -499,11 +514,14 @@ RideCache::refresh()
             staleCount++;
     }
 
+    Trace::counter("refresh", "stale activities", staleCount);
+
     // start if there is work to do
     // and future watcher can notify of updates
     if (staleCount)  {
         reverse_ = rides_;
         qSort(reverse_.begin(), reverse_.end(), rideCacheGreaterThan);
+        refreshStart = Trace::enabled() ? Trace::now() : -1;
         future = QtConcurrent::map(reverse_, itemRefresh);
         watcher.setFuture(future);
 
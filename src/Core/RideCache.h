@@ -117,6 +117,9 @@ class RideCache : public QObject
         // clear deleted objects
         void garbageCollect();
 
+        // background refresh finished, for the trace
+        void refreshed();
+
         // first run to initialise estimates
         void initEstimates();
 
@@ -146,6 +149,7 @@ class RideCache : public QObject
 
         QFuture<void> future;
         QFutureWatcher<void> watcher;
+        qint64 refreshStart; // when tracing, -1 otherwise
 
         Estimator *estimator;
         bool first; // updated when estimates are marked stale
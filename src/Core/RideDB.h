@@ -62,6 +62,9 @@ struct RideDBContext {
     HttpRequest *request;
     HttpResponse *response;
 
+    // or loading the api model
+    QList<RideItem*> *rides;
+
     // the scanner
     void *scanner;
 
@@ -81,6 +81,14 @@ ride: '{' rideelement_list '}'                                  {
                                                                         // we're listing rides in the api
                                                                         jc->api->writeRideLine(jc->item, jc->request, jc->response);
                                                                     #endif
+                                                                    } else if (jc->rides != NULL) {
+
+                                                                        // we're loading the api model, it owns the intervals now
+                                                                        RideItem *add = new RideItem;
+                                                                        add->planned = false;
+                                                                        add->setFrom(jc->item);
+                                                                        jc->rides->append(add);
+
                                                                     } else {
 
                                                                         // we're loading the cache
@@ -358,6 +366,7 @@ RideCache::load()
         jc->context = context;
         jc->cache = this;
         jc->api = NULL;
+        jc->rides = NULL;
         jc->old = false;
 
         // clean item
@@ -860,21 +869,71 @@ void RideCache::save(bool opendata, QString filename)
 
 #ifdef GC_WANT_HTTP
 #include "RideMetadata.h"
+#include "APIWebModel.h"
+
+void
+APIWebModel::readRideDB(QString filename, QString path, QList<RideItem*> &rides)
+{
+    QFile rideDB(filename);
+    if (rideDB.exists() && rideDB.open(QFile::ReadOnly)) {
+
+        // ok, lets read it in
+        QTextStream stream(&rideDB);
+        stream.setCodec("UTF-8");
+
+        // Read the entire file into a QString -- we avoid using fopen since it
+        // doesn't handle foreign characters well. Instead we use QFile and parse
+        // from a QString
+        QString contents = stream.readAll();
+        rideDB.close();
+
+        // create scanner context for reentrant parsing
+        RideDBContext *jc = new RideDBContext;
+        jc->cache = NULL;
+        jc->context = NULL;
+        jc->api = NULL;
+        jc->request = NULL;
+        jc->response = NULL;
+        jc->rides = &rides;
+        jc->old = false;
+
+        // clean item
+        jc->item.path = path;
+        jc->item.context = NULL;
+        jc->item.isstale = jc->item.isdirty = jc->item.isedit = false;
+
+        RideDBlex_init(&scanner);
+
+        // inform the parser/lexer we have a new file
+        RideDB_setString(contents, scanner);
+
+        // setup
+        jc->errors.clear();
+
+        // parse it
+        RideDBparse(jc);
+
+        // clean up
+        RideDBlex_destroy(scanner);
+
+        // regardless of errors we're done !
+        delete jc;
+    }
+}
 
 void
 APIWebService::listRides(QString athlete, HttpRequest &request, HttpResponse &response)
 {
     listRideSettings settings;
 
-    // the ride db
-    QString ridedb = QString("%1/%2/cache/rideDB.json").arg(home.absolutePath()).arg(athlete);
-    QFile rideDB(ridedb);
+    // the ride db, loaded once and shared
+    QSharedPointer<APIAthleteData> data = model->athlete(athlete);
 
     // list activities and associated metrics
     response.setHeader("Content-Type", "text; charset=ISO-8859-1");
 
     // not known..
-    if (!rideDB.exists()) {
+    if (!data) {
         response.setStatus(404);
         response.write("malformed URL or unknown athlete.\n");
         return;
@@ -966,7 +1025,7 @@ APIWebService::listRides(QString athlete, HttpRequest &request, HttpResponse &re
         if(settings.metawanted.count()) nometa = false;
     }
 
-    // list 'em by reading the ride cache from disk
+    // list 'em from the ride cache
     if ((nometa == false || nometrics == false) && settings.intervals == false) {
 
         int i=0;
@@ -998,49 +1057,8 @@ APIWebService::listRides(QString athlete, HttpRequest &request, HttpResponse &re
         }
         response.bwrite("\n");
 
-        // parse the rideDB and write a line for each entry
-        if (rideDB.exists() && rideDB.open(QFile::ReadOnly)) {
-
-            // ok, lets read it in
-            QTextStream stream(&rideDB);
-            stream.setCodec("UTF-8");
-
-            // Read the entire file into a QString -- we avoid using fopen since it
-            // doesn't handle foreign characters well. Instead we use QFile and parse
-            // from a QString
-            QString contents = stream.readAll();
-            rideDB.close();
-
-            // create scanner context for reentrant parsing
-            RideDBContext *jc = new RideDBContext;
-            jc->cache = NULL;
-            jc->api = this;
-            jc->response = &response;
-            jc->request = &request;
-            jc->old = false;
-
-            // clean item
-            jc->item.path = home.absolutePath() + "/activities";
-            jc->item.context = NULL;
-            jc->item.isstale = jc->item.isdirty = jc->item.isedit = false;
-
-            RideDBlex_init(&scanner);
-
-            // inform the parser/lexer we have a new file
-            RideDB_setString(contents, scanner);
-
-            // setup
-            jc->errors.clear();
-
-            // parse it
-            RideDBparse(jc);
-
-            // clean up
-            RideDBlex_destroy(scanner);
-
-            // regardless of errors we're done !
-            delete jc;
-        }
+        // a line for each entry in the resident ride cache
+        foreach(RideItem *item, data->rides) writeRideLine(*item, &request, &response);
 
     } else {
 
@@ -1054,28 +1072,20 @@ APIWebService::listRides(QString athlete, HttpRequest &request, HttpResponse &re
         QDate before(3000,01,01);
         if (beforep != "") before = QDate::fromString(beforep,"yyyy/MM/dd");
 
-        // fast list of rides by traversing the directory
+        // fast list of rides from the activities directory
         response.bwrite("\n"); // headings have no metric columns
 
-        // This will read the user preferences and change the file list order as necessary:
-        QFlags<QDir::Filter> spec = QDir::Files;
-        QStringList names;
-        names << "*"; // anything
-
         // loop through files, make sure in time range wanted
-        QDir activities(home.absolutePath() + "/" + athlete + "/activities");
-        foreach(QString name, activities.entryList(names, spec, QDir::Name)) {
+        QMapIterator<QString, QDateTime> it(data->activities);
+        while (it.hasNext()) {
+            it.next();
 
-            // parse it into date and time
-            QDateTime dateTime;
-            if (!RideFile::parseRideFileName(name, &dateTime)) continue; 
+            QString name = it.key();
+            QDateTime dateTime = it.value();
 
             // in range?
             if (dateTime.date() < since || dateTime.date() > before) continue;
 
-            // is it a backup ?
-            if (name.endsWith(".bak")) continue;
-
             // out a line
             response.bwrite(dateTime.date().toString("yyyy/MM/dd").toLocal8Bit());
             response.bwrite(", ");
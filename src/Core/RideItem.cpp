@@ -20,6 +20,7 @@
 #include "RideMetric.h"
 #include "RideFile.h"
 #include "RideFileCache.h"
+#include "ResampledSeries.h"
 #include "RideMetadata.h"
 #include "IntervalItem.h"
 #include "Route.h"
@@ -32,12 +33,14 @@
 #include "AddIntervalDialog.h" // till we fixup ridefilecache to have offsets
 #include "TimeUtils.h" // time_to_string()
 #include "WPrime.h" // for matches
+#include "Trace.h"
 
 #include <cmath>
 #include <QtAlgorithms>
 #include <QMap>
 #include <QMapIterator>
 #include <QByteArray>
+#include <QtConcurrent>
 
 // used to create a temporary ride item that is not in the cache and just
 // used to enable using the same calling semantics in things like the
@@ -257,11 +260,53 @@ RideItem::fileCache()
     return fileCache_;
 }
 
+QSharedPointer<const ResampledSeries>
+RideItem::resampled(RideFile::SeriesType series)
+{
+    // opening the ride can take a while, don't hold the lock for it
+    RideFile *f = ride();
+
+    QMutexLocker locker(&resampledLock);
+
+    QSharedPointer<const ResampledSeries> returning = resampledCache.value(series);
+    if (returning.isNull() && f) {
+        returning = QSharedPointer<const ResampledSeries>(new ResampledSeries(f, series));
+        resampledCache.insert(series, returning);
+    }
+    return returning;
+}
+
+// runs on a worker thread
+static void prepareRideData(RideFile *ride)
+{
+    ride->wprimeData();
+}
+
+QFuture<void>
+RideItem::prepare()
+{
+    // one job at a time, a chart asking again shares it
+    if (preparing.isRunning()) return preparing;
+
+    RideFile *f = ride();
+    if (f) preparing = QtConcurrent::run(prepareRideData, f);
+    return preparing;
+}
+
+void
+RideItem::clearResampled()
+{
+    // anyone still using them keeps their reference
+    QMutexLocker locker(&resampledLock);
+    resampledCache.clear();
+}
+
 void
 RideItem::setRide(RideFile *overwrite)
 {
     RideFile *old = ride_;
     ride_ = overwrite; // overwrite
+    clearResampled();
 
     // connect up to new one - if its not null
     if (ride_) {
@@ -352,10 +397,11 @@ RideItem::notifyRideDataChanged()
 
     // wipe user data
     userCache.clear();
+    clearResampled();
 
     // force a recompute of derived data series
     if (ride_) {
-        ride_->wstale = true;
+        ride_->wstale.storeRelease(true);
         ride_->recalculateDerivedSeries(true);
     }
 
@@ -435,6 +481,9 @@ RideItem::isOpen()
 void
 RideItem::close()
 {
+    // the ride may be being prepared in the background
+    preparing.waitForFinished();
+
     // ride data
     if (ride_) {
         // break link to ride file
@@ -443,6 +492,9 @@ RideItem::close()
         ride_ = NULL;
     }
 
+    // and the samples derived from it
+    clearResampled();
+
     // and the cpx data
     if (fileCache_) {
     	delete fileCache_;
@@ -547,6 +599,8 @@ RideItem::refresh()
 {
     if (!isstale) return;
 
+    TraceSpan span("refresh", "RideItem::refresh", fileName);
+
     // update current state coz we'll fix it below
     isstale = false;
 
@@ -671,7 +725,8 @@ RideItem::refresh()
 
             // if it is open then recompute
             userCache.clear();
-            ride_->wstale = true;
+            clearResampled();
+            ride_->wstale.storeRelease(true);
             ride_->recalculateDerivedSeries(true);
         }
 
@@ -830,6 +885,14 @@ struct effort {
     double quality;
 };
 
+// effort discovery only ever looks an hour ahead, so the running total
+// is kept in a ring of that many seconds rather than for the whole ride
+static const long EFFORTWINDOW = 3601;
+static inline long joulesAfter(const long *ring, long i, long t)
+{
+    return ring[(i+t) % EFFORTWINDOW] - ring[i % EFFORTWINDOW];
+}
+
 static bool intervalGreaterThanZone(const IntervalItem *a, const IntervalItem *b) { 
     return const_cast<IntervalItem*>(a)->getForSymbol("power_zone") > 
            const_cast<IntervalItem*>(b)->getForSymbol("power_zone"); 
@@ -1028,90 +1091,30 @@ RideItem::updateIntervals()
     if ((discovery & RideFileInterval::intervalTypeBits(RideFileInterval::EFFORT)) &&
         CP > 0 && WPRIME > 0 && PMAX > 0 && !f->isRun() && !f->isSwim() && f->isDataPresent(RideFile::watts)) {
 
-        const int SAMPLERATE = 1000; // 1000ms samplerate = 1 second samples
-
-        RideFilePoint sample;        // we reuse this to aggregate all values
-        long time = 0L;              // current time accumulates as we run through data
-        double lastT = 0.0f;         // last sample time seen in seconds
-
-        // set the array size
-        int arraySize = f->dataPoints().last()->secs + f->recIntSecs();
-
-        // anything longer than a day or negative is skipped
-        if (arraySize >= 0 && arraySize < (24*3600)) { // no indent, as added late
-
         QTime timer;
         timer.start();
 
-        // setup an integrated series
-        long *integrated_series = (long*)malloc(sizeof(long) * arraySize);
-        long *pi = integrated_series;
-        long rtot = 0;
-
-        long secs = 0;
-        foreach(RideFilePoint *p, f->dataPoints()) {
-
-            // increment secs by recIntSecs as the time series
-            // always starts at zero, normalized by the file reader
-            double psecs = p->secs + f->recIntSecs();
-
-            // whats the dt in microseconds
-            int dt = (psecs * 1000) - (lastT * 1000);
-            lastT = psecs;
-
-
-            // ignore time goes backwards
-            if (dt < 0) continue;
-
-            //
-            // AGGREGATE INTO SAMPLES
-            //
-            while (secs < arraySize && dt) {
-
-                // we keep track of how much time has been aggregated
-                // into sample, so 'need' is whats left to aggregate 
-                // for the full sample
-                int need = SAMPLERATE - sample.secs;
-
-                // aggregate
-                if (dt < need) {
-
-                    // the entire sample read is less than we need
-                    // so aggregate the whole lot and wait fore more
-                    // data to be read. If there is no more data then
-                    // this will be lost, we don't keep incomplete samples
-                    sample.secs += dt;
-                    sample.watts += float(dt) * p->watts;
-                    dt = 0;
-
-                } else {
+        // the 1 second power is shared with anyone else that wants it,
+        // but the running total is kept in whole joules, truncated after
+        // every second as it always has been, so the same efforts are
+        // found. The total at i includes sample i and the difference
+        // is the energy that follows it
+        QSharedPointer<const ResampledSeries> power = resampled(RideFile::watts);
+        long secs = power->count();
+        QVector<long> integrated(EFFORTWINDOW);
+        long *integrated_series = integrated.data();
+        long rtot = 0, filled = 0;
+
+        // each second only looks an hour ahead, so the work grows
+        // linearly with ride length and the ring slides along with i
+        for (long i=0; i<secs; i++) {
 
-                    // dt is more than we need to fill and entire sample
-                    // so lets just take the fraction we need
-                    dt -= need;
-
-                    // accumulating time and distance
-                    sample.secs = time; time += double(SAMPLERATE) / 1000.0f;
-
-                    // averaging sample data
-                    sample.watts += float(need) * p->watts;
-                    sample.watts /= 1000;
-
-                    // integrate
-                    rtot += sample.watts;
-                    *pi++ = rtot;
-                    secs++;
-                    // reset back to zero so we can aggregate
-                    // the next sample
-                    sample.secs = 0;
-                    sample.watts = 0;
-                }
+            // top up the running total to the end of the look ahead
+            while (filled < secs && filled <= i + EFFORTWINDOW - 1) {
+                rtot += power->samples[filled];
+                integrated_series[filled % EFFORTWINDOW] = rtot;
+                filled++;
             }
-        }
-
-        // now the data is integrated we can look at the 
-        // accumulated energy for each ride
-        for (long i=0; i<secs; i++) {
 
             // start out at 30 minutes and drop back to
             // 2 minutes, anything shorter and we are done
@@ -1132,7 +1135,7 @@ RideItem::updateIntervals()
                 // accounting for the fact it is expressed in joules
                 // So take Joules = (W'/t + CP) * t and solving that
                 // for t gives t = (Joules - W') / CP
-                double tc = ((integrated_series[i+t]-integrated_series[i]) - WPRIME) / CP;
+                double tc = (joulesAfter(integrated_series, i, t) - WPRIME) / CP;
                 // NOTE FOR ABOVE: it is looking at accumulation AFTER this point
                 //                 not FROM this point, so we are looking 1s ahead of i
                 //                 which is why the interval is registered as starting
@@ -1150,7 +1153,7 @@ RideItem::updateIntervals()
                         // register a candidate
                         tte.start = i + 1; // see NOTE above
                         tte.duration = t;
-                        tte.joules = integrated_series[i+t]-integrated_series[i];
+                        tte.joules = joulesAfter(integrated_series, i, t);
                         tte.quality = tc / double(t);
                         tte.zone = zoneok ? context->athlete->zones(isRun)->whichZone(zoneRange, tte.joules/tte.duration) : 1;
 
@@ -1161,7 +1164,7 @@ RideItem::updateIntervals()
                         // found one with a higher quality
                         if (tte.quality < thisquality) {
                             tte.duration = t;
-                            tte.joules = integrated_series[i+t]-integrated_series[i];
+                            tte.joules = joulesAfter(integrated_series, i, t);
                             tte.quality = thisquality;
                             tte.zone = zoneok ? context->athlete->zones(isRun)->whichZone(zoneRange, tte.joules/tte.duration) : 1;
                         }
@@ -1184,11 +1187,11 @@ RideItem::updateIntervals()
             // Search sprint
             while (t >= 5) {
                 // On Pmax only
-                // double tc = (integrated_series[i+t]-integrated_series[i]) / (PMAX);
+                // double tc = joulesAfter(integrated_series, i, t) / (PMAX);
 
                 // With the 3 components model
                 // t = W'/(P − CP) + W'/(CP − Pmax)
-                double p = (integrated_series[i+t]-integrated_series[i])/t;
+                double p = joulesAfter(integrated_series, i, t)/t;
 
                 if (p>0.5*(PMAX-CP)+CP) {
                     double tc = WPRIME / (p-CP) + WPRIME / ( CP - PMAX);
@@ -1203,17 +1206,17 @@ RideItem::updateIntervals()
                             // register a candidate
                             sprint.start = i + 1; // see NOTE above
                             sprint.duration = t;
-                            sprint.joules = integrated_series[i+t]-integrated_series[i];
+                            sprint.joules = joulesAfter(integrated_series, i, t);
                             sprint.quality = double(t) + (sprint.joules/sprint.duration/1000.0);
 
                         } else {
 
-                            double thisquality = double(t) + (integrated_series[i+t]-integrated_series[i])/t/1000.0;
+                            double thisquality = double(t) + joulesAfter(integrated_series, i, t)/t/1000.0;
 
                             // found one with a higher quality
                             if (sprint.quality < thisquality) {
                                 sprint.duration = t;
-                                sprint.joules = integrated_series[i+t]-integrated_series[i];
+                                sprint.joules = joulesAfter(integrated_series, i, t);
                                 sprint.quality = thisquality;
                             }
 
@@ -1329,12 +1332,8 @@ RideItem::updateIntervals()
 
         }
 
-        free(integrated_series);
-
-    // we skipped for whatever reason
         //qDebug()<<fileName<<"of"<<secs<<"seconds took "<<timer.elapsed()<<"ms to find"<<candidates.count();
     }
-    } // if arraySize is in bounds, no indent from above
 
     //qDebug() << "SEARCH HILLS";
     if ((discovery & RideFileInterval::intervalTypeBits(RideFileInterval::CLIMB)) &&
@@ -1353,26 +1352,34 @@ RideItem::updateIntervals()
         // Initialisation
         int hills = 0;
 
+        // we keep the index of start and stop alongside so a candidate
+        // doesn't need to search for them, which made long rides quadratic
         RideFilePoint *pstart = f->dataPoints().at(0);
         RideFilePoint *pstop = f->dataPoints().at(0);
+        int start = 0, stop = 0;
+
+        for (int index=0; index < f->dataPoints().count(); index++) {
+            RideFilePoint *p = f->dataPoints().at(index);
 
-        foreach(RideFilePoint *p, f->dataPoints()) {
             // new min altitude
             if (pstart->alt > p->alt) {
                 //update start
                 pstart = p;
+                start = index;
                 // update stop
                 pstop = p;
+                stop = index;
             }
             // Update max altitude
             if (pstop->alt < p->alt) {
                 // update stop
                 pstop = p;
+                stop = index;
             }
 
             bool downhill = (pstop->alt > p->alt+0.2*(pstop->alt-pstart->alt));
             bool flat = (!downhill && (p->km - pstop->km)>1/3.0*(p->km - pstart->km));
-            bool end = (p == f->dataPoints().last() );
+            bool end = (index == f->dataPoints().count()-1);
 
 
 
@@ -1384,30 +1391,30 @@ RideItem::updateIntervals()
                     // Candidat
 
                     // Check groundrise at end
-                    int start = f->dataPoints().indexOf(pstart);
-                    int stop = f->dataPoints().indexOf(pstop);
-
-                    for (int i=stop;i>start;i--) {
+                    int istart = start, istop = stop;
+                    for (int i=istop;i>istart;i--) {
                         RideFilePoint *p2 = f->dataPoints().at(i);
                         double distance2 =  pstop->km - p2->km;
                         if (distance2>0.1) {
                             if ((pstop->alt-p2->alt)/distance2<20.0) {
                                 //qDebug() << "        correct stop " << (pstop->alt-p2->alt)/distance2;
                                 pstop = p2;
+                                stop = i;
                             } else
-                                i = start;
+                                i = istart;
                         }
                     }
 
-                    for (int i=start;i<stop;i++) {
+                    for (int i=istart;i<istop;i++) {
                         RideFilePoint *p2 = f->dataPoints().at(i);
                         double distance2 = p2->km-pstart->km;
                         if (distance2>0.1) {
                             if ((p2->alt-pstart->alt)/distance2<20.0) {
                                 //qDebug() << "        correct start " << (p2->alt-pstart->alt)/distance2;
                                 pstart = p2;
+                                start = i;
                             } else
-                                i = stop;
+                                i = istop;
                         }
                     }
 
@@ -1444,6 +1451,7 @@ RideItem::updateIntervals()
                 }
 
                 pstart = pstop;
+                start = stop;
             }
         }
         out << "STOP" << QDateTime::currentDateTime().toString() + "\r\n";
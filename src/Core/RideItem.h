@@ -28,9 +28,13 @@
 #include <QString>
 #include <QMap>
 #include <QVector>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QFuture>
 
 class RideFile;
 class RideFileCache;
+class ResampledSeries;
 class RideCache;
 class RideCacheModel;
 class IntervalItem;
@@ -82,6 +86,14 @@ class RideItem : public QObject
         // userdata cache
         QMap<QString, QVector<double> > userCache;
 
+        // 1 second samples, see resampled()
+        QMap<int, QSharedPointer<const ResampledSeries> > resampledCache;
+        QMutex resampledLock;
+        void clearResampled();
+
+        // background work on ride_, see prepare()
+        QFuture<void> preparing;
+
         unsigned long metaCRC();
 
     public slots:
@@ -159,6 +171,14 @@ class RideItem : public QObject
         BodyMeasure weightData;
         RideFile *ride(bool open=true);
         RideFileCache *fileCache();
+
+        // a series as 1 second samples, computed on first use and shared
+        // by interval discovery until the ride data changes or is closed
+        QSharedPointer<const ResampledSeries> resampled(RideFile::SeriesType series);
+
+        // compute the ride data charts would otherwise compute lazily on
+        // the GUI thread (W'bal) in the background, close() waits for it
+        QFuture<void> prepare();
         QVector<double> &metrics() { return metrics_; }
         QVector<double> &counts() { return count_; }
         QMap <int, double>&stdmeans() { return stdmean_; }
@@ -29,6 +29,7 @@
 
 #include <QString>
 #include <QFile>
+#include <QScopedPointer>
 #include <QXmlInputSource>
 #include <QXmlSimpleReader>
 
@@ -124,8 +125,54 @@ RouteSegment::addPoint(RoutePoint _point)
     return points.count();
 }
 
-void 
-RouteSegment::search(RideItem *item, RideFile*ride, QList<IntervalItem*>&here)
+//
+// Ride samples are converted to unit vectors once, so looking for the start
+// of each route can rule out samples that are clearly too far away without
+// any trigonometry. Exact distances are still used for every decision
+// that is close to a threshold, so matches are the same as before.
+//
+RouteSearchPoints::RouteSearchPoints(RideFile *ride)
+{
+    int count = ride->dataPoints().count();
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+    valid.resize(count);
+    validNext.resize(count);
+
+    for (int i=0; i<count; i++) {
+        RideFilePoint *point = ride->dataPoints().at(i);
+
+        double v[3];
+        unitVector(point->lat, point->lon, v);
+        x[i] = v[0];
+        y[i] = v[1];
+        z[i] = v[2];
+
+        validNext[i] = point->lat != 0 && point->lon !=0 && ceil(point->lat) != 180 && ceil(point->lon) != 180;
+        valid[i] = validNext[i] && ceil(point->lat) != 540 && ceil(point->lon) != 540;
+    }
+}
+
+void
+RouteSearchPoints::unitVector(double lat, double lon, double *v)
+{
+    double rlat = lat * pi / 180;
+    double rlon = lon * pi / 180;
+    v[0] = cos(rlat) * cos(rlon);
+    v[1] = cos(rlat) * sin(rlon);
+    v[2] = sin(rlat);
+}
+
+// chord between two points on the unit sphere that are km apart
+double
+RouteSearchPoints::chord(double km)
+{
+    return 2 * sin(km / 6371 / 2);
+}
+
+void
+RouteSegment::search(RideItem *item, RideFile*ride, const RouteSearchPoints &gps, QList<IntervalItem*>&here)
 {
     //qDebug() << "Opening ride: " << item->fileName << " for " << name;
 
@@ -135,6 +182,12 @@ RouteSegment::search(RideItem *item, RideFile*ride, QList<IntervalItem*>&here)
                                      // if there is performance issue we can perhaps have 1m for small segments
                                      // and keep 10m for longer.
 
+    // samples clearly further than 1km, or clearly between 100m and 1km,
+    // from the start point don't need the exact distance (5% margin)
+    static const double farChord = RouteSearchPoints::chord(1.05);
+    static const double nearChord = RouteSearchPoints::chord(0.105);
+    static const double notFarChord = RouteSearchPoints::chord(0.95);
+
     double precision = -1;
 
     int found = 0;
@@ -142,23 +195,33 @@ RouteSegment::search(RideItem *item, RideFile*ride, QList<IntervalItem*>&here)
     int lastpoint = -1; // Last point to match
     double start = -1, stop = -1; // Start and stop secs
 
-    for (int n=0; n< this->getPoints().count();n++) {
-        RoutePoint routepoint = this->getPoints().at(n);
+    const int count = ride->dataPoints().count();
+    for (int n=0; n< points.count();n++) {
+        RoutePoint routepoint = points.at(n);
+        double v[3];
+        RouteSearchPoints::unitVector(routepoint.lat, routepoint.lon, v);
 
         bool present = false;
         RideFilePoint* point;
 
-        for (int i=lastpoint+1; i<ride->dataPoints().count();i++) {
+        for (int i=lastpoint+1; i<count;i++) {
             point = ride->dataPoints().at(i);
 
             double minimumdistance = -1;
 
-            if (point->lat != 0 && point->lon !=0 &&
-                ceil(point->lat) != 180 && ceil(point->lon) != 180 &&
-                ceil(point->lat) != 540 && ceil(point->lon) != 540) {
+            if (gps.valid[i]) {
                 // Valid GPS value
                 if (start == -1) {
                     diverge = 0;
+
+                    double chord = gps.chord(i, v);
+                    if (chord > farChord) {
+                        // fare away from reference point
+                        i += 50;
+                        continue;
+                    }
+                    if (chord > nearChord && chord < notFarChord) continue;
+
                     // Calculate distance to route point
                     double _dist = distance(routepoint.lat, routepoint.lon, point->lat, point->lon) ;
                     minimumdistance = _dist;
@@ -179,10 +242,10 @@ RouteSegment::search(RideItem *item, RideFile*ride, QList<IntervalItem*>&here)
 
                 if (start != -1) {
                     int end = i+10;
-                    for (int j=i; j<ride->dataPoints().count() && j<end;j++) {
+                    for (int j=i; j<count && j<end;j++) {
                         RideFilePoint* nextpoint = ride->dataPoints().at(j);
 
-                        if (nextpoint->lat != 0 && nextpoint->lon !=0 && ceil(nextpoint->lat) != 180 && ceil(nextpoint->lon) != 180) {
+                        if (gps.validNext[j]) {
                             double _nextdist = distance(routepoint.lat, routepoint.lon, nextpoint->lat, nextpoint->lon) ;
 
                             if (minimumdistance ==-1 || _nextdist<minimumdistance){
@@ -248,7 +311,7 @@ RouteSegment::search(RideItem *item, RideFile*ride, QList<IntervalItem*>&here)
         
         stop = point->secs;
         
-        if (n == this->getPoints().count()-1) {
+        if (n == points.count()-1) {
 
             // Add the interval and continue search
             //qDebug() << "    >>> Route identified in ride: " << name << " start: " << start << " stop: " << stop << " (distance " << precision << "km)\r\n";
@@ -406,17 +469,28 @@ Routes::search(RideItem *item, RideFile*ride, QList<IntervalItem*>&here)
 {
     if (ride) {
 
+        // ride bounding box
+        double minLat = ride->getMinPoint(RideFile::lat).toDouble();
+        double maxLat = ride->getMaxPoint(RideFile::lat).toDouble();
+        double minLon = ride->getMinPoint(RideFile::lon).toDouble();
+        double maxLon = ride->getMaxPoint(RideFile::lon).toDouble();
+
+        // prepared when the first segment overlaps
+        QScopedPointer<RouteSearchPoints> gps;
+
         // search all segments
         for (int routecount=0;routecount<routes.count();routecount++) {
             RouteSegment *segment = &routes[routecount];
 
             // The third decimal place is worth up to 110 m
-            if (ride->getMinPoint(RideFile::lat).toDouble()<segment->getMinLat()+0.001 &&
-                ride->getMaxPoint(RideFile::lat).toDouble()>segment->getMaxLat()-0.001 &&
-                ride->getMinPoint(RideFile::lon).toDouble()<segment->getMinLon()+0.001 &&
-                ride->getMaxPoint(RideFile::lon).toDouble()>segment->getMaxLon()-0.001   )
+            if (minLat<segment->getMinLat()+0.001 &&
+                maxLat>segment->getMaxLat()-0.001 &&
+                minLon<segment->getMinLon()+0.001 &&
+                maxLon>segment->getMaxLon()-0.001   ) {
 
-            segment->search(item, ride, here);
+                if (!gps) gps.reset(new RouteSearchPoints(ride));
+                segment->search(item, ride, *gps, here);
+            }
         }
     }
 }
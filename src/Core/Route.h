@@ -25,12 +25,15 @@
 #include <QString>
 #include <QDate>
 #include <QFile>
+#include <QVector>
+#include <cmath>
 
 #include "Context.h"
 
 class  RideFile;
 class  Routes;
 struct RoutePoint;
+struct RouteSearchPoints;
 
 class RouteSegment // represents a segment we match against
 {
@@ -59,8 +62,9 @@ class RouteSegment // represents a segment we match against
         int addPoint(RoutePoint _point);
         double distance(double lat1, double lon1, double lat2, double lon2);
 
-        // find segments in ridefiles
-        void search(RideItem *, RideFile*, QList<IntervalItem*>&);
+        // find segments in ridefiles, points are the ride's samples
+        // prepared once for all segments by Routes::search
+        void search(RideItem *, RideFile*, const RouteSearchPoints &, QList<IntervalItem*>&);
 
     private:
 
@@ -82,6 +86,24 @@ struct RoutePoint // represents a point within a segment
     double lon, lat;
 };
 
+struct RouteSearchPoints // ride samples as unit vectors, to rule out far away points cheaply
+{
+    RouteSearchPoints(RideFile *ride);
+
+    // straight line distance between sample i and a point on the unit sphere,
+    // it increases with the great circle distance so can be compared to chord()
+    double chord(int i, const double *v) const {
+        double dx = x[i]-v[0], dy = y[i]-v[1], dz = z[i]-v[2];
+        return sqrt(dx*dx + dy*dy + dz*dz);
+    }
+    static double chord(double km);
+    static void unitVector(double lat, double lon, double *v);
+
+    QVector<double> x, y, z;
+    QVector<bool> valid;        // usable gps when looking for a start point
+    QVector<bool> validNext;    // usable gps when following the route
+};
+
 
 class Routes : public QObject { // top-level object with API and map of segments/rides
 
@@ -133,6 +133,8 @@
 
 // Location of Python Installation - follows PYTHONHOME semantics
 #define GC_PYTHON_HOME                       "<system>pythonhome"
+// Worker processes for Python metrics and data processors, 0 to use the embedded interpreter
+#define GC_PYTHON_WORKERS                    "<system>pythonworkers"
 
 // --------------------------------------------------------------------
 // Global Properties - Stored in "root" of the active Athlete Directory
@@ -210,6 +212,8 @@
 #define GC_FIXGPS_ROUTE_FIX_DEGREE1     "<global-general>dataprocess/fixgps/route_degree1"
 #define GC_FIXGPS_ROUTE_FIX_DOAPPLY     "<global-general>dataprocess/fixgps/route_doapply"
 #define GC_FIXGPS_ROUTE_OUTLIER_PERCENT "<global-general>dataprocess/fixgps/route_outlier_percent"
+#define GC_DPFE_SOURCE                  "<global-general>dataprocess/fixelevation/source"
+#define GC_DPFE_DEMDIR                  "<global-general>dataprocess/fixelevation/demdir"
 
 // device Configurations NAME/SPEC/TYPE/DEFI/DEFR all get a number appended
 // to them to specify which configured device i.e. devices1 ... devicesn where
@@ -22,6 +22,7 @@
 #include <QString>
 #include <QStringList>
 #include <QSet>
+#include <QCryptographicHash>
 #include "TimeUtils.h"
 
 //
@@ -72,6 +73,20 @@ class FilterSet
         }
 
         int count() { return filters_.count(); }
+
+        // identifies the filter set, e.g. when used in a cache key, the
+        // number of sets and their sizes tell no filters from an empty
+        // one and the names are hashed so it doesn't grow with the rides
+        QString signature() const {
+            QString sig = QString::number(filters_.count());
+            foreach(QSet<QString> set, filters_) {
+                QStringList names = set.toList();
+                names.sort();
+                QByteArray hash = QCryptographicHash::hash(names.join("\n").toUtf8(), QCryptographicHash::Sha1);
+                sig += QString("|%1:%2").arg(set.count()).arg(QString(hash.toHex()));
+            }
+            return sig;
+        }
 };
 
 class RideFileIterator;
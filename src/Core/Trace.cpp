@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "Trace.h"
+
+#include <QCoreApplication>
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QFile>
+#include <QJsonObject>
+#include <QJsonDocument>
+
+#include <algorithm>
+
+// events kept for each thread, the oldest are overwritten
+static const int BUFFERSIZE = 16384;
+
+struct TraceEvent {
+    const char *category, *name;
+    QString detail;
+    qint64 start, duration;
+    double value;
+    char type; // 'X' span or 'C' counter
+    int tid;
+};
+
+// a thread's events, locked so they can be read while it records
+struct TraceBuffer {
+    QMutex mutex;
+    QVector<TraceEvent> events;
+    int next;
+    int tid;
+    bool free;
+};
+
+QAtomicInt Trace::active;
+
+// all the buffers, they outlive their threads so we can save
+// their events and are reused by threads started later
+static QMutex buffersMutex;
+static QList<TraceBuffer*> buffers;
+static QHash<int, QString> threadNames;
+static int lastTid = 0;
+
+static QElapsedTimer traceClock;
+
+static TraceBuffer *acquire()
+{
+    QMutexLocker locker(&buffersMutex);
+
+    TraceBuffer *buffer = NULL;
+    foreach(TraceBuffer *b, buffers) {
+        if (b->free) {
+            buffer = b;
+            break;
+        }
+    }
+    if (!buffer) {
+        buffer = new TraceBuffer;
+        buffer->next = 0;
+        buffers << buffer;
+    }
+    buffer->free = false;
+
+    // a new id, events left by the thread that used it before keep theirs
+    buffer->tid = ++lastTid;
+    QThread *thread = QThread::currentThread();
+    if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) threadNames.insert(buffer->tid, "main");
+    else if (thread->objectName() != "") threadNames.insert(buffer->tid, thread->objectName());
+    else threadNames.insert(buffer->tid, QString("thread %1").arg(buffer->tid));
+    return buffer;
+}
+
+// hands the buffer back when its thread finishes
+struct TraceThread {
+    TraceThread() : buffer(NULL) {}
+    ~TraceThread() {
+        if (buffer) {
+            QMutexLocker locker(&buffersMutex);
+            buffer->free = true;
+        }
+    }
+    TraceBuffer *buffer;
+};
+static thread_local TraceThread traceThread;
+
+static void record(TraceEvent &event)
+{
+    if (!traceThread.buffer) traceThread.buffer = acquire();
+    TraceBuffer *buffer = traceThread.buffer;
+
+    event.tid = buffer->tid;
+
+    QMutexLocker locker(&buffer->mutex);
+    if (buffer->events.count() < BUFFERSIZE) buffer->events.append(event);
+    else buffer->events[buffer->next] = event;
+    buffer->next = (buffer->next + 1) % BUFFERSIZE;
+}
+
+void
+Trace::setEnabled(bool enabled)
+{
+    QMutexLocker locker(&buffersMutex);
+    if (!traceClock.isValid()) traceClock.start();
+    active.storeRelease(enabled ? 1 : 0);
+}
+
+qint64
+Trace::now()
+{
+    return traceClock.nsecsElapsed();
+}
+
+void
+Trace::clear()
+{
+    QMutexLocker locker(&buffersMutex);
+    foreach(TraceBuffer *buffer, buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        buffer->events.clear();
+        buffer->next = 0;
+    }
+}
+
+void
+Trace::complete(const char *category, const char *name, const QString &detail, qint64 start)
+{
+    TraceEvent event;
+    event.category = category;
+    event.name = name;
+    event.detail = detail;
+    event.start = start;
+    event.duration = now() - start;
+    event.value = 0;
+    event.type = 'X';
+    record(event);
+}
+
+void
+Trace::counter(const char *category, const char *name, double value)
+{
+    if (!enabled()) return;
+
+    TraceEvent event;
+    event.category = category;
+    event.name = name;
+    event.start = now();
+    event.duration = 0;
+    event.value = value;
+    event.type = 'C';
+    record(event);
+}
+
+// all events recorded, from every thread
+static QList<TraceEvent> events()
+{
+    QList<TraceEvent> returning;
+
+    QMutexLocker locker(&buffersMutex);
+    foreach(TraceBuffer *buffer, buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        foreach(const TraceEvent &event, buffer->events) returning << event;
+    }
+    return returning;
+}
+
+bool
+Trace::write(QString filename)
+{
+    QFile file(filename);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) return false;
+
+    // written an event at a time, a trace can be large
+    file.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    bool first = true;
+    QMap<int, QString> names;
+    {
+        QMutexLocker locker(&buffersMutex);
+        QHashIterator<int, QString> it(threadNames);
+        while (it.hasNext()) {
+            it.next();
+            names.insert(it.key(), it.value());
+        }
+    }
+    QMapIterator<int, QString> it(names);
+    while (it.hasNext()) {
+        it.next();
+        QJsonObject args;
+        args.insert("name", it.value());
+        QJsonObject meta;
+        meta.insert("name", QString("thread_name"));
+        meta.insert("ph", QString("M"));
+        meta.insert("pid", 1);
+        meta.insert("tid", it.key());
+        meta.insert("args", args);
+
+        if (!first) file.write(",\n");
+        file.write(QJsonDocument(meta).toJson(QJsonDocument::Compact));
+        first = false;
+    }
+
+    QList<TraceEvent> all = events();
+    for(int i=0; i<all.count(); i++) {
+
+        const TraceEvent &event = all[i];
+        QJsonObject object;
+        object.insert("name", QString(event.name));
+        object.insert("cat", QString(event.category));
+        object.insert("ph", QString(QChar(event.type)));
+        object.insert("ts", double(event.start) / 1000.0);
+        object.insert("pid", 1);
+        object.insert("tid", event.tid);
+
+        QJsonObject args;
+        if (event.type == 'X') {
+            object.insert("dur", double(event.duration) / 1000.0);
+            if (event.detail != "") args.insert("detail", event.detail);
+        } else {
+            args.insert(event.name, event.value);
+        }
+        if (!args.isEmpty()) object.insert("args", args);
+
+        if (!first) file.write(",\n");
+        file.write(QJsonDocument(object).toJson(QJsonDocument::Compact));
+        first = false;
+    }
+
+    file.write("\n]}\n");
+    file.close();
+    return file.error() == QFile::NoError;
+}
+
+static bool moreTime(const TraceStat &a, const TraceStat &b) { return a.total > b.total; }
+
+QList<TraceStat>
+Trace::summary()
+{
+    QHash<QString, int> index;
+    QList<TraceStat> returning;
+
+    QList<TraceEvent> all = events();
+    for(int i=0; i<all.count(); i++) {
+
+        const TraceEvent &event = all[i];
+        if (event.type != 'X') continue;
+
+        QString key = QString("%1|%2|%3").arg(event.category).arg(event.name).arg(event.detail);
+        if (!index.contains(key)) {
+            TraceStat add;
+            add.category = event.category;
+            add.name = event.name;
+            add.detail = event.detail;
+            add.count = 0;
+            add.total = add.max = 0;
+            index.insert(key, returning.count());
+            returning << add;
+        }
+
+        TraceStat &stat = returning[index.value(key)];
+        stat.count++;
+        stat.total += event.duration;
+        if (event.duration > stat.max) stat.max = event.duration;
+    }
+
+    std::sort(returning.begin(), returning.end(), moreTime);
+    return returning;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_Trace_h
+#define _GC_Trace_h 1
+
+#include <QAtomicInt>
+#include <QString>
+#include <QList>
+
+// timings for one span, summed over all the times it ran
+struct TraceStat {
+    QString category, name, detail;
+    int count;
+    qint64 total, max; // nanoseconds
+};
+
+//
+// Tracing to see where the time goes when refreshing, loading rides
+// and drawing charts.
+//
+// Code marks the work it does with a TraceSpan on the stack and can
+// record counters. Events go to a ring buffer for each thread, so the
+// most recent are kept and threads don't contend. When tracing is off
+// a span is a test of one flag, so they are left in release builds.
+//
+// The buffers can be saved in the Chrome trace event format, to view
+// in chrome://tracing or ui.perfetto.dev, or summarised by span.
+//
+class Trace {
+
+    public:
+        static bool enabled() { return active.loadAcquire(); }
+        static void setEnabled(bool enabled);
+
+        // forget all events recorded so far
+        static void clear();
+
+        // a value over time, e.g. a queue length
+        static void counter(const char *category, const char *name, double value);
+
+        // save as Chrome trace json
+        static bool write(QString filename);
+
+        // totals by span, most time first
+        static QList<TraceStat> summary();
+
+        // nanoseconds since tracing was first enabled
+        static qint64 now();
+
+        // used by TraceSpan
+        static void complete(const char *category, const char *name, const QString &detail, qint64 start);
+
+    private:
+        static QAtomicInt active;
+};
+
+// times the scope it is declared in, the names must be literals
+// since only the pointer is kept
+class TraceSpan {
+
+    public:
+        TraceSpan(const char *category, const char *name)
+            : category(category), name(name), start(Trace::enabled() ? Trace::now() : -1) {}
+
+        // the detail, e.g. a metric symbol, is only copied when tracing
+        TraceSpan(const char *category, const char *name, const QString &detail)
+            : category(category), name(name), start(-1) {
+            if (Trace::enabled()) {
+                this->detail = detail;
+                start = Trace::now();
+            }
+        }
+
+        ~TraceSpan() { if (start >= 0) Trace::complete(category, name, detail, start); }
+
+    private:
+        Q_DISABLE_COPY(TraceSpan)
+
+        const char *category, *name;
+        QString detail;
+        qint64 start;
+};
+
+#endif
@@ -24,6 +24,7 @@
 #include <QDebug>
 #include <QDir>
 #include <QVector>
+#include <QByteArray>
 #include <QRegularExpression>
 
 namespace Utils
@@ -424,5 +425,78 @@ smooth_ewma(QVector<double>&data, double alpha)
     return returning;
 }
 
+
+// powers of ten that are exactly representable as doubles
+static const double exactPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline ushort code(char c) { return uchar(c); }
+static inline ushort code(const QChar &c) { return c.unicode(); }
+static inline bool space(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+static inline bool space(const QChar &c) { return c.isSpace(); }
+
+// [-+]digits[.digits] with at most 15 significant digits and 22
+// decimals: the mantissa and the power of ten are both exact so a
+// single division gives the correctly rounded result (the same
+// answer as a full conversion). Returns false for anything else.
+template<typename T>
+static bool
+fastNumber(const T *p, const T *end, double &value)
+{
+    // whitespace is ignored either side, as with QString::toDouble()
+    while (p < end && space(*p)) p++;
+    while (end > p && space(*(end-1))) end--;
+
+    bool negative = false;
+    if (p < end && (code(*p) == '-' || code(*p) == '+')) negative = (code(*p++) == '-');
+    if (p == end || code(*p) == '.' || code(*(end-1)) == '.') return false;
+
+    quint64 mantissa = 0;
+    int digits = 0, decimals = 0;
+    bool point = false;
+    for (; p < end; p++) {
+        ushort c = code(*p);
+        if (c >= '0' && c <= '9') {
+            if (point) decimals++;
+            if (mantissa == 0 && c == '0') continue; // leading zeros aren't significant
+            if (++digits > 15) return false;
+            mantissa = (mantissa * 10) + (c - '0');
+        } else if (c == '.' && !point) {
+            point = true;
+        } else {
+            return false;
+        }
+    }
+    if (decimals > 22) return false;
+
+    value = double(mantissa) / exactPowersOfTen[decimals];
+    if (negative) value = -value;
+    return true;
+}
+
+double
+number(const QStringRef &s, bool *ok)
+{
+    double value;
+    if (fastNumber(s.unicode(), s.unicode() + s.length(), value)) {
+        if (ok) *ok = true;
+        return value;
+    }
+    return s.toDouble(ok);
+}
+
+double
+number(const char *s, int len, bool *ok)
+{
+    double value;
+    if (fastNumber(s, s + len, value)) {
+        if (ok) *ok = true;
+        return value;
+    }
+    return QByteArray::fromRawData(s, len).toDouble(ok);
+}
+
 };
 
@@ -29,6 +29,7 @@
 #endif
 class QString;
 class QStringList;
+class QStringRef;
 
 #define GC_SMOOTH_FORWARD 0
 #define GC_SMOOTH_BACKWARD 1
@@ -47,6 +48,12 @@ namespace Utils
     QVector<int> arguniq(QVector<double> &v);
     QVector<double> smooth_sma(QVector<double>&, int pos, int window);
     QVector<double> smooth_ewma(QVector<double>&, double alpha);
+
+    // locale free number conversion for the short decimals found in
+    // ride files, without creating a temporary string; anything else
+    // is handed to Qt so results always match QString::toDouble()
+    double number(const QStringRef &s, bool *ok=0);
+    double number(const char *s, int len, bool *ok=0);
 };
 
 
@@ -26,6 +26,9 @@
 #include "Colors.h"
 #include "GcUpgrade.h"
 #include "IdleTimer.h"
+#include "Trace.h"
+#include "BatchCompute.h"
+#include "Benchmark.h"
 #include "PowerProfile.h"
 #include "GcCrashDialog.h" // for versionHTML
 
@@ -44,6 +47,7 @@
 #endif
 #ifdef GC_WANT_PYTHON
 #include "PythonEmbed.h"
+#include "PythonWorkers.h"
 #include "FixPySettings.h"
 #endif
 #include <signal.h>
@@ -68,6 +72,15 @@ static int gc_opened=0;
 // global application
 //
 QString gcroot;
+
+// --trace saves a trace on exit
+static bool trace = false;
+static void saveTrace()
+{
+    // view in chrome://tracing or ui.perfetto.dev
+    if (trace) Trace::write(QString("%1/goldencheetah-trace.json").arg(gcroot));
+}
+
 QApplication *application;
 QDesktopWidget *desktop = NULL;
 
@@ -98,6 +111,7 @@ void terminate(int code)
     delete fixPySettings;
 #endif
     delete appsettings;
+    saveTrace();
     application->exit();
 
     // because QT starts a bunch of threads (e.g. reading XcbEvents)
@@ -203,6 +217,8 @@ main(int argc, char *argv[])
     bool debug = false;
 #endif
     bool server = false;
+    bool batch = false, benchmark = false;
+    QStringList batchOptions, benchmarkOptions;
     nogui = false;
     bool help = false;
     bool newgui = false;
@@ -221,13 +237,16 @@ main(int argc, char *argv[])
         // help or usage requrested, additional information
         if (arg == "--help" || arg == "--usage") {
 
-            fprintf(stderr, "usage: GoldenCheetah [[directory] athlete]\n\n");
+            fprintf(stderr, "usage: GoldenCheetah [--batch [options]] [[directory] athlete]\n\n");
             fprintf(stderr, "--help or --usage   to print this message and exit\n");
             fprintf(stderr, "--version           to print detailed version information and exit\n");
             fprintf(stderr, "--newgui            to open the new gui (WIP)\n");
+            fprintf(stderr, "--trace             to record where time is spent, saved to goldencheetah-trace.json on exit\n");
 #ifdef GC_WANT_HTTP
             fprintf(stderr, "--server            to run as an API server\n");
 #endif
+            BatchCompute::usage();
+            Benchmark::usage();
 #ifdef GC_DEBUG
             fprintf(stderr, "--debug             to turn on redirection of messages to goldencheetah.log [debug build]\n");
 #else
@@ -258,6 +277,19 @@ main(int argc, char *argv[])
         } else if (arg == "--newgui") {
             newgui = true;
 
+        } else if (arg == "--trace") {
+            trace = true;
+
+        } else if (arg == "--batch") {
+            nogui = batch = true;
+
+        } else if (BatchCompute::isOption(arg)) {
+            batchOptions << arg;
+
+        } else if (Benchmark::isOption(arg)) {
+            if (arg.startsWith("--benchmark=")) nogui = benchmark = true;
+            benchmarkOptions << arg;
+
         } else if (arg == "--server") {
 #ifdef GC_WANT_HTTP
             nogui = server = true;
@@ -318,6 +350,27 @@ main(int argc, char *argv[])
         exit(0);
     }
 
+    // check the batch options before starting up
+    BatchCompute batchCompute;
+    if (batchOptions.count() && !batch) {
+        fprintf(stderr, "%s is only used with --batch\n", batchOptions.first().toLocal8Bit().constData());
+        exit(BatchCompute::Usage);
+    }
+    if (batch && !batchCompute.parse(batchOptions)) exit(BatchCompute::Usage);
+
+    Benchmark bench;
+    if (benchmarkOptions.count() && !benchmark) {
+        fprintf(stderr, "%s is only used with --benchmark\n", benchmarkOptions.first().toLocal8Bit().constData());
+        exit(Benchmark::Usage);
+    }
+    if (benchmark && !bench.parse(benchmarkOptions)) exit(Benchmark::Usage);
+
+    // no display needed when running a batch, e.g. on a server
+    if ((batch || benchmark) && qgetenv("QT_QPA_PLATFORM").isEmpty()) qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    // from the start, opening athletes is traced too
+    if (trace) Trace::setEnabled(true);
+
     //
     // INITIALISE ONE TIME OBJECTS
     //
@@ -476,6 +529,7 @@ main(int argc, char *argv[])
         if (embed && noPy == false && python == NULL) {
             python = new PythonEmbed(); // initialise python in this thread ?
             if (python->loaded == false) python=NULL;
+            else pythonWorkers = new PythonWorkers(python->pybin, appsettings->value(NULL, GC_PYTHON_WORKERS, QThread::idealThreadCount()).toInt());
         }
 #endif
 
@@ -604,6 +658,20 @@ main(int argc, char *argv[])
             
         }
 
+        // time the fixtures and synthetic data then exit
+        if (benchmark) {
+            ret = bench.run();
+            delete trainDB;
+            terminate(ret);
+        }
+
+        // compute and export for the athlete then exit
+        if (batch) {
+            ret = batchCompute.run(home, args.count() >= 2 ? args.last() : QString());
+            delete trainDB;
+            terminate(ret);
+        }
+
 #ifdef GC_WANT_HTTP
 
         // The API server offers webservices (default port 12021, see httpserver.ini)
@@ -747,6 +815,8 @@ main(int argc, char *argv[])
 
     } while (restarting);
 
+    saveTrace();
+
     delete application;
 
     return ret;
@@ -20,6 +20,8 @@
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QStorageInfo>
+#include <QThread>
+#include <QtConcurrent>
 
 #include "Athlete.h"
 #include "AthleteBackup.h"
@@ -109,6 +111,57 @@ AthleteBackup::backupImmediate()
 
 // -- private methods
 
+// a file read and compressed on the thread pool, or found to be the same
+// as the entry at index previous in the last backup
+struct BackupEntry {
+    BackupEntry() : read(false), previous(-1) {}
+    ZipWriter::CompressedFile file;
+    bool read;
+    int previous;
+};
+
+static BackupEntry
+backupFile(QString path, QString entryName, int previous, uint crc_32)
+{
+    BackupEntry entry;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return entry;
+
+    // same size as in the last backup but a different timestamp,
+    // if the contents are the same we can still copy it across
+    if (previous >= 0) {
+        if (ZipWriter::checksum(&file) == crc_32) {
+            entry.previous = previous;
+            return entry;
+        }
+        file.seek(0);
+    }
+
+    // store files that don't compress (media, archives) as they are
+    entry.file = ZipWriter::compressFile(entryName, &file, ZipWriter::AutoCompress);
+    entry.read = true;
+    return entry;
+}
+
+static ZipWriter::CompressedFile
+previousEntry(ZipReader *previous, const QList<ZipReader::FileInfo> &info, int index)
+{
+    ZipWriter::CompressedFile file;
+    file.fileName = info[index].filePath;
+    file.data = previous->rawFileData(index, &file.deflated);
+    file.crc_32 = info[index].crc_32;
+    file.size = info[index].size;
+    file.lastModified = info[index].lastModified;
+    return file;
+}
+
+static void
+writeBackupEntry(ZipWriter &writer, ZipReader *previous, const QList<ZipReader::FileInfo> &info, const BackupEntry &entry)
+{
+    if (entry.previous >= 0) writer.addCompressedFile(previousEntry(previous, info, entry.previous));
+    else if (entry.read) writer.addCompressedFile(entry.file);
+}
+
 bool
 AthleteBackup::backup(QString progressText)
 {
@@ -163,33 +216,104 @@ AthleteBackup::backup(QString progressText)
         return false;
     }
     zipFile.close();
+
+    // the most recent backup for this athlete, unchanged files are
+    // copied from it as they are instead of being compressed again
+    QScopedPointer<ZipReader> previous;
+    QList<ZipReader::FileInfo> previousInfo;
+    QHash<QString, int> previousEntries;
+    QRegExp backupName(QString("GC_\\d+_%1_\\d{4}_\\d{2}_\\d{2}_\\d{2}_\\d{2}_\\d{2}\\.zip").arg(QRegExp::escape(athlete)));
+    foreach (QFileInfo backup, QDir(backupFolder).entryInfoList(QStringList() << "GC_*.zip", QDir::Files, QDir::Time)) {
+        if (backup.fileName() != targetFileName && backupName.exactMatch(backup.fileName())) {
+            previous.reset(new ZipReader(backup.absoluteFilePath()));
+            previousInfo = previous->fileInfoList();
+            for (int i=0; i<previousInfo.count(); i++) previousEntries.insert(previousInfo[i].filePath, i);
+            break;
+        }
+    }
+
     ZipWriter writer(zipFile.fileName());
+    writer.setCompressionPolicy(ZipWriter::AutoCompress);
 
     QProgressDialog progress(tr("Adding files to backup %1 for athlete %2 ...").arg(targetFileName).arg(athlete), progressText, 0, fileCount, NULL);
     progress.setWindowModality(Qt::WindowModal);
 
-    // now do the Zipping
+    // now do the Zipping, files are read and compressed on the thread
+    // pool and written here as they complete. The compressed data is held
+    // until then, so the files in flight are limited by size as well as
+    // number, and large files (media) are streamed straight to the archive
+    const int window = qMax(2, QThread::idealThreadCount() * 2);
+    const qint64 windowBytes = 64 * 1024 * 1024;
+    const qint64 largeFile = 16 * 1024 * 1024;
+    QList<QFuture<BackupEntry> > pending;
+    QList<qint64> pendingSizes;
+    qint64 pendingBytes = 0;
     bool userCanceled = false;
     int fileCounter = 0;
     foreach (QDir folder, sourceFolderList) {
         // get all files
         writer.addDirectory(folder.dirName());
         foreach (QFileInfo fileName, folder.entryInfoList(QDir::Files | QDir::NoDotAndDotDot | QDir::NoSymLinks)) {
-            QFile file(fileName.canonicalFilePath());
-            if (file.open(QIODevice::ReadOnly)) {
-                if (progress.wasCanceled()) {
-                    userCanceled = true;
-                    break;
+
+            QString entryName = folder.dirName()+"/"+fileName.fileName();
+
+            // was it in the last backup ?
+            int index = previousEntries.value(entryName, -1);
+            uint crc_32 = 0;
+            bool unchanged = false;
+            if (index >= 0 && previousInfo[index].size == fileName.size()) {
+                // zip timestamps have a 2 second resolution
+                unchanged = qAbs(previousInfo[index].lastModified.secsTo(fileName.lastModified())) < 2;
+                crc_32 = previousInfo[index].crc_32;
+            } else {
+                index = -1;
+            }
+
+            if (unchanged) {
+                writer.addCompressedFile(previousEntry(previous.data(), previousInfo, index));
+                progress.setValue(++fileCounter);
+            } else if (fileName.size() > largeFile) {
+                QFile file(fileName.canonicalFilePath());
+                if (file.open(QIODevice::ReadOnly)) {
+                    if (index >= 0 && ZipWriter::checksum(&file) == crc_32) {
+                        writer.addCompressedFile(previousEntry(previous.data(), previousInfo, index));
+                    } else {
+                        file.seek(0);
+                        writer.addFile(entryName, &file);
+                    }
                 }
-                writer.addFile(folder.dirName()+"/"+fileName.fileName(), file.readAll());
-                progress.setValue(fileCounter);
-                fileCounter++;
-                file.close();
+                progress.setValue(++fileCounter);
+            } else {
+                pending << QtConcurrent::run(backupFile, fileName.canonicalFilePath(), entryName, index, crc_32);
+                pendingSizes << fileName.size();
+                pendingBytes += fileName.size();
+            }
+
+            // write the oldest when the window is full
+            while (pending.count() >= window || pendingBytes > windowBytes) {
+                writeBackupEntry(writer, previous.data(), previousInfo, pending.takeFirst().result());
+                pendingBytes -= pendingSizes.takeFirst();
+                progress.setValue(++fileCounter);
+            }
+
+            if (progress.wasCanceled()) {
+                userCanceled = true;
+                break;
             }
         }
         if (userCanceled) break;
     }
 
+    // and the remainder
+    while (!userCanceled && !pending.isEmpty()) {
+        writeBackupEntry(writer, previous.data(), previousInfo, pending.takeFirst().result());
+        progress.setValue(++fileCounter);
+        if (progress.wasCanceled()) userCanceled = true;
+    }
+
+    // any left are abandoned, wait so the files are closed
+    foreach (QFuture<BackupEntry> future, pending) future.waitForFinished();
+
     // final processing
     writer.close();
 
@@ -25,6 +25,7 @@
 #include "Zones.h"
 #include "WPrime.h"
 #include "Settings.h"
+#include "Utils.h"
 
 #include <QRegExp>
 #include <QTextStream>
@@ -36,6 +37,19 @@ static int csvFileReaderRegistered =
     RideFileFactory::instance().registerReader(
         "csv","Poweragent / PowerTap CSV", new CsvFileReader());
 
+// data rows are split once and fields converted in place, these have
+// the same results as line.section(',', n, n).toDouble() and .toInt()
+// without rescanning the line and copying the field for each value
+static inline double csvNumber(const QVector<QStringRef> &fields, int n)
+{
+    return (n >= 0 && n < fields.count()) ? Utils::number(fields[n]) : 0.0;
+}
+
+static inline int csvInt(const QVector<QStringRef> &fields, int n)
+{
+    return (n >= 0 && n < fields.count()) ? fields[n].toInt() : 0;
+}
+
 int static periMonth(QString month)
 {
     if (month == "jan") return 1;
@@ -621,6 +635,10 @@ RideFile *CsvFileReader::openRideFile(QFile &file, QStringList &errors, QList<Ri
                     tempType = degF;
 
             } else if (lineno > unitsHeader) {
+
+                // split the row once, the fields reference line
+                const QVector<QStringRef> fields = line.splitRef(',');
+
                 double minutes=0,nm=0,kph=0,watts=0,km=0,cad=0,alt=0,hr=0,dfpm=0, seconds=0.0;
                 double temp=RideFile::NA;
                 double slope=0.0;
@@ -642,20 +660,20 @@ RideFile *CsvFileReader::openRideFile(QFile &file, QStringList &errors, QList<Ri
                 quint64 ms;
 
                 if (csvType == powertap || csvType == joule) {
-                     minutes = line.section(',', 0, 0).toDouble();
-                     nm = line.section(',', 1, 1).toDouble();
-                     kph = line.section(',', 2, 2).toDouble();
-                     watts = line.section(',', 3, 3).toDouble();
-                     km = line.section(',', 4, 4).toDouble();
-                     cad = line.section(',', 5, 5).toDouble();
-                     hr = line.section(',', 6, 6).toDouble();
-                     interval = line.section(',', 7, 7).toInt();
-                     alt = line.section(',', 8, 8).toDouble();
+                     minutes = csvNumber(fields, 0);
+                     nm = csvNumber(fields, 1);
+                     kph = csvNumber(fields, 2);
+                     watts = csvNumber(fields, 3);
+                     km = csvNumber(fields, 4);
+                     cad = csvNumber(fields, 5);
+                     hr = csvNumber(fields, 6);
+                     interval = csvInt(fields, 7);
+                     alt = csvNumber(fields, 8);
                     if (csvType == joule && tempType != degNone) {
                         // is the position always the same?
                         // should we read the header and assign positions
                         // to each item instead?
-                        temp = line.section(',', 9, 9).toDouble();
+                        temp = csvNumber(fields, 9);
                         if (tempType == degF) {
                            // convert to deg C
                            temp *= FAHRENHEIT_PER_CENTIGRADE + FAHRENHEIT_ADD_CENTIGRADE;
@@ -670,37 +688,37 @@ RideFile *CsvFileReader::openRideFile(QFile &file, QStringList &errors, QList<Ri
                 } else if (csvType == gc) {
                     // GoldenCheetah CVS Format "secs, cad, hr, km, kph, nm, watts, alt, lon, lat, headwind, slope, temp, interval, lrbalance, lte, rte, lps, rps, smo2, thb, o2hb, hhb\n";
 
-                    seconds = line.section(',', 0, 0).toDouble();
+                    seconds = csvNumber(fields, 0);
                     minutes = seconds / 60.0f;
-                    cad = line.section(',', 1, 1).toDouble();
-                    hr = line.section(',', 2, 2).toDouble();
-                    km = line.section(',', 3, 3).toDouble();
-                    kph = line.section(',', 4, 4).toDouble();
-                    nm = line.section(',', 5, 5).toDouble();
-                    watts = line.section(',', 6, 6).toDouble();
-                    alt = line.section(',', 7, 7).toDouble();
-                    lon = line.section(',', 8, 8).toDouble();
-                    lat = line.section(',', 9, 9).toDouble();
-                    headwind = line.section(',', 10, 10).toDouble();
-                    slope = line.section(',', 11, 11).toDouble();
-                    temp = line.section(',', 12, 12)=="" ? double(RideFile::NA) : line.section(',', 12, 12).toDouble();
-                    interval = line.section(',', 13, 13).toInt();
-                    lrbalance = line.section(',', 14, 14).toDouble();
-                    lte = line.section(',', 15, 15).toDouble();
-                    rte = line.section(',', 16, 16).toDouble();
-                    lps = line.section(',', 17, 17).toDouble();
-                    rps = line.section(',', 18, 18).toDouble();
-                    smo2 = line.section(',', 19, 19).toDouble();
-                    thb = line.section(',', 20, 20).toDouble();
-                    //UNUSED o2hb = line.section(',', 21, 21).toDouble();
-                    //UNUSED hhb = line.section(',', 22, 22).toDouble();
-                    target = line.section(',', 23, 23).toInt();
+                    cad = csvNumber(fields, 1);
+                    hr = csvNumber(fields, 2);
+                    km = csvNumber(fields, 3);
+                    kph = csvNumber(fields, 4);
+                    nm = csvNumber(fields, 5);
+                    watts = csvNumber(fields, 6);
+                    alt = csvNumber(fields, 7);
+                    lon = csvNumber(fields, 8);
+                    lat = csvNumber(fields, 9);
+                    headwind = csvNumber(fields, 10);
+                    slope = csvNumber(fields, 11);
+                    temp = fields.value(12).isEmpty() ? double(RideFile::NA) : csvNumber(fields, 12);
+                    interval = csvInt(fields, 13);
+                    lrbalance = csvNumber(fields, 14);
+                    lte = csvNumber(fields, 15);
+                    rte = csvNumber(fields, 16);
+                    lps = csvNumber(fields, 17);
+                    rps = csvNumber(fields, 18);
+                    smo2 = csvNumber(fields, 19);
+                    thb = csvNumber(fields, 20);
+                    //UNUSED o2hb = csvNumber(fields, 21);
+                    //UNUSED hhb = csvNumber(fields, 22);
+                    target = csvInt(fields, 23);
 
                 } else if (csvType == peripedal) {
 
                     //mm-dd,hh:mm:ss,SmO2 Live,SmO2 Averaged,THb,Target Power,Heart Rate,Speed,Power,Cadence
                     // ignore lines with wrong number of entries
-                    if (line.split(",").count() != 10) continue;
+                    if (fields.count() != 10) continue;
 
                     seconds = moxySeconds(line.section(',',1,1));
                     minutes = seconds / 60.0f;
@@ -711,17 +729,17 @@ RideFile *CsvFileReader::openRideFile(QFile &file, QStringList &errors, QList<Ri
                         startTime = QDateTime(date,time);
                     }
 
-                    double aSmo2 = line.section(',', 3, 3).toDouble();
-                    smo2 = line.section(',', 2, 2).toDouble();
+                    double aSmo2 = csvNumber(fields, 3);
+                    smo2 = csvNumber(fields, 2);
 
                     // use average if live not available
                     if (aSmo2 && !smo2) smo2 = aSmo2;
 
-                    thb = line.section(',', 4, 4).toDouble();
-                    hr = line.section(',', 6, 6).toDouble();
-                    kph = line.section(',', 7, 7).toDouble();
-                    watts = line.section(',', 8, 8).toDouble();
-                    cad = line.section(',', 10, 10).toDouble();
+                    thb = csvNumber(fields, 4);
+                    hr = csvNumber(fields, 6);
+                    kph = csvNumber(fields, 7);
+                    watts = csvNumber(fields, 8);
+                    cad = csvNumber(fields, 10);
 
                     // dervice distance from speed
                     km = lastKM + (kph/3600.0f);
@@ -760,11 +778,11 @@ RideFile *CsvFileReader::openRideFile(QFile &file, QStringList &errors, QList<Ri
                     int min = timestampRegEx.cap(1).toInt();
                     minutes = (double(min) + double(sec)/60.0f);
 
-                    cad = line.section(',', 5, 5).toDouble();
-                    hr = line.section(',', 4, 4).toDouble();
-                    km = line.section(',', 1, 1).toDouble();
-                    kph = line.section(',', 2, 2).toDouble();
-                    watts = line.section(',', 3, 3).toDouble();
+                    cad = csvNumber(fields, 5);
+                    hr = csvNumber(fields, 4);
+                    km = csvNumber(fields, 1);
+                    kph = csvNumber(fields, 2);
+                    watts = csvNumber(fields, 3);
 
                     if (!metric) {
                         km *= KM_PER_MILE;
@@ -785,35 +803,35 @@ RideFile *CsvFileReader::openRideFile(QFile &file, QStringList &errors, QList<Ri
                          minutes = startTime.secsTo(QDateTime::fromString(timestamp, Qt::ISODate))/60.0;
                      }
                      nm = 0; //no torque
-                     kph = line.section(',', 0, 0).toDouble();
-                     dfpm = line.section( ',', 11, 11).toDouble();
-                     headwind = line.section(',', 1, 1).toDouble();
-                     km = line.section(',', 3, 3).toDouble();
+                     kph = csvNumber(fields, 0);
+                     dfpm = csvNumber(fields, 11);
+                     headwind = csvNumber(fields, 1);
+                     km = csvNumber(fields, 3);
 
                      if( iBikeVersion >= 11 && ( dfpm > 0.0 || dfpmExists ) ) {
                          dfpmExists = true;
                          watts = dfpm;
                      }
                      else {
-                         watts = line.section(',', 2, 2).toDouble();
+                         watts = csvNumber(fields, 2);
                      }
                      XDataPoint *p = new XDataPoint();
                      p->secs = minutes*60.0;
                      p->km = km;
-                     p->number[0] = line.section(',', 2, 2).toDouble();  // CALC-POWER
-                     p->number[1] = line.section(',', 17, 17).toDouble();  // Rho
+                     p->number[0] = csvNumber(fields, 2);  // CALC-POWER
+                     p->number[1] = csvNumber(fields, 17);  // Rho
                      ibikeSeries->datapoints.append(p);
 
-                     cad = line.section(',', 4, 4).toDouble();
-                     hr = line.section(',', 5, 5).toDouble();
-                     alt = line.section(',', 6, 6).toDouble();
-                     slope = line.section(',', 7, 7).toDouble();
-                     temp = line.section(',', 8, 8).toDouble();
-                     lat = line.section(',', 12, 12).toDouble();
-                     lon = line.section(',', 13, 13).toDouble();
+                     cad = csvNumber(fields, 4);
+                     hr = csvNumber(fields, 5);
+                     alt = csvNumber(fields, 6);
+                     slope = csvNumber(fields, 7);
+                     temp = csvNumber(fields, 8);
+                     lat = csvNumber(fields, 12);
+                     lon = csvNumber(fields, 13);
 
 
-                     int lap = line.section(',', 9, 9).toInt();
+                     int lap = csvInt(fields, 9);
                      if (lap > 0) {
                          iBikeInterval += 1;
                          interval = iBikeInterval;
@@ -831,15 +849,15 @@ RideFile *CsvFileReader::openRideFile(QFile &file, QStringList &errors, QList<Ri
                 } else if (csvType == xtrain) {
                     // this must be xtrain
                     // ignore lines with wrong number of entries
-                    if (line.split(",").count() != 6) continue;
+                    if (fields.count() != 6) continue;
 
                     minutes = (recInterval * lineno - unitsHeader)/60.0;
                     nm = 0; //no torque
-                    hr = line.section(',', 1, 1).toDouble();
-                    cad = line.section(',', 2, 2).toDouble();
-                    watts = line.section(',', 3, 3).toDouble();
-                    slope = line.section(',', 4, 4).toDouble()/10;
-                    kph = line.section(',', 5, 5).toDouble();
+                    hr = csvNumber(fields, 1);
+                    cad = csvNumber(fields, 2);
+                    watts = csvNumber(fields, 3);
+                    slope = csvNumber(fields, 4)/10;
+                    kph = csvNumber(fields, 5);
 
                     // derive distance from speed
                     km = lastKM + (kph/3600.0f);
@@ -874,7 +892,7 @@ RideFile *CsvFileReader::openRideFile(QFile &file, QStringList &errors, QList<Ri
                 }
                 else if (csvType == bsx || csvType == wahooMA)  {
                     if (secsIndex > -1) {
-                        seconds = line.section(',', secsIndex, secsIndex).toDouble();
+                        seconds = csvNumber(fields, secsIndex);
 
                         QDateTime time;
 
@@ -894,25 +912,25 @@ RideFile *CsvFileReader::openRideFile(QFile &file, QStringList &errors, QList<Ri
                     }
 
                     if (wattsIndex > -1) {
-                        watts = line.section(',', wattsIndex, wattsIndex).toDouble();
+                        watts = csvNumber(fields, wattsIndex);
                     }
                     if (cadenceIndex > -1) {
-                        cad = line.section(',', cadenceIndex, cadenceIndex).toDouble();
+                        cad = csvNumber(fields, cadenceIndex);
                     }
                     if (hrIndex > -1) {
-                        hr = line.section(',', hrIndex, hrIndex).toDouble();
+                        hr = csvNumber(fields, hrIndex);
                     }
                     if (smo2Index > -1) {
-                        smo2 = line.section(',', smo2Index, smo2Index).toDouble();
+                        smo2 = csvNumber(fields, smo2Index);
                     }
                     if (gctIndex > -1) {
-                        gct = line.section(',', gctIndex, gctIndex).toDouble();
+                        gct = csvNumber(fields, gctIndex);
                     }
                     if (voIndex > -1) {
-                        vo = line.section(',', voIndex, voIndex).toDouble();
+                        vo = csvNumber(fields, voIndex);
                     }
                     if (kphIndex > -1) {
-                        kph = line.section(',', kphIndex, kphIndex).toDouble() * 3.6f; // running speed is given in m/s, convert to km/h
+                        kph = csvNumber(fields, kphIndex) * 3.6f; // running speed is given in m/s, convert to km/h
                         if (!metric) {
                            kph *= KM_PER_MILE;
                         }
@@ -967,7 +985,7 @@ RideFile *CsvFileReader::openRideFile(QFile &file, QStringList &errors, QList<Ri
                      kph = kph_string.toDouble();
                      hr = line.section(ergomo_separator, 5, 5).toDouble();
                      alt = line.section(ergomo_separator, 6, 6).toDouble();
-                     interval = line.section(',', 8, 8).toInt();
+                     interval = csvInt(fields, 8);
                      if (interval != prevInterval) {
                          prevInterval = interval;
                          if (interval != 0) currentInterval++;
@@ -990,14 +1008,14 @@ RideFile *CsvFileReader::openRideFile(QFile &file, QStringList &errors, QList<Ri
                      }
                 } else if (csvType == cpexport) {
                     // seconds, value, (model), date
-                    seconds = line.section(',',0,0).toDouble();
+                    seconds = csvNumber(fields, 0);
                     if (seconds == precSecs)
                         continue;
                     minutes = seconds / 60.0f;
 
 
                     //seconds = lineno -1 ;
-                    double avgWatts = line.section(',', 1, 1).toDouble();
+                    double avgWatts = csvNumber(fields, 1);
                     if ( avgWatts > maxWatts ) {
                         maxWatts = avgWatts;
                     }
@@ -1037,20 +1055,20 @@ RideFile *CsvFileReader::openRideFile(QFile &file, QStringList &errors, QList<Ri
                         unitsHeader = lineno + 1000;
                         continue;
                     }
-                    seconds = line.section(',', 0, 0).toDouble() / 1000;
+                    seconds = csvNumber(fields, 0) / 1000;
                     minutes = seconds / 60.0f;
-                    km = line.section(',', 1, 1).toDouble() / 1000;
-                    double pace = line.section(',', 2, 2).toDouble();
+                    km = csvNumber(fields, 1) / 1000;
+                    double pace = csvNumber(fields, 2);
                     if (pace > 0 ) {
                         kph = 3.6 / pace;
                     }
-                    watts = line.section(',', 3, 3).toDouble();
-                    cad = line.section(',', 5, 5).toDouble();
-                    hr = line.section(',', 6, 6).toDouble();
+                    watts = csvNumber(fields, 3);
+                    cad = csvNumber(fields, 5);
+                    hr = csvNumber(fields, 6);
 
                } else {
                     if (secsIndex > -1) {
-                        seconds = line.section(',', secsIndex, secsIndex).toDouble();
+                        seconds = csvNumber(fields, secsIndex);
                         minutes = seconds / 60.0f;
                      }
                 }
@@ -1183,13 +1201,12 @@ RideFile *CsvFileReader::openRideFile(QFile &file, QStringList &errors, QList<Ri
                        }
                    } else if (xdataSeries != NULL) {
 
-                       QStringList els = line.split(",", QString::KeepEmptyParts);
-                       if (els.count() != xdataSeries->valuename.count()+2) continue;
+                       if (fields.count() != xdataSeries->valuename.count()+2) continue;
                        // add ALL data series to XDATA
                        XDataPoint *p = new XDataPoint();
-                       p->secs = els[0].toDouble();
-                       p->km = els[1].toDouble();
-                       for(int i=2; i<els.count(); i++) p->number[i-2] = els[i].toDouble();
+                       p->secs = csvNumber(fields, 0);
+                       p->km = csvNumber(fields, 1);
+                       for(int i=2; i<fields.count(); i++) p->number[i-2] = csvNumber(fields, i);
                        xdataSeries->datapoints.append(p);
 
                        // only time and distance as standard series
@@ -1207,12 +1224,12 @@ RideFile *CsvFileReader::openRideFile(QFile &file, QStringList &errors, QList<Ri
                } else if (csvType == opendata) {
 
                     // secs,km,power,hr,cad,alt
-                    double secs = line.section(',', 0, 0).toDouble();
-                    km = line.section(',', 1, 1).toDouble();
-                    watts = line.section(',', 2, 2).toDouble();
-                    hr = line.section(',', 3, 3).toDouble();
-                    cad = line.section(',', 4, 4).toDouble();
-                    alt = line.section(',', 5, 5).toDouble();
+                    double secs = csvNumber(fields, 0);
+                    km = csvNumber(fields, 1);
+                    watts = csvNumber(fields, 2);
+                    hr = csvNumber(fields, 3);
+                    cad = csvNumber(fields, 4);
+                    alt = csvNumber(fields, 5);
                     kph = (km - lastkm) / (secs-lastsecs) * 3600;
 
                     // for next time
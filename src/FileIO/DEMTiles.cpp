@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "DEMTiles.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+
+const double DEMTiles::NODATA = -32768;
+
+static const qint16 HGTVOID = -32768;
+
+static int tileKey(int lat, int lon) { return (lat + 90) * 360 + (lon + 180); }
+
+// used to sort the samples so each tile is visited once
+struct DEMTileOrder {
+    DEMTileOrder(const QVector<int> &keys) : keys(keys) {}
+    bool operator()(int a, int b) const { return keys[a] < keys[b]; }
+    const QVector<int> &keys;
+};
+
+DEMTiles::DEMTiles(QString directory, int maxTiles) : dir(directory), maxTiles(maxTiles)
+{
+}
+
+DEMTiles::~DEMTiles()
+{
+    foreach(Tile *t, tiles) close(t);
+}
+
+DEMTiles *
+DEMTiles::instance(QString directory)
+{
+    static QMutex instanceLock;
+    static QHash<QString, DEMTiles*> shared;
+
+    // never deleted, another thread may still be using the last directory
+    QMutexLocker locker(&instanceLock);
+    DEMTiles *tiles = shared.value(directory, NULL);
+    if (!tiles) {
+        tiles = new DEMTiles(directory);
+        shared.insert(directory, tiles);
+    }
+    return tiles;
+}
+
+bool
+DEMTiles::isValid() const
+{
+    return dir != "" && QDir(dir).exists();
+}
+
+void
+DEMTiles::close(Tile *t)
+{
+    t->file->unmap(const_cast<uchar*>(t->data));
+    t->file->close();
+    delete t->file;
+    delete t;
+}
+
+DEMTiles::Tile *
+DEMTiles::tile(int lat, int lon)
+{
+    int key = tileKey(lat, lon);
+
+    // already open
+    Tile *open = tiles.value(key, NULL);
+    if (open) {
+        used.removeOne(key);
+        used.append(key);
+        return open;
+    }
+
+    QString name = QString("%1%2%3%4.hgt").arg(lat >= 0 ? 'N' : 'S')
+                                          .arg(qAbs(lat), 2, 10, QChar('0'))
+                                          .arg(lon >= 0 ? 'E' : 'W')
+                                          .arg(qAbs(lon), 3, 10, QChar('0'));
+
+    QString path = QDir(dir).absoluteFilePath(name);
+    if (!QFileInfo(path).exists()) path = QDir(dir).absoluteFilePath(name.toLower());
+
+    // must be a square grid of 16 bit samples, missing tiles are not
+    // remembered so they can be downloaded while GoldenCheetah is running
+    QFile *file = new QFile(path);
+    qint64 bytes = file->size();
+    int size = sqrt(double(bytes / 2));
+
+    const uchar *data = NULL;
+    if (size > 1 && qint64(size) * size * 2 == bytes && file->open(QIODevice::ReadOnly))
+        data = file->map(0, bytes);
+
+    if (data == NULL) {
+        delete file;
+        return NULL;
+    }
+
+    // drop the least recently used
+    if (used.count() >= maxTiles) {
+        int oldest = used.takeFirst();
+        close(tiles.value(oldest));
+        tiles.remove(oldest);
+    }
+
+    Tile *t = new Tile;
+    t->file = file;
+    t->data = data;
+    t->size = size;
+
+    tiles.insert(key, t);
+    used.append(key);
+    return t;
+}
+
+double
+DEMTiles::height(const Tile *t, double lat, double lon) const
+{
+    const int n = t->size;
+
+    // row 0 is the northern edge of the tile
+    double row = (floor(lat) + 1.0 - lat) * (n - 1);
+    double col = (lon - floor(lon)) * (n - 1);
+
+    int r = qBound(0, int(row), n - 2);
+    int c = qBound(0, int(col), n - 2);
+    double fr = row - r;
+    double fc = col - c;
+
+    const uchar *p = t->data + 2 * (qint64(r) * n + c);
+    qint16 h[4] = { qFromBigEndian<qint16>(p), qFromBigEndian<qint16>(p + 2),
+                    qFromBigEndian<qint16>(p + 2*n), qFromBigEndian<qint16>(p + 2*n + 2) };
+    double w[4] = { (1-fr) * (1-fc), (1-fr) * fc, fr * (1-fc), fr * fc };
+
+    // voids are left out and the remaining weights rescaled
+    double sum = 0, weight = 0, plain = 0;
+    int count = 0;
+    for (int i=0; i<4; i++) {
+        if (h[i] == HGTVOID) continue;
+        sum += w[i] * h[i];
+        weight += w[i];
+        plain += h[i];
+        count++;
+    }
+
+    if (count == 0) return NODATA;
+    if (weight <= 0) return plain / count;
+    return sum / weight;
+}
+
+void
+DEMTiles::elevations(const QVector<double> &lat, const QVector<double> &lon, QVector<double> &alt)
+{
+    const int n = qMin(lat.count(), lon.count());
+    alt.fill(NODATA, n);
+    if (n == 0 || !isValid()) return;
+
+    // visit the samples tile by tile, a ride crossing a tile boundary
+    // back and forth would otherwise keep swapping tiles
+    QVector<int> keys(n), order(n);
+    for (int i=0; i<n; i++) {
+        order[i] = i;
+        if (lat[i] < -90 || lat[i] >= 90 || lon[i] < -180 || lon[i] >= 180) keys[i] = -1;
+        else keys[i] = tileKey(floor(lat[i]), floor(lon[i]));
+    }
+    std::stable_sort(order.begin(), order.end(), DEMTileOrder(keys));
+
+    QMutexLocker locker(&lock);
+
+    Tile *t = NULL;
+    int current = -2;
+    for (int k=0; k<n; k++) {
+
+        int i = order[k];
+        if (keys[i] == -1) continue;
+
+        if (keys[i] != current) {
+            current = keys[i];
+            t = tile(floor(lat[i]), floor(lon[i]));
+        }
+        if (t) alt[i] = height(t, lat[i], lon[i]);
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_DEMTiles_h
+#define _GC_DEMTiles_h 1
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+
+class QFile;
+
+//
+// Elevation lookup from a directory of SRTM height tiles (.hgt).
+//
+// Each tile covers one degree square and is named after its south west
+// corner e.g. N52E000.hgt or S34W071.hgt. The file is a grid of big
+// endian signed 16 bit heights in metres, 1201x1201 (3 arc second) or
+// 3601x3601 (1 arc second), north row first, with -32768 marking voids.
+//
+// Tiles are memory mapped, not read, and the most recently used ones
+// are kept open so a batch of rides in the same area only maps each
+// tile once.
+//
+class DEMTiles
+{
+    public:
+
+        static const double NODATA;
+
+        DEMTiles(QString directory, int maxTiles=16);
+        ~DEMTiles();
+
+        // shared instance for the directory, one per directory and kept
+        // for the life of the application
+        static DEMTiles *instance(QString directory);
+
+        bool isValid() const;
+        QString directory() const { return dir; }
+
+        // bilinear interpolated heights for all the points, NODATA where
+        // there is no tile or all the surrounding heights are voids
+        void elevations(const QVector<double> &lat, const QVector<double> &lon, QVector<double> &alt);
+
+    private:
+
+        struct Tile {
+            QFile *file;
+            const uchar *data;
+            int size;           // samples per row (and rows)
+        };
+
+        Tile *tile(int lat, int lon);
+        double height(const Tile *t, double lat, double lon) const;
+        void close(Tile *t);
+
+        QString dir;
+        int maxTiles;
+
+        QMutex lock;
+        QHash<int, Tile*> tiles;     // keyed on south west corner
+        QList<int> used;             // least recently used first
+};
+
+#endif
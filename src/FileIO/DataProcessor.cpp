@@ -17,8 +17,16 @@
  */
 
 #include <QApplication>
+#include <QProgressDialog>
+#include <QCheckBox>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <QMetaProperty>
 #include "DataProcessor.h"
 #include "Context.h"
+#include "Athlete.h"
+#include "RideCache.h"
+#include "JsonRideFile.h"
 #include "AllPlot.h"
 #include "Settings.h"
 #include "Units.h"
@@ -28,6 +36,24 @@
 #include "FixPySettings.h"
 #endif
 
+QVariant
+DataProcessorConfig::value(QWidget *widget) const
+{
+    // the spin box value, check box state, line edit text etc
+    if (values.contains(widget)) return values.value(widget);
+    return widget->metaObject()->userProperty().read(widget);
+}
+
+void
+DataProcessorConfig::freeze()
+{
+    values.clear();
+    foreach(QWidget *widget, findChildren<QWidget*>()) {
+        QMetaProperty user = widget->metaObject()->userProperty();
+        if (user.isValid()) values.insert(widget, user.read(widget));
+    }
+}
+
 DataProcessorFactory *DataProcessorFactory::instance_;
 DataProcessorFactory &DataProcessorFactory::instance()
 {
@@ -109,6 +135,185 @@ DataProcessorFactory::autoProcess(RideFile *ride, QString mode, QString op)
     return changed;
 }
 
+// a ride being batch processed, the RideItem isn't touched so
+// they can be opened, processed and saved on worker threads
+struct BatchRide {
+    Context *context;
+    QString path, fileName; // updated if converted to .json
+    QList<DataProcessor*> processors;
+    QList<DataProcessorConfig*> configs;
+    QString op, log;
+    bool changed;
+    QStringList failed; // why it could not be opened, processed or saved
+};
+
+void
+DataProcessorFactory::failure(const RideFile *ride, QString message)
+{
+    QMutexLocker locker(&failuresLock);
+    failures[ride] << message;
+}
+
+QStringList
+DataProcessorFactory::takeFailures(const RideFile *ride)
+{
+    QMutexLocker locker(&failuresLock);
+    return failures.take(ride);
+}
+
+static void
+batchProcessRide(BatchRide &batch)
+{
+    QFile file(batch.path + "/" + batch.fileName);
+    QStringList errors;
+    RideFile *ride = RideFileFactory::instance().openRideFile(batch.context, file, errors);
+    if (!ride) {
+        batch.failed << (errors.count() ? errors.join("; ") : QString("cannot open"));
+        return;
+    }
+
+    // its saved straight away, so no undo
+    ride->command->setHistory(false);
+
+    // run them all in one pass
+    QString applied;
+    for (int i=0; i<batch.processors.count(); i++) {
+        DataProcessor *processor = batch.processors[i];
+        if (processor->postProcess(ride, batch.configs.value(i, NULL), batch.op))
+            applied += processor->name() + '\n';
+    }
+    batch.failed << DataProcessorFactory::instance().takeFailures(ride);
+
+    if (applied != "") {
+
+        // same as a save; on save processors and the change history
+        DataProcessorFactory::instance().autoProcess(ride, "Save", "UPDATE");
+        ride->setTag("Change History", ride->getTag("Change History", "") + batch.log + '\n' + applied);
+
+        // save in GC format, keeping the original if it isn't one
+        QFileInfo currentFI(file);
+        bool convert = (currentFI.completeSuffix().toUpper() != "JSON");
+        QFile savedFile(convert ? currentFI.canonicalPath() + "/" + currentFI.baseName() + ".json" : file.fileName());
+
+        JsonFileReader reader;
+        if (reader.writeRideFile(batch.context, ride, savedFile)) {
+            if (convert) {
+                QFile::remove(file.fileName()+".bak"); // ignore errors if not there
+                file.rename(file.fileName(), file.fileName() + ".bak");
+                batch.path = QFileInfo(savedFile).canonicalPath();
+                batch.fileName = QFileInfo(savedFile).fileName();
+            }
+            batch.changed = true;
+        } else {
+            batch.failed << QString("cannot save %1").arg(savedFile.fileName());
+        }
+    }
+    delete ride;
+}
+
+int
+DataProcessorFactory::batchProcess(Context *context, QList<RideItem*> rides, QList<DataProcessor*> processors,
+                                   QList<DataProcessorConfig*> configs, QString op, QProgressDialog *progress,
+                                   QStringList *failed)
+{
+    if (processors.isEmpty()) return 0;
+
+    int changed = 0;
+    QString log = tr("Changes on ") + QDateTime::currentDateTime().toString() + ":";
+
+    // rides that are open may have unsaved changes and are in use, so
+    // they are processed in memory (with undo) and left for the user to save
+    QList<BatchRide> batch;
+    QList<RideItem*> batchItems;
+    foreach (RideItem *item, rides) {
+
+        if (item->isOpen()) {
+
+            bool dirty = false;
+            for (int i=0; i<processors.count(); i++)
+                dirty |= processors[i]->postProcess(item->ride(), configs.value(i, NULL), op);
+            if (dirty) {
+                item->setDirty(true);
+                changed++;
+            }
+            foreach(QString why, takeFailures(item->ride()))
+                if (failed) *failed << QString("%1: %2").arg(item->fileName).arg(why);
+
+        } else {
+
+            BatchRide add;
+            add.context = context;
+            add.path = item->path;
+            add.fileName = item->fileName;
+            add.processors = processors;
+            add.configs = configs;
+            add.op = op;
+            add.log = log;
+            add.changed = false;
+            batch << add;
+            batchItems << item;
+        }
+    }
+
+    // the rest are done on the thread pool, one ride per thread so
+    // memory is bounded, unless a processor can only run here, including
+    // those that run automatically on save
+    bool parallel = true;
+    foreach (DataProcessor *processor, processors) parallel &= processor->isThreadSafe();
+
+    QMapIterator<QString, DataProcessor*> i(this->processors);
+    while (i.hasNext()) {
+        i.next();
+        QString configsetting = QString("dp/%1/apply").arg(i.key());
+        if (appsettings->value(NULL, GC_QSETTINGS_GLOBAL_GENERAL+configsetting, "Manual").toString() == "Save")
+            parallel &= i.value()->isThreadSafe();
+    }
+
+    // the workers don't read the config widgets
+    foreach(DataProcessorConfig *config, configs) if (config) config->freeze();
+
+    if (progress) progress->setRange(0, batch.count());
+    if (parallel) {
+
+        QFuture<void> future = QtConcurrent::map(batch, batchProcessRide);
+        if (progress) {
+            QFutureWatcher<void> watcher;
+            QObject::connect(&watcher, SIGNAL(finished()), progress, SLOT(reset()));
+            QObject::connect(&watcher, SIGNAL(progressValueChanged(int)), progress, SLOT(setValue(int)));
+            QObject::connect(progress, SIGNAL(canceled()), &watcher, SLOT(cancel()));
+            watcher.setFuture(future);
+            progress->exec();
+        }
+        future.waitForFinished();
+
+    } else {
+
+        for (int i=0; i<batch.count(); i++) {
+            if (progress) {
+                progress->setValue(i);
+                if (progress->wasCanceled()) break;
+            }
+            batchProcessRide(batch[i]);
+        }
+        if (progress) progress->reset();
+    }
+    foreach(DataProcessorConfig *config, configs) if (config) config->thaw();
+
+    // point the ride cache at the saved files and refresh their metrics
+    for (int i=0; i<batch.count(); i++) {
+        foreach(QString why, batch[i].failed)
+            if (failed) *failed << QString("%1: %2").arg(batch[i].fileName).arg(why);
+        if (batch[i].changed) {
+            batchItems[i]->setFileName(batch[i].path, batch[i].fileName);
+            batchItems[i]->isstale = true;
+            changed++;
+        }
+    }
+    if (changed) context->athlete->rideCache->refresh();
+
+    return changed;
+}
+
 ManualDataProcessorDialog::ManualDataProcessorDialog(Context *context, QString name, RideItem *ride) : context(context), ride(ride)
 {
     setAttribute(Qt::WA_DeleteOnClose);
@@ -140,10 +345,14 @@ ManualDataProcessorDialog::ManualDataProcessorDialog(Context *context, QString n
     explain->setText(config->explain());
     explain->setReadOnly(true);
 
+    // batch mode
+    all = new QCheckBox(tr("Apply to all activities"), this);
+
     mainLayout->addWidget(configLabel);
     mainLayout->addWidget(config);
     mainLayout->addWidget(explainLabel);
     mainLayout->addWidget(explain);
+    mainLayout->addWidget(all);
 
     ok = new QPushButton(tr("OK"), this);
     cancel = new QPushButton(tr("Cancel"), this);
@@ -165,14 +374,29 @@ ManualDataProcessorDialog::okClicked()
     ok->setEnabled(false);
     cancel->setEnabled(false);
 
-    QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+    if (all->isChecked()) {
 
-    if (ride && ride->ride() && processor->postProcess((RideFile *)ride->ride(), config, "UPDATE") == true) {
-        context->notifyRideSelected(ride);     // to remain compatible with rest of GC for now
-    }
+        // every activity is opened, processed and saved
+        QList<RideItem*> rides = context->athlete->rideCache->rides().toList();
+        QProgressDialog progress(tr("Processing activities ..."), tr("Abort"), 0, rides.count(), this);
+        progress.setWindowModality(Qt::WindowModal);
+
+        DataProcessorFactory::instance().batchProcess(context, rides, QList<DataProcessor*>() << processor,
+                                                      QList<DataProcessorConfig*>() << config, "UPDATE", &progress);
 
-    // reset cursor and wait
-    QApplication::restoreOverrideCursor();
+        if (ride) context->notifyRideSelected(ride);
+
+    } else {
+
+        QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+
+        if (ride && ride->ride() && processor->postProcess((RideFile *)ride->ride(), config, "UPDATE") == true) {
+            context->notifyRideSelected(ride);     // to remain compatible with rest of GC for now
+        }
+
+        // reset cursor and wait
+        QApplication::restoreOverrideCursor();
+    }
 
     // and we're done
     accept();
@@ -35,6 +35,9 @@
 #include <QTextEdit>
 #include <QLineEdit>
 #include <QMap>
+#include <QHash>
+#include <QMutex>
+#include <QVariant>
 #include <QVector>
 
 // This file defines four classes:
@@ -50,7 +53,8 @@
 // all DataProcessor objects that can be applied to rideFiles
 //
 // ManualDataProcessorDialog is a dialog box to manually execute a
-// dataprocessor on the current ride and is called from the mainWindow menus
+// dataprocessor on the current ride, or all rides, and is called from
+// the mainWindow menus
 //
 
 // every data processor must supply a configuration Widget
@@ -67,6 +71,16 @@ class DataProcessorConfig : public QWidget
         virtual void readConfig() = 0;
         virtual void saveConfig() = 0;
         virtual QString explain() = 0;
+
+        // the value a settings widget shows, processors read them this way
+        // since batch processing runs them on worker threads: freeze() takes
+        // the values on the gui thread first, thaw() goes back to the widgets
+        QVariant value(QWidget *widget) const;
+        void freeze();
+        void thaw() { values.clear(); }
+
+    private:
+        QHash<const QWidget*, QVariant> values;
 };
 
 // the data processor abstract base class
@@ -79,11 +93,19 @@ class DataProcessor
         virtual DataProcessorConfig *processorConfig(QWidget *parent, const RideFile* ride = NULL) = 0;
         virtual QString name() = 0; // Localized Name for user interface
         virtual bool isCoreProcessor() { return true; }
+        // can run on worker threads when batch processing, core processors
+        // that use the context, the GUI or shared state must override this
+        virtual bool isThreadSafe() { return isCoreProcessor(); }
 };
 
+class Context;
+class QProgressDialog;
+
 // all data processors
 class DataProcessorFactory {
 
+    Q_DECLARE_TR_FUNCTIONS(DataProcessorFactory)
+
     private:
 
         static DataProcessorFactory *instance_;
@@ -91,6 +113,9 @@ class DataProcessorFactory {
         QMap<QString,DataProcessor*> processors;
         DataProcessorFactory() {}
 
+        QMutex failuresLock;
+        QHash<const RideFile*, QStringList> failures;
+
 
     public:
 
@@ -100,10 +125,24 @@ class DataProcessorFactory {
         void unregisterProcessor(QString name);
         QMap<QString,DataProcessor*> getProcessors(bool coreProcessorsOnly = false) const;
         bool autoProcess(RideFile *, QString mode, QString op); // run auto processes (after open rideFile)
+
+        // run processors over many rides, each is opened, processed and saved once
+        // on the thread pool, configs are optional (NULL uses the settings)
+        // returns the number of rides changed, their metrics are refreshed.
+        // Rides that could not be opened, saved or processed are added to failed
+        int batchProcess(Context *, QList<RideItem*> rides, QList<DataProcessor*> processors,
+                         QList<DataProcessorConfig*> configs = QList<DataProcessorConfig*>(),
+                         QString op = "UPDATE", QProgressDialog *progress = NULL,
+                         QStringList *failed = NULL);
+
+        // a processor that fails with no main window to tell the user (--batch)
+        // reports it here instead, batchProcess collects them for each ride
+        void failure(const RideFile *ride, QString message);
+        QStringList takeFailures(const RideFile *ride);
         void setAutoProcessRule(bool b) { autoprocess = b; } // allows to switch autoprocess off (e.g. for Upgrades)
 };
 
-class Context;
+class QCheckBox;
 class ManualDataProcessorDialog : public QDialog
 {
     Q_OBJECT
@@ -124,6 +163,7 @@ class ManualDataProcessorDialog : public QDialog
         DataProcessor *processor;
         DataProcessorConfig *config;
         QTextEdit *explain;
+        QCheckBox *all;
         QPushButton *ok, *cancel;
 };
 #endif // _DataProcessor_h
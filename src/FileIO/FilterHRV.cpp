@@ -23,6 +23,8 @@
 #include "HelpWhatsThis.h"
 #include "HrvMeasuresDownload.h"
 #include "HrvMeasures.h"
+#include "RideMetric.h"
+#include "Specification.h"
 
 void FilterHrv(XDataSeries *rr, double rr_min, double rr_max, double filt, int hwin)
 {
@@ -244,6 +246,9 @@ public:
     QString name() {
         return (tr("Filter R-R Outliers"));
     }
+
+    // uses the selected ride item and updates the athlete's HRV measures
+    bool isThreadSafe() { return false; }
 };
 
 static bool FilterHrvOutliersAdded = DataProcessorFactory::instance().registerProcessor(QString("Filter R-R Outliers"), new FilterHrvOutliers());
@@ -278,21 +283,45 @@ FilterHrvOutliers::postProcess(RideFile *ride, DataProcessorConfig *config=0, QS
             setRestHrv = (bool) ((FilterHrvOutliersConfig*)(config))->setRestHrv->checkState();
         }
         FilterHrv(series, rrMin, rrMax, rrFilt, rrWindow);
-        ride->context->rideItem()->refresh();
+
+        // when batch processing the ride isn't the one selected, it is
+        // refreshed once it is saved
+        RideItem *rideItem = ride->context->rideItem();
+        if (rideItem && rideItem->ride(false) == ride) rideItem->refresh();
+        else rideItem = NULL;
 
         // Set HRV Measures according to user request
         if (setRestHrv) {
-            RideItem *rideItem = ride->context->rideItem();
 
-            double avnn = rideItem->getForSymbol("AVNN");
+            double avnn, sdnn, rmssd, pnn50;
+            QDateTime when;
+            if (rideItem) {
+                when = rideItem->dateTime;
+                avnn = rideItem->getForSymbol("AVNN");
+                sdnn = rideItem->getForSymbol("SDNN");
+                rmssd = rideItem->getForSymbol("rMSSD");
+                pnn50 = rideItem->getForSymbol("pNN50");
+            } else {
+                // compute them ourselves, the item doesn't own the ride
+                RideItem measured(ride, ride->context);
+                QHash<QString,RideMetricPtr> computed = RideMetric::computeMetrics(&measured, Specification(),
+                                                        QStringList() << "AVNN" << "SDNN" << "rMSSD" << "pNN50");
+                measured.setRide(NULL);
+
+                when = ride->startTime();
+                avnn = computed.value("AVNN") ? computed.value("AVNN")->value(true) : 0;
+                sdnn = computed.value("SDNN") ? computed.value("SDNN")->value(true) : 0;
+                rmssd = computed.value("rMSSD") ? computed.value("rMSSD")->value(true) : 0;
+                pnn50 = computed.value("pNN50") ? computed.value("pNN50")->value(true) : 0;
+            }
 
             HrvMeasure hrvMeasure;
-            hrvMeasure.when = rideItem->dateTime;
+            hrvMeasure.when = when;
             hrvMeasure.hr = !qFuzzyIsNull(avnn) ? 60000 / avnn : 0;
             hrvMeasure.avnn = avnn;
-            hrvMeasure.sdnn = rideItem->getForSymbol("SDNN");
-            hrvMeasure.rmssd = rideItem->getForSymbol("rMSSD");
-            hrvMeasure.pnn50 = rideItem->getForSymbol("pNN50");
+            hrvMeasure.sdnn = sdnn;
+            hrvMeasure.rmssd = rmssd;
+            hrvMeasure.pnn50 = pnn50;
             hrvMeasure.recovery_points = 1.5 * log(hrvMeasure.rmssd) + 2;
 
             QList<HrvMeasure> hrvMeasures;
@@ -119,7 +119,7 @@ FixDeriveDistance::postProcess(RideFile *ride, DataProcessorConfig *config=0, QS
     if (config == NULL) { // being called automatically
         fUseCubicSplines = appsettings->value(NULL, GC_DPDD_UCS, Qt::Unchecked).toBool();
     } else { // being called manually
-        fUseCubicSplines = ((FixDeriveDistanceConfig*)(config))->useCubicSplines->isChecked();
+        fUseCubicSplines = config->value(((FixDeriveDistanceConfig*)(config))->useCubicSplines).toBool();
     }
 
     GeoPointInterpolator gpi;
@@ -216,12 +216,12 @@ FixDerivePower::postProcess(RideFile *ride, DataProcessorConfig *config=0, QStri
         windSpeed = 0.0;
         windHeading = 0.0;
     } else { // being called manually
-        MBik = ((FixDerivePowerConfig*)(config))->bikeWeight->value();
-        CrV = ((FixDerivePowerConfig*)(config))->crr->value();
-        CdA = ((FixDerivePowerConfig*)(config))->cdA->value();
-        DraftM = ((FixDerivePowerConfig*)(config))->draftM->value();
-        windSpeed = ((FixDerivePowerConfig*)(config))->windSpeed->value();                // kph
-        windHeading = ((FixDerivePowerConfig*)(config))->windHeading->value() / 180 * MATHCONST_PI; // rad
+        MBik = config->value(((FixDerivePowerConfig*)(config))->bikeWeight).toDouble();
+        CrV = config->value(((FixDerivePowerConfig*)(config))->crr).toDouble();
+        CdA = config->value(((FixDerivePowerConfig*)(config))->cdA).toDouble();
+        DraftM = config->value(((FixDerivePowerConfig*)(config))->draftM).toDouble();
+        windSpeed = config->value(((FixDerivePowerConfig*)(config))->windSpeed).toDouble();                // kph
+        windHeading = config->value(((FixDerivePowerConfig*)(config))->windHeading).toDouble() / 180 * MATHCONST_PI; // rad
     }
 
     // Do nothing for swims and runs
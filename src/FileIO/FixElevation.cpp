@@ -17,15 +17,21 @@
  */
 
 #include "DataProcessor.h"
+#include "Context.h"
 #include "Settings.h"
 #include "Units.h"
 #include "HelpWhatsThis.h"
+#include "DEMTiles.h"
 #include <algorithm>
 #include <QVector>
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QMessageBox>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QFileDialog>
 
 // MapQuest default API key.
 // If you have reliability problems with Fix Elevation, caused by too
@@ -52,22 +58,77 @@ class FixElevationConfig : public DataProcessorConfig
     Q_DECLARE_TR_FUNCTIONS(FixElevationConfig)
     friend class ::FixElevation;
     protected:
+        QHBoxLayout *layout;
+        QLabel *sourceLabel;
+        QComboBox *source;
+        QLineEdit *demDir;
+        QPushButton *browse;
+
     public:
-        // there is no config
+        enum { MapQuest=0, LocalTiles=1 };
+
         FixElevationConfig(QWidget *parent) : DataProcessorConfig(parent) {
 
             HelpWhatsThis *help = new HelpWhatsThis(parent);
             parent->setWhatsThis(help->getWhatsThisText(HelpWhatsThis::MenuBar_Edit_FixElevationErrors));
+
+            layout = new QHBoxLayout(this);
+
+            layout->setContentsMargins(0,0,0,0);
+            setContentsMargins(0,0,0,0);
+
+            sourceLabel = new QLabel(tr("Source"));
+
+            source = new QComboBox();
+            source->addItem(tr("MapQuest (online)"));
+            source->addItem(tr("Local SRTM tiles"));
+
+            demDir = new QLineEdit();
+            demDir->setPlaceholderText(tr("Directory containing .hgt files"));
+            browse = new QPushButton(tr("Browse"));
+
+            layout->addWidget(sourceLabel);
+            layout->addWidget(source);
+            layout->addWidget(demDir);
+            layout->addWidget(browse);
+            layout->addStretch();
+
+            connect(source, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &FixElevationConfig::sourceChanged);
+            connect(browse, &QPushButton::clicked, this, &FixElevationConfig::browseClicked);
         }
 
         QString explain() {
             return(QString(tr("Fix or add elevation data. If elevation data is "
-                           "present it will be removed and overwritten."
-                           "\n\nINTERNET CONNECTION REQUIRED.")));
+                           "present it will be removed and overwritten.\n\n"
+                           "source - MapQuest looks up the elevation online "
+                           "and requires an internet connection. Local SRTM "
+                           "tiles reads heights from the 1 degree .hgt files "
+                           "(e.g. N52E000.hgt) in the chosen directory, "
+                           "which works offline and always gives the same "
+                           "result for the same ride.")));
+        }
+
+        void sourceChanged(int index) {
+            demDir->setEnabled(index == LocalTiles);
+            browse->setEnabled(index == LocalTiles);
+        }
+
+        void browseClicked() {
+            QString dir = QFileDialog::getExistingDirectory(this, tr("Select SRTM Tile Directory"),
+                                                            demDir->text(), QFileDialog::ShowDirsOnly);
+            if (dir != "") demDir->setText(dir);
+        }
+
+        void readConfig() {
+            source->setCurrentIndex(appsettings->value(NULL, GC_DPFE_SOURCE, MapQuest).toInt() == LocalTiles ? LocalTiles : MapQuest);
+            demDir->setText(appsettings->value(NULL, GC_DPFE_DEMDIR, "").toString());
+            sourceChanged(source->currentIndex());
         }
 
-        void readConfig() {}
-        void saveConfig() {}
+        void saveConfig() {
+            appsettings->setValue(GC_DPFE_SOURCE, source->currentIndex());
+            appsettings->setValue(GC_DPFE_DEMDIR, demDir->text());
+        }
 
 };
 
@@ -96,6 +157,14 @@ class FixElevation : public DataProcessor {
         QString name() {
             return (tr("Fix Elevation errors"));
         }
+
+        // reports errors with a message box
+        bool isThreadSafe() { return false; }
+
+    private:
+        // set alt for the ride samples, throw a QString on error
+        bool lookupMapQuest(RideFile *ride);
+        bool lookupLocalTiles(RideFile *ride, QString directory);
 };
 
 static bool fixElevationAdded = DataProcessorFactory::instance().registerProcessor(QString("Fix Elevation errors"), new FixElevation());
@@ -103,109 +172,47 @@ static bool fixElevationAdded = DataProcessorFactory::instance().registerProcess
 bool
 FixElevation::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op="")
 {
-    Q_UNUSED(config)
     Q_UNUSED(op)
 
     // Cannot process without without GPS data
     if (!ride || ride->areDataPresent()->lat == false || ride->areDataPresent()->lon == false)
         return false;
 
-    int errors=0;
+    // get settings
+    int source;
+    QString directory;
+    if (config == NULL) { // being called automatically
+        source = appsettings->value(NULL, GC_DPFE_SOURCE, FixElevationConfig::MapQuest).toInt();
+        directory = appsettings->value(NULL, GC_DPFE_DEMDIR, "").toString();
+    } else { // being called manually
+        source = ((FixElevationConfig*)(config))->source->currentIndex();
+        directory = ((FixElevationConfig*)(config))->demDir->text();
+    }
 
-    std::vector<elevationGPSPoint> elvPoints;
+    int errors=0;
 
     ride->command->startLUW("Fix Elevation Data");
 
-    int lastDistance = 0;
-    for (int i=0; i<ride->dataPoints().count(); i++) {
-        // is the gps point any good?
-        if (ride->dataPoints()[i]->lat && ride->dataPoints()[i]->lat >= double(-56) && ride->dataPoints()[i]->lat <= double(60) &&
-            ride->dataPoints()[i]->lon && ride->dataPoints()[i]->lon >= double(-180) && ride->dataPoints()[i]->lon <= double(180)) {
-            if (lastDistance < (int) (ride->dataPoints()[i]->km * 1000)) {
-                elevationGPSPoint elvPoint;
-
-                elvPoint.lat = (double) ((int) (ride->dataPoints()[i]->lat*100000))/ (double) 100000;
-                elvPoint.lon = (double) ((int) (ride->dataPoints()[i]->lon*100000))/ (double) 100000;
-                elvPoint.rideFileIndex = i;
-
-                elvPoints.push_back(elvPoint);
-
-                //grab a gps point every 20 meters
-                lastDistance = (int) (ride->dataPoints()[i]->km * 1000) + 20;
-            }
-            ride->command->setPointValue(i, RideFile::alt, 0);
-        }
-    }
-
-    //loop through points and build a string to sent to MapQuest
-    QStringList elevationPoints;
-    QString latLngCollection = "";
-    int pointCount = 0;
+    bool found;
     try {
-        for (std::vector<elevationGPSPoint>::iterator point = elvPoints.begin();
-             point != elvPoints.end(); ++point) {
-            if (latLngCollection.length() != 0) {
-                latLngCollection.append(',');
-            }
-            latLngCollection.append(QString::number(point->lat));
-            latLngCollection.append(',');
-            latLngCollection.append(QString::number(point->lon));
-            if (pointCount == 400) {
-                elevationPoints = elevationPoints + FetchElevationDataFromMapQuest(latLngCollection);
-                latLngCollection = "";
-                pointCount = 0;
-            } else {
-                ++pointCount;
-            }
-        }
-        if (pointCount > 0) {
-            elevationPoints = elevationPoints + FetchElevationDataFromMapQuest(latLngCollection);
-        }
+        if (source == FixElevationConfig::LocalTiles) found = lookupLocalTiles(ride, directory);
+        else found = lookupMapQuest(ride);
     } catch (QString err) {
         qDebug() << "Cannot fetch elevation data: " << err;
-        QMessageBox oops(QMessageBox::Critical, tr("Fix Elevation Data not possible"),
-                         tr("The following problem occured: %1").arg(err));
-        oops.exec();
+        if (ride->context && ride->context->mainWindow) {
+            QMessageBox oops(QMessageBox::Critical, tr("Fix Elevation Data not possible"),
+                             tr("The following problem occured: %1").arg(err));
+            oops.exec();
+        } else {
+            // no one to ask, e.g. --batch
+            DataProcessorFactory::instance().failure(ride, tr("Fix Elevation Data not possible: %1").arg(err));
+        }
         // close LUW
         ride->command->endLUW();
         return false;
     }
 
-
-    if (elevationPoints.length() > 0) {
-        QVector<double> smoothArray(elevationPoints.length());
-        double lastGoodElevation = 0;
-        for (int i=0; i<elevationPoints.length(); i++) {
-            double elev = QString(elevationPoints.at(i).mid(elevationPoints.at(i).indexOf("|")+1)).toDouble();
-            if (elev>-1000) {
-                lastGoodElevation = elev;
-                smoothArray[i] = elev;
-            } else {
-                smoothArray[i] = lastGoodElevation;
-            }
-        }
-
-        // initialise rolling average
-        double rtot = 0;
-        for (int i=10; i>0 && elevationPoints.length()-i >=0; i--) {
-            rtot += smoothArray[elevationPoints.length()-i];
-        }
-
-        // now run backwards setting the rolling average
-        for (int i=elevationPoints.length()-1; i>=10; i--) {
-            double here = smoothArray[i];
-            smoothArray[i] = rtot / 10;
-            rtot -= here;
-            rtot += smoothArray[i-10];
-        }
-        int loopCount = 0;
-
-        for( std::vector<elevationGPSPoint>::iterator point = elvPoints.begin() ; point != elvPoints.end() ; ++point ) {
-            double elev = smoothArray.size() > loopCount ? smoothArray[loopCount] : -100;
-            // ignore any seriously negative points
-            if (elev>-100) ride->command->setPointValue(point->rideFileIndex, RideFile::alt, elev);
-            ++loopCount;
-        }
+    if (found) {
 
         // set data present if not currently so
         if (ride->areDataPresent()->alt == false) ride->command->setDataPresent(RideFile::alt, true);
@@ -252,11 +259,137 @@ FixElevation::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString
     // close LUW
     ride->command->endLUW();
 
-    if (errors) {
-        ride->setTag("GPS errors", QString("%1").arg(errors));
-        return true;
-    } else
-        return false;
+    // the altitude was replaced, even when no gaps needed filling
+    if (errors) ride->setTag("GPS errors", QString("%1").arg(errors));
+    return found;
+}
+
+bool
+FixElevation::lookupMapQuest(RideFile *ride)
+{
+    std::vector<elevationGPSPoint> elvPoints;
+
+    int lastDistance = 0;
+    for (int i=0; i<ride->dataPoints().count(); i++) {
+        // is the gps point any good?
+        if (ride->dataPoints()[i]->lat && ride->dataPoints()[i]->lat >= double(-56) && ride->dataPoints()[i]->lat <= double(60) &&
+            ride->dataPoints()[i]->lon && ride->dataPoints()[i]->lon >= double(-180) && ride->dataPoints()[i]->lon <= double(180)) {
+            if (lastDistance < (int) (ride->dataPoints()[i]->km * 1000)) {
+                elevationGPSPoint elvPoint;
+
+                elvPoint.lat = (double) ((int) (ride->dataPoints()[i]->lat*100000))/ (double) 100000;
+                elvPoint.lon = (double) ((int) (ride->dataPoints()[i]->lon*100000))/ (double) 100000;
+                elvPoint.rideFileIndex = i;
+
+                elvPoints.push_back(elvPoint);
+
+                //grab a gps point every 20 meters
+                lastDistance = (int) (ride->dataPoints()[i]->km * 1000) + 20;
+            }
+            ride->command->setPointValue(i, RideFile::alt, 0);
+        }
+    }
+
+    //loop through points and build a string to sent to MapQuest
+    QStringList elevationPoints;
+    QString latLngCollection = "";
+    int pointCount = 0;
+    for (std::vector<elevationGPSPoint>::iterator point = elvPoints.begin();
+         point != elvPoints.end(); ++point) {
+        if (latLngCollection.length() != 0) {
+            latLngCollection.append(',');
+        }
+        latLngCollection.append(QString::number(point->lat));
+        latLngCollection.append(',');
+        latLngCollection.append(QString::number(point->lon));
+        if (pointCount == 400) {
+            elevationPoints = elevationPoints + FetchElevationDataFromMapQuest(latLngCollection);
+            latLngCollection = "";
+            pointCount = 0;
+        } else {
+            ++pointCount;
+        }
+    }
+    if (pointCount > 0) {
+        elevationPoints = elevationPoints + FetchElevationDataFromMapQuest(latLngCollection);
+    }
+
+    if (elevationPoints.length() == 0) return false;
+
+    QVector<double> smoothArray(elevationPoints.length());
+    double lastGoodElevation = 0;
+    for (int i=0; i<elevationPoints.length(); i++) {
+        double elev = QString(elevationPoints.at(i).mid(elevationPoints.at(i).indexOf("|")+1)).toDouble();
+        if (elev>-1000) {
+            lastGoodElevation = elev;
+            smoothArray[i] = elev;
+        } else {
+            smoothArray[i] = lastGoodElevation;
+        }
+    }
+
+    // initialise rolling average
+    double rtot = 0;
+    for (int i=10; i>0 && elevationPoints.length()-i >=0; i--) {
+        rtot += smoothArray[elevationPoints.length()-i];
+    }
+
+    // now run backwards setting the rolling average
+    for (int i=elevationPoints.length()-1; i>=10; i--) {
+        double here = smoothArray[i];
+        smoothArray[i] = rtot / 10;
+        rtot -= here;
+        rtot += smoothArray[i-10];
+    }
+    int loopCount = 0;
+
+    for( std::vector<elevationGPSPoint>::iterator point = elvPoints.begin() ; point != elvPoints.end() ; ++point ) {
+        double elev = smoothArray.size() > loopCount ? smoothArray[loopCount] : -100;
+        // ignore any seriously negative points
+        if (elev>-100) ride->command->setPointValue(point->rideFileIndex, RideFile::alt, elev);
+        ++loopCount;
+    }
+    return true;
+}
+
+bool
+FixElevation::lookupLocalTiles(RideFile *ride, QString directory)
+{
+    DEMTiles *tiles = DEMTiles::instance(directory);
+    if (!tiles->isValid())
+        throw QString(tr("SRTM tile directory '%1' not found")).arg(directory);
+
+    // the tiles are already a terrain model, so every sample is
+    // looked up rather than one every 20 meters and no smoothing
+    QVector<int> index;
+    QVector<double> lat, lon, alt;
+    for (int i=0; i<ride->dataPoints().count(); i++) {
+        const RideFilePoint *p = ride->dataPoints()[i];
+        if (p->lat && p->lat >= double(-90) && p->lat < double(90) &&
+            p->lon && p->lon >= double(-180) && p->lon < double(180)) {
+            index << i;
+            lat << p->lat;
+            lon << p->lon;
+        }
+    }
+
+    tiles->elevations(lat, lon, alt);
+
+    // check coverage before touching the ride, so it is left as
+    // it was when there are no tiles for it
+    int found = 0;
+    for (int k=0; k<index.count(); k++)
+        if (alt[k] != DEMTiles::NODATA) found++;
+
+    if (found == 0 && index.count() > 0)
+        throw QString(tr("No SRTM tiles for this ride in '%1'")).arg(directory);
+
+    // points without a tile are zeroed and interpolated like the
+    // gaps returned by MapQuest
+    for (int k=0; k<index.count(); k++)
+        ride->command->setPointValue(index[k], RideFile::alt, alt[k] == DEMTiles::NODATA ? 0 : alt[k]);
+
+    return found > 0;
 }
 
 QStringList
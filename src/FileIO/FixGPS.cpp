@@ -1246,15 +1246,15 @@ bool FixGPS::postProcess(RideFile *ride, DataProcessorConfig *config, QString op
     unsigned degree0, degree1, degree0Route, degree1Route;
     double outlierCriteria, outlierCriteriaRoute;
     if (config) {
-        fDoSmoothAltitude    = ((FixGPSConfig*)(config))->doSmoothAltitude->checkState();
-        degree0              = ((FixGPSConfig*)(config))->degree0SpinBox->value();
-        degree1              = ((FixGPSConfig*)(config))->degree1SpinBox->value();
-        outlierCriteria      = (((FixGPSConfig*)(config))->outlierSpinBox->value()) / 100.;
-
-        fDoSmoothRoute       = ((FixGPSConfig*) (config))->doSmoothRoute->checkState();
-        degree0Route         = ((FixGPSConfig*) (config))->degree0SpinBoxRoute->value();
-        degree1Route         = ((FixGPSConfig*) (config))->degree1SpinBoxRoute->value();
-        outlierCriteriaRoute = (((FixGPSConfig*)(config))->outlierSpinBoxRoute->value()) / 100.;
+        fDoSmoothAltitude    = config->value(((FixGPSConfig*)(config))->doSmoothAltitude).toBool();
+        degree0              = config->value(((FixGPSConfig*)(config))->degree0SpinBox).toInt();
+        degree1              = config->value(((FixGPSConfig*)(config))->degree1SpinBox).toInt();
+        outlierCriteria      = (config->value(((FixGPSConfig*)(config))->outlierSpinBox).toDouble()) / 100.;
+
+        fDoSmoothRoute       = config->value(((FixGPSConfig*)(config))->doSmoothRoute).toBool();
+        degree0Route         = config->value(((FixGPSConfig*)(config))->degree0SpinBoxRoute).toInt();
+        degree1Route         = config->value(((FixGPSConfig*)(config))->degree1SpinBoxRoute).toInt();
+        outlierCriteriaRoute = (config->value(((FixGPSConfig*)(config))->outlierSpinBoxRoute).toDouble()) / 100.;
     } else {
         fDoSmoothAltitude     = appsettings->value(NULL, GC_FIXGPS_ALTITUDE_FIX_DOAPPLY, Qt::Unchecked).toBool();
         degree0               = appsettings->value(NULL, GC_FIXGPS_ALTITUDE_FIX_DEGREE, 200).toUInt();
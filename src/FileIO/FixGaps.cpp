@@ -145,8 +145,8 @@ FixGaps::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op="
         tolerance = appsettings->value(NULL, GC_DPFG_TOLERANCE, "1.0").toDouble();
         stop = appsettings->value(NULL, GC_DPFG_STOP, "90.0").toDouble();
     } else { // being called manually
-        tolerance = ((FixGapsConfig*)(config))->tolerance->value();
-        stop = ((FixGapsConfig*)(config))->beerandburrito->value();
+        tolerance = config->value(((FixGapsConfig*)(config))->tolerance).toDouble();
+        stop = config->value(((FixGapsConfig*)(config))->beerandburrito).toDouble();
     }
 
     // if the number of duration / number of samples
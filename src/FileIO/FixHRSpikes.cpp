@@ -132,7 +132,7 @@ FixHRSpikes::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString
     if (config == NULL) { // being called automatically
         max = appsettings->value(NULL, GC_DPFHRS_MAX, "200").toDouble();
     } else { // being called manually
-        max = ((FixHRSpikesConfig*)(config))->max->value();
+        max = config->value(((FixHRSpikesConfig*)(config))->max).toDouble();
     }
 
     // Find the HR outliers
@@ -110,6 +110,9 @@ class FixLapSwim : public DataProcessor {
         QString name() {
             return (tr("Fix Lap Swim from Length Data"));
         }
+
+        // refreshes the ride item selected in the GUI
+        bool isThreadSafe() { return false; }
 };
 
 static bool FixLapSwimAdded = DataProcessorFactory::instance().registerProcessor(QString("Fix Lap Swim"), new FixLapSwim());
@@ -257,10 +260,14 @@ FixLapSwim::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString o
     ride->setDataPresent(ride->kph, true);
     ride->setDataPresent(ride->cad, strokesIdx>0);
     ride->command->endLUW();
-    // rebuild intervals and force metric update
+    // rebuild intervals and force metric update, when batch processing
+    // the ride isn't the one selected and is refreshed once it is saved
     ride->fillInIntervals();
-    ride->context->rideItem()->isstale = true;
-    ride->context->rideItem()->refresh();
+    RideItem *item = ride->context->rideItem();
+    if (item && item->ride(false) == ride) {
+        item->isstale = true;
+        item->refresh();
+    }
 
     return true;
 }
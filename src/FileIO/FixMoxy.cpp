@@ -126,8 +126,8 @@ FixMoxy::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op="
 	isCad = appsettings->value(NULL, GC_CAD2SMO2, Qt::Checked).toBool();
 	isSpd = appsettings->value(NULL, GC_SPD2THB, Qt::Checked).toBool();
     } else { // being called manually
-	isCad = ((FixMoxyConfig*)(config))->cadConv->checkState();
-	isSpd = ((FixMoxyConfig*)(config))->spdConv->checkState();
+	isCad = config->value(((FixMoxyConfig*)(config))->cadConv).toBool();
+	isSpd = config->value(((FixMoxyConfig*)(config))->spdConv).toBool();
     }
 
     // does this ride have power?
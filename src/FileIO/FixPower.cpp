@@ -138,8 +138,8 @@ FixPower::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op=
         tpRel = appsettings->value(NULL, GC_DPPA, "0").toString();
         tpAbs = appsettings->value(NULL, GC_DPPA_ABS, "0").toString();
     } else { // being called manually
-        tpRel = ((FixPowerConfig*)(config))->paRel->text();
-        tpAbs = ((FixPowerConfig*)(config))->paAbs->text();
+        tpRel = config->value(((FixPowerConfig*)(config))->paRel).toString();
+        tpAbs = config->value(((FixPowerConfig*)(config))->paAbs).toString();
 
     }
 
@@ -3,6 +3,7 @@
 
 #include "FixPyRunner.h"
 #include "PythonEmbed.h"
+#include "PythonWorkers.h"
 #include "RideFileCommand.h"
 
 FixPyRunner::FixPyRunner(Context *context, RideFile *rideFile, bool useNewThread)
@@ -50,8 +51,8 @@ int FixPyRunner::run(QString source, QString scriptKey, QString &errText)
         }
 
         // output on console
-        if (python->messages.count()) {
-            errText = python->messages.join("\n");
+        if (params.messages.count()) {
+            errText = params.messages.join("\n");
         }
 
     } catch(std::exception& ex) {
@@ -73,10 +74,16 @@ int FixPyRunner::run(QString source, QString scriptKey, QString &errText)
 void FixPyRunner::execScript(FixPyRunParams *params)
 {
     QList<RideFile *> editedRideFiles;
-    python->canvas = NULL;
-    python->chart = NULL;
-    python->runline(ScriptContext(params->context, params->rideFile, false,
-                                  false, &editedRideFiles), params->script);
+    ScriptContext scriptContext(params->context, params->rideFile, false, false, &editedRideFiles);
+
+    // on a worker if it can, otherwise the embedded interpreter
+    double result = 0;
+    if (pythonWorkers == NULL || !pythonWorkers->runline(scriptContext, params->script, result, params->messages)) {
+        python->canvas = NULL;
+        python->chart = NULL;
+        python->runline(scriptContext, params->script);
+        params->messages = python->messages;
+    }
 
     // finish up commands on edited rides
     foreach (RideFile *f, editedRideFiles) {
@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QString>
+#include <QStringList>
 
 #include "FixPyScript.h"
 #include "Context.h"
@@ -12,6 +13,7 @@ struct FixPyRunParams
     Context *context;
     RideFile *rideFile;
     QString script;
+    QStringList messages;
 };
 
 class FixPyRunner : public QObject
@@ -181,10 +181,10 @@ FixRunningPower::postProcess(RideFile *ride, DataProcessorConfig *config=0, QStr
         windSpeed = 0.0;
         windHeading = 0.0;
     } else { // being called manually
-        MEquip = ((FixRunningPowerConfig*)(config))->equipWeight->value();
-        DraftM = ((FixRunningPowerConfig*)(config))->draftM->value();
-        windSpeed = ((FixRunningPowerConfig*)(config))->windSpeed->value();                // kph
-        windHeading = ((FixRunningPowerConfig*)(config))->windHeading->value() / 180 * MATHCONST_PI; // rad
+        MEquip = config->value(((FixRunningPowerConfig*)(config))->equipWeight).toDouble();
+        DraftM = config->value(((FixRunningPowerConfig*)(config))->draftM).toDouble();
+        windSpeed = config->value(((FixRunningPowerConfig*)(config))->windSpeed).toDouble();                // kph
+        windHeading = config->value(((FixRunningPowerConfig*)(config))->windHeading).toDouble() / 180 * MATHCONST_PI; // rad
     }
 
     // if not a run or its already there do nothing !
@@ -144,9 +144,9 @@ FixSmO2::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op="
         maxtHb = appsettings->value(NULL, GC_MOXY_FIX_THB_MAX, "50.0").toDouble();
 
     } else { // being called manually
-        fixSmO2 = ((FixSmO2Config*)(config))->fixSmO2Box->isChecked();
-        fixtHb = ((FixSmO2Config*)(config))->fixtHbBox->isChecked();
-        maxtHb = ((FixSmO2Config*)(config))->maxtHbInput->value();
+        fixSmO2 = config->value(((FixSmO2Config*)(config))->fixSmO2Box).toBool();
+        fixtHb = config->value(((FixSmO2Config*)(config))->fixtHbBox).toBool();
+        maxtHb = config->value(((FixSmO2Config*)(config))->maxtHbInput).toDouble();
     }
 
     int smO2spikes = 0;
@@ -120,7 +120,7 @@ FixSpeed::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op=
     if (config == NULL) { // being called automatically
         ma = appsettings->value(NULL, GC_DPFV_MA, "1").toInt();
     } else { // being called manually
-        ma = ((FixSpeedConfig*)(config))->ma->value();
+        ma = config->value(((FixSpeedConfig*)(config))->ma).toInt();
     }
 
     // no dice if we don't have Distance
@@ -150,8 +150,8 @@ FixSpikes::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op
         max = appsettings->value(NULL, GC_DPFS_MAX, "200").toDouble();
         variance = appsettings->value(NULL, GC_DPFS_VARIANCE, "20").toDouble();
     } else { // being called manually
-        max = ((FixSpikesConfig*)(config))->max->value();
-        variance = ((FixSpikesConfig*)(config))->variance->value();
+        max = config->value(((FixSpikesConfig*)(config))->max).toDouble();
+        variance = config->value(((FixSpikesConfig*)(config))->variance).toDouble();
     }
 
     int windowsize = 30 / ride->recIntSecs();
@@ -123,7 +123,7 @@ FixTorque::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op
     if (config == NULL) { // being called automatically
         ta = appsettings->value(NULL, GC_DPTA, "0 nm").toString();
     } else { // being called manually
-        ta = ((FixTorqueConfig*)(config))->ta->text();
+        ta = config->value(((FixTorqueConfig*)(config))->ta).toString();
     }
 
     // patrick's torque adjustment code
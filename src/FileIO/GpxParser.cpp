@@ -52,42 +52,68 @@ GpxParser::GpxParser (RideFile* rideFile)
 
 }
 
-bool GpxParser::startElement( const QString&, const QString&,
-    const QString& qName,
-    const QXmlAttributes& qAttributes)
+bool
+GpxParser::parse(QIODevice *device)
+{
+    if (!device->isOpen() && !device->open(QIODevice::ReadOnly))
+        return false;
+
+    QXmlStreamReader xml(device);
+    while (!xml.atEnd()) {
+
+        switch (xml.readNext()) {
+        case QXmlStreamReader::StartElement:
+            startElement(xml.qualifiedName(), xml.attributes());
+            break;
+
+        case QXmlStreamReader::EndElement:
+            endElement(xml.qualifiedName());
+            break;
+
+        case QXmlStreamReader::Characters:
+            buffer.append(xml.text());
+            break;
+
+        default:
+            break;
+        }
+    }
+    return !xml.hasError();
+}
+
+void
+GpxParser::startElement(const QStringRef &qName, const QXmlStreamAttributes &qAttributes)
 {
-    buffer.clear();
+    // truncate rather than clear to keep the allocation
+    buffer.truncate(0);
 
     if(metadata)
-        return true;
+        return;
 
-    if(qName == "metadata")
+    if(qName == QLatin1String("metadata"))
     {
         metadata = true;
 
     }
-    else if(qName == "trkpt")
+    else if(qName == QLatin1String("trkpt"))
     {
-        int i = qAttributes.index("lat");
-        if(i >= 0)
+        if(qAttributes.hasAttribute(QLatin1String("lat")))
         {
-            lat = qAttributes.value(i).toDouble();
+            lat = qAttributes.value(QLatin1String("lat")).toDouble();
         }
         else
         {
             lat = lastLat;
         }
-        i = qAttributes.index("lon");
-        if( i >= 0)
+        if(qAttributes.hasAttribute(QLatin1String("lon")))
         {
-            lon = qAttributes.value(i).toDouble();
+            lon = qAttributes.value(QLatin1String("lon")).toDouble();
         }
         else
         {
             lon = lastLon;
         }
     }
-    return true;
 }
 
 #define PI 3.14159265
@@ -97,18 +123,18 @@ inline double toRadians(double degrees)
 
 }
 
-bool
-        GpxParser::endElement( const QString&, const QString&, const QString& qName)
+void
+GpxParser::endElement(const QStringRef &qName)
 {
-    if(qName == "metadata")
+    if(qName == QLatin1String("metadata"))
     {
         metadata = false;
     }
     else if(metadata == true)
     {
-        return true;
+        return;
     }
-    else if (qName == "time")
+    else if (qName == QLatin1String("time"))
     {
 
         time = convertToLocalTime(buffer);
@@ -119,33 +145,33 @@ bool
             firstTime = false;
         }
     }
-    else if (qName == "ele")
+    else if (qName == QLatin1String("ele"))
     {
         alt = buffer.toDouble();  // metric
     }
-    else if (qName == "gpxtpx:hr" || qName == "heartrate")
+    else if (qName == QLatin1String("gpxtpx:hr") || qName == QLatin1String("heartrate"))
     {
         hr = buffer.toInt();
     }
-    else if (qName == "gpxdata:hr")
+    else if (qName == QLatin1String("gpxdata:hr"))
     {
         hr = buffer.toDouble(); // on suunto ambit export file, there are sometimes double values
     }
-    else if (qName == "gpxdata:temp" || (qName == "gpxtpx:atemp"))
+    else if (qName == QLatin1String("gpxdata:temp") || (qName == QLatin1String("gpxtpx:atemp")))
     {
         temp = buffer.toDouble();
     }
-    else if ((qName == "gpxdata:cadence") || (qName == "gpxtpx:cad") || qName == "cadence")
+    else if ((qName == QLatin1String("gpxdata:cadence")) || (qName == QLatin1String("gpxtpx:cad")) || qName == QLatin1String("cadence"))
     {
         cad = buffer.toDouble();
     }
-    else if (qName == "power" || qName == "gpxdata:power" || qName.endsWith("PowerInWatts")) // from suunto ambit export file and UrbanBiker
+    else if (qName == QLatin1String("power") || qName == QLatin1String("gpxdata:power") || qName.endsWith(QLatin1String("PowerInWatts"))) // from suunto ambit export file and UrbanBiker
     {
         watts = buffer.toDouble();
     }
 
 
-    else if (qName == "trkpt")
+    else if (qName == QLatin1String("trkpt"))
     {
         // Time from beginning of activity
         double secs = start_time.secsTo(time);
@@ -160,7 +186,7 @@ bool
             rideFile->appendPoint(secs, cad, hr, 0, 0, 0, watts, alt, lon, lat, 0, 0.0, temp, 0.0, 
                                   0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
                                   0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0);
-            return true;
+            return;
         }
         // we need to figure out the distance by using the lon,lat
         // using the haversine formula
@@ -261,12 +287,4 @@ bool
         lastLon = lon;
         lastLat = lat;
     }
-
-    return true;
-}
-
-bool GpxParser::characters( const QString& str )
-{
-    buffer += str;
-    return true;
 }
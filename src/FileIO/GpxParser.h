@@ -26,22 +26,27 @@
 #include "RideFile.h"
 #include <QString>
 #include <QDateTime>
-#include <QXmlDefaultHandler>
+#include <QIODevice>
+#include <QXmlStreamReader>
 #include "Settings.h"
 
-class GpxParser : public QXmlDefaultHandler
+// pull parser, elements are matched by reference into the reader's
+// buffer and text is accumulated into a single reused buffer so the
+// only allocations made are for the ride samples themselves
+class GpxParser
 {
 public:
     GpxParser(RideFile* rideFile);
 
-    bool startElement( const QString&, const QString&, const QString&,
-		       const QXmlAttributes& );
-    bool endElement( const QString&, const QString&, const QString& );
-
-    bool characters( const QString& );
+    // parse the document on device (opened if needed), returns false
+    // if it was not well formed; the points up to the error are kept
+    bool parse(QIODevice *device);
 
 private:
 
+    void startElement(const QStringRef &qName, const QXmlStreamAttributes &qAttributes);
+    void endElement(const QStringRef &qName);
+
     RideFile*   rideFile;
 
     QString     buffer;
@@ -37,11 +37,7 @@ RideFile *GpxFileReader::openRideFile(QFile &file, QStringList &errors, QList<Ri
     rideFile->setFileFormat("GPS Exchange Format (gpx)");
 
     GpxParser handler(rideFile);
-
-    QXmlInputSource source (&file);
-    QXmlSimpleReader reader;
-    reader.setContentHandler (&handler);
-    reader.parse (source);
+    handler.parse(&file);
 
     return rideFile;
 }
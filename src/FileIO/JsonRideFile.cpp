@@ -0,0 +1,1268 @@
+/*
+ * Copyright (c) 2010 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+// The reader is specific to the RideFile format serialised in
+// toByteArray below, this is NOT a generic json parser.
+//
+// It used to be a flex/bison grammar, it is now a hand written single
+// pass parser that works on the UTF-8 bytes of the file. It accepts the
+// same documents the grammar did (including its quirks, noted below) but
+// only creates strings for string values, keys and numbers are matched
+// and converted in place.
+
+#include "JsonRideFile.h"
+#include "Utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include <cmath>
+
+//
+// Utility functions
+//
+
+// Escape special characters (JSON compliance)
+static QString protect(const QString string)
+{
+    QString s = string;
+    s.replace("\\", "\\\\"); // backslash
+    s.replace("\"", "\\\""); // quote
+    s.replace("\t", "\\t");  // tab
+    s.replace("\n", "\\n");  // newline
+    s.replace("\r", "\\r");  // carriage-return
+    s.replace("\b", "\\b");  // backspace
+    s.replace("\f", "\\f");  // formfeed
+    s.replace("/", "\\/");   // solidus
+
+    // add a trailing space to avoid conflicting with GC special tokens
+    s += " ";
+
+    return s;
+}
+
+// append value formatted as QString("%1").arg(value, 0, 'g', precision),
+// whole numbers are written directly and the rest via the digits of a
+// correctly rounded "%.*e" (read locale independently) laid out as %g
+static void
+appendNumber(QByteArray &out, double value, int precision=6)
+{
+    // nan, inf and negative zero are rare, leave them to Qt
+    if (!std::isfinite(value) || (value == 0 && std::signbit(value))) {
+        out += QString("%1").arg(value, 0, 'g', precision);
+        return;
+    }
+
+    char buffer[64];
+    int n = 0;
+
+    double limit = 1;
+    for (int i=0; i<precision; i++) limit *= 10;
+
+    if (value > -limit && value < limit && value == double(qint64(value))) {
+
+        // whole numbers, %g writes them as they are
+        qint64 whole = qint64(value);
+        bool negative = whole < 0;
+        if (negative) whole = -whole;
+        char digits[24];
+        int d = 0;
+        do { digits[d++] = '0' + (whole % 10); whole /= 10; } while (whole);
+        if (negative) buffer[n++] = '-';
+        while (d) buffer[n++] = digits[--d];
+        out.append(buffer, n);
+        return;
+    }
+
+    // precision significant digits and the decimal exponent
+    char e[64];
+    snprintf(e, sizeof(e), "%.*e", precision-1, value);
+    const char *p = e;
+    bool negative = (*p == '-');
+    if (negative) p++;
+    char digits[24];
+    int d = 0;
+    for (; *p && *p != 'e' && *p != 'E'; p++) if (*p >= '0' && *p <= '9') digits[d++] = *p;
+    int exponent = atoi(p+1);
+
+    // %g drops trailing zeros
+    while (d > 1 && digits[d-1] == '0') d--;
+
+    if (negative) buffer[n++] = '-';
+    if (exponent < -4 || exponent >= precision) {
+
+        // d.ddde[+-]XX
+        buffer[n++] = digits[0];
+        if (d > 1) {
+            buffer[n++] = '.';
+            for (int i=1; i<d; i++) buffer[n++] = digits[i];
+        }
+        buffer[n++] = 'e';
+        buffer[n++] = exponent < 0 ? '-' : '+';
+        if (exponent < 0) exponent = -exponent;
+        if (exponent < 10) buffer[n++] = '0';
+        n += snprintf(buffer + n, sizeof(buffer) - n, "%d", exponent);
+
+    } else if (exponent < 0) {
+
+        // 0.000ddd
+        buffer[n++] = '0';
+        buffer[n++] = '.';
+        for (int i=-1; i>exponent; i--) buffer[n++] = '0';
+        for (int i=0; i<d; i++) buffer[n++] = digits[i];
+
+    } else {
+
+        // ddd.ddd
+        for (int i=0; i<=exponent; i++) buffer[n++] = i < d ? digits[i] : '0';
+        if (d > exponent+1) {
+            buffer[n++] = '.';
+            for (int i=exponent+1; i<d; i++) buffer[n++] = digits[i];
+        }
+    }
+    out.append(buffer, n);
+}
+
+//
+// Tokens, single characters such as : { or } are returned as themselves
+//
+enum {
+    JS_END = 0,
+    JS_STRING = 256, JS_INTEGER, JS_FLOAT,
+    JS_RIDE, JS_STARTTIME, JS_RECINTSECS, JS_DEVICETYPE, JS_IDENTIFIER,
+    JS_OVERRIDES,
+    JS_TAGS, JS_INTERVALS, JS_NAME, JS_START, JS_STOP, JS_COLOR, JS_TEST,
+    JS_CALIBRATIONS, JS_VALUE, JS_VALUES, JS_UNIT, JS_UNITS,
+    JS_REFERENCES,
+    JS_XDATA,
+    JS_SAMPLES, JS_SECS, JS_KM, JS_WATTS, JS_NM, JS_CAD, JS_KPH, JS_HR, JS_ALT, JS_LAT, JS_LON,
+    JS_HEADWIND, JS_SLOPE, JS_TEMP,
+    JS_LRBALANCE, JS_LTE, JS_RTE, JS_LPS, JS_RPS, JS_THB, JS_SMO2, JS_RVERT, JS_RCAD, JS_RCON,
+    JS_LPCO, JS_RPCO, JS_LPPB, JS_RPPB, JS_LPPE, JS_RPPE, JS_LPPPB, JS_RPPPB, JS_LPPPE, JS_RPPPE
+};
+
+#define JSON_KEYWORD(name, token) { name, sizeof(name)-1, token }
+static const struct { const char *name; int length; int token; } jsonKeywords[] = {
+
+    // sample series first, they are by far the most common
+    JSON_KEYWORD("SECS", JS_SECS),
+    JSON_KEYWORD("KM", JS_KM),
+    JSON_KEYWORD("WATTS", JS_WATTS),
+    JSON_KEYWORD("CAD", JS_CAD),
+    JSON_KEYWORD("KPH", JS_KPH),
+    JSON_KEYWORD("HR", JS_HR),
+    JSON_KEYWORD("ALT", JS_ALT),
+    JSON_KEYWORD("LAT", JS_LAT),
+    JSON_KEYWORD("LON", JS_LON),
+    JSON_KEYWORD("NM", JS_NM),
+    JSON_KEYWORD("SLOPE", JS_SLOPE),
+    JSON_KEYWORD("TEMP", JS_TEMP),
+    JSON_KEYWORD("HEADWIND", JS_HEADWIND),
+    JSON_KEYWORD("LRBALANCE", JS_LRBALANCE),
+    JSON_KEYWORD("LTE", JS_LTE),
+    JSON_KEYWORD("RTE", JS_RTE),
+    JSON_KEYWORD("LPS", JS_LPS),
+    JSON_KEYWORD("RPS", JS_RPS),
+    JSON_KEYWORD("LPCO", JS_LPCO),
+    JSON_KEYWORD("RPCO", JS_RPCO),
+    JSON_KEYWORD("LPPB", JS_LPPB),
+    JSON_KEYWORD("RPPB", JS_RPPB),
+    JSON_KEYWORD("LPPE", JS_LPPE),
+    JSON_KEYWORD("RPPE", JS_RPPE),
+    JSON_KEYWORD("LPPPB", JS_LPPPB),
+    JSON_KEYWORD("RPPPB", JS_RPPPB),
+    JSON_KEYWORD("LPPPE", JS_LPPPE),
+    JSON_KEYWORD("RPPPE", JS_RPPPE),
+    JSON_KEYWORD("SMO2", JS_SMO2),
+    JSON_KEYWORD("THB", JS_THB),
+    JSON_KEYWORD("RCON", JS_RCON),
+    JSON_KEYWORD("RVERT", JS_RVERT),
+    JSON_KEYWORD("RCAD", JS_RCAD),
+
+    // xdata samples
+    JSON_KEYWORD("VALUE", JS_VALUE),
+    JSON_KEYWORD("VALUES", JS_VALUES),
+
+    // everything else
+    JSON_KEYWORD("RIDE", JS_RIDE),
+    JSON_KEYWORD("STARTTIME", JS_STARTTIME),
+    JSON_KEYWORD("RECINTSECS", JS_RECINTSECS),
+    JSON_KEYWORD("DEVICETYPE", JS_DEVICETYPE),
+    JSON_KEYWORD("IDENTIFIER", JS_IDENTIFIER),
+    JSON_KEYWORD("OVERRIDES", JS_OVERRIDES),
+    JSON_KEYWORD("TAGS", JS_TAGS),
+    JSON_KEYWORD("INTERVALS", JS_INTERVALS),
+    JSON_KEYWORD("NAME", JS_NAME),
+    JSON_KEYWORD("START", JS_START),
+    JSON_KEYWORD("STOP", JS_STOP),
+    JSON_KEYWORD("PTEST", JS_TEST), // bool is a performance test
+    JSON_KEYWORD("COLOR", JS_COLOR),
+    JSON_KEYWORD("CALIBRATIONS", JS_CALIBRATIONS),
+    JSON_KEYWORD("UNIT", JS_UNIT),
+    JSON_KEYWORD("UNITS", JS_UNITS),
+    JSON_KEYWORD("XDATA", JS_XDATA),
+    JSON_KEYWORD("REFERENCES", JS_REFERENCES),
+    JSON_KEYWORD("SAMPLES", JS_SAMPLES)
+};
+#undef JSON_KEYWORD
+
+static const int jsonKeywordCount = sizeof(jsonKeywords) / sizeof(jsonKeywords[0]);
+
+static inline bool jsonDigit(char c) { return c >= '0' && c <= '9'; }
+
+// parser state, one per file so parsing is reentrant
+struct JsonContext {
+
+    JsonContext(const char *begin, const char *end, RideFile *ride)
+        : p(begin), end(end), token(JS_END), text(NULL), length(0), JsonRide(ride), failed(false) { next(); }
+
+    // the scanner, text and length are the current token
+    const char *p, *end;
+    int token;
+    const char *text;
+    int length;
+
+    // Set during parser processing
+    RideFile *JsonRide;
+    bool failed;
+    QStringList JsonRideFileerrors;
+
+    // term state data is held in these variables
+    RideFilePoint JsonPoint;
+    RideFileInterval JsonInterval;
+    RideFileCalibration JsonCalibration;
+    QString JsonOverName, JsonOverKey, JsonOverValue;
+    QMap <QString, QString> JsonOverrides;
+
+    XDataSeries xdataseries;
+    XDataPoint xdatapoint;
+    QStringList stringlist;
+    QVector<double> numberlist;
+
+    // scanner
+    void next();
+
+    // terms
+    bool fail();
+    bool expect(int t) { if (token != t) return fail(); next(); return true; }
+    bool more() { if (token != ',') return false; next(); return true; } // another list item?
+    bool string(QString &value);
+    bool number(double &value);
+    bool listnumber(double &value);
+
+    // grammar
+    bool document();
+    bool ride();
+    bool rideelement();
+    bool override();
+    bool override_value();
+    bool tag();
+    bool interval();
+    bool calibration();
+    bool series();
+    bool sample();
+    bool reference();
+    bool xdata_series();
+    bool xdata_item();
+    bool xdata_sample();
+    bool xdata_value();
+};
+
+bool
+JsonContext::fail()
+{
+    // like the grammar we stop at the first error
+    if (!failed) JsonRideFileerrors << "syntax error";
+    failed = true;
+    token = JS_END;
+    return false;
+}
+
+void
+JsonContext::next()
+{
+    if (failed) return;
+
+    // we just ignore whitespace
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r')) p++;
+
+    text = p;
+    if (p == end) {
+        token = JS_END;
+        length = 0;
+        return;
+    }
+
+    if (*p == '"') {
+
+        // a string runs to the first quote that isn't preceded by a
+        // backslash, which is how the lexer matched them
+        const char *q = p + 1;
+        while (q < end && !(*q == '"' && *(q-1) != '\\')) q++;
+
+        if (q < end) {
+
+            p = q + 1;
+            length = p - text;
+
+            // quoted keywords must match exactly, anything else is a string
+            token = JS_STRING;
+            for (int i=0; i<jsonKeywordCount; i++) {
+                if (jsonKeywords[i].length == length - 2 && !memcmp(jsonKeywords[i].name, text + 1, length - 2)) {
+                    token = jsonKeywords[i].token;
+                    break;
+                }
+            }
+            return;
+        }
+
+    } else {
+
+        // [-+]?[0-9]+ is an integer, [-+]?[0-9]+e-[0-9]+ and
+        // [-+]?[0-9]+\.[-+e0-9]* are floats
+        const char *q = p;
+        if (*q == '-' || *q == '+') q++;
+        const char *digits = q;
+        while (q < end && jsonDigit(*q)) q++;
+
+        if (q > digits) {
+            token = JS_INTEGER;
+            if (q < end && *q == '.') {
+                token = JS_FLOAT;
+                q++;
+                while (q < end && (jsonDigit(*q) || *q == '-' || *q == '+' || *q == 'e')) q++;
+            } else if (q+2 < end && q[0] == 'e' && q[1] == '-' && jsonDigit(q[2])) {
+                token = JS_FLOAT;
+                q += 2;
+                while (q < end && jsonDigit(*q)) q++;
+            }
+            p = q;
+            length = p - text;
+            return;
+        }
+    }
+
+    // any other character, typically :, { or }
+    token = uchar(*p++);
+    length = 1;
+}
+
+bool
+JsonContext::string(QString &value)
+{
+    if (token != JS_STRING) return fail();
+
+    // sending UTF-8 to FLEX demands symetric conversion back to QString
+    QString s = QString::fromUtf8(text + 1, length - 2);
+
+    // does it end with a space (to avoid token conflict) ?
+    QStringRef r(&s);
+    if (r.endsWith(" ")) r = r.mid(0, r.length()-1);
+
+    value = Utils::RidefileUnEscape(r);
+    next();
+    return true;
+}
+
+bool
+JsonContext::number(double &value)
+{
+    if (token == JS_INTEGER) {
+
+        // the grammar used QString::toInt(), which is 0 on overflow
+        const char *q = text;
+        bool negative = false;
+        if (*q == '-' || *q == '+') negative = (*q++ == '-');
+        qint64 integer = 0;
+        for (; q < text + length && integer <= qint64(INT_MAX) + 1; q++) integer = (integer * 10) + (*q - '0');
+        if (negative) integer = -integer;
+        value = (integer > INT_MAX || integer < INT_MIN) ? 0 : integer;
+
+    } else if (token == JS_FLOAT) {
+
+        value = Utils::number(text, length);
+
+    } else return fail();
+
+    next();
+    return true;
+}
+
+// number lists always converted the token text as a double
+bool
+JsonContext::listnumber(double &value)
+{
+    if (token != JS_INTEGER && token != JS_FLOAT) return fail();
+
+    value = Utils::number(text, length);
+    next();
+    return true;
+}
+
+/* We allow a .json file to be encapsulated within optional braces */
+/* multiple rides in a single file are supported, rides will be joined */
+bool
+JsonContext::document()
+{
+    bool braces = (token == '{');
+    if (braces) next();
+
+    do {
+        if (!ride()) return false;
+    } while (more());
+
+    if (braces && !expect('}')) return false;
+    if (token != JS_END) return fail();
+    return true;
+}
+
+bool
+JsonContext::ride()
+{
+    if (!expect(JS_RIDE) || !expect(':') || !expect('{')) return false;
+
+    do {
+        if (!rideelement()) return false;
+    } while (more());
+
+    return expect('}');
+}
+
+bool
+JsonContext::rideelement()
+{
+    QString string;
+    double number;
+
+    switch (token) {
+
+    //
+    // First class variables
+    //
+    case JS_STARTTIME:
+        {
+            next();
+            if (!expect(':') || !this->string(string)) return false;
+            QDateTime aslocal = QDateTime::fromString(string, DATETIME_FORMAT);
+            QDateTime asUTC = QDateTime(aslocal.date(), aslocal.time(), Qt::UTC);
+            JsonRide->setStartTime(asUTC.toLocalTime());
+        }
+        return true;
+
+    case JS_RECINTSECS:
+        next();
+        if (!expect(':') || !this->number(number)) return false;
+        JsonRide->setRecIntSecs(number);
+        return true;
+
+    case JS_DEVICETYPE:
+        next();
+        if (!expect(':') || !this->string(string)) return false;
+        JsonRide->setDeviceType(string);
+        return true;
+
+    case JS_IDENTIFIER:
+        next();
+        if (!expect(':') || !this->string(string)) return false;
+        JsonRide->setId(string);
+        return true;
+
+    //
+    // Metric Overrides
+    //
+    case JS_OVERRIDES:
+        next();
+        if (!expect(':') || !expect('[')) return false;
+        do {
+            if (!override()) return false;
+        } while (more());
+        return expect(']');
+
+    //
+    // Ride metadata tags
+    //
+    case JS_TAGS:
+        next();
+        if (!expect(':') || !expect('{')) return false;
+        do {
+            if (!tag()) return false;
+        } while (more());
+        return expect('}');
+
+    //
+    // Intervals
+    //
+    case JS_INTERVALS:
+        next();
+        if (!expect(':') || !expect('[')) return false;
+        do {
+            if (!interval()) return false;
+        } while (more());
+        return expect(']');
+
+    //
+    // Calibrations
+    //
+    case JS_CALIBRATIONS:
+        next();
+        if (!expect(':') || !expect('[')) return false;
+        do {
+            if (!calibration()) return false;
+        } while (more());
+        return expect(']');
+
+    //
+    // Ride references
+    //
+    case JS_REFERENCES:
+        next();
+        if (!expect(':') || !expect('[')) return false;
+        do {
+            if (!reference()) return false;
+        } while (more());
+        if (!expect(']')) return false;
+        JsonPoint = RideFilePoint();
+        return true;
+
+    //
+    // Ride datapoints
+    //
+    case JS_SAMPLES:
+        next();
+        if (!expect(':') || !expect('[')) return false;
+        do {
+            if (!sample()) return false;
+        } while (more());
+        return expect(']');
+
+    //
+    // XData series
+    //
+    case JS_XDATA:
+        next();
+        if (!expect(':') || !expect('[')) return false;
+        do {
+            if (!xdata_series()) return false;
+        } while (more());
+        return expect(']');
+
+    default:
+        return fail();
+    }
+}
+
+bool
+JsonContext::override()
+{
+    QString name;
+    if (!expect('{') || !string(name)) return false;
+
+    // we renamed time riding to time moving ...
+    if (name == "Time Riding") JsonOverName = "Time Moving";
+    else JsonOverName = name;
+
+    if (!expect(':') || !expect('{')) return false;
+    do {
+        if (!override_value()) return false;
+    } while (more());
+    if (!expect('}') || !expect('}')) return false;
+
+    JsonRide->metricOverrides.insert(JsonOverName, JsonOverrides);
+    JsonOverrides.clear();
+    return true;
+}
+
+// the grammar defined override_value twice, so values could nest and a
+// bare string was accepted, we keep accepting them
+bool
+JsonContext::override_value()
+{
+    QString string;
+    if (!this->string(string)) return false;
+
+    if (token == ':') {
+        JsonOverKey = string;
+        next();
+        if (!override_value()) return false;
+        JsonOverrides.insert(JsonOverKey, JsonOverValue);
+    } else {
+        JsonOverValue = string;
+    }
+    return true;
+}
+
+bool
+JsonContext::tag()
+{
+    QString key, value;
+    if (!string(key)) return false;
+
+    // we renamed time riding to time moving ...
+    if (key == "Time Riding") key = "Time Moving";
+
+    if (!expect(':') || !string(value)) return false;
+    JsonRide->setTag(key, value);
+    return true;
+}
+
+bool
+JsonContext::interval()
+{
+    QString string;
+
+    if (!expect('{') || !expect(JS_NAME) || !expect(':') || !this->string(string) || !expect(',')) return false;
+    JsonInterval.name = string;
+    if (!expect(JS_START) || !expect(':') || !number(JsonInterval.start) || !expect(',')) return false;
+    if (!expect(JS_STOP) || !expect(':') || !number(JsonInterval.stop)) return false;
+
+    // the grammar resolved the optional color and test in favour of the
+    // color, so a test is only accepted after a color
+    if (token == ',') {
+        next();
+        if (!expect(JS_COLOR) || !expect(':') || !this->string(string)) return false;
+        JsonInterval.color.setNamedColor(string);
+
+        if (token == ',') {
+            next();
+            if (!expect(JS_TEST) || !expect(':') || !this->string(string)) return false;
+            JsonInterval.test = (string == "true" ? true : false);
+        }
+    }
+    if (!expect('}')) return false;
+
+    JsonRide->addInterval(RideFileInterval::USER,
+                          JsonInterval.start,
+                          JsonInterval.stop,
+                          JsonInterval.name,
+                          JsonInterval.color,
+                          JsonInterval.test);
+    JsonInterval = RideFileInterval();
+    return true;
+}
+
+bool
+JsonContext::calibration()
+{
+    double value;
+
+    if (!expect('{') || !expect(JS_NAME) || !expect(':') || !string(JsonCalibration.name) || !expect(',')) return false;
+    if (!expect(JS_START) || !expect(':') || !number(JsonCalibration.start) || !expect(',')) return false;
+    if (!expect(JS_VALUE) || !expect(':') || !number(value) || !expect('}')) return false;
+    JsonCalibration.value = value;
+
+    JsonRide->addCalibration(JsonCalibration.start,
+                             JsonCalibration.value,
+                             JsonCalibration.name);
+    JsonCalibration = RideFileCalibration();
+    return true;
+}
+
+// a reference was only ever a single series
+bool
+JsonContext::reference()
+{
+    if (!expect('{') || !series() || !expect('}')) return false;
+
+    JsonRide->appendReference(JsonPoint);
+    JsonPoint = RideFilePoint();
+    return true;
+}
+
+bool
+JsonContext::sample()
+{
+    if (!expect('{')) return false;
+    do {
+        if (!series()) return false;
+    } while (more());
+    if (!expect('}')) return false;
+
+    JsonRide->appendPoint(JsonPoint);
+    JsonPoint = RideFilePoint();
+    return true;
+}
+
+bool
+JsonContext::series()
+{
+    double *value = NULL;
+
+    switch (token) {
+    case JS_SECS: value = &JsonPoint.secs; break;
+    case JS_KM: value = &JsonPoint.km; break;
+    case JS_WATTS: value = &JsonPoint.watts; break;
+    case JS_NM: value = &JsonPoint.nm; break;
+    case JS_CAD: value = &JsonPoint.cad; break;
+    case JS_KPH: value = &JsonPoint.kph; break;
+    case JS_HR: value = &JsonPoint.hr; break;
+    case JS_ALT: value = &JsonPoint.alt; break;
+    case JS_LAT: value = &JsonPoint.lat; break;
+    case JS_LON: value = &JsonPoint.lon; break;
+    case JS_HEADWIND: value = &JsonPoint.headwind; break;
+    case JS_SLOPE: value = &JsonPoint.slope; break;
+    case JS_TEMP: value = &JsonPoint.temp; break;
+    case JS_LRBALANCE: value = &JsonPoint.lrbalance; break;
+    case JS_LTE: value = &JsonPoint.lte; break;
+    case JS_RTE: value = &JsonPoint.rte; break;
+    case JS_LPS: value = &JsonPoint.lps; break;
+    case JS_RPS: value = &JsonPoint.rps; break;
+    case JS_LPCO: value = &JsonPoint.lpco; break;
+    case JS_RPCO: value = &JsonPoint.rpco; break;
+    case JS_LPPB: value = &JsonPoint.lppb; break;
+    case JS_RPPB: value = &JsonPoint.rppb; break;
+    case JS_LPPE: value = &JsonPoint.lppe; break;
+    case JS_RPPE: value = &JsonPoint.rppe; break;
+    case JS_LPPPB: value = &JsonPoint.lpppb; break;
+    case JS_RPPPB: value = &JsonPoint.rpppb; break;
+    case JS_LPPPE: value = &JsonPoint.lpppe; break;
+    case JS_RPPPE: value = &JsonPoint.rpppe; break;
+    case JS_SMO2: value = &JsonPoint.smo2; break;
+    case JS_THB: value = &JsonPoint.thb; break;
+    case JS_RVERT: value = &JsonPoint.rvert; break;
+    case JS_RCAD: value = &JsonPoint.rcad; break;
+    case JS_RCON: value = &JsonPoint.rcontact; break;
+
+    case JS_STRING:
+        {
+            // ignored for future compatibility
+            next();
+            if (!expect(':')) return false;
+            if (token == JS_STRING) return expect(JS_STRING);
+            double ignored;
+            return number(ignored);
+        }
+
+    default:
+        return fail();
+    }
+
+    next();
+    return expect(':') && number(*value);
+}
+
+bool
+JsonContext::xdata_series()
+{
+    if (!expect('{')) return false;
+    do {
+        if (!xdata_item()) return false;
+    } while (more());
+    if (!expect('}')) return false;
+
+    XDataSeries *add = new XDataSeries;
+    add->name=xdataseries.name;
+    add->datapoints=xdataseries.datapoints;
+    add->valuename=xdataseries.valuename;
+    add->unitname=xdataseries.unitname;
+    JsonRide->addXData(add->name, add);
+
+    // clear for next one
+    xdataseries = XDataSeries();
+    return true;
+}
+
+bool
+JsonContext::xdata_item()
+{
+    QString string;
+    int item = token;
+
+    switch (item) {
+    case JS_NAME:
+    case JS_VALUE:
+    case JS_UNIT:
+        next();
+        if (!expect(':') || !this->string(string)) return false;
+        if (item == JS_NAME) xdataseries.name = string;
+        else if (item == JS_VALUE) xdataseries.valuename << string;
+        else xdataseries.unitname << string;
+        return true;
+
+    case JS_VALUES:
+    case JS_UNITS:
+        next();
+        if (!expect(':') || !expect('[')) return false;
+        do {
+            if (!this->string(string)) return false;
+            stringlist << string;
+        } while (more());
+        if (!expect(']')) return false;
+        if (item == JS_VALUES) xdataseries.valuename = stringlist;
+        else xdataseries.unitname = stringlist;
+        stringlist.clear();
+        return true;
+
+    case JS_SAMPLES:
+        next();
+        if (!expect(':') || !expect('[')) return false;
+        do {
+            if (!xdata_sample()) return false;
+        } while (more());
+        return expect(']');
+
+    default:
+        return fail();
+    }
+}
+
+bool
+JsonContext::xdata_sample()
+{
+    if (!expect('{')) return false;
+    do {
+        if (!xdata_value()) return false;
+    } while (more());
+    if (!expect('}')) return false;
+
+    xdataseries.datapoints.append(new XDataPoint(xdatapoint));
+    xdatapoint = XDataPoint();
+    return true;
+}
+
+bool
+JsonContext::xdata_value()
+{
+    double number;
+
+    switch (token) {
+    case JS_SECS:
+        next();
+        return expect(':') && this->number(xdatapoint.secs);
+
+    case JS_KM:
+        next();
+        return expect(':') && this->number(xdatapoint.km);
+
+    case JS_VALUE:
+        next();
+        return expect(':') && this->number(xdatapoint.number[0]);
+
+    case JS_VALUES:
+        next();
+        if (!expect(':') || !expect('[')) return false;
+        do {
+            if (!listnumber(number)) return false;
+            numberlist << number;
+        } while (more());
+        if (!expect(']')) return false;
+        for(int i=0; i<numberlist.count() && i<XDATA_MAXVALUES; i++)
+            xdatapoint.number[i]= numberlist[i];
+        numberlist.clear();
+        return true;
+
+    case JS_STRING:
+        // ignored for future compatibility
+        next();
+        if (!expect(':')) return false;
+        if (token == JS_STRING) return expect(JS_STRING);
+        return this->number(number);
+
+    default:
+        return fail();
+    }
+}
+
+static int jsonFileReaderRegistered =
+    RideFileFactory::instance().registerReader(
+        "json", "GoldenCheetah Json", new JsonFileReader());
+
+RideFile *
+JsonFileReader::openRideFile(QFile &file, QStringList &errors, QList<RideFile*>*) const
+{
+    // Read the entire file, the parser works on the UTF-8 bytes
+    QByteArray contents;
+    if (file.exists() && file.open(QFile::ReadOnly)) {
+
+        contents = file.readAll();
+        file.close();
+
+    } else {
+
+        errors << "unable to open file" + file.fileName();
+        return NULL;
+    }
+
+    const char *begin = contents.constData();
+    const char *end = begin + contents.size();
+
+    // GC .JSON is stored in UTF-8 with BOM(Byte order mark) for identification
+    if (contents.startsWith("\xEF\xBB\xBF")) begin += 3;
+
+    // check if the text contains invalid UTF-8, if yes, read it as Latin1/ISO 8859-1
+    // (assuming this is an "old" non-UTF-8 Json file); plain ascii doesn't need checking
+    QByteArray converted;
+    for (const char *c = begin; c < end; c++) {
+        if (uchar(*c) < 0x80) continue;
+
+        if (QString::fromUtf8(begin, end - begin).contains(QChar::ReplacementCharacter)) {
+            converted = QString::fromLatin1(begin, end - begin).toUtf8();
+            begin = converted.constData();
+            end = begin + converted.size();
+        }
+        break;
+    }
+
+    // the lexer read a nul terminated string
+    const char *nul = static_cast<const char*>(memchr(begin, 0, end - begin));
+    if (nul) end = nul;
+
+    // parse it
+    JsonContext jc(begin, end, new RideFile);
+    jc.document();
+
+    // Only get errors so fail if we have any
+    if (errors.count()) {
+        errors << jc.JsonRideFileerrors;
+        delete jc.JsonRide;
+        return NULL;
+    } else {
+        return jc.JsonRide;
+    }
+}
+
+QByteArray
+JsonFileReader::toByteArray(Context *, const RideFile *ride, bool withAlt, bool withWatts, bool withHr, bool withCad) const
+{
+    QByteArray out;
+
+    // start of document and ride
+    out += "{\n\t\"RIDE\":{\n";
+
+    // first class variables
+    out += "\t\t\"STARTTIME\":\"" + protect(ride->startTime().toUTC().toString(DATETIME_FORMAT)) + "\",\n";
+    out += "\t\t\"RECINTSECS\":" + QString("%1").arg(ride->recIntSecs()) + ",\n";
+    out += "\t\t\"DEVICETYPE\":\"" + protect(ride->deviceType()) + "\",\n";
+    out += "\t\t\"IDENTIFIER\":\"" + protect(ride->id()) + "\"";
+
+    //
+    // OVERRIDES
+    //
+    bool nonblanks = false; // if an override has been deselected it may be blank
+                            // so we only output the OVERRIDES section if we find an
+                            // override whilst iterating over the QMap
+
+    if (ride->metricOverrides.count()) {
+
+
+        QMap<QString,QMap<QString, QString> >::const_iterator k;
+        for (k=ride->metricOverrides.constBegin(); k != ride->metricOverrides.constEnd(); k++) {
+
+            if (nonblanks == false) {
+                out += ",\n\t\t\"OVERRIDES\":[\n";
+                nonblanks = true;
+
+            }
+            // begin of overrides
+            out += "\t\t\t{ \"" + k.key() + "\":{ ";
+
+            // key/value pairs
+            QMap<QString, QString>::const_iterator j;
+            for (j=k.value().constBegin(); j != k.value().constEnd(); j++) {
+
+                // comma separated
+                out += "\"" + j.key() + "\":\"" + j.value() + "\"";
+                if (j+1 != k.value().constEnd()) out += ", ";
+            }
+            if (k+1 != ride->metricOverrides.constEnd()) out += " }},\n";
+            else out += " }}\n";
+        }
+
+        if (nonblanks == true) {
+            // end of the overrides
+            out += "\t\t]";
+        }
+    }
+
+    //
+    // TAGS
+    //
+    if (ride->tags().count()) {
+
+        out += ",\n\t\t\"TAGS\":{\n";
+
+        QMap<QString,QString>::const_iterator i;
+        for (i=ride->tags().constBegin(); i != ride->tags().constEnd(); i++) {
+
+                out += "\t\t\t\"" + i.key() + "\":\"" + protect(i.value()) + "\"";
+                if (i+1 != ride->tags().constEnd()) out += ",\n";
+                else out += "\n";
+        }
+
+        // end of the tags
+        out += "\t\t}";
+    }
+
+    //
+    // INTERVALS
+    //
+    if (!ride->intervals().empty()) {
+
+        out += ",\n\t\t\"INTERVALS\":[\n";
+        bool first = true;
+
+        foreach (RideFileInterval *i, ride->intervals()) {
+            if (first) first=false;
+            else out += ",\n";
+
+            out += "\t\t\t{ ";
+            out += "\"NAME\":\"" + protect(i->name) + "\"";
+            out += ", \"START\": " + QString("%1").arg(i->start);
+            out += ", \"STOP\": " + QString("%1").arg(i->stop);
+            out += ", \"COLOR\":" + QString("\"%1\"").arg(i->color.name());
+            out += ", \"PTEST\":\"" + QString("%1").arg(i->test ? "true" : "false") + "\" }";
+        }
+        out += "\n\t\t]";
+    }
+
+    //
+    // CALIBRATION
+    //
+    if (!ride->calibrations().empty()) {
+
+        out += ",\n\t\t\"CALIBRATIONS\":[\n";
+        bool first = true;
+
+        foreach (RideFileCalibration *i, ride->calibrations()) {
+            if (first) first=false;
+            else out += ",\n";
+
+            out += "\t\t\t{ ";
+            out += "\"NAME\":\"" + protect(i->name) + "\"";
+            out += ", \"START\": " + QString("%1").arg(i->start);
+            out += ", \"VALUE\": " + QString("%1").arg(i->value) + " }";
+        }
+        out += "\n\t\t]";
+    }
+
+    //
+    // REFERENCES
+    //
+    if (!ride->referencePoints().empty()) {
+
+        out += ",\n\t\t\"REFERENCES\":[\n";
+        bool first = true;
+
+        foreach (RideFilePoint *p, ride->referencePoints()) {
+            if (first) first=false;
+            else out += ",\n";
+
+            out += "\t\t\t{ ";
+
+            if (p->watts > 0) out += " \"WATTS\":" + QString("%1").arg(p->watts);
+            if (p->cad > 0) out += " \"CAD\":" + QString("%1").arg(p->cad);
+            if (p->hr > 0) out += " \"HR\":"  + QString("%1").arg(p->hr);
+            if (p->secs > 0) out += " \"SECS\":" + QString("%1").arg(p->secs);
+
+            // sample points in here!
+            out += " }";
+        }
+        out +="\n\t\t]";
+    }
+
+    //
+    // SAMPLES
+    //
+    if (ride->dataPoints().count()) {
+
+        out += ",\n\t\t\"SAMPLES\":[\n";
+        bool first = true;
+
+        // the samples are the bulk of the file so we format them directly
+        // into the buffer, the layout is the same as QString("%1").arg()
+        const RideFileDataPresent *present = ride->areDataPresent();
+        out.reserve(out.size() + (ride->dataPoints().count() * 128));
+
+        foreach (RideFilePoint *p, ride->dataPoints()) {
+
+            if (first) first=false;
+            else out += ",\n";
+
+            out += "\t\t\t{ ";
+
+            // always store time
+            out += "\"SECS\":"; appendNumber(out, p->secs);
+
+            if (present->km) { out += ", \"KM\":"; appendNumber(out, p->km); }
+            if (present->watts && withWatts) { out += ", \"WATTS\":"; appendNumber(out, p->watts); }
+            if (present->nm) { out += ", \"NM\":"; appendNumber(out, p->nm); }
+            if (present->cad && withCad) { out += ", \"CAD\":"; appendNumber(out, p->cad); }
+            if (present->kph) { out += ", \"KPH\":"; appendNumber(out, p->kph); }
+            if (present->hr && withHr) { out += ", \"HR\":"; appendNumber(out, p->hr); }
+            if (present->alt && withAlt) { out += ", \"ALT\":"; appendNumber(out, p->alt, 11); }
+            if (present->lat) { out += ", \"LAT\":"; appendNumber(out, p->lat, 11); }
+            if (present->lon) { out += ", \"LON\":"; appendNumber(out, p->lon, 11); }
+            if (present->headwind) { out += ", \"HEADWIND\":"; appendNumber(out, p->headwind); }
+            if (present->slope) { out += ", \"SLOPE\":"; appendNumber(out, p->slope); }
+            if (present->temp && p->temp != RideFile::NA) { out += ", \"TEMP\":"; appendNumber(out, p->temp); }
+            if (present->lrbalance && p->lrbalance != RideFile::NA) { out += ", \"LRBALANCE\":"; appendNumber(out, p->lrbalance); }
+            if (present->lte) { out += ", \"LTE\":"; appendNumber(out, p->lte); }
+            if (present->rte) { out += ", \"RTE\":"; appendNumber(out, p->rte); }
+            if (present->lps) { out += ", \"LPS\":"; appendNumber(out, p->lps); }
+            if (present->rps) { out += ", \"RPS\":"; appendNumber(out, p->rps); }
+            if (present->lpco) { out += ", \"LPCO\":"; appendNumber(out, p->lpco); }
+            if (present->rpco) { out += ", \"RPCO\":"; appendNumber(out, p->rpco); }
+            if (present->lppb) { out += ", \"LPPB\":"; appendNumber(out, p->lppb); }
+            if (present->rppb) { out += ", \"RPPB\":"; appendNumber(out, p->rppb); }
+            if (present->lppe) { out += ", \"LPPE\":"; appendNumber(out, p->lppe); }
+            if (present->rppe) { out += ", \"RPPE\":"; appendNumber(out, p->rppe); }
+            if (present->lpppb) { out += ", \"LPPPB\":"; appendNumber(out, p->lpppb); }
+            if (present->rpppb) { out += ", \"RPPPB\":"; appendNumber(out, p->rpppb); }
+            if (present->lpppe) { out += ", \"LPPPE\":"; appendNumber(out, p->lpppe); }
+            if (present->rpppe) { out += ", \"RPPPE\":"; appendNumber(out, p->rpppe); }
+            if (present->smo2) { out += ", \"SMO2\":"; appendNumber(out, p->smo2); }
+            if (present->thb) { out += ", \"THB\":"; appendNumber(out, p->thb); }
+            if (present->rcad) { out += ", \"RCAD\":"; appendNumber(out, p->rcad); }
+            if (present->rvert) { out += ", \"RVERT\":"; appendNumber(out, p->rvert); }
+            if (present->rcontact) { out += ", \"RCON\":"; appendNumber(out, p->rcontact); }
+
+            // sample points in here!
+            out += " }";
+        }
+        out +="\n\t\t]";
+    }
+
+    //
+    // XDATA
+    //
+    if (const_cast<RideFile*>(ride)->xdata().count()) {
+        // output the xdata series
+        out += ",\n\t\t\"XDATA\":[\n";
+
+        bool first = true;
+        QMapIterator<QString,XDataSeries*> xdata(const_cast<RideFile*>(ride)->xdata());
+        xdata.toFront();
+        while(xdata.hasNext()) {
+
+            // iterate
+            xdata.next();
+
+            XDataSeries *series = xdata.value();
+
+            // does it have values names?
+            if (series->valuename.isEmpty()) continue;
+
+            if (!first) out += ",\n";
+            out += "\t\t{\n";
+
+            // series name
+            out += "\t\t\t\"NAME\" : \"" + xdata.key() + "\",\n";
+
+            // value names
+            if (series->valuename.count() > 1) {
+                out += "\t\t\t\"VALUES\" : [ ";
+                bool firstv=true;
+                foreach(QString x, series->valuename) {
+                    if (!firstv) out += ", ";
+                    out += "\"" + x + "\"";
+                    firstv=false;
+                }
+                out += " ]";
+            } else {
+                out += "\t\t\t\"VALUE\" : \"" + series->valuename[0] + "\"";
+            }
+
+            // unit names
+            if (series->unitname.count() > 1) {
+                out += ",\n\t\t\t\"UNITS\" : [ ";
+                bool firstv=true;
+                foreach(QString x, series->unitname) {
+                    if (!firstv) out += ", ";
+                    out += "\"" + x + "\"";
+                    firstv=false;
+                }
+                out += " ]";
+            } else {
+                if (series->unitname.count() > 0) out += ",\n\t\t\t\"UNIT\" : \"" + series->unitname[0] + "\"";
+            }
+
+            // samples
+            if (series->datapoints.count()) {
+                out += ",\n\t\t\t\"SAMPLES\" : [\n";
+
+                bool firsts=true;
+                foreach(XDataPoint *p, series->datapoints) {
+                    if (!firsts) out += ",\n";
+
+                    // multi value sample
+                    if (series->valuename.count()>1) {
+
+                        out += "\t\t\t\t{ \"SECS\":"; appendNumber(out, p->secs);
+                        out += ", \"KM\":"; appendNumber(out, p->km);
+                        out += ", \"VALUES\":[ ";
+
+                        bool firstvv=true;
+                        for(int i=0; i<series->valuename.count(); i++) {
+                            if (!firstvv) out += ", ";
+                            appendNumber(out, p->number[i]);
+                            firstvv=false;
+                         }
+                         out += " ] }";
+
+                    } else {
+
+                        out += "\t\t\t\t{ \"SECS\":"; appendNumber(out, p->secs);
+                        out += ", \"KM\":"; appendNumber(out, p->km);
+                        out += ", \"VALUE\":"; appendNumber(out, p->number[0]);
+                        out += " }";
+                    }
+                    firsts = false;
+                }
+
+                out += "\n\t\t\t]\n";
+            } else {
+                out += "\n";
+            }
+
+            out += "\t\t}";
+
+            // now do next
+            first = false;
+        }
+
+        out += "\n\t\t]";
+    }
+
+    // end of ride and document
+    out += "\n\t}\n}\n";
+
+    return out;
+}
+
+// Writes valid .json (validated at www.jsonlint.com)
+bool
+JsonFileReader::writeRideFile(Context *context, const RideFile *ride, QFile &file) const
+{
+    // can we open the file for writing?
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    // truncate existing
+    file.resize(0);
+
+    QByteArray json = toByteArray(context, ride, true, true, true, true);
+
+    // toByteArray is already UTF-8, so just add the BOM
+    // for identification on all platforms
+    file.write("\xEF\xBB\xBF");
+    file.write(json);
+
+    // close
+    file.close();
+
+    return true;
+}
@@ -20,6 +20,7 @@
 #include "Athlete.h"
 #include "Settings.h"
 #include <QDomDocument>
+#include <QXmlStreamReader>
 #include <QVector>
 
 #include <QDebug>
@@ -31,29 +32,118 @@ static int pwxFileReaderRegistered =
 RideFile *
 PwxFileReader::openRideFile(QFile &file, QStringList &errors, QList<RideFile*>*) const
 {
-    QDomDocument doc("TrainingPeaks PWX");
     if (!file.open(QIODevice::ReadOnly)) {
         errors << "Could not open file.";
         return NULL;
     }
 
-    bool parsed = doc.setContent(&file);
+    // stream the file, samples can run to hundreds of thousands
+    // of elements and building a dom tree for them is expensive
+    QXmlStreamReader xml(&file);
+    RideFile *rideFile = PwxFromStream(xml, errors);
     file.close();
-    if (!parsed) {
-        errors << "Could not parse file.";
-        return NULL;
+
+    return rideFile;
+}
+
+// nothing in the tree reads pwx from a dom any more, the document is
+// serialised and streamed so there is only one reader to maintain
+RideFile *
+PwxFileReader::PwxFromDomDoc(QDomDocument doc, QStringList &errors) const
+{
+    QXmlStreamReader xml(doc.toByteArray());
+    return PwxFromStream(xml, errors);
+}
+
+// read the current element to its end tag, returning its text (all
+// descendant text, like QDomElement::text()) and recording the text of
+// each descendant keyed on its path relative to the element e.g.
+// "summarydata/beginning". As with QDomElement::firstChildElement the
+// first element for any given path wins. When ordered is supplied the
+// descendants are also appended to it in document order.
+static QString
+pwxReadElement(QXmlStreamReader &xml, const QString &path,
+               QHash<QString,QString> &values, QList<QPair<QString,QString> > *ordered)
+{
+    QString text;
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (xml.isStartElement()) {
+
+            QString child = path.isEmpty() ? xml.qualifiedName().toString()
+                                           : path + "/" + xml.qualifiedName().toString();
+            QString childText = pwxReadElement(xml, child, values, ordered);
+            if (!values.contains(child)) values.insert(child, childText);
+            if (ordered) ordered->append(QPair<QString,QString>(child, childText));
+            text += childText;
+
+        } else if (xml.isCharacters()) text += xml.text();
+        else if (xml.isEndElement()) break;
     }
+    return text;
+}
+
+// the per-sample fields, looked up by name as they stream past
+enum { PwxOffset, PwxHr, PwxSpd, PwxPwr, PwxPwrRight, PwxTorq, PwxCad, PwxDist,
+       PwxLat, PwxLon, PwxAlt, PwxTemp, PwxLte, PwxRte, PwxLps, PwxRps, PwxSampleFields };
 
-    return PwxFromDomDoc(doc, errors);
+static const char *pwxSampleFieldNames[PwxSampleFields] = {
+    "timeoffset", "hr", "spd", "pwr", "pwrright", "torq", "cad", "dist",
+    "lat", "lon", "alt", "temp",
+    "torque_effectiveness_left", "torque_effectiveness_right",
+    "pedal_smoothness_left", "pedal_smoothness_right"
+};
+
+static int
+pwxSampleField(const QStringRef &name)
+{
+    for (int i=0; i<PwxSampleFields; i++)
+        if (name == QLatin1String(pwxSampleFieldNames[i])) return i;
+    return -1;
+}
+
+// read a <sample> element, the field text is gathered in one buffer that
+// is reused for every field so no string is created per field. The reader
+// may split text into several chunks (at buffer boundaries or around
+// entities and comments) so the chunks are joined before converting.
+// Sets the bit for each field found in present, fields not present are
+// left at zero.
+static void
+pwxReadSample(QXmlStreamReader &xml, double value[PwxSampleFields], quint32 &present, QString &text)
+{
+    for (int i=0; i<PwxSampleFields; i++) value[i] = 0.0;
+    present = 0;
+
+    int depth = 0;
+    int field = -1;
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (xml.isStartElement()) {
+
+            if (++depth == 1) {
+                field = pwxSampleField(xml.qualifiedName());
+                if (field >= 0 && (present & (1u << field))) field = -1; // first one wins
+                else if (field >= 0) present |= (1u << field);
+                text.resize(0);
+            }
+
+        } else if (xml.isCharacters()) {
+
+            if (depth == 1 && field >= 0) text.append(xml.text());
+
+        } else if (xml.isEndElement()) {
+
+            if (depth-- == 0) break;
+            if (depth == 0 && field >= 0) value[field] = text.toDouble();
+            field = -1;
+        }
+    }
 }
 
 RideFile *
-PwxFileReader::PwxFromDomDoc(QDomDocument doc, QStringList&) const
+PwxFileReader::PwxFromStream(QXmlStreamReader &xml, QStringList &errors) const
 {
     RideFile *rideFile = new RideFile();
-    QDomElement root = doc.documentElement();
-    QDomNode workout = root.firstChildElement("workout");
-    QDomNode node = workout.firstChild();
 
     // get the Smart Recording parameters
     QVariant isGarminSmartRecording = appsettings->value(NULL, GC_GARMIN_SMARTRECORD,Qt::Checked);
@@ -90,198 +180,70 @@ PwxFileReader::PwxFromDomDoc(QDomDocument doc, QStringList&) const
     swimXdata->valuename << "DURATION";
     swimXdata->valuename << "STROKES";
 
-    while (!node.isNull()) {
-
-        // athlete
-        if (node.nodeName() == "athlete") {
-
-            QDomElement name = node.firstChildElement("name");
-            if (!name.isNull()) {
-                rideFile->setTag("Athlete Name", name.text());
-            }
-
-            QDomElement weight = node.firstChildElement("weight");
-            if (!weight.isNull()) {
-                rideFile->setTag("Weight", weight.text());
+    // position on the first workout below the root element
+    bool workout = false;
+    if (xml.readNextStartElement()) {
+        while (xml.readNextStartElement()) {
+            if (xml.qualifiedName() == "workout") {
+                workout = true;
+                break;
             }
+            xml.skipCurrentElement();
+        }
+    }
 
-        // workout code
-        } else if (node.nodeName() == "code") {
-
-            QDomElement code = node.toElement();
-            rideFile->setTag("Workout Code", code.text());
-
-        // workout title
-        } else if (node.nodeName() == "title") {
-
-            QDomElement title = node.toElement();
-            rideFile->setTag("Workout Title", title.text());
-
-        // goal / objective
-        } else if (node.nodeName() == "goal") {
-
-            QDomElement goal = node.toElement();
-            rideFile->setTag("Objective", goal.text());
-
-        // sport
-        } else if (node.nodeName() == "sportType") {
-
-            QDomElement sport = node.toElement();
-            rideFile->setTag("Sport", sport.text());
-
-        // notes
-        } else if (node.nodeName() == "cmt") {
-
-            // Add the PWX cmt tag as notes
-            QDomElement notes = node.toElement();
-            rideFile->setTag("Notes", notes.text());
-
-        // device type and info
-        } else if (node.nodeName() == "device") {
-
-            QString devicetype;
-            // make and model
-            QDomElement make = node.firstChildElement("make");
-            if (!make.isNull()) devicetype = make.text();
-            QDomElement model = node.firstChildElement("model");
-            if (!model.isNull()) {
-                if (devicetype != "") devicetype += " ";
-                devicetype += model.text();
-            }
-            rideFile->setDeviceType(devicetype);
-            rideFile->setFileFormat("Peaksware Data File (pwx)");
-
-            // device settings data
-            QString deviceinfo;
-            QDomElement extension = node.firstChildElement("extension");
-            if (!extension.isNull()) {
-                for (QDomElement info=extension.firstChildElement();
-                    !info.isNull();
-                    info = info.nextSiblingElement()) {
-                    deviceinfo += info.tagName();
-                    deviceinfo += ": ";
-                    deviceinfo += info.text();
-                    deviceinfo += '\n';
-                }
-            }
-            rideFile->setTag("Device Info", deviceinfo);
-
-        // start date/time
-        } else if (node.nodeName() == "time") {
-            QDomElement date = node.toElement();
-            rideDate = QDateTime::fromString(date.text(), Qt::ISODate);
-            rideFile->setStartTime(rideDate);
-
-        // interval data
-        } else if (node.nodeName() == "segment") {
-            RideFileInterval add;
-
-            // name
-            QDomElement name = node.firstChildElement("name");
-            if (!name.isNull()) add.name = name.text();
-            else add.name = QString("Interval #%1").arg(++intervals);
-
-            QDomElement summary = node.firstChildElement("summarydata");
-            if (!summary.isNull()) {
-
-                // start
-                QDomElement beginning = summary.firstChildElement("beginning");
-                if (!beginning.isNull()) add.start = beginning.text().toDouble();
-                else add.start = -1;
-
-                // duration - convert to end
-                QDomElement duration = summary.firstChildElement("duration");
-                if (!duration.isNull() && add.start != -1)
-                    add.stop = duration.text().toDouble() + add.start;
-                else
-                    add.stop = -1;
-
-                // add interval
-                if (add.start != -1 && add.stop != -1) {
-                    rideFile->addInterval(RideFileInterval::DEVICE, round(add.start+1), round(add.stop+1), add.name);
-                }
-            }
+    QString text; // sample field buffer, reused
+    while (workout && xml.readNextStartElement()) {
 
         // data points: offset, hr, spd, pwr, torq, cad, dist, lat, lon, alt, temp
-        } else if (node.nodeName() == "sample") {
+        if (xml.qualifiedName() == "sample") {
             RideFilePoint add;
 
+            double value[PwxSampleFields];
+            quint32 present;
+            pwxReadSample(xml, value, present, text);
+
             // offset (secs)
-            QDomElement off = node.firstChildElement("timeoffset");
-            if (!off.isNull()) add.secs = round(off.text().toDouble());
-            else add.secs = 0.0;
+            add.secs = round(value[PwxOffset]);
             // hr
-            QDomElement hr = node.firstChildElement("hr");
-            if (!hr.isNull()) add.hr = hr.text().toDouble();
-            else add.hr = 0.0;
+            add.hr = value[PwxHr];
             // spd in meters per second converted to kph
-            QDomElement spd = node.firstChildElement("spd");
-            if (!spd.isNull()) add.kph = spd.text().toDouble() * 3.6;
-            else add.kph = 0.0;
+            add.kph = value[PwxSpd] * 3.6;
             // pwr
-            QDomElement pwr = node.firstChildElement("pwr");
-            if (!pwr.isNull()) {
-                add.watts = pwr.text().toDouble();
-                // NOTE! undo the fudge to set zero values to
-                //       1 in the writer (below). This is to keep
-                //       the TP upload web-service happy with zero values
-                if (add.watts == 1) add.watts = 0.0;
-            } else add.watts = 0.0;
+            add.watts = value[PwxPwr];
+            // NOTE! undo the fudge to set zero values to
+            //       1 in the writer (below). This is to keep
+            //       the TP upload web-service happy with zero values
+            if ((present & (1u << PwxPwr)) && add.watts == 1) add.watts = 0.0;
             // lrbalance (pwrright)
-            QDomElement lrbalance = node.firstChildElement("pwrright");
-            if (!lrbalance.isNull()) {
+            if (present & (1u << PwxPwrRight)) {
                 if (add.watts == 0) {
                    add.lrbalance = 50.0;
                 } else {
-                    add.lrbalance =(add.watts-lrbalance.text().toDouble())/add.watts*100.0;
+                    add.lrbalance =(add.watts-value[PwxPwrRight])/add.watts*100.0;
                 }
             } else add.lrbalance = RideFile::NA;
             // torq
-            QDomElement torq = node.firstChildElement("torq");
-            if (!torq.isNull()) add.nm = torq.text().toDouble();
-            else add.nm = 0.0;
+            add.nm = value[PwxTorq];
             // cad
-            QDomElement cad = node.firstChildElement("cad");
-            if (!cad.isNull()) add.cad = cad.text().toDouble();
-            else add.cad = 0.0;
+            add.cad = value[PwxCad];
             // dist
-            QDomElement dist = node.firstChildElement("dist");
-            if (!dist.isNull()) add.km = dist.text().toDouble() /1000;
-            else add.km = 0.0;
-
+            add.km = value[PwxDist] /1000;
             // lat
-            QDomElement lat = node.firstChildElement("lat");
-            if (!lat.isNull()) add.lat = lat.text().toDouble();
-            else add.lat = 0.0;
+            add.lat = value[PwxLat];
             // lon
-            QDomElement lon = node.firstChildElement("lon");
-            if (!lon.isNull()) add.lon = lon.text().toDouble();
-            else add.lon = 0.0;
+            add.lon = value[PwxLon];
             // alt
-            QDomElement alt = node.firstChildElement("alt");
-            if (!alt.isNull()) add.alt = alt.text().toDouble();
-            else add.alt = 0.0;
+            add.alt = value[PwxAlt];
             // temp
-            QDomElement temp = node.firstChildElement("temp");
-            if (!temp.isNull()) add.temp = temp.text().toDouble();
+            if (present & (1u << PwxTemp)) add.temp = value[PwxTemp];
             else add.temp = RideFile::NA;
-
-            // torque_effectiveness_left
-            QDomElement lte = node.firstChildElement("torque_effectiveness_left");
-            if (!lte.isNull()) add.lte = lte.text().toDouble();
-            else add.lte = 0.0;
-            // torque_effectiveness_right
-            QDomElement rte = node.firstChildElement("torque_effectiveness_right");
-            if (!rte.isNull()) add.rte = rte.text().toDouble();
-            else add.rte = 0.0;
-            // pedal_smoothness_left
-            QDomElement lps = node.firstChildElement("pedal_smoothness_left");
-            if (!lps.isNull()) add.lps = lps.text().toDouble();
-            else add.lps = 0.0;
-            // pedal_smoothness_right
-            QDomElement rps = node.firstChildElement("pedal_smoothness_right");
-            if (!rps.isNull()) add.rps = rps.text().toDouble();
-            else add.rps = 0.0;
+            // torque_effectiveness_left/right
+            add.lte = value[PwxLte];
+            add.rte = value[PwxRte];
+            // pedal_smoothness_left/right
+            add.lps = value[PwxLps];
+            add.rps = value[PwxRps];
 
             // if there are data points && a time difference > 1sec && smartRecording processing is requested at all
             if ((!rideFile->dataPoints().empty()) && (add.secs > rtime + 1) && (isGarminSmartRecording.toInt() != 0)) {
@@ -425,60 +387,162 @@ PwxFileReader::PwxFromDomDoc(QDomDocument doc, QStringList&) const
                     add.interval);
             }
         
-        } else if (node.nodeName() == "summarydata") {
-
-            // get the summary data in case there are no samples
-            // this is when there is a manual entry, so we can
-            // set the overrides from this
-
-            //<summarydata xmlns="http://www.peaksware.com/PWX/1/0">
-            //<duration>600</duration>
-            //<work>514.632000296428</work>
-            //<tss>100</tss>
-            //<hr></hr>
-            //<spd></spd>
-            //<pwr></pwr>
-            //<dist>23000</dist>
-            //<climbingelevation>14</climbingelevation>
-            //</summarydata>
-
-            // duration
-            QDomElement off = node.firstChildElement("duration");
-            if (!off.isNull()) manualDuration = off.text().toDouble();
-
-            // work
-            off = node.firstChildElement("work");
-            if (!off.isNull()) manualWork = off.text().toDouble();
-
-            // tss
-            off = node.firstChildElement("tss");
-            if (!off.isNull()) manualTSS = off.text().toDouble();
+        } else {
 
-            // hr
-            off = node.firstChildElement("hr");
-            if (!off.isNull()) manualHR = off.text().toDouble();
+            // everything else is small, just collect the element text
+            QString name = xml.qualifiedName().toString();
+            QHash<QString,QString> values;
+            QList<QPair<QString,QString> > ordered;
+            QString text = pwxReadElement(xml, QString(), values, &ordered);
+
+            // athlete
+            if (name == "athlete") {
 
-            // speed
-            off = node.firstChildElement("spd");
-            if (!off.isNull()) manualSpeed = off.text().toDouble();
+                if (values.contains("name")) {
+                    rideFile->setTag("Athlete Name", values.value("name"));
+                }
+
+                if (values.contains("weight")) {
+                    rideFile->setTag("Weight", values.value("weight"));
+                }
 
-            // power
-            off = node.firstChildElement("pwr");
-            if (!off.isNull()) manualPower = off.text().toDouble();
+            // workout code
+            } else if (name == "code") {
 
-            // distance
-            off = node.firstChildElement("dist");
-            if (!off.isNull()) manualKM = off.text().toDouble();
+                rideFile->setTag("Workout Code", text);
 
-            // Elevation
-            off = node.firstChildElement("climbingelevation");
-            if (!off.isNull()) manualElevation = off.text().toDouble();
+            // workout title
+            } else if (name == "title") {
 
+                rideFile->setTag("Workout Title", text);
+
+            // goal / objective
+            } else if (name == "goal") {
+
+                rideFile->setTag("Objective", text);
+
+            // sport
+            } else if (name == "sportType") {
+
+                rideFile->setTag("Sport", text);
+
+            // notes
+            } else if (name == "cmt") {
+
+                // Add the PWX cmt tag as notes
+                rideFile->setTag("Notes", text);
+
+            // device type and info
+            } else if (name == "device") {
+
+                QString devicetype;
+                // make and model
+                if (values.contains("make")) devicetype = values.value("make");
+                if (values.contains("model")) {
+                    if (devicetype != "") devicetype += " ";
+                    devicetype += values.value("model");
+                }
+                rideFile->setDeviceType(devicetype);
+                rideFile->setFileFormat("Peaksware Data File (pwx)");
+
+                // device settings data, the children of the first extension
+                // (they are recorded ahead of the extension element itself)
+                QString deviceinfo;
+                for (int i=0; i<ordered.count(); i++) {
+                    const QString &path = ordered[i].first;
+                    if (path == "extension") break;
+                    if (!path.startsWith("extension/") || path.indexOf('/', 10) != -1) continue;
+                    deviceinfo += path.mid(10);
+                    deviceinfo += ": ";
+                    deviceinfo += ordered[i].second;
+                    deviceinfo += '\n';
+                }
+                rideFile->setTag("Device Info", deviceinfo);
 
-        } else if (node.nodeName() == "extension") {
+            // start date/time
+            } else if (name == "time") {
+                rideDate = QDateTime::fromString(text, Qt::ISODate);
+                rideFile->setStartTime(rideDate);
+
+            // interval data
+            } else if (name == "segment") {
+                RideFileInterval add;
+
+                // name
+                if (values.contains("name")) add.name = values.value("name");
+                else add.name = QString("Interval #%1").arg(++intervals);
+
+                if (values.contains("summarydata")) {
+
+                    // start
+                    if (values.contains("summarydata/beginning")) add.start = values.value("summarydata/beginning").toDouble();
+                    else add.start = -1;
+
+                    // duration - convert to end
+                    if (values.contains("summarydata/duration") && add.start != -1)
+                        add.stop = values.value("summarydata/duration").toDouble() + add.start;
+                    else
+                        add.stop = -1;
+
+                    // add interval
+                    if (add.start != -1 && add.stop != -1) {
+                        rideFile->addInterval(RideFileInterval::DEVICE, round(add.start+1), round(add.stop+1), add.name);
+                    }
+                }
+
+            } else if (name == "summarydata") {
+
+                // get the summary data in case there are no samples
+                // this is when there is a manual entry, so we can
+                // set the overrides from this
+
+                //<summarydata xmlns="http://www.peaksware.com/PWX/1/0">
+                //<duration>600</duration>
+                //<work>514.632000296428</work>
+                //<tss>100</tss>
+                //<hr></hr>
+                //<spd></spd>
+                //<pwr></pwr>
+                //<dist>23000</dist>
+                //<climbingelevation>14</climbingelevation>
+                //</summarydata>
+
+                // duration
+                if (values.contains("duration")) manualDuration = values.value("duration").toDouble();
+
+                // work
+                if (values.contains("work")) manualWork = values.value("work").toDouble();
+
+                // tss
+                if (values.contains("tss")) manualTSS = values.value("tss").toDouble();
+
+                // hr
+                if (values.contains("hr")) manualHR = values.value("hr").toDouble();
+
+                // speed
+                if (values.contains("spd")) manualSpeed = values.value("spd").toDouble();
+
+                // power
+                if (values.contains("pwr")) manualPower = values.value("pwr").toDouble();
+
+                // distance
+                if (values.contains("dist")) manualKM = values.value("dist").toDouble();
+
+                // Elevation
+                if (values.contains("climbingelevation")) manualElevation = values.value("climbingelevation").toDouble();
+            }
         }
+    }
 
-        node = node.nextSibling();
+    // the dom based reader rejected the whole file if it was not
+    // well formed, so we do the same, reading on to the end of the
+    // document since only the first workout is used
+    while (!xml.atEnd()) xml.readNext();
+    if (xml.hasError()) {
+        errors << "Could not parse file.";
+        delete swimXdata;
+        delete rideFile;
+        return NULL;
     }
 
     // post-process and check
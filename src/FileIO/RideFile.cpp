@@ -45,6 +45,7 @@
 
 #include "../qzip/zipwriter.h"
 #include "../qzip/zipreader.h"
+#include "Trace.h"
 
 #ifdef Q_CC_MSVC
 #include <QtZlib/zlib.h>
@@ -201,13 +202,21 @@ RideFile::updateDataTag()
     setTag("Data", flags);
 }
 
+// W'bal may be computed in the background (e.g. by AllPlotWindow when
+// a ride is selected) whilst charts ask for it on the GUI thread, so the
+// recompute is serialised on the ride's own lock. Once it is current the
+// lock is not taken at all, wstale is only cleared after the recompute
+// so nobody is handed a WPrime still being computed
 WPrime *
 RideFile::wprimeData()
 {
-    if (wprime_ == NULL || wstale) {
+    if (!wstale.loadAcquire()) return wprime_;
+
+    QMutexLocker locker(&wprimeLock);
+    if (wprime_ == NULL || wstale.loadAcquire()) {
         if (!wprime_) wprime_ = new WPrime();
         wprime_->setRide(const_cast<RideFile*>(this)); // recompute
-        wstale = false;
+        wstale.storeRelease(false);
     }
     return wprime_;
 }
@@ -849,6 +858,9 @@ RideFile *RideFileFactory::openRideFile(Context *context, QFile &file,
     RideFileReader *reader = readFuncs_.value(suffix.toLower());
     if (!reader) return NULL;
 
+    // timed by file type
+    TraceSpan span("reader", "openRideFile", suffix.toLower());
+
     // if we uncompressed a ride, we need to save to a temporary ride for import
     if (uncompressed) {
 
@@ -1489,20 +1501,7 @@ void RideFile::appendOrUpdatePoint(double secs, double cad, double hr, double km
            forceAppend = true;
     }
 
-    if (forceAppend) {
-        RideFilePoint* point = new RideFilePoint(secs, cad, hr, km, kph, nm, watts, alt, lon, lat,
-                                                 headwind, slope, temp,
-                                                 lrbalance,
-                                                 lte, rte, lps, rps,
-                                                 lpco, rpco,
-                                                 lppb, rppb, lppe, rppe,
-                                                 lpppb, rpppb, lpppe, rpppe,
-                                                 smo2, thb,
-                                                 rvert, rcad, rcontact, tcore,
-                                                 interval);
-
-        dataPoints_.append(point);
-    }
+    if (forceAppend) dataPoints_.append(point);
 
     dataPresent.secs     |= (secs != 0);
     dataPresent.cad      |= (cad != 0);
@@ -2171,7 +2170,8 @@ void
 RideFile::emitSaved()
 {
     weight_ = 0;
-    wstale = dstale = true;
+    dstale = true;
+    wstale.storeRelease(true);
     emit saved();
 }
 
@@ -2179,7 +2179,8 @@ void
 RideFile::emitReverted()
 {
     weight_ = 0;
-    wstale = dstale = true;
+    dstale = true;
+    wstale.storeRelease(true);
     emit reverted();
 }
 
@@ -2187,7 +2188,8 @@ void
 RideFile::emitModified()
 {
     weight_ = 0;
-    wstale = dstale = true;
+    dstale = true;
+    wstale.storeRelease(true);
     emit modified();
 }
 
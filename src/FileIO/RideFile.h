@@ -25,6 +25,8 @@
 #include <QFile>
 #include <QList>
 #include <QMap>
+#include <QMutex>
+#include <QAtomicInt>
 #include <QVector>
 #include <QObject>
 
@@ -412,7 +414,7 @@ class RideFile : public QObject // QObject to emit signals
         void emitReverted();
         void emitModified();
 
-        bool wstale;
+        QAtomicInt wstale; // W'bal needs recomputing
 
     private:
 
@@ -433,6 +435,7 @@ class RideFile : public QObject // QObject to emit signals
         QMap<QString,QString> tags_;
         EditorData *data;
         WPrime *wprime_;
+        QMutex wprimeLock; // held whilst W'bal is recomputed
         double weight_; // cached to save calls to getWeight();
         double totalCount, totalTemp;
 
@@ -26,6 +26,7 @@
 #include "PaceZones.h"
 #include "WPrime.h" // for wbal zones
 #include "LTMSettings.h" // getAllBestsFor needs this
+#include "Trace.h"
 
 #include <cmath> // for pow()
 #include <QDebug>
@@ -928,6 +929,8 @@ void RideFileCache::RideFileCache::compute()
         return;
     }
 
+    TraceSpan span("refresh", "RideFileCache::compute");
+
     // all the mean maxes
     MeanMaxComputer thread1(ride, wattsMeanMax, RideFile::watts); thread1.start();
     MeanMaxComputer thread2(ride, hrMeanMax, RideFile::hr); thread2.start();
@@ -31,7 +31,7 @@ static bool doubles_equal(double a, double b)
 //----------------------------------------------------------------------
 // The public interface to the commands
 //----------------------------------------------------------------------
-RideFileCommand::RideFileCommand(RideFile *ride) : ride(ride), stackptr(0), inLUW(false), luw(NULL)
+RideFileCommand::RideFileCommand(RideFile *ride) : ride(ride), stackptr(0), history(true), inLUW(false), luw(NULL)
 {
     connect(ride, SIGNAL(saved()), this, SLOT(clearHistory()));
     connect(ride, SIGNAL(reverted()), this, SLOT(clearHistory()));
@@ -192,6 +192,8 @@ RideFileCommand::clearHistory()
 void
 RideFileCommand::startLUW(QString name)
 {
+    if (history == false) return; // each command is just executed
+
     luw = new LUWCommand(this, name, ride);
     inLUW = true;
     beginCommand(false, luw);
@@ -224,6 +226,17 @@ RideFileCommand::doCommand(RideCommand *cmd, bool noexec)
         return;
     }
 
+    // no undo, so execute and forget
+    if (history == false) {
+        beginCommand(false, cmd);
+        cmd->doCommand();
+        endCommand(false, cmd);
+        delete cmd;
+
+        ride->emitModified();
+        return;
+    }
+
     // place onto stack
     if (stack.count()) {
         // wipe away commands we can no longer redo
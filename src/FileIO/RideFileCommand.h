@@ -74,6 +74,10 @@ class RideFileCommand : public QObject
         void startLUW(QString name);
         void endLUW();
 
+        // without history commands are executed and discarded, there
+        // is no undo (e.g. batch processing rides that are saved straight away)
+        void setHistory(bool history) { this->history = history; }
+
         // change status
         QString changeLog();
         int undoCount();
@@ -94,6 +98,7 @@ class RideFileCommand : public QObject
         RideFile *ride;
         QVector<RideCommand *> stack;
         int stackptr;
+        bool history;
         bool inLUW;
         LUWCommand *luw;
 };
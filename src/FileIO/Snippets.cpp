@@ -78,6 +78,9 @@ class Snippets : public DataProcessor {
         QString name() {
             return (tr("Snippet export"));
         }
+
+        // each snippet takes the next journal id from the athlete settings
+        bool isThreadSafe() { return false; }
 };
 
 static bool SnippetsAdded = DataProcessorFactory::instance().registerProcessor(QString("Snippet export"), new Snippets());
@@ -42,11 +42,58 @@ TcxParser::TcxParser (RideFile* rideFile, QList<RideFile*> *rides) : rideFile(ri
 }
 
 bool
-TcxParser::startElement( const QString&, const QString&, const QString& qName, const QXmlAttributes& qAttributes)
+TcxParser::parse(QIODevice *device)
 {
-    buffer.clear();
+    if (!device->isOpen() && !device->open(QIODevice::ReadOnly))
+        return false;
 
-    if (qName == "Activity") {
+    QXmlStreamReader xml(device);
+    while (!xml.atEnd()) {
+
+        switch (xml.readNext()) {
+        case QXmlStreamReader::StartElement:
+            startElement(xml.qualifiedName(), xml.attributes());
+            break;
+
+        case QXmlStreamReader::EndElement:
+            endElement(xml.qualifiedName());
+            break;
+
+        case QXmlStreamReader::Characters:
+            buffer.append(xml.text());
+            break;
+
+        default:
+            break;
+        }
+    }
+    return !xml.hasError();
+}
+
+// lat/lon are parsed with the C locale, strtod is only used (as it was
+// historically) when Qt rejects the text, since switching the process
+// locale twice per trackpoint is expensive
+double
+TcxParser::toDegrees() const
+{
+    bool ok;
+    double degrees = buffer.toDouble(&ok);
+    if (ok) return degrees;
+
+    char *p;
+    setlocale(LC_NUMERIC,"C"); // strtod is locale dependent!
+    degrees = strtod(buffer.toLatin1(), &p);
+    setlocale(LC_NUMERIC,"");
+    return degrees;
+}
+
+void
+TcxParser::startElement(const QStringRef &qName, const QXmlStreamAttributes &qAttributes)
+{
+    // truncate rather than clear to keep the allocation
+    buffer.truncate(0);
+
+    if (qName == QLatin1String("Activity")) {
 
         // First initialisation for altitude (not initialised for each point)
         alt= 0;
@@ -74,15 +121,15 @@ TcxParser::startElement( const QString&, const QString&, const QString& qName, c
 
         // Sport ("Biking", "Running", "Other")
         swim = NotSwim;
-        QString sport = qAttributes.value("Sport");
+        QString sport = qAttributes.value(QLatin1String("Sport")).toString();
         if (sport == "Biking") rideFile->setTag("Sport", "Bike");
         else if (sport == "Running") rideFile->setTag("Sport", "Run");
         else if (sport == "Other") swim = MayBeSwim;
         // start of last length for lap swimming
         lastLength = 0.0;
 
-    } else if (qName == "Lap") {
-        lap_start_time = convertToLocalTime(qAttributes.value("StartTime").trimmed());
+    } else if (qName == QLatin1String("Lap")) {
+        lap_start_time = convertToLocalTime(qAttributes.value(QLatin1String("StartTime")).toString().trimmed());
         lapSecs = 0.0;
         lapTrigger = ltManual;
 
@@ -97,7 +144,7 @@ TcxParser::startElement( const QString&, const QString&, const QString& qName, c
         }
         lap++;
 
-    } else if (qName == "Trackpoint") {
+    } else if (qName == QLatin1String("Trackpoint")) {
 
         power = 0.0;
         cadence = 0.0;
@@ -118,51 +165,45 @@ TcxParser::startElement( const QString&, const QString&, const QString& qName, c
         distance = -1;  // nh - we set this to -1 so we can detect if there was a distance in the trackpoint.
         secs = 0;
 
-    } else if (qName == "Creator") {
+    } else if (qName == QLatin1String("Creator")) {
         creator = true;
     }
-
-    return true;
 }
 
-bool
-TcxParser::endElement( const QString&, const QString&, const QString& qName)
+void
+TcxParser::endElement(const QStringRef &qName)
 {
-    if (qName == "Time") {
+    if (qName == QLatin1String("Time")) {
         time = convertToLocalTime(buffer);
         secs = double(start_time.msecsTo(time)) / 1000.00f;
 
-    } else if (qName == "DistanceMeters") { distance = buffer.toDouble() / 1000; }
-    else if (qName == "TotalTimeSeconds") { lapSecs = buffer.toDouble(); }
-    else if (qName == "Watts" || qName.endsWith( ":Watts")) { power = buffer.toDouble(); }          //TCX Extension Fields may use a namespace prefix
-    else if (qName == "Speed" || qName.endsWith(":Speed")) { speed = buffer.toDouble() * 3.6; }     //TCX Extension Fields may use a namespace prefix
-    else if (qName == "RunCadence" || qName.endsWith( ":RunCadence")) { rcad = buffer.toDouble(); } //TCX Extension Fields may use a namespace prefix
-    else if (qName == "Value") { hr = buffer.toDouble(); }
-    else if (qName == "Cadence") { cadence = buffer.toDouble(); }
-    else if (qName == "PedalPower") { lrbalance = buffer.toDouble(); }
-    else if (qName == "TorqueEffLeft") { lte = buffer.toDouble(); }
-    else if (qName == "TorqueEffRight") { rte = buffer.toDouble(); }
-    else if (qName == "PedalSmoothLeft") { lps = buffer.toDouble(); }
-    else if (qName == "PedalSmoothRight") { rps = buffer.toDouble(); }
-    else if (qName == "AltitudeMeters") {
+    } else if (qName == QLatin1String("DistanceMeters")) { distance = buffer.toDouble() / 1000; }
+    else if (qName == QLatin1String("TotalTimeSeconds")) { lapSecs = buffer.toDouble(); }
+    else if (qName == QLatin1String("Watts") || qName.endsWith(QLatin1String(":Watts"))) { power = buffer.toDouble(); }          //TCX Extension Fields may use a namespace prefix
+    else if (qName == QLatin1String("Speed") || qName.endsWith(QLatin1String(":Speed"))) { speed = buffer.toDouble() * 3.6; }     //TCX Extension Fields may use a namespace prefix
+    else if (qName == QLatin1String("RunCadence") || qName.endsWith(QLatin1String(":RunCadence"))) { rcad = buffer.toDouble(); } //TCX Extension Fields may use a namespace prefix
+    else if (qName == QLatin1String("Value")) { hr = buffer.toDouble(); }
+    else if (qName == QLatin1String("Cadence")) { cadence = buffer.toDouble(); }
+    else if (qName == QLatin1String("PedalPower")) { lrbalance = buffer.toDouble(); }
+    else if (qName == QLatin1String("TorqueEffLeft")) { lte = buffer.toDouble(); }
+    else if (qName == QLatin1String("TorqueEffRight")) { rte = buffer.toDouble(); }
+    else if (qName == QLatin1String("PedalSmoothLeft")) { lps = buffer.toDouble(); }
+    else if (qName == QLatin1String("PedalSmoothRight")) { rps = buffer.toDouble(); }
+    else if (qName == QLatin1String("AltitudeMeters")) {
         // on Suunto TCX files there are lots of 0 values between valid ones, skip these
-        if (buffer.toDouble() != 0) {
-            alt = buffer.toDouble();
+        double value = buffer.toDouble();
+        if (value != 0) {
+            alt = value;
         }
-    } else if (qName == "LongitudeDegrees") {
+    } else if (qName == QLatin1String("LongitudeDegrees")) {
+
+        lon = toDegrees();
 
-        char *p; 
-        setlocale(LC_NUMERIC,"C"); // strtod is locale dependent!
-        lon = strtod(buffer.toLatin1(), &p);
-        setlocale(LC_NUMERIC,"");
+    } else if (qName == QLatin1String("LatitudeDegrees")) {
 
-    } else if (qName == "LatitudeDegrees") {
-        char *p;
-        setlocale(LC_NUMERIC,"C"); // strtod is locale dependent!
-        lat = strtod(buffer.toLatin1(), &p);
-        setlocale(LC_NUMERIC,"");
+        lat = toDegrees();
 
-    } else if (qName == "Trackpoint") {
+    } else if (qName == QLatin1String("Trackpoint")) {
 
         // Some TCX lap swimming files uses distance = 0 for no distance...
         if (swim == Swim && distance == 0) distance = -1;
@@ -342,7 +383,7 @@ TcxParser::endElement( const QString&, const QString&, const QString& qName)
         }
         last_distance = distance;
         last_time = time;
-    } else if (qName == "TriggerMethod") {
+    } else if (qName == QLatin1String("TriggerMethod")) {
         // see "TriggerMethod_t" in Garmin's Training Center Database XML (TCX) Schema
         if (buffer == "Distance")
             lapTrigger = ltDistance;
@@ -352,7 +393,7 @@ TcxParser::endElement( const QString&, const QString&, const QString& qName)
             lapTrigger = ltTime;
         else if (buffer == "HeartRate")
             lapTrigger = ltHeartRate;
-    } else if (qName == "Lap") {
+    } else if (qName == QLatin1String("Lap")) {
         // for pool swimming, laps with distance 0 are pauses, without trackpoints
         // length-by-length Swim XData
         if (swim == Swim && distance == 0.0) {
@@ -414,7 +455,7 @@ TcxParser::endElement( const QString&, const QString&, const QString& qName)
 
         double start = double(start_time.msecsTo(lap_start_time)) / 1000.00f;
         rideFile->addInterval(RideFileInterval::DEVICE, start, start + lapSecs, name);
-    } else if (qName == "Activity") {
+    } else if (qName == QLatin1String("Activity")) {
         // Add length-by-length Swim XData, if present
         if (swimXdata && swimXdata->datapoints.count()>0) {
             rideFile->addXData("SWIM", swimXdata);
@@ -422,20 +463,13 @@ TcxParser::endElement( const QString&, const QString&, const QString& qName)
             delete swimXdata;
             swimXdata = NULL;
         }
-    } else if (qName == "Notes") {
+    } else if (qName == QLatin1String("Notes")) {
         // Add Notes to metadata
         rideFile->setTag("Notes", buffer);
-    } else if (qName == "Creator") {
+    } else if (qName == QLatin1String("Creator")) {
         creator = false;
-    } else if (creator && qName == "Name") {
+    } else if (creator && qName == QLatin1String("Name")) {
         if (!buffer.isEmpty())
             rideFile->setDeviceType(buffer);
     }
-    return true;
-}
-
-bool TcxParser::characters( const QString& str )
-{
-    buffer += str;
-    return true;
 }
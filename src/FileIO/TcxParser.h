@@ -24,26 +24,32 @@
 #include "RideFile.h"
 #include <QString>
 #include <QDateTime>
-#include <QXmlDefaultHandler>
+#include <QIODevice>
+#include <QXmlStreamReader>
 #include "Settings.h"
 #include "locale.h" // for LC_LOCALE definition used in strtod
 
-class TcxParser : public QXmlDefaultHandler
+// pull parser, see GpxParser.h
+class TcxParser
 {
 
 public:
 
     TcxParser(RideFile* rideFile, QList<RideFile*>*rides);
 
-    bool startElement( const QString&, const QString&, const QString&, const QXmlAttributes& );
-    bool endElement( const QString&, const QString&, const QString& );
-    bool characters( const QString& );
+    // parse the document on device (opened if needed), returns false
+    // if it was not well formed; the points up to the error are kept
+    bool parse(QIODevice *device);
 
     RideFile*	rideFile;
     QList<RideFile*> *rides; // when parsed multiple rides
 
 private:
 
+    void startElement(const QStringRef &qName, const QXmlStreamAttributes &qAttributes);
+    void endElement(const QStringRef &qName);
+    double toDegrees() const;
+
     QString	buffer;
     QVariant isGarminSmartRecording;
     QVariant GarminHWM;
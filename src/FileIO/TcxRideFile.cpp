@@ -43,11 +43,7 @@ RideFile *TcxFileReader::openRideFile(QFile &file, QStringList &errors, QList<Ri
     rideFile->setFileFormat("Garmin Training Centre (tcx)");
 
     TcxParser handler(rideFile, list);
-
-    QXmlInputSource source (&file);
-    QXmlSimpleReader reader;
-    reader.setContentHandler (&handler);
-    reader.parse (source);
+    handler.parse(&file);
 
     return rideFile;
 }
@@ -881,11 +881,17 @@ AddIntervalDialog::findPeaks(Context *context, bool typeTime, const RideFile *ri
             double start = window.first()->secs;
             double stop = window.last()->secs; //start + duration;
             double avg = total * secsDelta / duration;
-            bests.append(AddedInterval(start, stop, avg));
+
+            // when only the best is wanted, as it is for discovery and
+            // the peak metrics, there is no need to keep and sort them all
+            AddedInterval candidate(start, stop, avg);
+            if (maxIntervals != 1) bests.append(candidate);
+            else if (bests.isEmpty()) bests.append(candidate);
+            else if (CompareBests()(candidate, bests.first())) bests[0] = candidate;
         }
     }
 
-    std::sort(bests.begin(), bests.end(), CompareBests());
+    if (maxIntervals != 1) std::sort(bests.begin(), bests.end(), CompareBests());
 
     while (!bests.empty() && (_results.size() < maxIntervals)) {
         AddedInterval candidate = bests.takeFirst();
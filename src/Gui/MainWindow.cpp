@@ -65,6 +65,7 @@
 #include "MergeActivityWizard.h"
 #include "GenerateHeatMapDialog.h"
 #include "BatchExportDialog.h"
+#include "TraceDialog.h"
 #include "TodaysPlan.h"
 #include "BodyMeasuresDownload.h"
 #include "HrvMeasuresDownload.h"
@@ -610,6 +611,7 @@ MainWindow::MainWindow(const QDir &home)
     helpMenu->addSeparator();
     helpMenu->addAction(tr("&User Guide"), this, SLOT(helpView()));
     helpMenu->addAction(tr("&Log a bug or feature request"), this, SLOT(logBug()));
+    helpMenu->addAction(tr("&Performance Trace..."), this, SLOT(showTrace()));
     helpMenu->addAction(tr("&Discussion and Support Forum"), this, SLOT(support()));
     helpMenu->addSeparator();
     helpMenu->addAction(tr("&About GoldenCheetah"), this, SLOT(aboutDialog()));
@@ -1057,6 +1059,12 @@ MainWindow::aboutDialog()
     ad->exec();
 }
 
+void MainWindow::showTrace()
+{
+    TraceDialog *td = new TraceDialog(currentTab->context);
+    td->show();
+}
+
 void MainWindow::showSolveCP()
 {
    SolveCPDialog *td = new SolveCPDialog(this, currentTab->context);
@@ -122,6 +122,7 @@ class MainWindow : public QMainWindow
         void helpWindow();
         void helpView();
         void logBug();
+        void showTrace();
         void support();
         void actionClicked(int);
 
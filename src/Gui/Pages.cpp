@@ -278,6 +278,17 @@ GeneralPage::GeneralPage(Context *context) : context(context)
     configLayout->addWidget(pythonBrowseButton, 8 + offset,2);
     offset++;
 
+    // worker processes for python metrics and data processors
+    pythonWorkerLabel = new QLabel(tr("Python Workers"));
+    pythonWorkerCount = new QSpinBox(this);
+    pythonWorkerCount->setRange(0, 64);
+    pythonWorkerCount->setValue(appsettings->value(NULL, GC_PYTHON_WORKERS, QThread::idealThreadCount()).toInt());
+    pythonWorkerCount->setToolTip(tr("Processes that run Python metrics and data processors in parallel, 0 to run them all in GoldenCheetah"));
+
+    configLayout->addWidget(pythonWorkerLabel, 8 + offset,0, Qt::AlignRight);
+    configLayout->addWidget(pythonWorkerCount, 8 + offset,1, Qt::AlignLeft);
+    offset++;
+
     bool embedPython = appsettings->value(NULL, GC_EMBED_PYTHON, true).toBool();
     embedPythonchanged(embedPython);
 
@@ -310,6 +321,8 @@ GeneralPage::embedPythonchanged(int state)
     pythonBrowseButton->setVisible(state);
     pythonDirectory->setVisible(state);
     pythonLabel->setVisible(state);
+    pythonWorkerCount->setVisible(state);
+    pythonWorkerLabel->setVisible(state);
 }
 #endif
 
@@ -337,6 +350,7 @@ GeneralPage::saveClicked()
 #endif
 #ifdef GC_WANT_PYTHON
     appsettings->setValue(GC_PYTHON_HOME, pythonDirectory->text());
+    appsettings->setValue(GC_PYTHON_WORKERS, pythonWorkerCount->value());
 #endif
 
     // update to reflect the state - if hidden user hasn't been asked yet to
@@ -126,6 +126,8 @@ class GeneralPage : public QWidget
         QPushButton *pythonBrowseButton;
         QLineEdit *pythonDirectory;
         QLabel *pythonLabel;
+        QSpinBox *pythonWorkerCount;
+        QLabel *pythonWorkerLabel;
 #endif
 #ifdef GC_WANT_R
         QPushButton *rBrowseButton;
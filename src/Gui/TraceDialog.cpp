@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "TraceDialog.h"
+#include "MainWindow.h"
+#include "Colors.h"
+#include "Trace.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QDir>
+#include <QMap>
+
+TraceDialog::TraceDialog(Context *context) : QDialog(context->mainWindow), context(context)
+{
+    setAttribute(Qt::WA_DeleteOnClose);
+    setWindowTitle(tr("Performance Trace"));
+
+    // make the dialog a resonable size
+    setMinimumWidth(600 *dpiXFactor);
+    setMinimumHeight(450 *dpiYFactor);
+
+    QVBoxLayout *layout = new QVBoxLayout;
+    setLayout(layout);
+
+    record = new QCheckBox(tr("Record where the time goes (refresh, activity files, metrics, charts)"), this);
+    record->setChecked(Trace::enabled());
+    layout->addWidget(record);
+
+    spans = new QTreeWidget;
+    spans->headerItem()->setText(0, tr("Span"));
+    spans->headerItem()->setText(1, tr("Calls"));
+    spans->headerItem()->setText(2, tr("Total (ms)"));
+    spans->headerItem()->setText(3, tr("Mean (ms)"));
+    spans->headerItem()->setText(4, tr("Max (ms)"));
+    spans->setColumnCount(5);
+    spans->setColumnWidth(0, 250 *dpiXFactor);
+    spans->setSelectionMode(QAbstractItemView::NoSelection);
+    spans->setUniformRowHeights(true);
+    layout->addWidget(spans);
+
+    QHBoxLayout *buttons = new QHBoxLayout;
+    refreshButton = new QPushButton(tr("Refresh"), this);
+    clearButton = new QPushButton(tr("Clear"), this);
+    saveButton = new QPushButton(tr("Save Trace..."), this);
+    closeButton = new QPushButton(tr("Close"), this);
+    buttons->addWidget(refreshButton);
+    buttons->addWidget(clearButton);
+    buttons->addStretch();
+    buttons->addWidget(saveButton);
+    buttons->addWidget(closeButton);
+    layout->addLayout(buttons);
+
+    connect(record, SIGNAL(clicked()), this, SLOT(recordClicked()));
+    connect(refreshButton, SIGNAL(clicked()), this, SLOT(refreshClicked()));
+    connect(clearButton, SIGNAL(clicked()), this, SLOT(clearClicked()));
+    connect(saveButton, SIGNAL(clicked()), this, SLOT(saveClicked()));
+    connect(closeButton, SIGNAL(clicked()), this, SLOT(accept()));
+
+    refreshClicked();
+}
+
+void
+TraceDialog::recordClicked()
+{
+    Trace::setEnabled(record->isChecked());
+}
+
+void
+TraceDialog::refreshClicked()
+{
+    spans->clear();
+
+    // one branch per category, e.g. each metric under "metric"
+    QMap<QString, QTreeWidgetItem*> categories;
+    foreach(TraceStat stat, Trace::summary()) {
+
+        QTreeWidgetItem *parent = categories.value(stat.category, NULL);
+        if (!parent) {
+            parent = new QTreeWidgetItem(spans->invisibleRootItem());
+            parent->setText(0, stat.category);
+            parent->setText(1, "0");
+            parent->setText(2, "0");
+            categories.insert(stat.category, parent);
+        }
+
+        QTreeWidgetItem *add = new QTreeWidgetItem(parent);
+        add->setText(0, stat.detail != "" ? stat.detail : stat.name);
+        add->setToolTip(0, stat.name);
+        add->setText(1, QString("%1").arg(stat.count));
+        add->setText(2, QString("%1").arg(stat.total / 1000000.0, 0, 'f', 1));
+        add->setText(3, QString("%1").arg(stat.total / 1000000.0 / stat.count, 0, 'f', 2));
+        add->setText(4, QString("%1").arg(stat.max / 1000000.0, 0, 'f', 2));
+
+        // add to the category totals, spans inside others are counted
+        // twice so this is a guide to where to look, not a sum
+        parent->setText(1, QString("%1").arg(parent->text(1).toInt() + stat.count));
+        parent->setText(2, QString("%1").arg(parent->text(2).toDouble() + stat.total / 1000000.0, 0, 'f', 1));
+    }
+    for(int i=0; i<5; i++) spans->header()->setSectionResizeMode(i, i ? QHeaderView::ResizeToContents : QHeaderView::Interactive);
+}
+
+void
+TraceDialog::clearClicked()
+{
+    Trace::clear();
+    refreshClicked();
+}
+
+void
+TraceDialog::saveClicked()
+{
+    QString filename = QFileDialog::getSaveFileName(this, tr("Save Trace"),
+                                                    QDir::homePath() + "/goldencheetah-trace.json",
+                                                    tr("Trace (*.json)"));
+    if (filename == "") return;
+
+    if (!Trace::write(filename)) {
+        QMessageBox::warning(this, tr("Save Trace"), tr("Could not write to %1").arg(filename));
+    }
+}
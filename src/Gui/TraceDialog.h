@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _TraceDialog_h
+#define _TraceDialog_h
+#include "GoldenCheetah.h"
+#include "Context.h"
+
+#include <QDialog>
+#include <QTreeWidget>
+#include <QCheckBox>
+#include <QPushButton>
+
+// Turn tracing on and off, see where the time went by
+// metric, file reader etc and save a trace for bug reports
+class TraceDialog : public QDialog
+{
+    Q_OBJECT
+    G_OBJECT
+
+public:
+    TraceDialog(Context *context);
+
+private slots:
+    void recordClicked();
+    void refreshClicked();
+    void clearClicked();
+    void saveClicked();
+
+private:
+    Context *context;
+
+    QCheckBox *record;
+    QTreeWidget *spans;
+    QPushButton *refreshButton, *clearButton, *saveButton, *closeButton;
+};
+#endif // _TraceDialog_h
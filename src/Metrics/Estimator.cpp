@@ -25,6 +25,7 @@
 #include "Specification.h"
 
 #include "Banister.h"
+#include "Trace.h"
 
 #ifndef ESTIMATOR_DEBUG
 #define ESTIMATOR_DEBUG false
@@ -164,6 +165,8 @@ Estimator::calculate()
 void
 Estimator::run()
 {
+  TraceSpan span("refresh", "Estimator::run");
+
   for (int i = 0; i < 2; i++) {
 
     bool isRun = (i > 0); // two times: one for rides and other for runs
@@ -26,6 +26,7 @@
 #include "Specification.h"
 #include "Season.h"
 #include "Context.h"
+#include "Trace.h"
 
 #include <stdio.h>
 #include <cmath>
@@ -107,6 +108,8 @@ void PMCData::refresh()
 {
     if (!isstale) return;
 
+    TraceSpan span("refresh", "PMCData::refresh");
+
     // we need to reread config if refreshing (it might have changed)
     if (useDefaults) {
 
@@ -24,6 +24,7 @@
 #include "TimeUtils.h"
 #include "Zones.h"
 #include "HrZones.h"
+#include "Trace.h"
 
 // DB Schema Version - YOU MUST UPDATE THIS IF THE SCHEMA VERSION CHANGES!!!
 // Schema version will change if a) the default metadata.xml is updated
@@ -249,7 +250,10 @@ RideMetric::computeMetrics(RideItem *item, Specification spec, const QStringList
             RideMetric *m = factory.newMetric(symbol);
             m->setValue(0.0);
             m->setCount(0);
-            m->compute(item, spec, done);
+            {
+                TraceSpan span("metric", "compute", symbol);
+                m->compute(item, spec, done);
+            }
 
             // override the computed value if set by user, but not for intervals
             if (!spec.interval() && item->ride() && item->ride()->metricOverrides.contains(symbol))
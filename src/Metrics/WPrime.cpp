@@ -1218,13 +1218,14 @@ class WCPZoneTime : public RideMetric {
         tiz.fill(0.0f);
 
         int i=0;
-        if (item->ride()->wprimeData() && item->ride()->wprimeData()->ydata().count()) {
+        WPrime *wprime = item->ride()->wprimeData();
+        if (wprime && wprime->ydata().count()) {
 
             // get the power values
-            foreach(int value, item->ride()->wprimeData()->ydata()) {
+            foreach(int value, wprime->ydata()) {
 
                 // skip if below CP
-                if (item->ride()->wprimeData()->powerValues[i++] <= 0) continue;
+                if (wprime->powerValues[i++] <= 0) continue;
 
                 // percent is PERCENT OF W' USED
                 double percent = 100.0f - ((double (value) / WPRIME) * 100.0f);
@@ -1360,13 +1361,14 @@ class WZoneWork : public RideMetric {
         QVector<double> tiz(4);
         tiz.fill(0.0f);
 
-        if (item->ride()->wprimeData() && item->ride()->wprimeData()->ydata().count()) {
+        WPrime *wprime = item->ride()->wprimeData();
+        if (wprime && wprime->ydata().count()) {
 
             int i=0;
-            foreach(int value, item->ride()->wprimeData()->ydata()) {
+            foreach(int value, wprime->ydata()) {
 
                 // watts is joules when in 1s intervals
-                double kj = item->ride()->wprimeData()->smoothArray[i++]/1000.0f;
+                double kj = wprime->smoothArray[i++]/1000.0f;
 
                 // percent is PERCENT OF W' USED
                 double percent = 100.0f - ((double (value) / WPRIME) * 100.0f);
@@ -0,0 +1,487 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "PythonWorkers.h"
+
+#include "Context.h"
+#include "Athlete.h"
+#include "RideItem.h"
+#include "RideFileCommand.h"
+#include "RideMetadata.h"
+#include "Colors.h"
+#include "Settings.h"
+#include "GcUpgrade.h"
+
+#include <QDir>
+#include <QFile>
+#include <QProcess>
+#include <QTemporaryFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <cmath>
+
+// global pool of workers, NULL if not configured
+PythonWorkers *pythonWorkers;
+
+// shared memory for the series, grows when a ride needs more
+static const qint64 INITIALSIZE = 16*1024*1024;
+
+// same choice of ride as Bindings::selectRideFile for the current ride
+static RideFile *
+selectRideFile(const ScriptContext &scriptContext)
+{
+    if (scriptContext.rideFile) return scriptContext.rideFile;
+
+    RideItem *item = scriptContext.item;
+    if (item && item->ride()) return item->ride();
+
+    if (scriptContext.context) {
+        item = const_cast<RideItem*>(scriptContext.context->currentRideItem());
+        if (item && item->ride()) return item->ride();
+    }
+    return NULL;
+}
+
+//
+// Worker
+//
+PythonWorker::PythonWorker(QString program, QString script, QString library)
+    : failed(false), program(program), script(script), library(library), process(NULL), file(NULL),
+      memory(NULL), size(0), job(NULL), stopping(false)
+{
+    QThread::start();
+}
+
+PythonWorker::~PythonWorker()
+{
+    mutex.lock();
+    stopping = true;
+    wake.wakeAll();
+    mutex.unlock();
+    wait();
+}
+
+bool
+PythonWorker::execute(PythonWorkerJob *job)
+{
+    QMutexLocker locker(&mutex);
+    if (failed || stopping) return false;
+
+    this->job = job;
+    wake.wakeAll();
+    while (this->job) done.wait(&mutex);
+
+    return job->completed;
+}
+
+void
+PythonWorker::run()
+{
+    QMutexLocker locker(&mutex);
+    while (!stopping) {
+
+        if (job == NULL) {
+            wake.wait(&mutex);
+            continue;
+        }
+
+        // talk to the process without holding the lock
+        PythonWorkerJob *current = job;
+        locker.unlock();
+        if (!converse(current)) current->completed = false;
+        locker.relock();
+
+        job = NULL;
+        done.wakeAll();
+    }
+    locker.unlock();
+
+    // the process and the shared memory belong to this thread
+    if (process) {
+        process->closeWriteChannel();
+        if (!process->waitForFinished(1000)) {
+            process->kill();
+            process->waitForFinished(1000);
+        }
+        delete process;
+    }
+    delete file;
+}
+
+bool
+PythonWorker::launch()
+{
+    if (process && process->state() == QProcess::Running) return true;
+
+    // it went away during the last job, start another
+    delete process;
+    process = NULL;
+
+    if (file == NULL) {
+        file = new QTemporaryFile(QDir::tempPath() + "/GCpythonXXXXXX");
+        if (file->open() && file->resize(INITIALSIZE)) {
+            memory = file->map(0, INITIALSIZE);
+            size = INITIALSIZE;
+        }
+        if (memory == NULL) {
+            printd("Cannot map %s\n", file->fileName().toStdString().c_str());
+            failed = true;
+            return false;
+        }
+    }
+
+    process = new QProcess;
+    process->setProgram(program);
+    process->setArguments(QStringList() << "-u" << script << file->fileName() << library);
+    process->start();
+    if (process->waitForStarted(5000) == false) {
+        printd("Failed to start: %s\n", program.toStdString().c_str());
+        delete process;
+        process = NULL;
+        failed = true;
+        return false;
+    }
+    return true;
+}
+
+QByteArray
+PythonWorker::receive()
+{
+    while (!process->canReadLine()) {
+        if (process->waitForReadyRead(-1) == false) return QByteArray();
+    }
+    return process->readLine();
+}
+
+bool
+PythonWorker::send(const QJsonObject &message)
+{
+    process->write(QJsonDocument(message).toJson(QJsonDocument::Compact) + "\n");
+    return process->waitForBytesWritten(-1);
+}
+
+bool
+PythonWorker::converse(PythonWorkerJob *job)
+{
+    if (!launch()) return false;
+
+    RideFile *f = selectRideFile(job->scriptContext);
+
+    // what the script can ask about without a round trip
+    QJsonArray names, present;
+    for (int i=0; i<static_cast<int>(RideFile::none); i++) {
+        RideFile::SeriesType type = static_cast<RideFile::SeriesType>(i);
+        names.append(RideFile::seriesName(type, true));
+        present.append(f ? f->isDataPresent(type) : false);
+    }
+
+    QJsonObject begin;
+    begin.insert("script", job->script);
+    begin.insert("names", names);
+    begin.insert("present", present);
+    begin.insert("xdata", f ? !f->xdata().isEmpty() : false);
+    begin.insert("readOnly", job->scriptContext.readOnly);
+    begin.insert("build", VERSION_LATEST);
+    begin.insert("version", QString(VERSION_STRING));
+
+    qint64 used = 0;
+    bool ok = send(begin);
+    while (ok) {
+
+        QByteArray line = receive();
+        if (line.isEmpty()) break;
+
+        QJsonObject request = QJsonDocument::fromJson(line).object();
+        QString call = request.value("call").toString();
+
+        if (call == "done") {
+
+            job->result = request.value("result").toDouble();
+
+            // same as the embedded interpreter's messages
+            QString output = request.value("messages").toString();
+            if (output != "") job->messages = output.split("\n") << "\n";
+
+            job->completed = request.value("unsupported").toString() == "";
+            return true;
+        }
+
+        QJsonObject reply;
+        if (call == "series") {
+            reply = series(job, static_cast<RideFile::SeriesType>(request.value("type").toInt()), used);
+        } else if (call == "activityMetrics") {
+            reply = activityMetrics(job);
+        } else if (call == "athlete") {
+            reply = athlete(job);
+        }
+        ok = send(reply);
+    }
+
+    // the script crashed the interpreter, start again next time
+    printd("Worker process stopped: %s\n", process->readAllStandardError().constData());
+    process->kill();
+    process->waitForFinished(1000);
+    return false;
+}
+
+QJsonObject
+PythonWorker::series(PythonWorkerJob *job, RideFile::SeriesType type, qint64 &used)
+{
+    RideFile *f = selectRideFile(job->scriptContext);
+
+    // the included points are a range of the whole series
+    int start = 0, count = 0;
+    if (f && type >= 0 && type < RideFile::none) {
+        RideFileIterator it(f, job->scriptContext.spec);
+        start = it.firstIndex();
+        count = (start < 0 || it.lastIndex() < start) ? 0 : it.lastIndex() - start + 1;
+        if (start < 0) start = 0;
+    }
+
+    // grow the shared memory, the worker maps the new size when it sees it.
+    // Windows won't resize a file the worker has mapped, the script is
+    // left to the embedded interpreter instead
+    qint64 needed = used + count * sizeof(double);
+    if (needed > size) {
+        qint64 grow = size;
+        while (grow < needed) grow *= 2;
+
+        file->unmap(memory);
+        memory = file->resize(grow) ? file->map(0, grow) : NULL;
+        if (memory) {
+            size = grow;
+        } else {
+            memory = file->map(0, size);
+            QJsonObject reply;
+            reply.insert("unsupported", true);
+            return reply;
+        }
+    }
+
+    double *values = reinterpret_cast<double*>(memory + used);
+    for (int i=0; i<count; i++) values[i] = f->dataPoints()[start+i]->value(type);
+
+    PythonWorkerJob::Region region;
+    region.type = type;
+    region.start = start;
+    region.count = count;
+    region.offset = used;
+    job->regions << region;
+
+    QJsonObject reply;
+    reply.insert("offset", double(used));
+    reply.insert("count", count);
+    reply.insert("size", double(size));
+    used = needed;
+    return reply;
+}
+
+QJsonObject
+PythonWorker::activityMetrics(PythonWorkerJob *job)
+{
+    // as Bindings::activityMetrics(RideItem*), dates and times as text
+    QJsonObject dict;
+
+    Context *context = job->scriptContext.context;
+    if (context == NULL) return dict;
+
+    RideItem *item = job->scriptContext.item;
+    if (item == NULL) item = const_cast<RideItem*>(context->currentRideItem());
+    if (item == NULL) return dict;
+
+    const RideMetricFactory &factory = RideMetricFactory::instance();
+
+    //
+    // Date and Time
+    //
+    dict.insert("date", item->dateTime.date().toString("yyyy-MM-dd"));
+    dict.insert("time", item->dateTime.time().toString("hh:mm:ss.zzz"));
+
+    //
+    // METRICS
+    //
+    const QHash<QString,RideMetric*> *metrics = job->scriptContext.metrics;
+    bool useMetricUnits = context->athlete->useMetricUnits;
+    for(int i=0; i<factory.metricCount();i++) {
+
+        QString symbol = factory.metricName(i);
+        const RideMetric *metric = factory.rideMetric(symbol);
+        QString name = context->specialFields.internalName(metric->name());
+        name = name.replace(" ","_");
+        name = name.replace("'","_");
+
+        double value = item->metrics()[i] * (useMetricUnits ? 1.0f : metric->conversion()) + (useMetricUnits ? 0.0f : metric->conversionSum());
+
+        // Override if we have precomputed values (UserMetric)
+        if (metrics && metrics->contains(symbol)) value = metrics->value(symbol)->value(useMetricUnits);
+
+        dict.insert(name, value);
+    }
+
+    //
+    // META
+    //
+    foreach(FieldDefinition field, context->athlete->rideMetadata()->getFields()) {
+
+        // don't add incomplete meta definitions or metric override fields
+        if (field.name == "" || field.tab == "" ||
+            context->specialFields.isMetric(field.name)) continue;
+
+        dict.insert(field.name.replace(" ","_"), item->getText(field.name, ""));
+    }
+
+    //
+    // add Color
+    //
+    QString color;
+
+    // apply item color, remembering that 1,1,1 means use default (reverse in this case)
+    if (item->color == QColor(1,1,1,1)) {
+
+        // use the inverted color, not plot marker as that hideous
+        QColor col =GCColor::invertColor(GColor(CPLOTBACKGROUND));
+
+        // white is jarring on a dark background!
+        if (col==QColor(Qt::white)) col=QColor(127,127,127);
+
+        color = col.name();
+    } else
+        color = item->color.name();
+
+    dict.insert("color", color);
+
+    return dict;
+}
+
+QJsonObject
+PythonWorker::athlete(PythonWorkerJob *job)
+{
+    // as Bindings::athlete()
+    QJsonObject dict;
+
+    Context *context = job->scriptContext.context;
+    if (context == NULL) return dict;
+
+    QString cyclist = context->athlete->cyclist;
+    dict.insert("name", cyclist);
+    dict.insert("home", context->athlete->home->root().absolutePath());
+    dict.insert("dob", appsettings->cvalue(cyclist, GC_DOB).toDate().toString("yyyy-MM-dd"));
+    dict.insert("weight", appsettings->cvalue(cyclist, GC_WEIGHT).toDouble());
+    dict.insert("height", appsettings->cvalue(cyclist, GC_HEIGHT).toDouble());
+    dict.insert("gender", appsettings->cvalue(cyclist, GC_SEX).toInt() ? QString("female") : QString("male"));
+
+    return dict;
+}
+
+//
+// Pool
+//
+PythonWorkers::PythonWorkers(QString program, int count) : program(program)
+{
+    // the interpreter wants the worker script as a file, and
+    // library.py for the constants scripts use
+    script = new QTemporaryFile(QDir::tempPath() + "/GCworkerXXXXXX.py");
+    library = new QTemporaryFile(QDir::tempPath() + "/GClibraryXXXXXX.py");
+    QFile source(":python/worker.py"), lib(":python/library.py");
+    if (count > 0 && source.open(QFile::ReadOnly) && script->open() &&
+        lib.open(QFile::ReadOnly) && library->open()) {
+        script->write(source.readAll());
+        script->close();
+        library->write(lib.readAll());
+        library->close();
+
+        for (int i=0; i<count; i++) {
+            PythonWorker *worker = new PythonWorker(program, script->fileName(), library->fileName());
+            workers << worker;
+            free << worker;
+        }
+    }
+    printd("Python workers: %d\n", workers.count());
+}
+
+PythonWorkers::~PythonWorkers()
+{
+    qDeleteAll(workers);
+    delete script;
+    delete library;
+}
+
+bool
+PythonWorkers::available()
+{
+    QMutexLocker locker(&mutex);
+    foreach(PythonWorker *worker, workers)
+        if (!worker->failed) return true;
+    return false;
+}
+
+bool
+PythonWorkers::runline(ScriptContext scriptContext, QString script, double &result, QStringList &messages)
+{
+    // wait for a worker
+    PythonWorker *worker = NULL;
+    mutex.lock();
+    while (free.isEmpty()) {
+        bool usable = false;
+        foreach(PythonWorker *w, workers) if (!w->failed) usable = true;
+        if (!usable) {
+            mutex.unlock();
+            return false;
+        }
+        idle.wait(&mutex);
+    }
+    worker = free.takeLast();
+    mutex.unlock();
+
+    PythonWorkerJob job(scriptContext, script);
+    bool completed = worker->execute(&job);
+
+    if (completed) {
+
+        // edits to the series are applied as Bindings does, one
+        // command per changed sample in a single LUW
+        RideFile *f = selectRideFile(scriptContext);
+        if (f && !scriptContext.readOnly) {
+            foreach(PythonWorkerJob::Region region, job.regions) {
+                const double *values = worker->shared(region.offset);
+                for (int i=0; i<region.count; i++) {
+                    double was = f->dataPoints()[region.start+i]->value(region.type);
+                    if (values[i] == was || (std::isnan(values[i]) && std::isnan(was))) continue;
+
+                    if (scriptContext.editedRideFiles && !scriptContext.editedRideFiles->contains(f)) {
+                        f->command->startLUW("Python");
+                        scriptContext.editedRideFiles->append(f);
+                    }
+                    f->command->setPointValue(region.start+i, region.type, values[i]);
+                    if (!f->isDataPresent(region.type)) f->command->setDataPresent(region.type, true);
+                }
+            }
+        }
+        result = job.result;
+        messages = job.messages;
+    }
+
+    // failed workers aren't given back, waiters check there are some left
+    mutex.lock();
+    if (!worker->failed) free << worker;
+    idle.wakeAll();
+    mutex.unlock();
+
+    return completed;
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GC_PYTHONWORKERS_H
+#define GC_PYTHONWORKERS_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QJsonObject>
+
+#include "PythonEmbed.h"
+
+class QProcess;
+class QTemporaryFile;
+
+class PythonWorkers;
+extern PythonWorkers *pythonWorkers;
+
+// a script run on a worker and what it returned
+class PythonWorkerJob {
+    public:
+        PythonWorkerJob(ScriptContext scriptContext, QString script)
+            : scriptContext(scriptContext), script(script), result(0), completed(false) {}
+
+        ScriptContext scriptContext;
+        QString script;
+
+        double result;
+        QStringList messages;
+        bool completed; // false if it needs the embedded interpreter
+
+        // series handed to the script, written back for data processors
+        struct Region {
+            RideFile::SeriesType type;
+            int start, count;
+            qint64 offset;
+        };
+        QList<Region> regions;
+};
+
+// one python process, with a thread of its own that talks to it
+// while the caller waits
+class PythonWorker : public QThread {
+
+    public:
+        PythonWorker(QString program, QString script, QString library);
+        ~PythonWorker();
+
+        // run the job, blocks until it finishes
+        bool execute(PythonWorkerJob *job);
+
+        // the series the job was given, until the next job
+        const double *shared(qint64 offset) const { return reinterpret_cast<const double*>(memory + offset); }
+
+        // it couldn't be started
+        bool failed;
+
+    protected:
+        void run();
+
+    private:
+        bool launch();
+        bool converse(PythonWorkerJob *job);
+        QByteArray receive();
+        bool send(const QJsonObject &message);
+
+        QJsonObject series(PythonWorkerJob *job, RideFile::SeriesType type, qint64 &used);
+        QJsonObject activityMetrics(PythonWorkerJob *job);
+        QJsonObject athlete(PythonWorkerJob *job);
+
+        QString program, script, library;
+        QProcess *process;
+        QTemporaryFile *file;
+        uchar *memory;
+        qint64 size;
+
+        QMutex mutex;
+        QWaitCondition wake, done;
+        PythonWorkerJob *job;
+        bool stopping;
+};
+
+//
+// Runs Python user metrics and data processors in a pool of worker
+// processes instead of the embedded interpreter, which serialises them
+// all under the one GIL.
+//
+// Each worker has its own interpreter so metrics computed on the
+// RideCache refresh threads run in parallel. Ride series are passed in a
+// memory mapped file shared with the worker, filled when the script asks
+// for them. Scripts that use calls the workers don't support are run by
+// the embedded interpreter as before.
+//
+class PythonWorkers {
+
+    public:
+        PythonWorkers(QString program, int count);
+        ~PythonWorkers();
+
+        // run on a worker, false if it needs the embedded interpreter
+        bool runline(ScriptContext scriptContext, QString script, double &result, QStringList &messages);
+
+        // workers are configured and at least one could be started
+        bool available();
+
+    private:
+        QString program;
+        QTemporaryFile *script, *library;
+
+        QMutex mutex;
+        QWaitCondition idle;
+        QList<PythonWorker*> workers, free;
+};
+
+#endif
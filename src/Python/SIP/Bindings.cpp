@@ -20,6 +20,7 @@
 
 #include <QWebEngineView>
 #include <QUrl>
+#include <QMutexLocker>
 #include <datetime.h> // for Python datetime macros
 
 long Bindings::threadid() const
@@ -641,10 +642,6 @@ Bindings::series(int type, PyObject* activity) const
     RideFile *f = selectRideFile(activity);
     if (f == nullptr) return nullptr;
 
-    // count the included points, create data series output and copy data
-    int pCount = 0;
-    RideFileIterator it(f, python->contexts.value(threadid()).spec);
-    while (it.hasNext()) { it.next(); pCount++; }
     RideFile::SeriesType seriesType = static_cast<RideFile::SeriesType>(type);
     bool readOnly = python->contexts.value(threadid()).readOnly;
     QList<RideFile *> *editedRideFiles = python->contexts.value(threadid()).editedRideFiles;
@@ -653,14 +650,76 @@ Bindings::series(int type, PyObject* activity) const
         editedRideFiles->append(f);
     }
 
-    PythonDataSeries* ds = new PythonDataSeries(seriesName(type), pCount, readOnly, seriesType, f);
-    it.toFront();
-    for(int i=0; i<pCount && it.hasNext(); i++) {
-        struct RideFilePoint *point = it.next();
-        ds->data[i] = point->value(seriesType);
+    // the included points are a range of the whole series
+    RideFileIterator it(f, python->contexts.value(threadid()).spec);
+    int start = it.firstIndex();
+    int pCount = (start < 0 || it.lastIndex() < start) ? 0 : it.lastIndex() - start + 1;
+
+    QVector<double> values = PythonSeriesCache::instance().series(f, seriesType);
+    if (start < 0 || start + pCount > values.count()) start = pCount = 0;
+
+    return new PythonDataSeries(seriesName(type), values, start, pCount, readOnly, seriesType, f);
+}
+
+// get the data series for many activities at once, a list of
+// series per activity and NULL where there is no such ride
+QList<PythonDataSeries*>
+Bindings::activitiesSeries(PyObject* types, PyObject* activities, QStringList &names) const
+{
+    QList<PythonDataSeries*> returning;
+
+    // which series?
+    QList<RideFile::SeriesType> wanted;
+    PyObject *seq = PySequence_Fast(types, "series must be a list of series types");
+    if (seq == NULL) return returning;
+    for (Py_ssize_t i=0; i<PySequence_Fast_GET_SIZE(seq); i++) {
+        long type = PyLong_AsLong(PySequence_Fast_GET_ITEM(seq, i));
+        if (type == -1 && PyErr_Occurred()) break;
+        if (type < 0 || type >= static_cast<int>(RideFile::none)) continue;
+        wanted << static_cast<RideFile::SeriesType>(type);
+        names << seriesName(type);
+    }
+    Py_DECREF(seq);
+    if (wanted.isEmpty()) return returning;
+
+    // which rides, the current one when not given
+    QList<RideItem*> items;
+    QList<RideFile*> files;
+    if (activities == NULL || activities == Py_None) {
+        RideFile *f = selectRideFile();
+        items << NULL;
+        files << f;
+    } else {
+        seq = PySequence_Fast(activities, "activities must be a list of dates");
+        if (seq == NULL) return returning;
+        for (Py_ssize_t i=0; i<PySequence_Fast_GET_SIZE(seq); i++) {
+            items << fromDateTime(PySequence_Fast_GET_ITEM(seq, i));
+            files << NULL;
+        }
+        Py_DECREF(seq);
     }
 
-    return ds;
+    for (int i=0; i<items.count(); i++) {
+
+        // rides we open just to read them are closed again, the
+        // series handed out keep the values
+        RideItem *item = items[i];
+        bool opened = item && !item->isOpen();
+        RideFile *f = item ? item->ride() : files[i];
+
+        foreach(RideFile::SeriesType type, wanted) {
+            if (f == NULL) {
+                returning << NULL;
+                continue;
+            }
+
+            // bulk access is read-only, editing goes through series()
+            QVector<double> values = PythonSeriesCache::instance().series(f, type);
+            returning << new PythonDataSeries(seriesName(type), values, 0, values.count(), true, type, NULL);
+        }
+        if (opened) item->close();
+    }
+    return returning;
 }
 
 // get the wbal series for the currently selected ride
@@ -686,7 +745,8 @@ Bindings::activityWbal(PyObject* activity) const
         pCount++;
     }
     PythonDataSeries* ds = new PythonDataSeries("WBal", pCount);
-    for(int i=0; i<pCount; i++) ds->data[i] = w->ydata()[i+idxStart];
+    double *data = ds->data();
+    for(int i=0; i<pCount; i++) data[i] = w->ydata()[i+idxStart];
 
     return ds;
 }
@@ -723,10 +783,11 @@ Bindings::xdata(QString name, QString series, QString join, PyObject* activity)
     PythonDataSeries* ds = new PythonDataSeries(QString("%1_%2").arg(name).arg(series), pCount);
     it.toFront();
     int idx = 0;
+    double *data = ds->data();
     for(int i=0; i<pCount && it.hasNext(); i++) {
         struct RideFilePoint *point = it.next();
         double val = f->xdataValue(point, idx, name, series, xjoin);
-        ds->data[i] = (val == RideFile::NA) ? sqrt(-1) : val; // NA => NaN
+        data[i] = (val == RideFile::NA) ? sqrt(-1) : val; // NA => NaN
     }
 
     return ds;
@@ -824,35 +885,132 @@ Bindings::seriesPresent(int type, PyObject* activity) const
 }
 
 PythonDataSeries::PythonDataSeries(QString name, Py_ssize_t count, bool readOnly, RideFile::SeriesType seriesType, RideFile *rideFile)
-    : name(name), count(count), data(NULL), readOnly(readOnly), seriesType(seriesType), rideFile(rideFile)
+    : name(name), count(count), readOnly(readOnly), seriesType(seriesType), rideFile(rideFile), offset(0), view(false)
+{
+    if (count > 0) values.resize(count);
+    else this->count = 0;
+}
+
+PythonDataSeries::PythonDataSeries(QString name, Py_ssize_t count) : name(name), count(count),
+    readOnly(true), seriesType(RideFile::none), rideFile(NULL), offset(0), view(false)
 {
-    if (count > 0) data = new double[count];
+    if (count > 0) values.resize(count);
+    else this->count = 0;
 }
 
-PythonDataSeries::PythonDataSeries(QString name, Py_ssize_t count) : name(name), count(count), data(NULL),
-    readOnly(true), seriesType(RideFile::none), rideFile(NULL)
+PythonDataSeries::PythonDataSeries(QString name, QVector<double> values, int offset, Py_ssize_t count, bool readOnly,
+                                   RideFile::SeriesType seriesType, RideFile *rideFile)
+    : name(name), count(count), readOnly(readOnly), seriesType(seriesType), rideFile(rideFile),
+      values(values), offset(offset), view(true)
 {
-    if (count > 0) data = new double[count];
 }
 
-// default constructor and copy constructor
-PythonDataSeries::PythonDataSeries() : name(QString()), count(0), data(NULL),
-    readOnly(true), seriesType(RideFile::none), rideFile(NULL) {}
+// default constructor and the constructor the generated code uses to
+// take over the series returned by the bindings
+PythonDataSeries::PythonDataSeries() : name(QString()), count(0),
+    readOnly(true), seriesType(RideFile::none), rideFile(NULL), offset(0), view(false) {}
 PythonDataSeries::PythonDataSeries(PythonDataSeries *clone)
 {
-    if (clone) *this = *clone;
-    else {
+    if (clone) {
+        *this = *clone;
+        delete clone;
+    } else {
         name = QString();
         count = 0;
-        data = NULL;
+        readOnly = true;
+        seriesType = RideFile::none;
+        rideFile = NULL;
+        offset = 0;
+        view = false;
     }
 }
 
-PythonDataSeries::~PythonDataSeries()
+double *
+PythonDataSeries::data()
 {
-    if (data) delete[] data;
-    data=NULL;
-    rideFile = NULL;
+    // copy on write, only the range we cover
+    if (view) {
+        if (offset || values.count() != count) values = values.mid(offset, count);
+        offset = 0;
+        view = false;
+    }
+    return values.data();
+}
+
+//
+// Series cache
+//
+// Ride files hold samples as an array of points, so a series has to be
+// gathered into an array before it can be handed to a script. That is
+// done once per ride and series and the array shared by every series
+// handed out until the ride is changed or deleted.
+//
+static const qint64 MAXCACHEDBYTES = 64 * 1024 * 1024;
+
+PythonSeriesCache &
+PythonSeriesCache::instance()
+{
+    static PythonSeriesCache cache;
+    return cache;
+}
+
+QVector<double>
+PythonSeriesCache::series(RideFile *f, RideFile::SeriesType type)
+{
+    QMutexLocker locker(&lock);
+
+    int points = f->dataPoints().count();
+    Key key(f, type);
+    for (int i=0; i<entries.count(); i++) {
+        if (entries[i].key != key) continue;
+
+        // points added or removed without a command
+        if (entries[i].values.count() != points) {
+            bytes -= entries[i].values.count() * sizeof(double);
+            entries.removeAt(i);
+            break;
+        }
+
+        entries.move(i, entries.count()-1);
+        return entries.last().values;
+    }
+
+    // watch it for changes, once
+    if (!watched.contains(f)) {
+        watched.insert(f);
+        QObject::connect(f, &RideFile::modified, [this, f]() { invalidate(f); });
+        QObject::connect(f, &RideFile::reverted, [this, f]() { invalidate(f); });
+        QObject::connect(f->command, &RideFileCommand::endCommand, [this, f]() { invalidate(f); });
+        QObject::connect(f, &QObject::destroyed, [this, f]() { invalidate(f, true); });
+    }
+
+    Entry add;
+    add.key = key;
+    add.values.resize(points);
+    double *data = add.values.data();
+    for (int i=0; i<points; i++) data[i] = f->dataPoints()[i]->value(type);
+    entries.append(add);
+    bytes += points * sizeof(double);
+
+    // least recently used go first, series handed out keep their copy
+    while (bytes > MAXCACHEDBYTES && entries.count() > 1) {
+        bytes -= entries.first().values.count() * sizeof(double);
+        entries.removeFirst();
+    }
+    return add.values;
+}
+
+void
+PythonSeriesCache::invalidate(RideFile *f, bool deleted)
+{
+    QMutexLocker locker(&lock);
+
+    for (int i=0; i<entries.count(); i++) {
+        if (entries[i].key.first != f) continue;
+        bytes -= entries[i].values.count() * sizeof(double);
+        entries.removeAt(i--);
+    }
+    if (deleted) watched.remove(f);
 }
 
 PythonXDataSeries::PythonXDataSeries(QString xdata, QString series, QString unit, int count, bool readOnly, RideFile *rideFile)
@@ -1706,12 +1864,13 @@ Bindings::metrics(QString metric, bool all, QString filter) const
 
             // found, set an array of metric values
             PythonDataSeries* pds = new PythonDataSeries(name, rides);
+            double *data = pds->data();
 
             int idx = 0;
             foreach(RideItem *item, context->athlete->rideCache->rides()) {
                 if (!specification.pass(item)) continue;
                 if (all || range.pass(item->dateTime.date())) {
-                    pds->data[idx++] = item->metrics()[i] * (useMetricUnits ? 1.0f : m->conversion()) + (useMetricUnits ? 0.0f : m->conversionSum());
+                    data[idx++] = item->metrics()[i] * (useMetricUnits ? 1.0f : m->conversion()) + (useMetricUnits ? 0.0f : m->conversionSum());
                 }
             }
 
@@ -2,6 +2,11 @@
 #define _Bindings_h
 
 #include <QString>
+#include <QVector>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QMutex>
 #include "RideFile.h"
 #include "RideFileCache.h"
 #include "RideFileCommand.h"
@@ -10,22 +15,64 @@
 #include <Python.h>
 
 
+// Values are implicitly shared, series taken from a ride are views onto
+// the values held by the series cache and are only copied when written
 class PythonDataSeries {
 
     public:
         PythonDataSeries(QString name, Py_ssize_t count, bool readOnly, RideFile::SeriesType seriesType, RideFile *rideFile);
         PythonDataSeries(QString name, Py_ssize_t count);
+        PythonDataSeries(QString name, QVector<double> values, int offset, Py_ssize_t count, bool readOnly,
+                         RideFile::SeriesType seriesType, RideFile *rideFile);
         PythonDataSeries(PythonDataSeries*);
         PythonDataSeries();
-        ~PythonDataSeries();
+
+        // reading never copies
+        const double *constData() const { return values.constData() + offset; }
+        double at(Py_ssize_t i) const { return values.at(offset + i); }
+
+        // writing takes a copy first if the values are shared
+        double *data();
+
+        // the values may be shared, so exported buffers are read-only
+        bool isView() const { return view; }
 
         QString name;
         Py_ssize_t count;
-        double *data;
 
         bool readOnly;
         int seriesType;
         RideFile *rideFile;
+
+    private:
+        QVector<double> values;
+        int offset;
+        bool view;
+};
+
+// Whole ride series shared by the PythonDataSeries handed to scripts,
+// dropped when the ride is changed, see Bindings.cpp
+class PythonSeriesCache {
+
+    public:
+        static PythonSeriesCache &instance();
+
+        QVector<double> series(RideFile *f, RideFile::SeriesType type);
+        void invalidate(RideFile *f, bool deleted=false);
+
+    private:
+        PythonSeriesCache() : bytes(0) {}
+
+        typedef QPair<RideFile*, int> Key;
+        struct Entry {
+            Key key;
+            QVector<double> values;
+        };
+
+        QMutex lock;
+        QList<Entry> entries;   // least recently used first
+        QSet<RideFile*> watched;
+        qint64 bytes;
 };
 
 class PythonXDataSeries {
@@ -86,6 +133,7 @@ class Bindings {
         int seriesLast() const;
         QString seriesName(int type) const;
         PythonDataSeries *series(int type, PyObject* activity=NULL) const;
+        QList<PythonDataSeries*> activitiesSeries(PyObject* types, PyObject* activities, QStringList &names) const;
         PythonDataSeries *activityWbal(PyObject* activity=NULL) const;
         PythonDataSeries *xdata(QString name, QString series, QString join="repeat", PyObject* activity=NULL) const;
         PythonXDataSeries *xdataSeries(QString name, QString series, PyObject* activity=NULL) const;
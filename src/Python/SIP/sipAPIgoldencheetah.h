@@ -199,6 +199,8 @@
 #define sipName_s2 &sipStrings_goldencheetah[823]
 #define sipNameNr_s1 826
 #define sipName_s1 &sipStrings_goldencheetah[826]
+#define sipNameNr_activitiesSeries 829
+#define sipName_activitiesSeries &sipStrings_goldencheetah[829]
 
 #define sipMalloc                   sipAPI_goldencheetah->api_malloc
 #define sipFree                     sipAPI_goldencheetah->api_free
@@ -404,6 +404,65 @@ static PyObject *meth_Bindings_series(PyObject *sipSelf, PyObject *sipArgs, PyOb
 }
 
 
+extern "C" {static PyObject *meth_Bindings_activitiesSeries(PyObject *, PyObject *, PyObject *);}
+static PyObject *meth_Bindings_activitiesSeries(PyObject *sipSelf, PyObject *sipArgs, PyObject *sipKwds)
+{
+    PyObject *sipParseErr = NULL;
+
+    {
+        PyObject * a0;
+        PyObject * a1 = 0;
+         ::Bindings *sipCpp;
+
+        static const char *sipKwdList[] = {
+            sipName_series,
+            sipName_activities,
+        };
+
+        if (sipParseKwdArgs(&sipParseErr, sipArgs, sipKwds, sipKwdList, NULL, "BP0|P0", &sipSelf, sipType_Bindings, &sipCpp, &a0, &a1))
+        {
+            PyObject * sipRes = 0;
+            int sipIsErr = 0;
+
+#line 376 "goldencheetah.sip"
+        // a dict of series, keyed by name, for each activity
+        QStringList names;
+        QList<PythonDataSeries*> found = sipCpp->activitiesSeries(a0, a1, names);
+        if (PyErr_Occurred()) {
+            qDeleteAll(found);
+            sipIsErr = 1;
+        } else {
+            int n = names.count();
+            int rides = n ? found.count() / n : 0;
+            sipRes = PyList_New(rides);
+            for (int i=0; i<rides; i++) {
+                PyObject *dict = PyDict_New();
+                for (int j=0; j<n; j++) {
+                    PythonDataSeries *ds = found[i*n+j];
+                    if (ds == NULL) continue;
+                    PyObject *value = sipConvertFromNewType(ds, sipType_PythonDataSeries, NULL);
+                    PyDict_SetItemString(dict, names[j].toUtf8().constData(), value);
+                    Py_DECREF(value);
+                }
+                PyList_SET_ITEM(sipRes, i, dict);
+            }
+        }
+#line 451 "./sipgoldencheetahBindings.cpp"
+
+            if (sipIsErr)
+                return 0;
+
+            return sipRes;
+        }
+    }
+
+    /* Raise an exception if the arguments couldn't be parsed. */
+    sipNoMethod(sipParseErr, sipName_Bindings, sipName_activitiesSeries, NULL);
+
+    return NULL;
+}
+
+
 extern "C" {static PyObject *meth_Bindings_activityWbal(PyObject *, PyObject *, PyObject *);}
 static PyObject *meth_Bindings_activityWbal(PyObject *sipSelf, PyObject *sipArgs, PyObject *sipKwds)
 {
@@ -1328,6 +1387,7 @@ static void *init_type_Bindings(sipSimpleWrapper *, PyObject *sipArgs, PyObject
 
 static PyMethodDef methods_Bindings[] = {
     {SIP_MLNAME_CAST(sipName_activities), (PyCFunction)meth_Bindings_activities, METH_VARARGS|METH_KEYWORDS, NULL},
+    {SIP_MLNAME_CAST(sipName_activitiesSeries), (PyCFunction)meth_Bindings_activitiesSeries, METH_VARARGS|METH_KEYWORDS, NULL},
     {SIP_MLNAME_CAST(sipName_activityIntervals), (PyCFunction)meth_Bindings_activityIntervals, METH_VARARGS|METH_KEYWORDS, NULL},
     {SIP_MLNAME_CAST(sipName_activityMeanmax), (PyCFunction)meth_Bindings_activityMeanmax, METH_VARARGS|METH_KEYWORDS, NULL},
     {SIP_MLNAME_CAST(sipName_activityMetrics), (PyCFunction)meth_Bindings_activityMetrics, METH_VARARGS|METH_KEYWORDS, NULL},
@@ -1378,7 +1438,7 @@ sipClassTypeDef sipTypeDef_goldencheetah_Bindings = {
     {
         sipNameNr_Bindings,
         {0, 0, 1},
-        35, methods_Bindings,
+        36, methods_Bindings,
         0, 0,
         0, 0,
         {0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
@@ -40,7 +40,7 @@ static int slot_PythonDataSeries___setitem__(PyObject *sipSelf,PyObject *sipArgs
         } else {
             if (a0 < 0) a0 += sipCpp->count;
             if (a0 >= 0 && a0 < sipCpp->count) {
-                sipCpp->data[a0] = a1;
+                sipCpp->data()[a0] = a1;
                 RideFile *rideFile = sipCpp->rideFile;
                 if (rideFile) {
                     RideFile::SeriesType seriesType = static_cast<RideFile::SeriesType>(sipCpp->seriesType);
@@ -94,7 +94,7 @@ static PyObject *slot_PythonDataSeries___getitem__(PyObject *sipSelf,PyObject *s
 #line 94 "goldencheetah.sip"
         if (a0 < 0) a0 += sipCpp->count;
         if (a0 >= 0 && a0 < sipCpp->count) {
-            sipRes = sipCpp->data[a0];
+            sipRes = sipCpp->at(a0);
         } else {
             PyErr_SetString(PyExc_IndexError, "Index out of range");
             sipError = sipErrorFail;
@@ -180,16 +180,18 @@ static void release_PythonDataSeries(void *sipCppV, int)
 
 #if PY_MAJOR_VERSION >= 3
 extern "C" {static int getbuffer_PythonDataSeries(PyObject *, void *, Py_buffer *, int);}
-static int getbuffer_PythonDataSeries(PyObject *sipSelf, void *sipCppV, Py_buffer *sipBuffer, int )
+static int getbuffer_PythonDataSeries(PyObject *sipSelf, void *sipCppV, Py_buffer *sipBuffer, int sipFlags)
 {
      ::PythonDataSeries *sipCpp = reinterpret_cast< ::PythonDataSeries *>(sipCppV);
     int sipRes;
 
-#line 63 "goldencheetah.sip"
+#line 67 "goldencheetah.sip"
+    // asking for a writable buffer takes a private copy, data() below
+    bool shared = sipCpp->isView() && sipCpp->readOnly && !(sipFlags & PyBUF_WRITABLE);
     sipBuffer->obj = sipSelf;
-    sipBuffer->buf = (void*)sipCpp->data;
+    sipBuffer->buf = shared ? (void*)sipCpp->constData() : (void*)sipCpp->data();
     sipBuffer->len = sipCpp->count * sizeof(double);
-    sipBuffer->readonly = 0;
+    sipBuffer->readonly = shared ? 1 : 0;
     sipBuffer->itemsize = sizeof(double);
     sipBuffer->format = (char*)"d";  // double
     sipBuffer->ndim = 1;
@@ -200,7 +202,7 @@ static int getbuffer_PythonDataSeries(PyObject *sipSelf, void *sipCppV, Py_buffe
 
     Py_INCREF(sipSelf);  // need to increase the reference count
     sipRes = 0;
-#line 204 "./sipgoldencheetahPythonDataSeries.cpp"
+#line 206 "./sipgoldencheetahPythonDataSeries.cpp"
 
     return sipRes;
 }
@@ -213,7 +215,7 @@ static void releasebuffer_PythonDataSeries(PyObject *, void *, Py_buffer *)
 {
 #line 80 "goldencheetah.sip"
     // we do not require any special release function
-#line 217 "./sipgoldencheetahPythonDataSeries.cpp"
+#line 219 "./sipgoldencheetahPythonDataSeries.cpp"
 }
 #endif
 
@@ -106,6 +106,7 @@ const char sipStrings_goldencheetah[] = {
     'u', 'r', 'l', 0,
     's', '2', 0,
     's', '1', 0,
+    'a', 'c', 't', 'i', 'v', 'i', 't', 'i', 'e', 's', 'S', 'e', 'r', 'i', 'e', 's', 0,
 };
 
 
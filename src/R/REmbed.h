@@ -42,6 +42,12 @@
 #include "R_ext/GraphicsEngine.h"
 #include "R_ext/GraphicsDevice.h"
 
+// vectors backed by our own data, the header
+// can only be used from C++ as of R 3.6
+#if R_VERSION >= R_Version(3,6,0)
+#include <R_ext/Altrep.h>
+#endif
+
 // remap
 #include "RLibrary.h"
 
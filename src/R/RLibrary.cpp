@@ -24,6 +24,10 @@
 #include <R_ext/Rdynload.h>
 #include <R_ext/GraphicsEngine.h>
 #include <R_ext/GraphicsDevice.h>
+#include "Rversion.h"
+#if R_VERSION >= R_Version(3,6,0)
+#include <R_ext/Altrep.h>
+#endif
 
 #include "RLibrary.h"
 #include "Settings.h"
@@ -90,6 +94,25 @@ typedef SEXP (*Prot_GC_Rf_install)(const char *);
 typedef SEXP (*Prot_GC_Rf_setAttrib)(SEXP, SEXP, SEXP);
 typedef Rboolean ((*Prot_GC_Rf_isNull))(SEXP s);
 typedef char *((*Prot_GC_R_CHAR))(SEXP x);
+typedef SEXP (*Prot_GC_R_MakeExternalPtr)(void *p, SEXP tag, SEXP prot);
+typedef void *(*Prot_GC_R_ExternalPtrAddr)(SEXP s);
+typedef void (*Prot_GC_R_ClearExternalPtr)(SEXP s);
+typedef void (*Prot_GC_R_RegisterCFinalizerEx)(SEXP s, R_CFinalizer_t fun, Rboolean onexit);
+
+// ALTREP
+#ifdef R_EXT_ALTREP_H_
+typedef R_altrep_class_t (*Prot_GC_R_make_altreal_class)(const char *cname, const char *pname, DllInfo *info);
+typedef SEXP (*Prot_GC_R_new_altrep)(R_altrep_class_t aclass, SEXP data1, SEXP data2);
+typedef SEXP (*Prot_GC_R_altrep_data1)(SEXP x);
+typedef SEXP (*Prot_GC_R_altrep_data2)(SEXP x);
+typedef void (*Prot_GC_R_set_altrep_data2)(SEXP x, SEXP v);
+typedef void (*Prot_GC_R_set_altrep_Length_method)(R_altrep_class_t cls, R_altrep_Length_method_t fun);
+typedef void (*Prot_GC_R_set_altrep_Duplicate_method)(R_altrep_class_t cls, R_altrep_Duplicate_method_t fun);
+typedef void (*Prot_GC_R_set_altvec_Dataptr_method)(R_altrep_class_t cls, R_altvec_Dataptr_method_t fun);
+typedef void (*Prot_GC_R_set_altvec_Dataptr_or_null_method)(R_altrep_class_t cls, R_altvec_Dataptr_or_null_method_t fun);
+typedef void (*Prot_GC_R_set_altreal_Elt_method)(R_altrep_class_t cls, R_altreal_Elt_method_t fun);
+typedef void (*Prot_GC_R_set_altreal_Get_region_method)(R_altrep_class_t cls, R_altreal_Get_region_method_t fun);
+#endif
 
 // Graphics Device
 typedef pGEDevDesc (*Prot_GC_GEcreateDevDesc)(pDevDesc dev);
@@ -169,6 +192,25 @@ Prot_GC_Rf_install ptr_GC_Rf_install;
 Prot_GC_Rf_setAttrib ptr_GC_Rf_setAttrib;
 Prot_GC_Rf_isNull ptr_GC_Rf_isNull;
 Prot_GC_R_CHAR ptr_GC_R_CHAR;
+Prot_GC_R_MakeExternalPtr ptr_GC_R_MakeExternalPtr;
+Prot_GC_R_ExternalPtrAddr ptr_GC_R_ExternalPtrAddr;
+Prot_GC_R_ClearExternalPtr ptr_GC_R_ClearExternalPtr;
+Prot_GC_R_RegisterCFinalizerEx ptr_GC_R_RegisterCFinalizerEx;
+
+// ALTREP
+#ifdef R_EXT_ALTREP_H_
+Prot_GC_R_make_altreal_class ptr_GC_R_make_altreal_class;
+Prot_GC_R_new_altrep ptr_GC_R_new_altrep;
+Prot_GC_R_altrep_data1 ptr_GC_R_altrep_data1;
+Prot_GC_R_altrep_data2 ptr_GC_R_altrep_data2;
+Prot_GC_R_set_altrep_data2 ptr_GC_R_set_altrep_data2;
+Prot_GC_R_set_altrep_Length_method ptr_GC_R_set_altrep_Length_method;
+Prot_GC_R_set_altrep_Duplicate_method ptr_GC_R_set_altrep_Duplicate_method;
+Prot_GC_R_set_altvec_Dataptr_method ptr_GC_R_set_altvec_Dataptr_method;
+Prot_GC_R_set_altvec_Dataptr_or_null_method ptr_GC_R_set_altvec_Dataptr_or_null_method;
+Prot_GC_R_set_altreal_Elt_method ptr_GC_R_set_altreal_Elt_method;
+Prot_GC_R_set_altreal_Get_region_method ptr_GC_R_set_altreal_Get_region_method;
+#endif
 
 // Graphics Device
 Prot_GC_GEcreateDevDesc ptr_GC_GEcreateDevDesc;
@@ -231,6 +273,26 @@ SEXP GC_Rf_install(const char *a) { return (*ptr_GC_Rf_install)(a); }
 SEXP GC_Rf_setAttrib(SEXP a, SEXP b, SEXP c) { return (*ptr_GC_Rf_setAttrib)(a,b,c); }
 Rboolean (GC_Rf_isNull)(SEXP s) { return (*ptr_GC_Rf_isNull)(s); }
 const char *(GC_R_CHAR)(SEXP x) { return (*ptr_GC_R_CHAR)(x); }
+SEXP GC_R_MakeExternalPtr(void *p, SEXP tag, SEXP prot) { return (*ptr_GC_R_MakeExternalPtr)(p,tag,prot); }
+void *GC_R_ExternalPtrAddr(SEXP s) { return (*ptr_GC_R_ExternalPtrAddr)(s); }
+void GC_R_ClearExternalPtr(SEXP s) { (*ptr_GC_R_ClearExternalPtr)(s); }
+void GC_R_RegisterCFinalizerEx(SEXP s, R_CFinalizer_t fun, Rboolean onexit) { (*ptr_GC_R_RegisterCFinalizerEx)(s,fun,onexit); }
+
+// ALTREP
+bool GC_R_altrep = false;
+#ifdef R_EXT_ALTREP_H_
+R_altrep_class_t GC_R_make_altreal_class(const char *a, const char *b, DllInfo *c) { return (*ptr_GC_R_make_altreal_class)(a,b,c); }
+SEXP GC_R_new_altrep(R_altrep_class_t a, SEXP b, SEXP c) { return (*ptr_GC_R_new_altrep)(a,b,c); }
+SEXP GC_R_altrep_data1(SEXP x) { return (*ptr_GC_R_altrep_data1)(x); }
+SEXP GC_R_altrep_data2(SEXP x) { return (*ptr_GC_R_altrep_data2)(x); }
+void GC_R_set_altrep_data2(SEXP x, SEXP v) { (*ptr_GC_R_set_altrep_data2)(x,v); }
+void GC_R_set_altrep_Length_method(R_altrep_class_t a, R_altrep_Length_method_t b) { (*ptr_GC_R_set_altrep_Length_method)(a,b); }
+void GC_R_set_altrep_Duplicate_method(R_altrep_class_t a, R_altrep_Duplicate_method_t b) { (*ptr_GC_R_set_altrep_Duplicate_method)(a,b); }
+void GC_R_set_altvec_Dataptr_method(R_altrep_class_t a, R_altvec_Dataptr_method_t b) { (*ptr_GC_R_set_altvec_Dataptr_method)(a,b); }
+void GC_R_set_altvec_Dataptr_or_null_method(R_altrep_class_t a, R_altvec_Dataptr_or_null_method_t b) { (*ptr_GC_R_set_altvec_Dataptr_or_null_method)(a,b); }
+void GC_R_set_altreal_Elt_method(R_altrep_class_t a, R_altreal_Elt_method_t b) { (*ptr_GC_R_set_altreal_Elt_method)(a,b); }
+void GC_R_set_altreal_Get_region_method(R_altrep_class_t a, R_altreal_Get_region_method_t b) { (*ptr_GC_R_set_altreal_Get_region_method)(a,b); }
+#endif
 
 // Graphics Device
 pGEDevDesc GC_GEcreateDevDesc(pDevDesc dev) { return (*ptr_GC_GEcreateDevDesc)(dev); }
@@ -274,6 +336,13 @@ RLibrary::resolve(const char *symbol)
     }
 }
 
+QFunctionPointer
+RLibrary::resolveOptional(const char *symbol)
+{
+    // not an error if its missing, the caller falls back
+    return libR->resolve(symbol);
+}
+
 // by default any dependant libs will be loaded only if they
 // are in the relevant search path. R libs are rarely in this
 // path, so we update it just whilst we load the libs
@@ -412,6 +481,32 @@ RLibrary::load()
     ptr_GC_Rf_setAttrib = Prot_GC_Rf_setAttrib(resolve("Rf_setAttrib"));
     ptr_GC_Rf_isNull = Prot_GC_Rf_isNull(resolve("Rf_isNull"));
     ptr_GC_R_CHAR = Prot_GC_R_CHAR(resolve("R_CHAR"));
+    ptr_GC_R_MakeExternalPtr = Prot_GC_R_MakeExternalPtr(resolve("R_MakeExternalPtr"));
+    ptr_GC_R_ExternalPtrAddr = Prot_GC_R_ExternalPtrAddr(resolve("R_ExternalPtrAddr"));
+    ptr_GC_R_ClearExternalPtr = Prot_GC_R_ClearExternalPtr(resolve("R_ClearExternalPtr"));
+    ptr_GC_R_RegisterCFinalizerEx = Prot_GC_R_RegisterCFinalizerEx(resolve("R_RegisterCFinalizerEx"));
+
+    // ALTREP arrived in R 3.5, without it vectors are copied into R
+    GC_R_altrep = false;
+#ifdef R_EXT_ALTREP_H_
+    ptr_GC_R_make_altreal_class = Prot_GC_R_make_altreal_class(resolveOptional("R_make_altreal_class"));
+    ptr_GC_R_new_altrep = Prot_GC_R_new_altrep(resolveOptional("R_new_altrep"));
+    ptr_GC_R_altrep_data1 = Prot_GC_R_altrep_data1(resolveOptional("R_altrep_data1"));
+    ptr_GC_R_altrep_data2 = Prot_GC_R_altrep_data2(resolveOptional("R_altrep_data2"));
+    ptr_GC_R_set_altrep_data2 = Prot_GC_R_set_altrep_data2(resolveOptional("R_set_altrep_data2"));
+    ptr_GC_R_set_altrep_Length_method = Prot_GC_R_set_altrep_Length_method(resolveOptional("R_set_altrep_Length_method"));
+    ptr_GC_R_set_altrep_Duplicate_method = Prot_GC_R_set_altrep_Duplicate_method(resolveOptional("R_set_altrep_Duplicate_method"));
+    ptr_GC_R_set_altvec_Dataptr_method = Prot_GC_R_set_altvec_Dataptr_method(resolveOptional("R_set_altvec_Dataptr_method"));
+    ptr_GC_R_set_altvec_Dataptr_or_null_method = Prot_GC_R_set_altvec_Dataptr_or_null_method(resolveOptional("R_set_altvec_Dataptr_or_null_method"));
+    ptr_GC_R_set_altreal_Elt_method = Prot_GC_R_set_altreal_Elt_method(resolveOptional("R_set_altreal_Elt_method"));
+    ptr_GC_R_set_altreal_Get_region_method = Prot_GC_R_set_altreal_Get_region_method(resolveOptional("R_set_altreal_Get_region_method"));
+
+    GC_R_altrep = ptr_GC_R_make_altreal_class && ptr_GC_R_new_altrep &&
+                  ptr_GC_R_altrep_data1 && ptr_GC_R_altrep_data2 && ptr_GC_R_set_altrep_data2 &&
+                  ptr_GC_R_set_altrep_Length_method && ptr_GC_R_set_altrep_Duplicate_method &&
+                  ptr_GC_R_set_altvec_Dataptr_method && ptr_GC_R_set_altvec_Dataptr_or_null_method &&
+                  ptr_GC_R_set_altreal_Elt_method && ptr_GC_R_set_altreal_Get_region_method;
+#endif
 
     // Graphics Device
     ptr_GC_GEcreateDevDesc = Prot_GC_GEcreateDevDesc(resolve("GEcreateDevDesc"));
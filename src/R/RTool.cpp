@@ -18,6 +18,7 @@
 
 #include "RTool.h"
 #include "RGraphicsDevice.h"
+#include "RVector.h"
 #include "GcUpgrade.h"
 
 #include "RideCache.h"
@@ -256,6 +257,9 @@ RTool::RTool()
         if (majorN > 3 || (majorN == 3 && minorN > 3)) R_registerRoutines(info, (const R_CMethodDef*)(cMethods34), callMethods, NULL, NULL);
         else R_registerRoutines(info, (const R_CMethodDef*)(cMethods33), callMethods, NULL, NULL);
 
+        // vectors over activity and metric data
+        RVector::initialise(info);
+
         // what version are we running?
         #ifdef GC_WANT_ALLDEBUG
         fprintf(stderr,"R loaded. [Compiled=%s.%s, Loaded=%d.%d, Loaded DeviceEngine=%d]\n", R_MAJOR, R_MINOR, majorN, minorN, GC_R_GE_getVersion());
@@ -1213,9 +1217,13 @@ RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
 
     // we need to count rides that are in range...
     rides = 0;
+    QList<QPointer<RideItem> > selected;
     foreach(RideItem *ride, rtool->context->athlete->rideCache->rides()) {
         if (!specification.pass(ride)) continue;
-        if (all || range.pass(ride->dateTime.date())) rides++;
+        if (all || range.pass(ride->dateTime.date())) {
+            selected << ride;
+            rides++;
+        }
     }
 
     // get a listAllocated
@@ -1292,10 +1300,6 @@ RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
     //
     for(int i=0; i<factory.metricCount();i++) {
 
-        // set a vector
-        SEXP m;
-        PROTECT(m=Rf_allocVector(REALSXP, rides));
-
         QString symbol = factory.metricName(i);
         const RideMetric *metric = factory.rideMetric(symbol);
         QString name = rtool->context->specialFields.internalName(factory.rideMetric(symbol)->name());
@@ -1304,14 +1308,12 @@ RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
 
         bool useMetricUnits = rtool->context->athlete->useMetricUnits;
 
-        int index=0;
-        foreach(RideItem *item, rtool->context->athlete->rideCache->rides()) {
-            if (!specification.pass(item)) continue;
-            if (all || range.pass(item->dateTime.date())) {
-                REAL(m)[index++] = item->metrics()[i] * (useMetricUnits ? 1.0f : metric->conversion())
-                                                      + (useMetricUnits ? 0.0f : metric->conversionSum());
-            }
-        }
+        // set a vector, the values are only collected
+        // for the metrics the script actually uses
+        SEXP m;
+        PROTECT(m=RVector::vector(QSharedPointer<RVectorSource>(new RMetricColumn(selected, i,
+                                                          useMetricUnits ? 1.0f : metric->conversion(),
+                                                          useMetricUnits ? 0.0f : metric->conversionSum()))));
 
         // add to the list
         SET_VECTOR_ELT(ans, next, m);
@@ -2164,6 +2166,19 @@ RTool::dfForActivity(RideFile *f, int split, QString join)
     // return a data frame for the ride passed
     QList<SEXP> returning;
 
+    // the series are shared by each part when we split, and
+    // are only read from the ride when R uses them, or just
+    // before the ride is edited or closed
+    QSharedPointer<RVectorSource> times(new RRideTime(f));
+    RRideSnapshot::watch(f, times);
+    QVector<QSharedPointer<RVectorSource> > values(static_cast<int>(RideFile::none));
+    for(int i=0; i<static_cast<int>(RideFile::none); i++) {
+        RideFile::SeriesType series = static_cast<RideFile::SeriesType>(i);
+        if (i > 15 && !f->isDataPresent(series)) continue;
+        values[i] = QSharedPointer<RVectorSource>(new RRideSeries(f, series));
+        RRideSnapshot::watch(f, values[i]);
+    }
+
     // how many series?
     int seriescount=0;
     for(int i=0; i<static_cast<int>(RideFile::none); i++) {
@@ -2219,12 +2234,9 @@ RTool::dfForActivity(RideFile *f, int split, QString join)
         // TIME
 
         // add in actual time in POSIXct format
-        SEXP time = PROTECT(Rf_allocVector(REALSXP, points));
+        SEXP time = PROTECT(RVector::vector(times, index, points));
         pcount++;
 
-        // fill with values for date and class
-        for(int k=0; k<points; k++) REAL(time)[k] = f->startTime().addSecs(f->dataPoints()[index+k]->secs).toUTC().toTime_t();
-
         // POSIXct class
         SEXP clas = PROTECT(Rf_allocVector(STRSXP, 2));
         pcount++;
@@ -2249,20 +2261,9 @@ RTool::dfForActivity(RideFile *f, int split, QString join)
             if (s > 15 && !f->isDataPresent(series)) continue;
 
             // set a vector
-            SEXP vector = PROTECT(Rf_allocVector(REALSXP, points));
+            SEXP vector = PROTECT(RVector::vector(values[s], index, points));
             pcount++;
 
-            for(int j=index; j<stop; j++) {
-                if (f->isDataPresent(series)) {
-                    if (f->dataPoints()[j]->value(series) == 0 && (series == RideFile::lat || series == RideFile::lon))
-                        REAL(vector)[j-index] = NA_REAL;
-                    else
-                        REAL(vector)[j-index] = f->dataPoints()[j]->value(series);
-                } else {
-                    REAL(vector)[j-index] = NA_REAL;
-                }
-            }
-
             // add to the list
             SET_VECTOR_ELT(ans, next, vector);
 
@@ -2409,7 +2410,8 @@ RTool::activity(SEXP datetime, SEXP pCompare, SEXP pSplit, SEXP pJoin)
                 if (rtool->cancelled) break;
 
                 // we open, if it wasn't open we also close
-                // to make sure we don't exhause memory
+                // to make sure we don't exhause memory, the
+                // series are read as it closes (RRideSnapshot)
                 bool close = (item->isOpen() == false);
                 foreach(SEXP df, rtool->dfForActivity(item->ride(), split, join)) f<<df;
                 if (close) item->close();
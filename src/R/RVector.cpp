@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "RVector.h"
+#include "RideItem.h"
+#include "RideFileCommand.h"
+
+#include <string.h>
+
+//
+// Sources
+//
+const double *
+RVectorSource::data()
+{
+    if (!filled) {
+        values.resize(count);
+        if (count) fill(values.data());
+        filled = true;
+    }
+    return values.constData();
+}
+
+RRideSeries::RRideSeries(RideFile *f, RideFile::SeriesType series)
+    : RVectorSource(f->dataPoints().count()), ride(f), series(series)
+{
+}
+
+void
+RRideSeries::fill(double *values)
+{
+    // the ride may have been edited or closed since
+    int points = 0;
+    if (ride && ride->isDataPresent(series)) {
+        points = qMin(count, ride->dataPoints().count());
+        for(int i=0; i<points; i++) {
+            double value = ride->dataPoints()[i]->value(series);
+            if (value == 0 && (series == RideFile::lat || series == RideFile::lon)) values[i] = NA_REAL;
+            else values[i] = value;
+        }
+    }
+    for(int i=points; i<count; i++) values[i] = NA_REAL;
+}
+
+void
+RRideTime::fill(double *values)
+{
+    int points = 0;
+    if (ride) {
+        double start = ride->startTime().toUTC().toTime_t();
+        points = qMin(count, ride->dataPoints().count());
+        for(int i=0; i<points; i++) values[i] = start + qint64(ride->dataPoints()[i]->secs);
+    }
+    for(int i=points; i<count; i++) values[i] = NA_REAL;
+}
+
+//
+// Snapshots
+//
+QHash<RideFile*, RRideSnapshot*> RRideSnapshot::watching;
+
+RRideSnapshot::RRideSnapshot(RideFile *f) : ride(f)
+{
+    // direct, they must be read before the change is made
+    connect(f, SIGNAL(deleted()), this, SLOT(rideDeleted()), Qt::DirectConnection);
+    connect(f->command, SIGNAL(beginCommand(bool,RideCommand*)), this, SLOT(snapshot()), Qt::DirectConnection);
+}
+
+void
+RRideSnapshot::watch(RideFile *f, QSharedPointer<RVectorSource> source)
+{
+    RRideSnapshot *watcher = watching.value(f, NULL);
+    if (watcher == NULL) {
+        watcher = new RRideSnapshot(f);
+        watching.insert(f, watcher);
+    }
+
+    // forget any R has let go of
+    for(int i=watcher->sources.count()-1; i>=0; i--)
+        if (watcher->sources[i].isNull()) watcher->sources.removeAt(i);
+
+    watcher->sources << source.toWeakRef();
+}
+
+void
+RRideSnapshot::snapshot()
+{
+    foreach(QWeakPointer<RVectorSource> source, sources) {
+        QSharedPointer<RVectorSource> held = source.toStrongRef();
+        if (held) held->data();
+    }
+    sources.clear();
+}
+
+void
+RRideSnapshot::rideDeleted()
+{
+    snapshot();
+    watching.remove(ride);
+    deleteLater();
+}
+
+void
+RMetricColumn::fill(double *values)
+{
+    for(int i=0; i<count; i++) {
+        RideItem *item = rides[i];
+        if (item && index < item->metrics().count()) values[i] = item->metrics()[index] * factor + offset;
+        else values[i] = NA_REAL;
+    }
+}
+
+//
+// Vectors
+//
+
+// what an R vector refers to
+struct RVectorView {
+    QSharedPointer<RVectorSource> source;
+    int offset, count;
+};
+
+#ifdef R_EXT_ALTREP_H_
+
+static R_altrep_class_t gcSeries;
+
+static RVectorView *
+view(SEXP x)
+{
+    return static_cast<RVectorView*>(R_ExternalPtrAddr(R_altrep_data1(x)));
+}
+
+static void
+finalize(SEXP ptr)
+{
+    delete static_cast<RVectorView*>(R_ExternalPtrAddr(ptr));
+    R_ClearExternalPtr(ptr);
+}
+
+static SEXP
+make(RVectorView *v)
+{
+    SEXP ptr = PROTECT(R_MakeExternalPtr(v, R_NilValue, R_NilValue));
+    R_RegisterCFinalizerEx(ptr, finalize, TRUE);
+    SEXP ans = R_new_altrep(gcSeries, ptr, R_NilValue);
+    UNPROTECT(1);
+    return ans;
+}
+
+static R_xlen_t
+seriesLength(SEXP x)
+{
+    return view(x)->count;
+}
+
+// data2 holds R's own copy once it has written to it
+static const void *
+seriesDataptrOrNull(SEXP x)
+{
+    SEXP copy = R_altrep_data2(x);
+    if (copy != R_NilValue) return REAL(copy);
+
+    RVectorView *v = view(x);
+    return v->source->data() + v->offset;
+}
+
+static void *
+seriesDataptr(SEXP x, Rboolean writeable)
+{
+    SEXP copy = R_altrep_data2(x);
+    if (copy == R_NilValue && writeable) {
+        RVectorView *v = view(x);
+        PROTECT(copy = Rf_allocVector(REALSXP, v->count));
+        if (v->count) memcpy(REAL(copy), v->source->data() + v->offset, v->count * sizeof(double));
+        R_set_altrep_data2(x, copy);
+        UNPROTECT(1);
+    }
+    return const_cast<void*>(seriesDataptrOrNull(x));
+}
+
+static double
+seriesElt(SEXP x, R_xlen_t i)
+{
+    return static_cast<const double*>(seriesDataptrOrNull(x))[i];
+}
+
+static R_xlen_t
+seriesGetRegion(SEXP x, R_xlen_t i, R_xlen_t n, double *buf)
+{
+    const double *values = static_cast<const double*>(seriesDataptrOrNull(x));
+    R_xlen_t count = qMin(n, seriesLength(x) - i);
+    for(R_xlen_t k=0; k<count; k++) buf[k] = values[i+k];
+    return count;
+}
+
+static SEXP
+seriesDuplicate(SEXP x, Rboolean)
+{
+    // once written R copies its own values
+    if (R_altrep_data2(x) != R_NilValue) return NULL;
+
+    // otherwise the copy shares the source too
+    return make(new RVectorView(*view(x)));
+}
+
+#endif
+
+void
+RVector::initialise(DllInfo *info)
+{
+#ifdef R_EXT_ALTREP_H_
+    if (!GC_R_altrep) return;
+
+    gcSeries = R_make_altreal_class("gc_series", "GoldenCheetah", info);
+    R_set_altrep_Length_method(gcSeries, seriesLength);
+    R_set_altrep_Duplicate_method(gcSeries, seriesDuplicate);
+    R_set_altvec_Dataptr_method(gcSeries, seriesDataptr);
+    R_set_altvec_Dataptr_or_null_method(gcSeries, seriesDataptrOrNull);
+    R_set_altreal_Elt_method(gcSeries, seriesElt);
+    R_set_altreal_Get_region_method(gcSeries, seriesGetRegion);
+#else
+    Q_UNUSED(info);
+#endif
+}
+
+static bool sharing = true;
+
+bool
+RVector::shared()
+{
+#ifdef R_EXT_ALTREP_H_
+    return GC_R_altrep && sharing;
+#else
+    return false;
+#endif
+}
+
+void
+RVector::setShared(bool share)
+{
+    sharing = share;
+}
+
+SEXP
+RVector::vector(QSharedPointer<RVectorSource> source, int offset, int count)
+{
+#ifdef R_EXT_ALTREP_H_
+    if (shared()) {
+        RVectorView *v = new RVectorView;
+        v->source = source;
+        v->offset = offset;
+        v->count = count;
+        return make(v);
+    }
+#endif
+
+    // R has its own copy
+    SEXP ans = Rf_allocVector(REALSXP, count);
+    if (count) memcpy(REAL(ans), source->data() + offset, count * sizeof(double));
+    return ans;
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GC_RVector_h
+#define GC_RVector_h
+
+#include "REmbed.h"
+#include "RideFile.h"
+
+#include <QObject>
+#include <QVector>
+#include <QList>
+#include <QHash>
+#include <QPointer>
+#include <QSharedPointer>
+
+class RideItem;
+
+// the values behind one or more R vectors, they are
+// only fetched the first time R looks at them
+class RVectorSource {
+
+    public:
+        RVectorSource(int count) : count(count), filled(false) {}
+        virtual ~RVectorSource() {}
+
+        const double *data();
+        int count;
+
+    protected:
+        virtual void fill(double *values) = 0;
+
+    private:
+        QVector<double> values;
+        bool filled;
+};
+
+// a ride series, NA when not present. See RRideSnapshot, R keeps
+// the values the ride had when it was handed the vector
+class RRideSeries : public RVectorSource {
+
+    public:
+        RRideSeries(RideFile *f, RideFile::SeriesType series);
+
+    protected:
+        void fill(double *values);
+        QPointer<RideFile> ride;
+        RideFile::SeriesType series;
+};
+
+// sample times as seconds since the epoch (for POSIXct)
+class RRideTime : public RRideSeries {
+
+    public:
+        RRideTime(RideFile *f) : RRideSeries(f, RideFile::secs) {}
+
+    protected:
+        void fill(double *values);
+};
+
+// a metric for a list of rides, in the athlete's units
+class RMetricColumn : public RVectorSource {
+
+    public:
+        RMetricColumn(QList<QPointer<RideItem> > rides, int index, double factor, double offset)
+            : RVectorSource(rides.count()), rides(rides), index(index), factor(factor), offset(offset) {}
+
+    protected:
+        void fill(double *values);
+
+    private:
+        QList<QPointer<RideItem> > rides;
+        int index;
+        double factor, offset;
+};
+
+// Ride series are read when R first looks at them, so any R still refers
+// to are read just before the ride is edited or deleted (e.g. closed once
+// GC.activity has built the data frames for a list of activities) and
+// from then on they no longer follow the ride.
+class RRideSnapshot : public QObject {
+
+    Q_OBJECT
+
+    public:
+        static void watch(RideFile *f, QSharedPointer<RVectorSource> source);
+
+    private slots:
+        void snapshot();
+        void rideDeleted();
+
+    private:
+        RRideSnapshot(RideFile *f);
+
+        RideFile *ride;
+        QList<QWeakPointer<RVectorSource> > sources;
+
+        static QHash<RideFile*, RRideSnapshot*> watching;
+};
+
+//
+// R numeric vectors over data we already hold
+//
+// With R 3.5 or higher they are ALTREP vectors that read the source
+// directly; R only gets a copy of its own if it wants to change one.
+// Vectors from the same source (e.g. when an activity is split) share
+// it. With older versions of R the values are copied as before.
+//
+class RVector {
+
+    public:
+        // register the vector class, once R is running
+        static void initialise(DllInfo *info);
+
+        // a REALSXP of count values from offset, unprotected
+        // just like Rf_allocVector
+        static SEXP vector(QSharedPointer<RVectorSource> source, int offset, int count);
+        static SEXP vector(QSharedPointer<RVectorSource> source) { return vector(source, 0, source->count); }
+
+        // are vectors shared with R or copied? The benchmark
+        // turns sharing off to compare
+        static bool shared();
+        static void setShared(bool);
+};
+
+#endif
@@ -0,0 +1,190 @@
+#
+# Worker process started by PythonWorkers to run Python user
+# metrics and data processors outside the embedded interpreter
+#
+# Jobs and replies are lines of json on stdin/stdout, ride series
+# are read from (and written to) the file named on the command line
+# which GoldenCheetah has mapped into memory too. The second file is
+# library.py, for the constants it defines.
+#
+# Only the calls a script needs for the ride it is run on are here,
+# anything else raises Unsupported and the job is run again by the
+# embedded interpreter. The call is recorded on GC as it is raised,
+# so a script that catches it (even with a bare except) is still
+# run again.
+#
+import sys
+import json
+import mmap
+import datetime
+import threading
+import traceback
+
+class Unsupported(BaseException):
+   pass
+
+# same as the embedded interpreter, output goes to messages
+class CatchOutErr:
+   def __init__(self):
+      self.value = ''
+   def write(self, txt):
+      self.value += txt
+   def flush(self):
+      pass
+
+channelIn = sys.stdin.buffer
+channelOut = sys.stdout.buffer
+catchOutErr = CatchOutErr()
+sys.stdout = catchOutErr
+sys.stderr = catchOutErr
+
+shared = open(sys.argv[1], "r+b")
+mapped = None
+mappedSize = 0
+
+# run library.py against a stand in for GC to collect the constants it
+# defines, the functions it adds need the embedded interpreter's GC
+class LibraryGC:
+   pass
+
+library = { "__name__": "library", "__builtins__": __builtins__, "GC": LibraryGC() }
+with open(sys.argv[2], "r") as source:
+   exec(compile(source.read(), "library.py", "exec"), library)
+
+constants = {}
+for name, value in library.items():
+   if not name.startswith("_") and name != "GC" and not callable(value):
+      constants[name] = value
+gcConstants = {}
+for name, value in vars(library["GC"]).items():
+   if not callable(value):
+      gcConstants[name] = value
+
+def send(message):
+   channelOut.write(json.dumps(message).encode("utf-8") + b"\n")
+   channelOut.flush()
+
+def call(request):
+   send(request)
+   line = channelIn.readline()
+   if not line:
+      sys.exit(0)
+   return json.loads(line.decode("utf-8"))
+
+def sharedMemory(size):
+   # the file only grows, views on the old mapping stay valid
+   global mapped, mappedSize
+   if size > mappedSize:
+      mapped = memoryview(mmap.mmap(shared.fileno(), size))
+      mappedSize = size
+   return mapped
+
+class Bindings:
+   # GC.SERIES_WATTS, GC.CHART_LINE ... are added below
+
+   def __init__(self, job):
+      self.job = job
+      self.value = 0
+      self.fetched = {}
+      self.unsupported = ""
+
+   # the first unsupported call is the one reported
+   def unsupportedCall(self, name):
+      if not self.unsupported:
+         self.unsupported = name
+      return Unsupported(name)
+
+   def __getattr__(self, name):
+      raise self.unsupportedCall(name)
+
+   def threadid(self):
+      return threading.get_ident()
+
+   def build(self):
+      return self.job["build"]
+
+   def version(self):
+      return self.job["version"]
+
+   def result(self, value):
+      self.value = float(value)
+
+   def seriesLast(self):
+      return len(self.job["names"])
+
+   def seriesName(self, type):
+      return self.job["names"][type]
+
+   def seriesPresent(self, type, activity=None):
+      if activity is not None:
+         raise self.unsupportedCall("seriesPresent")
+      if type < 0 or type >= len(self.job["present"]):
+         return False
+      return self.job["present"][type]
+
+   def series(self, type=10, activity=None):
+      if activity is not None:
+         raise self.unsupportedCall("series")
+      if type not in self.fetched:
+         reply = call({"call": "series", "type": type})
+         if "unsupported" in reply:
+            raise self.unsupportedCall("series")
+         start = reply["offset"]
+         values = sharedMemory(reply["size"])[start:start + 8 * reply["count"]].cast("d")
+         if self.job["readOnly"] and hasattr(values, "toreadonly"):
+            values = values.toreadonly()
+         self.fetched[type] = values
+      return self.fetched[type]
+
+   def activity(self, join="repeat", activity=None):
+      if activity is not None or self.job["xdata"]:
+         raise self.unsupportedCall("activity")
+      rd = {}
+      for x in range(0, self.seriesLast()):
+         if self.seriesPresent(x):
+            rd[self.seriesName(x)] = self.series(x)
+      return rd
+
+   def activityMetrics(self, compare=False):
+      if compare:
+         raise self.unsupportedCall("activityMetrics")
+      rd = call({"call": "activityMetrics"})
+      if "date" in rd:
+         rd["date"] = datetime.datetime.strptime(rd["date"], "%Y-%m-%d").date()
+         rd["time"] = datetime.datetime.strptime(rd["time"], "%H:%M:%S.%f").time()
+      return rd
+
+   def athlete(self):
+      rd = call({"call": "athlete"})
+      if "dob" in rd:
+         rd["dob"] = datetime.datetime.strptime(rd["dob"], "%Y-%m-%d").date()
+      return rd
+
+for name, value in gcConstants.items():
+   setattr(Bindings, name, value)
+
+while True:
+   line = channelIn.readline()
+   if not line:
+      break
+
+   job = json.loads(line.decode("utf-8"))
+   GC = Bindings(job)
+   catchOutErr.__init__()
+
+   try:
+      code = compile(job["script"], "<string>", "exec")
+      scope = dict(constants)
+      scope.update({"__name__": "__main__", "__builtins__": __builtins__, "GC": GC})
+      exec(code, scope)
+   except Unsupported:
+      pass
+   except SystemExit:
+      pass
+   except BaseException:
+      traceback.print_exc()
+
+   # views on the shared memory go with the job, an unsupported
+   # call fails the job even if the script caught the exception
+   GC.fetched = {}
+   send({"call": "done", "result": GC.value, "messages": catchOutErr.value, "unsupported": GC.unsupported})
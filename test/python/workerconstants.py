@@ -0,0 +1,68 @@
+#
+# Checks the Python worker (src/Resources/python/worker.py) gives scripts
+# the constants library.py defines for the embedded interpreter.
+#
+# Run from the top of the source tree: python3 test/python/workerconstants.py
+#
+# It talks to the worker the way PythonWorker does, lines of json on
+# stdin/stdout with the series in a shared file.
+#
+import os
+import sys
+import json
+import array
+import tempfile
+import subprocess
+
+top = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..")
+worker = os.path.join(top, "src", "Resources", "python", "worker.py")
+library = os.path.join(top, "src", "Resources", "python", "library.py")
+
+watts = [100.0, 200.0, 300.0, 400.0]
+names = ["SECS", "CAD", "CADD", "HR", "HRD", "KM", "KPH", "KPHD", "NM", "NMD", "WATTS"]
+
+shared = tempfile.NamedTemporaryFile(prefix="GCpython")
+shared.write(array.array("d", watts).tobytes())
+shared.flush()
+
+process = subprocess.Popen([sys.executable, "-u", worker, shared.name, library],
+                           stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+
+def run(script):
+   job = { "script": script, "names": names, "present": [True] * len(names),
+           "xdata": False, "readOnly": True, "build": 0, "version": "test" }
+   process.stdin.write(json.dumps(job).encode("utf-8") + b"\n")
+   process.stdin.flush()
+   while True:
+      message = json.loads(process.stdout.readline().decode("utf-8"))
+      if message["call"] == "done":
+         return message
+      if message["call"] == "series" and message["type"] == 10:
+         reply = { "offset": 0, "count": len(watts), "size": len(watts) * 8 }
+      else:
+         reply = { "unsupported": True }
+      process.stdin.write(json.dumps(reply).encode("utf-8") + b"\n")
+      process.stdin.flush()
+
+failed = 0
+def check(name, script, result, unsupported=""):
+   global failed
+   done = run(script)
+   if done["result"] != result or done["unsupported"] != unsupported or (not unsupported and done["messages"]):
+      print("FAIL %s: %s" % (name, done))
+      failed += 1
+   else:
+      print("PASS %s" % name)
+
+check("GC.SERIES_*", "GC.result(sum(GC.series(GC.SERIES_WATTS)) / len(GC.series(GC.SERIES_WATTS)))", 250)
+check("GC.CHART_*", "GC.result(GC.CHART_LINE + GC.CHART_PIE)", 5)
+check("module constants", "GC.result(GC_LINE_SOLID * 10 + GC_ALIGN_RIGHT)", 13)
+check("constants are per job", "GC_LINE_SOLID = 7\nGC.result(GC_LINE_SOLID)", 7)
+check("constants are per job", "GC.result(GC_LINE_SOLID)", 1)
+
+# charts are left to the embedded interpreter
+check("GC.setChart", "GC.setChart(title='x', type=GC.CHART_LINE)", 0, "setChart")
+
+process.stdin.close()
+process.wait()
+sys.exit(1 if failed else 0)
@@ -0,0 +1,175 @@
+#!/usr/bin/env python
+
+"""
+Load generator for the GoldenCheetah API web services (--server).
+
+Opens a number of keep-alive connections to the server and sends the
+given paths round robin on each, optionally pipelining several requests
+before reading the responses. Reports throughput and the latency of the
+responses, measured from sending a request to receiving all of it.
+
+e.g. with the server running on the default port:
+
+    httpbench.py -c 32 -n 200 /
+    httpbench.py -c 8 -p 4 "/Joe Bloggs" "/Joe Bloggs/meanmax/bests"
+"""
+
+import argparse
+import socket
+import sys
+import threading
+import time
+
+try:
+    from urllib import quote
+except ImportError:
+    from urllib.parse import quote
+
+
+class Connection(object):
+    """One keep-alive connection reading responses from a buffer."""
+
+    def __init__(self, host, port):
+        self.sock = socket.create_connection((host, port))
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self.buffer = b""
+
+    def fill(self):
+        data = self.sock.recv(65536)
+        if not data:
+            raise IOError("connection closed by server")
+        self.buffer += data
+
+    def line(self):
+        while b"\r\n" not in self.buffer:
+            self.fill()
+        line, self.buffer = self.buffer.split(b"\r\n", 1)
+        return line
+
+    def bytes(self, count):
+        while len(self.buffer) < count:
+            self.fill()
+        data, self.buffer = self.buffer[:count], self.buffer[count:]
+        return data
+
+    def response(self):
+        """Read one response, returns the status and body size."""
+        status = int(self.line().split(b" ")[1])
+        headers = {}
+        while True:
+            line = self.line()
+            if not line:
+                break
+            name, value = line.split(b":", 1)
+            headers[name.strip().lower()] = value.strip()
+
+        size = 0
+        if headers.get(b"transfer-encoding", b"").lower() == b"chunked":
+            while True:
+                chunk = int(self.line().split(b";")[0], 16)
+                if chunk == 0:
+                    self.line()
+                    break
+                size += len(self.bytes(chunk))
+                self.line()
+        elif b"content-length" in headers:
+            size = len(self.bytes(int(headers[b"content-length"])))
+        else:
+            # body runs to the end of the connection
+            try:
+                while True:
+                    self.fill()
+            except IOError:
+                pass
+            size = len(self.buffer)
+            self.buffer = b""
+            self.sock.close()
+            self.sock = None
+        return status, size, headers.get(b"connection", b"").lower() == b"close"
+
+
+def client(args, requests, results, errors):
+    latencies = []
+    received = 0
+    statuses = {}
+    try:
+        conn = Connection(args.host, args.port)
+        sent = 0
+        while sent < len(requests):
+            batch = requests[sent:sent + args.pipeline]
+            start = time.time()
+            conn.sock.sendall(b"".join(batch))
+            for _ in batch:
+                status, size, close = conn.response()
+                latencies.append(time.time() - start)
+                received += size
+                statuses[status] = statuses.get(status, 0) + 1
+                if close or conn.sock is None:
+                    raise IOError("server closed the connection")
+            sent += len(batch)
+        conn.sock.close()
+    except Exception as e:
+        errors.append(str(e))
+    results.append((latencies, received, statuses))
+
+
+def percentile(values, p):
+    if not values:
+        return 0
+    return values[min(len(values) - 1, int(len(values) * p / 100.0))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Load generator for the API web services")
+    parser.add_argument("paths", nargs="*", default=["/"], help="paths to request, round robin")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=12021)
+    parser.add_argument("-c", "--connections", type=int, default=16, help="concurrent connections")
+    parser.add_argument("-n", "--requests", type=int, default=100, help="requests per connection")
+    parser.add_argument("-p", "--pipeline", type=int, default=1, help="requests sent before reading responses")
+    parser.add_argument("-H", "--header", action="append", default=[], help="extra request header")
+    args = parser.parse_args()
+
+    extra = "".join(h + "\r\n" for h in args.header)
+    templates = [("GET %s HTTP/1.1\r\nHost: %s:%d\r\n%s\r\n" %
+                  (quote(p, safe="/?=&"), args.host, args.port, extra)).encode("latin-1")
+                 for p in args.paths]
+
+    results = []
+    errors = []
+    threads = []
+    start = time.time()
+    for c in range(args.connections):
+        requests = [templates[(c + i) % len(templates)] for i in range(args.requests)]
+        t = threading.Thread(target=client, args=(args, requests, results, errors))
+        t.start()
+        threads.append(t)
+    for t in threads:
+        t.join()
+    elapsed = time.time() - start
+
+    latencies = sorted(l for r in results for l in r[0])
+    received = sum(r[1] for r in results)
+    statuses = {}
+    for r in results:
+        for status, count in r[2].items():
+            statuses[status] = statuses.get(status, 0) + count
+
+    print("connections %d, pipeline %d, %d responses in %.2fs" %
+          (args.connections, args.pipeline, len(latencies), elapsed))
+    if elapsed > 0:
+        print("throughput  %.1f requests/s, %.1f KB/s" % (len(latencies) / elapsed, received / 1024.0 / elapsed))
+    print("status      " + ", ".join("%d: %d" % (s, statuses[s]) for s in sorted(statuses)))
+    if latencies:
+        print("latency ms  mean %.2f, p50 %.2f, p90 %.2f, p99 %.2f, max %.2f" %
+              (1000 * sum(latencies) / len(latencies),
+               1000 * percentile(latencies, 50), 1000 * percentile(latencies, 90),
+               1000 * percentile(latencies, 99), 1000 * latencies[-1]))
+    for e in sorted(set(errors)):
+        print("error       %s (%d connections)" % (e, errors.count(e)))
+
+    return 1 if errors else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())